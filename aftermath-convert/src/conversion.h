@@ -0,0 +1,41 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_CONVERT_CONVERSION_H
+#define AM_CONVERT_CONVERSION_H
+
+#include <stdint.h>
+
+/* Parameters common to all input formats */
+struct am_convert_params {
+	/* Maximum number of threads used to convert independent event streams
+	 * in parallel. A value of zero indicates one thread per online
+	 * processor. */
+	unsigned int num_workers;
+};
+
+/* Statistics gathered during a conversion */
+struct am_convert_stats {
+	/* Number of bytes consumed from the input file */
+	uint64_t bytes_read;
+
+	/* Number of bytes written to the output file */
+	uint64_t bytes_written;
+};
+
+#endif
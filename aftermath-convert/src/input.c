@@ -0,0 +1,156 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "input.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Tries to map the entire input file into memory, with the window starting at
+ * the current position of the file pointer. Returns 0 on success, otherwise
+ * 1. */
+static int am_convert_input_try_map(struct am_convert_input* in, off_t offset)
+{
+	struct stat st;
+	void* addr;
+
+	if(offset < 0 || fstat(fileno(in->fp), &st))
+		return 1;
+
+	if(!S_ISREG(st.st_mode) || st.st_size <= offset)
+		return 1;
+
+	if((uintmax_t)st.st_size > SIZE_MAX)
+		return 1;
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		    fileno(in->fp), 0);
+
+	if(addr == MAP_FAILED)
+		return 1;
+
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+	in->map_base = addr;
+	in->map_size = st.st_size;
+	in->data = addr;
+	in->capacity = st.st_size;
+	in->len = st.st_size;
+	in->pos = offset;
+	in->window_offset = 0;
+
+	return 0;
+}
+
+/* Initializes the input of a conversion reading from fp, starting at the
+ * current position of fp. If the input cannot be mapped, it is read in blocks
+ * of block_size bytes. Returns 0 on success, otherwise 1. */
+int am_convert_input_init(struct am_convert_input* in,
+			  FILE* fp,
+			  size_t block_size)
+{
+	off_t offset = ftello(fp);
+
+	in->fp = fp;
+	in->map_base = NULL;
+	in->map_size = 0;
+
+	if(!am_convert_input_try_map(in, offset))
+		return 0;
+
+	if(!(in->data = malloc(block_size)))
+		return 1;
+
+	in->capacity = block_size;
+	in->len = 0;
+	in->pos = 0;
+	in->window_offset = (offset < 0) ? 0 : offset;
+
+	return 0;
+}
+
+/* Destroys the input of a conversion. The file pointer is not closed. */
+void am_convert_input_destroy(struct am_convert_input* in)
+{
+	if(in->map_base)
+		munmap(in->map_base, in->map_size);
+	else
+		free(in->data);
+}
+
+/* Makes sure that at least size bytes are available in the window by moving the
+ * remaining data to the beginning of the block buffer and reading another
+ * block. Returns 0 if at least size bytes are available, otherwise 1. */
+static int am_convert_input_fill(struct am_convert_input* in, size_t size)
+{
+	size_t avail = in->len - in->pos;
+	size_t nread;
+	char* tmp;
+
+	if(avail >= size)
+		return 0;
+
+	if(in->map_base)
+		return 1;
+
+	memmove(in->data, in->data + in->pos, avail);
+	in->window_offset += in->pos;
+	in->len = avail;
+	in->pos = 0;
+
+	if(size > in->capacity) {
+		if(!(tmp = realloc(in->data, size)))
+			return 1;
+
+		in->data = tmp;
+		in->capacity = size;
+	}
+
+	while(in->len < size) {
+		nread = fread(in->data + in->len, 1,
+			      in->capacity - in->len, in->fp);
+
+		if(nread == 0)
+			return 1;
+
+		in->len += nread;
+	}
+
+	return 0;
+}
+
+/* Slow path of am_convert_input_read for reads crossing the end of the current
+ * window. Returns 0 on success, otherwise 1. */
+int am_convert_input_read_slow(struct am_convert_input* in,
+			       void* buf,
+			       size_t size)
+{
+	if(am_convert_input_fill(in, size))
+		return 1;
+
+	memcpy(buf, in->data + in->pos, size);
+	in->pos += size;
+
+	return 0;
+}
+
+/* Returns true if all data of the input has been consumed, otherwise false. */
+int am_convert_input_eof(struct am_convert_input* in)
+{
+	return am_convert_input_fill(in, 1);
+}
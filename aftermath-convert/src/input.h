@@ -0,0 +1,114 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_CONVERT_INPUT_H
+#define AM_CONVERT_INPUT_H
+
+#include <aftermath/core/convert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+/* Default size of the blocks read from input files that cannot be mapped into
+ * memory */
+#define AM_CONVERT_INPUT_DEFAULT_BLOCK_SIZE (16 << 20)
+
+/* Input file of a conversion. If the input file is a regular file, its contents
+ * are mapped into memory and all reads are served from the mapping. Otherwise,
+ * data is read through the file pointer in large blocks, such that the number
+ * of calls to the C library does not depend on the number of fields read. */
+struct am_convert_input {
+	FILE* fp;
+
+	/* Base address and size of the mapping or NULL and 0 if the input is
+	 * read in blocks */
+	char* map_base;
+	size_t map_size;
+
+	/* Window of input data; either the entire mapping or the block
+	 * buffer. The first len bytes are valid and pos is the offset of the
+	 * next byte to be read. */
+	char* data;
+	size_t capacity;
+	size_t len;
+	size_t pos;
+
+	/* Offset in the input file of the first byte of the window */
+	off_t window_offset;
+};
+
+int am_convert_input_init(struct am_convert_input* in,
+			  FILE* fp,
+			  size_t block_size);
+void am_convert_input_destroy(struct am_convert_input* in);
+int am_convert_input_read_slow(struct am_convert_input* in,
+			       void* buf,
+			       size_t size);
+int am_convert_input_eof(struct am_convert_input* in);
+
+/* Returns the offset in the input file of the next byte to be read. */
+static inline off_t am_convert_input_tell(const struct am_convert_input* in)
+{
+	return in->window_offset + in->pos;
+}
+
+/* Reads size bytes from the input into buf. Returns 0 on success, otherwise
+ * 1. */
+static inline int am_convert_input_read(struct am_convert_input* in,
+					void* buf,
+					size_t size)
+{
+	if(in->len - in->pos < size)
+		return am_convert_input_read_slow(in, buf, size);
+
+	memcpy(buf, in->data + in->pos, size);
+	in->pos += size;
+
+	return 0;
+}
+
+#define AM_CONVERT_DECL_INPUT_READ_INT_NOCONV_FUN(type)			\
+	static inline int							\
+	am_convert_input_read_##type(struct am_convert_input* in, type* out)	\
+	{									\
+		return am_convert_input_read(in, out, sizeof(*out));		\
+	}
+
+#define AM_CONVERT_DECL_INPUT_READ_INT_FUN(type, bits)				\
+	static inline int							\
+	am_convert_input_read_##type(struct am_convert_input* in, type* out)	\
+	{									\
+		if(am_convert_input_read(in, out, sizeof(*out)))		\
+			return 1;						\
+										\
+		*out = am_int##bits##_letoh(*out);				\
+										\
+		return 0;							\
+	}
+
+AM_CONVERT_DECL_INPUT_READ_INT_NOCONV_FUN(int8_t)
+AM_CONVERT_DECL_INPUT_READ_INT_NOCONV_FUN(uint8_t)
+AM_CONVERT_DECL_INPUT_READ_INT_FUN(int16_t, 16)
+AM_CONVERT_DECL_INPUT_READ_INT_FUN(uint16_t, 16)
+AM_CONVERT_DECL_INPUT_READ_INT_FUN(int32_t, 32)
+AM_CONVERT_DECL_INPUT_READ_INT_FUN(uint32_t, 32)
+AM_CONVERT_DECL_INPUT_READ_INT_FUN(int64_t, 64)
+AM_CONVERT_DECL_INPUT_READ_INT_FUN(uint64_t, 64)
+
+#endif
@@ -20,11 +20,14 @@
 #include <aftermath/core/on_disk.h>
 
 #include <getopt.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "conversion.h"
 #include "ost/ost.h"
 
 #define MAX_ERRSTACK_NESTING 10
@@ -33,6 +36,7 @@
 struct am_convert_options {
 	const char* input_filename;
 	const char* output_filename;
+	unsigned int num_workers;
 	int verbose;
 	int print_usage;
 };
@@ -76,7 +80,8 @@ static void print_usage(void)
 {
 	puts("Aftermath-convert, a utility converting Aftermath trace files.\n"
 	     "\n"
-	     "  Usage: aftermath-convert [-i input_file] [-o output_file] [-v]\n"
+	     "  Usage: aftermath-convert [-i input_file] [-o output_file]\n"
+	     "                           [-t num_threads] [-v]\n"
 	     "\n"
 	     "  -h             Display this help message.\n"
 	     "  -i input_file  Read trace data from input_file. If input_file\n"
@@ -85,7 +90,12 @@ static void print_usage(void)
 	     "  -o output_file Write trace data to output_file. If output_file\n"
 	     "                 is '-' or if the option is omitted, trace data\n"
 	     "                 is written to standard output.\n"
-	     "  -v             Verbose output on stderror.\n");
+	     "  -t num_threads Use at most num_threads threads to convert the\n"
+	     "                 events of different CPUs in parallel. If\n"
+	     "                 num_threads is 0 or if the option is omitted,\n"
+	     "                 one thread per online processor is used.\n"
+	     "  -v             Verbose output on stderror, including the\n"
+	     "                 throughput of the conversion.\n");
 }
 
 /* Checks if the short option c is specified as an option on a getopt option
@@ -112,13 +122,16 @@ static int parse_options(struct am_convert_options* o,
 			 char** argv,
 			 struct am_io_error_stack* estack)
 {
-	static const char* options_str = "hi:o:v";
+	static const char* options_str = "hi:o:t:v";
 	int opt;
 	char c;
+	char* endptr;
+	unsigned long num_workers;
 
 	/* Default values */
 	o->input_filename = NULL;
 	o->output_filename = NULL;
+	o->num_workers = 0;
 	o->verbose = 0;
 	o->print_usage = 0;
 
@@ -132,6 +145,23 @@ static int parse_options(struct am_convert_options* o,
 			case 'o':
 				o->output_filename = optarg;
 				break;
+			case 't':
+				num_workers = strtoul(optarg, &endptr, 10);
+
+				if(*optarg == '\0' || *endptr != '\0' ||
+				   num_workers > UINT_MAX)
+				{
+					am_io_error_stack_push(
+						estack,
+						AM_IOERR_ASSERT,
+						"Invalid number of threads "
+						"\"%s\".",
+						optarg);
+					return 1;
+				}
+
+				o->num_workers = num_workers;
+				break;
 			case 'v':
 				o->verbose = 1;
 				break;
@@ -177,22 +207,51 @@ static int
 convert_trace(FILE* fp_in,
 	      FILE* fp_out,
 	      enum am_convert_input_format format,
+	      const struct am_convert_params* params,
+	      struct am_convert_stats* stats,
 	      struct am_io_error_stack* estack)
 {
 	switch(format) {
 		case AM_CONVERT_INPUT_FORMAT_OST:
-			return am_convert_trace_ost(fp_in, fp_out, estack);
+			return am_convert_trace_ost(fp_in, fp_out, params,
+						    stats, estack);
 			break;
 	}
 
 	return 1;
 }
 
+/* Returns the difference in seconds between the timestamps start and end */
+static double timespec_diff_sec(const struct timespec* start,
+				const struct timespec* end)
+{
+	return (double)(end->tv_sec - start->tv_sec) +
+		(double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Prints the amount of data read and written as well as the throughput of a
+ * conversion that took the specified number of seconds to stderr */
+static void print_throughput(const struct am_convert_stats* stats,
+			     double seconds)
+{
+	double mb_read = (double)stats->bytes_read / 1e6;
+	double mb_written = (double)stats->bytes_written / 1e6;
+
+	fprintf(stderr,
+		"Read %.2f MB, wrote %.2f MB in %.3f s (%.2f MB/s).\n",
+		mb_read, mb_written, seconds,
+		(seconds > 0) ? mb_read / seconds : 0.0);
+}
+
 int main(int argc, char** argv)
 {
 	struct am_convert_options options;
 	struct am_io_error_stack estack;
 	enum am_convert_input_format format;
+	struct am_convert_params params;
+	struct am_convert_stats stats;
+	struct timespec start;
+	struct timespec end;
 	int ret = 1;
 	FILE* in_file = stdin;
 	FILE* out_file = stdout;
@@ -239,12 +298,27 @@ int main(int argc, char** argv)
 		}
 	}
 
+	params.num_workers = options.num_workers;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
 	if(am_convert_detect_format(in_file, &estack, &format))
 		goto out_outfile;
 
-	if(convert_trace(in_file, out_file, format, &estack))
+	if(convert_trace(in_file, out_file, format, &params, &stats, &estack))
 		goto out_outfile;
 
+	if(fflush(out_file)) {
+		am_io_error_stack_push(&estack,
+				       AM_IOERR_WRITE,
+				       "Could not write to output file.");
+		goto out_outfile;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if(options.verbose)
+		print_throughput(&stats, timespec_diff_sec(&start, &end));
+
 	ret = 0;
 
 out_outfile:
@@ -21,12 +21,16 @@
 #include <aftermath/core/on_disk.h>
 
 /* Converts a file in an old OST format to the most recent OST format. The input
- * file handle must be positioned after the magic number.
+ * file handle must be positioned after the magic number. Statistics on the
+ * conversion are stored in *stats.
  *
  * Returns 0 on success, otherwise 1.
  */
-int am_convert_trace_ost(
-	FILE* fp_in, FILE* fp_out, struct am_io_error_stack* estack)
+int am_convert_trace_ost(FILE* fp_in,
+			 FILE* fp_out,
+			 const struct am_convert_params* params,
+			 struct am_convert_stats* stats,
+			 struct am_io_error_stack* estack)
 {
 	uint32_t version;
 
@@ -44,7 +48,8 @@ int am_convert_trace_ost(
 		case 14:
 		case 15:
 		case 16:
-			return v16_convert_trace(fp_in, fp_out, estack);
+			return v16_convert_trace(fp_in, fp_out, params,
+						 stats, estack);
 		default:
 			am_io_error_stack_push(estack,
 					       AM_IOERR_READ,
@@ -21,8 +21,12 @@
 
 #include <aftermath/core/io_error.h>
 #include <stdio.h>
+#include "../conversion.h"
 
-int am_convert_trace_ost(
-	FILE* fp_in, FILE* fp_out, struct am_io_error_stack* estack);
+int am_convert_trace_ost(FILE* fp_in,
+			 FILE* fp_out,
+			 const struct am_convert_params* params,
+			 struct am_convert_stats* stats,
+			 struct am_io_error_stack* estack);
 
 #endif
@@ -18,6 +18,7 @@
 
 #include "v16.h"
 #include "v16_structs.h"
+#include "../input.h"
 #include <aftermath/core/convert.h>
 #include <aftermath/core/io_context.h>
 #include <aftermath/core/on_disk.h>
@@ -26,6 +27,7 @@
 #include <aftermath/core/safe_alloc.h>
 #include <aftermath/core/ansi_extras.h>
 #include <aftermath/core/bits.h>
+#include <aftermath/core/parallel.h>
 #include <stdint.h>
 
 /* The old trace format had a set of built-in states that didn't require a state
@@ -44,15 +46,130 @@ static char* v16_default_state_names[] = {
 
 #define V16_NUM_DEFAULT_STATES AM_ARRAY_SIZE(v16_default_state_names)
 
+/* Maximum number of events read from the input before the pending frames are
+ * written to the output file. This bounds the amount of memory used for
+ * buffering independently of the size of the input trace. */
+#define V16_MAX_PENDING_EVENTS (1 << 18)
+
+/* Output buffer backed by a memory stream. Frames are encoded into the buffer
+ * through fp and then written to the output file with a single call. */
+struct v16_chunk {
+	FILE* fp;
+	char* buf;
+	size_t size;
+};
+
+/* Initializes an empty chunk. Returns 0 on success, otherwise 1. */
+static int v16_chunk_init(struct v16_chunk* c)
+{
+	c->buf = NULL;
+	c->size = 0;
+
+	if(!(c->fp = open_memstream(&c->buf, &c->size)))
+		return 1;
+
+	return 0;
+}
+
+/* Destroys a chunk; any data not yet written is discarded. */
+static void v16_chunk_destroy(struct v16_chunk* c)
+{
+	fclose(c->fp);
+	free(c->buf);
+}
+
+/* Appends the contents of a chunk to fp_out and empties the chunk. The number
+ * of bytes written is added to *bytes_written. Returns 0 on success, otherwise
+ * 1. */
+static int v16_chunk_flush(struct v16_chunk* c,
+			   FILE* fp_out,
+			   uint64_t* bytes_written)
+{
+	off_t len;
+
+	if(fflush(c->fp))
+		return 1;
+
+	if((len = ftello(c->fp)) < 0)
+		return 1;
+
+	if(len > 0 && fwrite(c->buf, len, 1, fp_out) != 1)
+		return 1;
+
+	rewind(c->fp);
+	*bytes_written += len;
+
+	return 0;
+}
+
+AM_DECL_TYPED_ARRAY(v16_state_event_array, struct am_dsk_state_event)
+AM_DECL_TYPED_ARRAY(v16_counter_event_array, struct am_dsk_counter_event)
+
+/* Events of the event collection of a CPU that have been read from the input,
+ * but not yet been written to the output. Since the frames of an event
+ * collection only depend on the collection itself, the pending events of all
+ * CPUs are encoded in parallel, each into the CPU's own chunk. */
+struct v16_cpu_stream {
+	struct v16_state_event_array state_events;
+	struct v16_counter_event_array counter_events;
+
+	/* I/O context encoding the frames into the chunk */
+	struct am_io_context octx;
+	struct v16_chunk chunk;
+};
+
+/* Allocates and initializes a stream without pending events. Returns the new
+ * stream or NULL on failure. */
+static struct v16_cpu_stream* v16_cpu_stream_create(void)
+{
+	struct v16_cpu_stream* s;
+
+	if(!(s = malloc(sizeof(*s))))
+		goto out_err;
+
+	if(v16_chunk_init(&s->chunk))
+		goto out_err_free;
+
+	if(am_io_context_init(&s->octx, NULL))
+		goto out_err_chunk;
+
+	s->octx.fp = s->chunk.fp;
+	v16_state_event_array_init(&s->state_events);
+	v16_counter_event_array_init(&s->counter_events);
+
+	return s;
+
+out_err_chunk:
+	v16_chunk_destroy(&s->chunk);
+out_err_free:
+	free(s);
+out_err:
+	return NULL;
+}
+
+/* Destroys and frees a stream. */
+static void v16_cpu_stream_destroy(struct v16_cpu_stream* s)
+{
+	v16_state_event_array_destroy(&s->state_events);
+	v16_counter_event_array_destroy(&s->counter_events);
+
+	s->octx.fp = NULL;
+	am_io_context_destroy(&s->octx);
+	v16_chunk_destroy(&s->chunk);
+
+	free(s);
+}
+
 /* Structure accumulating information on a CPU: CPU number discovered through
- * the CPU field from the events, the NUMA node if define by a cpu info and the
+ * the CPU field from the events, the NUMA node if define by a cpu info, the
  * ID of default hierarchy node in the output trace associated to the CPU's
- * event collection */
+ * event collection and the pending events of the collection */
 struct v16_cpu_def {
 	uint32_t cpu;
 	uint32_t numa_node;
 	int numa_node_known;
 	uint32_t hnode_id;
+	struct v16_cpu_stream* stream;
 };
 
 #define ACC_CPU(cpu_def) (cpu_def).cpu
@@ -171,7 +288,23 @@ struct v16ctx {
 	uint64_t max_timestamp;
 
 	/* Input file in v16 format */
-	FILE* fp_in;
+	struct am_convert_input in;
+
+	/* Output file. All frames are first encoded into chunks and then
+	 * written to fp_out in large blocks. */
+	FILE* fp_out;
+
+	/* Chunk receiving all frames not associated to a CPU stream */
+	struct v16_chunk chunk;
+
+	/* Number of events read since the last flush */
+	size_t num_pending_events;
+
+	/* Maximum number of threads encoding CPU streams */
+	unsigned int num_workers;
+
+	/* Statistics updated during the conversion */
+	struct am_convert_stats* stats;
 
 	/* In the v16, measurement intervals are split across two global single
 	 * events. This interval collects the start and end timestamp of the two
@@ -293,8 +426,29 @@ static int v16ctx_register_frame_types(struct v16ctx* v16ctx)
 static int v16ctx_init(struct v16ctx* v16ctx,
 		       FILE* fp_in,
 		       FILE* fp_out,
+		       const struct am_convert_params* params,
+		       struct am_convert_stats* stats,
 		       struct am_io_error_stack* estack)
 {
+	if(am_convert_input_init(&v16ctx->in, fp_in,
+				 AM_CONVERT_INPUT_DEFAULT_BLOCK_SIZE))
+	{
+		am_io_error_stack_push(estack,
+				       AM_IOERR_ALLOC,
+				       "Could not initialize input buffer.");
+		goto out_err;
+	}
+
+	if(v16_chunk_init(&v16ctx->chunk)) {
+		am_io_error_stack_push(estack,
+				       AM_IOERR_ALLOC,
+				       "Could not initialize output buffer.");
+		goto out_err_in;
+	}
+
+	if(am_io_context_init(&v16ctx->octx, NULL))
+		goto out_err_chunk;
+
 	v16_cpu_array_init(&v16ctx->cpus);
 	v16_numa_node_array_init(&v16ctx->numa_nodes);
 	v16_texec_start_array_init(&v16ctx->per_cpu.last_texec_start);
@@ -302,26 +456,39 @@ static int v16ctx_init(struct v16ctx* v16ctx,
 	u64_array_init(&v16ctx->omp_task_type_addresses);
 	for_loop_type_array_init(&v16ctx->omp_for_loop_types);
 
-	v16ctx->fp_in = fp_in;
+	v16ctx->fp_out = fp_out;
+	v16ctx->num_pending_events = 0;
+	v16ctx->num_workers = params->num_workers;
+	v16ctx->stats = stats;
 	v16ctx->estack = estack;
 	v16ctx->max_timestamp = 0;
 	v16ctx->default_states_missing_description =
 		(1 << V16_NUM_DEFAULT_STATES) - 1;
 	v16ctx->measurement_interval_started = 0;
 
-	if(am_io_context_init(&v16ctx->octx, NULL))
-		return 1;
-
-	v16ctx->octx.fp = fp_out;
+	v16ctx->octx.fp = v16ctx->chunk.fp;
 	v16ctx->curr_id = 0;
 
+	stats->bytes_read = 0;
+	stats->bytes_written = 0;
+
 	return 0;
+
+out_err_chunk:
+	v16_chunk_destroy(&v16ctx->chunk);
+out_err_in:
+	am_convert_input_destroy(&v16ctx->in);
+out_err:
+	return 1;
 }
 
 /* Destroys a v16 conversion context. The input and output file handles are not
  * closed. */
 static void v16ctx_destroy(struct v16ctx* v16ctx)
 {
+	for(size_t i = 0; i < v16ctx->cpus.num_elements; i++)
+		v16_cpu_stream_destroy(v16ctx->cpus.elements[i].stream);
+
 	v16_cpu_array_destroy(&v16ctx->cpus);
 	v16_numa_node_array_destroy(&v16ctx->numa_nodes);
 	v16_texec_start_array_destroy(&v16ctx->per_cpu.last_texec_start);
@@ -332,6 +499,91 @@ static void v16ctx_destroy(struct v16ctx* v16ctx)
 	v16ctx->octx.fp = NULL;
 
 	am_io_context_destroy(&v16ctx->octx);
+	v16_chunk_destroy(&v16ctx->chunk);
+	am_convert_input_destroy(&v16ctx->in);
+}
+
+/* Encodes the pending events of the CPU stream with the index idx in the array
+ * of CPUs into the stream's chunk. Returns 0 on success, otherwise 1. */
+static int v16_cpu_stream_encode(void* data, size_t idx, unsigned int worker)
+{
+	struct v16ctx* v16ctx = data;
+	struct v16_cpu_stream* s = v16ctx->cpus.elements[idx].stream;
+	uint32_t se_type = AM_FRAME_TYPE_STATE_EVENT;
+	uint32_t ce_type = AM_FRAME_TYPE_COUNTER_EVENT;
+
+	for(size_t i = 0; i < s->state_events.num_elements; i++) {
+		if(am_dsk_state_event_write(&s->octx, se_type,
+					    &s->state_events.elements[i]))
+		{
+			am_io_error_stack_push(&s->octx.error_stack,
+					       AM_IOERR_WRITE,
+					       "Could not write state_event.");
+			return 1;
+		}
+	}
+
+	for(size_t i = 0; i < s->counter_events.num_elements; i++) {
+		if(am_dsk_counter_event_write(&s->octx, ce_type,
+					      &s->counter_events.elements[i]))
+		{
+			am_io_error_stack_push(&s->octx.error_stack,
+					       AM_IOERR_WRITE,
+					       "Could not write counter_event.");
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Writes all pending frames to the output file: first the frames from the
+ * chunk of the conversion context, then the events of each CPU, which are
+ * encoded in parallel beforehand.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int v16ctx_flush(struct v16ctx* v16ctx)
+{
+	struct v16_cpu_stream* s;
+	uint64_t* bytes_written = &v16ctx->stats->bytes_written;
+
+	if(am_parallel_for(v16ctx->cpus.num_elements,
+			   v16ctx->num_workers,
+			   v16_cpu_stream_encode,
+			   v16ctx))
+	{
+		for(size_t i = 0; i < v16ctx->cpus.num_elements; i++) {
+			s = v16ctx->cpus.elements[i].stream;
+			am_io_error_stack_move(v16ctx->estack,
+					       &s->octx.error_stack);
+		}
+
+		return 1;
+	}
+
+	if(v16_chunk_flush(&v16ctx->chunk, v16ctx->fp_out, bytes_written))
+		goto out_err;
+
+	for(size_t i = 0; i < v16ctx->cpus.num_elements; i++) {
+		s = v16ctx->cpus.elements[i].stream;
+
+		if(v16_chunk_flush(&s->chunk, v16ctx->fp_out, bytes_written))
+			goto out_err;
+
+		v16_state_event_array_reset(&s->state_events);
+		v16_counter_event_array_reset(&s->counter_events);
+	}
+
+	v16ctx->num_pending_events = 0;
+
+	return 0;
+
+out_err:
+	am_io_error_stack_push(v16ctx->estack,
+			       AM_IOERR_WRITE,
+			       "Could not write to output file.");
+	return 1;
 }
 
 /* Updates the maximum timestamp discovered in the input file if necessary */
@@ -683,6 +935,18 @@ v16ctx_find_add_cpu_def(struct v16ctx* v16ctx, uint32_t cpu)
 			d->numa_node = 0;
 			d->numa_node_known = 0;
 
+			if(!(d->stream = v16_cpu_stream_create())) {
+				am_io_error_stack_push(v16ctx->estack,
+						       AM_IOERR_ALLOC,
+						       "Could not allocate "
+						       "event stream for CPU "
+						       "%" PRIu32 ".", cpu);
+
+				v16_cpu_array_removep(&v16ctx->cpus, d);
+
+				return NULL;
+			}
+
 			if(v16ctx_write_event_collection(v16ctx, cpu))
 				return NULL;
 		} else {
@@ -703,14 +967,15 @@ v16ctx_find_add_cpu_def(struct v16ctx* v16ctx, uint32_t cpu)
  * error stack of the conversion context and 1 is returned from the function
  * invoking the macro. */
 #define READ_FIELD_OR_ERROR_RET1(v16ctx, s, frame_type, field, field_type)	\
-	if(am_dsk_##field_type##_read_fp((v16ctx)->fp_in, &(s)->field)) {		\
+	if(am_convert_input_read_##field_type(&(v16ctx)->in, &(s)->field)) {	\
 		am_io_error_stack_push((v16ctx)->estack,			\
 				       AM_IOERR_READ_FIELD,			\
 				       "Could not field %s "			\
 				       "of frame type type %s at offset %jd.",	\
 				       #field,					\
 				       frame_type,				\
-				       ftello((v16ctx)->fp_in));		\
+				       (intmax_t)am_convert_input_tell(	\
+					       &(v16ctx)->in));			\
 										\
 		return 1;							\
 	}									\
@@ -987,12 +1252,13 @@ static int v16ctx_convert_state_description(struct v16ctx* v16ctx)
 		goto out;
 	}
 
-	if(fread(name, name_size, 1, v16ctx->fp_in) != 1) {
+	if(am_convert_input_read(&v16ctx->in, name, name_size)) {
 		am_io_error_stack_push(v16ctx->estack,
 				       AM_IOERR_ALLOC,
 				       "Could not read %zu characters of state "
 				       "description name at offset %jd",
-				       name_size - 1, ftello(v16ctx->fp_in));
+				       name_size - 1,
+				       (intmax_t)am_convert_input_tell(&v16ctx->in));
 		goto out_free;
 	}
 
@@ -1025,10 +1291,13 @@ static int v16ctx_convert_state_event(struct v16ctx* v16ctx)
 {
 	struct v16_trace_state_event se16;
 	struct am_dsk_state_event se;
-	uint32_t type = AM_FRAME_TYPE_STATE_EVENT;
+	struct v16_cpu_def* cpu_def;
 
-	if(!v16_read_convert_event_header_add_cpu(v16ctx, &se16.header))
+	if(!(cpu_def = v16_read_convert_event_header_add_cpu(v16ctx,
+							     &se16.header)))
+	{
 		return 1;
+	}
 
 	READ_FIELD_OR_ERROR_RET1(v16ctx, &se16, "state event",
 				 end_time, uint64_t);
@@ -1041,14 +1310,10 @@ static int v16ctx_convert_state_event(struct v16ctx* v16ctx)
 
 	v16ctx_check_update_max_timestamp(v16ctx, se16.end_time);
 
-	if(am_dsk_state_event_write(&v16ctx->octx, type, &se)) {
+	if(v16_state_event_array_append(&cpu_def->stream->state_events, se)) {
 		am_io_error_stack_push(v16ctx->estack,
-				       AM_IOERR_WRITE,
-				       "Could not write state_event.");
-
-		am_io_error_stack_move(v16ctx->estack,
-				       &v16ctx->octx.error_stack);
-
+				       AM_IOERR_ALLOC,
+				       "Could not add state_event.");
 		return 1;
 	}
 
@@ -1089,12 +1354,13 @@ static int v16ctx_convert_counter_description(struct v16ctx* v16ctx)
 		goto out;
 	}
 
-	if(fread(name, name_size, 1, v16ctx->fp_in) != 1) {
+	if(am_convert_input_read(&v16ctx->in, name, name_size)) {
 		am_io_error_stack_push(v16ctx->estack,
 				       AM_IOERR_ALLOC,
 				       "Could not read %zu characters of counter "
 				       "description name at offset %jd",
-				       name_size - 1, ftello(v16ctx->fp_in));
+				       name_size - 1,
+				       (intmax_t)am_convert_input_tell(&v16ctx->in));
 		goto out_free;
 	}
 
@@ -1134,10 +1400,13 @@ static int v16ctx_convert_counter_event(struct v16ctx* v16ctx)
 {
 	struct v16_trace_counter_event ce16;
 	struct am_dsk_counter_event ce;
-	uint32_t type = AM_FRAME_TYPE_COUNTER_EVENT;
+	struct v16_cpu_def* cpu_def;
 
-	if(!v16_read_convert_event_header_add_cpu(v16ctx, &ce16.header))
+	if(!(cpu_def = v16_read_convert_event_header_add_cpu(v16ctx,
+							     &ce16.header)))
+	{
 		return 1;
+	}
 
 	READ_FIELD_OR_ERROR_RET1(v16ctx, &ce16, "counter event", counter_id, uint64_t);
 	READ_FIELD_OR_ERROR_RET1(v16ctx, &ce16, "counter event", value, int64_t);
@@ -1146,13 +1415,12 @@ static int v16ctx_convert_counter_event(struct v16ctx* v16ctx)
 	ce.time = ce16.header.time;
 	ce.value = ce16.value;
 
-	if(am_dsk_counter_event_write(&v16ctx->octx, type, &ce)) {
+	if(v16_counter_event_array_append(&cpu_def->stream->counter_events,
+					  ce))
+	{
 		am_io_error_stack_push(v16ctx->estack,
-				       AM_IOERR_WRITE,
-				       "Could not write counter_event.");
-
-		am_io_error_stack_move(v16ctx->estack, &v16ctx->octx.error_stack);
-
+				       AM_IOERR_ALLOC,
+				       "Could not add counter_event.");
 		return 1;
 	}
 
@@ -1690,7 +1958,8 @@ static int v16ctx_convert_single_event(struct v16ctx* v16ctx)
 }
 
 /* Converts all directly convertible samples of the input file and writes the
- * corresponding frames to the output file.
+ * corresponding frames to the output file. Frames are flushed to the output
+ * file every V16_MAX_PENDING_EVENTS events.
  *
  * Returns 0 on success, otherwise 1.
  */
@@ -1698,18 +1967,12 @@ int v16ctx_convert_samples(struct v16ctx* v16ctx)
 {
 	uint32_t event_type;
 
-	while(!feof(v16ctx->fp_in)) {
-		if(am_dsk_uint32_t_read_fp(v16ctx->fp_in, &event_type)) {
-			if(feof(v16ctx->fp_in)) {
-				/* End reached */
-				return 0;
-			} else {
-				am_io_error_stack_push(v16ctx->estack,
-						       AM_IOERR_READ,
-						       "Could not read event "
-						       "type.");
-				return 1;
-			}
+	while(!am_convert_input_eof(&v16ctx->in)) {
+		if(am_convert_input_read_uint32_t(&v16ctx->in, &event_type)) {
+			am_io_error_stack_push(v16ctx->estack,
+					       AM_IOERR_READ,
+					       "Could not read event type.");
+			return 1;
 		}
 
 		switch(event_type) {
@@ -1777,9 +2040,15 @@ int v16ctx_convert_samples(struct v16ctx* v16ctx)
 						       event_type);
 				return 1;
 		}
+
+		if(++v16ctx->num_pending_events == V16_MAX_PENDING_EVENTS &&
+		   v16ctx_flush(v16ctx))
+		{
+			return 1;
+		}
 	}
 
-	return 1;
+	return 0;
 }
 
 /* Discards the rest of the input file header (i.e., all fields, except the
@@ -1822,16 +2091,21 @@ int v16ctx_final_check(struct v16ctx* v16ctx)
 /* Converts a trace in format version 13, 14, 15 or 16 to the current format.
  * fp_in must be positioned after the file version field of the file header
  * and fp_out must be positioned at the beginning of the output file. Errors
- * are reported using the I/O error stack estack.
+ * are reported using the I/O error stack estack. The number of bytes read and
+ * written is stored in *stats.
  *
  * Returns 0 on success, otherwise 1.
  */
-int v16_convert_trace(FILE* fp_in, FILE* fp_out, struct am_io_error_stack* es)
+int v16_convert_trace(FILE* fp_in,
+		      FILE* fp_out,
+		      const struct am_convert_params* params,
+		      struct am_convert_stats* stats,
+		      struct am_io_error_stack* es)
 {
 	struct v16ctx v16ctx;
 	int ret = 1;
 
-	if(v16ctx_init(&v16ctx, fp_in, fp_out, es))
+	if(v16ctx_init(&v16ctx, fp_in, fp_out, params, stats, es))
 		goto out;
 
 	if(v16ctx_discard_input_file_header(&v16ctx))
@@ -1858,6 +2132,10 @@ int v16_convert_trace(FILE* fp_in, FILE* fp_out, struct am_io_error_stack* es)
 	if(v16ctx_final_check(&v16ctx))
 		goto out_destroy;
 
+	if(v16ctx_flush(&v16ctx))
+		goto out_destroy;
+
+	stats->bytes_read = am_convert_input_tell(&v16ctx.in);
 	ret = 0;
 
 out_destroy:
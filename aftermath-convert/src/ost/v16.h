@@ -21,7 +21,12 @@
 
 #include <stdio.h>
 #include <aftermath/core/io_error.h>
+#include "../conversion.h"
 
-int v16_convert_trace(FILE* fp_in, FILE* fp_out, struct am_io_error_stack* es);
+int v16_convert_trace(FILE* fp_in,
+		      FILE* fp_out,
+		      const struct am_convert_params* params,
+		      struct am_convert_stats* stats,
+		      struct am_io_error_stack* es);
 
 #endif
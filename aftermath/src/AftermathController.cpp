@@ -21,6 +21,7 @@
 #include "gui/DFGNodeTypeSelectionDialog.h"
 #include "gui/widgets/CairoWidgetWithDFGNode.h"
 #include "gui/widgets/HierarchyComboBox.h"
+#include "gui/widgets/TimelineWidget.h"
 #include "gui/widgets/ToolbarButton.h"
 #include "gui/dialogs/GUIConfigurationDialog.h"
 #include "models/GUITreeModel.h"
@@ -69,6 +70,8 @@ struct am_dfg_node* AftermathController::createNodeAt(
 	if(!(n = am_dfg_node_type_registry_instantiate(ntr, nt, id)))
 		throw AftermathException("Could not instantiate node");
 
+	this->session->getDFGProcessor().sync();
+
 	if(am_dfg_graph_add_node(g, n)) {
 		am_dfg_node_destroy(n);
 		free(n);
@@ -77,6 +80,7 @@ struct am_dfg_node* AftermathController::createNodeAt(
 	}
 
 	if(am_dfg_coordinate_mapping_set_coordinates(mapping, id, p.x, p.y)) {
+		this->session->getDFGProcessor().discardNode(n);
 		am_dfg_graph_remove_node(g, n);
 		am_dfg_node_destroy(n);
 		free(n);
@@ -117,6 +121,7 @@ void AftermathController::execCreateNodeAtAdialog(struct am_dfg_graph* g,
  * returned in *num_connections. */
 void AftermathController::setupConnections(QWidget* w, size_t* num_connections)
 {
+	TimelineWidget* timelineWidget;
 	DFGWidget* dfgWidget;
 
 	if(w->property("DFGNode").isValid()) {
@@ -158,6 +163,58 @@ void AftermathController::setupConnections(QWidget* w, size_t* num_connections)
 				     this->portsConnected);
 		this->connections.push_back(c);
 		(*num_connections)++;
+
+		/* Evaluations in progress must finish before the structure of
+		 * the graph changes */
+		c = QObject::connect(
+			dfgWidget,
+			&DFGWidget::graphAboutToChange,
+			[&](struct am_dfg_graph* g) {
+				this->session->getDFGProcessor().sync();
+			});
+		this->connections.push_back(c);
+		(*num_connections)++;
+
+		c = QObject::connect(
+			dfgWidget,
+			&DFGWidget::nodeAboutToBeRemoved,
+			[&](struct am_dfg_graph* g, struct am_dfg_node* n) {
+				this->session->getDFGProcessor().discardNode(n);
+			});
+		this->connections.push_back(c);
+		(*num_connections)++;
+	}
+
+	if((timelineWidget = dynamic_cast<TimelineWidget*>(w))) {
+		/* Paging in a new window of the trace schedules the DFG, which
+		 * must not happen while the DFG is processing the timeline
+		 * node; the connection is therefore queued */
+		QMetaObject::Connection c = QObject::connect(
+			timelineWidget,
+			&TimelineWidget::visibleIntervalChanged,
+			timelineWidget,
+			[=](){
+				this->pageTraceWindow(timelineWidget);
+			},
+			Qt::QueuedConnection);
+
+		this->connections.push_back(c);
+		(*num_connections)++;
+	}
+}
+
+/* Loads the window of the trace covering the visible interval of the timeline
+ * t if only a window of the trace is loaded */
+void AftermathController::pageTraceWindow(TimelineWidget* t)
+{
+	struct am_interval visible;
+
+	t->getVisibleInterval(&visible);
+
+	try {
+		this->session->pageTraceWindow(&visible);
+	} catch(std::exception& e) {
+		this->showError(e.what());
 	}
 }
 
@@ -209,7 +266,11 @@ void AftermathController::DFGNodeDoubleClicked(struct am_dfg_node* n)
 
 	DFGNodePropertyDialog dlg(n, this->mainWindow);
 	dlg.setModal(true);
+
+	/* The properties of the node must not change during an evaluation */
+	this->session->getDFGProcessor().disable();
 	dlg.exec();
+	this->session->getDFGProcessor().enable();
 
 	if(dlg.result() == QDialog::Accepted) {
 		/* The changed attributes might have an impact on the output
@@ -268,6 +329,7 @@ void AftermathController::deleteNode(struct am_dfg_node* n)
 {
 	struct am_dfg_graph* g = this->session->getDFG();
 
+	this->session->getDFGProcessor().discardNode(n);
 	am_dfg_graph_remove_node(g, n);
 	am_dfg_node_destroy(n);
 	free(n);
@@ -403,6 +465,7 @@ void AftermathController::createWidget(GUIFactory* factory,
 		}
 	} catch(...) {
 		if(dfgNode) {
+			this->session->getDFGProcessor().discardNode(dfgNode);
 			am_dfg_graph_remove_node(g, dfgNode);
 			am_dfg_node_destroy(dfgNode);
 			free(dfgNode);
@@ -24,6 +24,7 @@
 #include "gui/factory/GUIFactory.h"
 #include "gui/widgets/ManagedWidget.h"
 #include "gui/widgets/DFGWidget.h"
+#include "gui/widgets/TimelineWidget.h"
 #include "MainWindow.h"
 #include <QObject>
 
@@ -59,6 +60,7 @@ class AftermathController {
 		void widgetDeletionOrder(QObject* o,
 					 QList<ManagedWidget*>& list);
 		void setupConnections(QWidget* w, size_t* num_connections);
+		void pageTraceWindow(TimelineWidget* t);
 		bool reparentWidget(ManagedWidget* w,
 				    ManagedContainerWidget* old_parent,
 				    int old_idx,
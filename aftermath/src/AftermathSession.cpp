@@ -44,15 +44,19 @@ extern "C" {
 	#include <aftermath/core/dfg_builtin_node_types.h>
 	#include <aftermath/core/dfg/nodes/trace.h>
 	#include <aftermath/core/frame_type_registry.h>
+	#include <aftermath/core/interval.h>
 	#include <aftermath/core/io_context.h>
 	#include <aftermath/core/io_error.h>
 	#include <aftermath/core/on_disk.h>
 	#include <aftermath/core/parse_status.h>
+	#include <aftermath/core/trace_cache.h>
 }
 
 AftermathSession::AftermathSession() :
 	trace(NULL)
 {
+	this->traceWindow.partial = false;
+	this->outOfCore = false;
 	this->dfg.graph = NULL;
 	this->dfg.coordinate_mapping = NULL;
 
@@ -104,6 +108,10 @@ AftermathSession::AftermathSession() :
 
 void AftermathSession::cleanup()
 {
+	/* Wait for evaluations in progress before destroying the graph and the
+	 * trace */
+	this->dfgProcessor.setDFG(NULL);
+
 	am_timeline_render_layer_type_registry_destroy(&this->rltr);
 
 	if(this->trace) {
@@ -160,6 +168,14 @@ void AftermathSession::setTrace(struct am_trace* t) noexcept
 	this->trace = t;
 }
 
+/* If outOfCore is true, the event arrays of traces loaded subsequently are
+ * moved to a memory-mapped cache file next to the trace file, such that their
+ * residency is managed by the page cache rather than by the heap. */
+void AftermathSession::setOutOfCore(bool outOfCore) noexcept
+{
+	this->outOfCore = outOfCore;
+}
+
 struct am_dfg_graph* AftermathSession::getDFG() noexcept
 {
 	return this->dfg.graph;
@@ -167,6 +183,8 @@ struct am_dfg_graph* AftermathSession::getDFG() noexcept
 
 void AftermathSession::setDFG(struct am_dfg_graph* g) noexcept
 {
+	this->dfgProcessor.setDFG(NULL);
+
 	if(this->dfg.graph) {
 		am_dfg_graph_destroy(this->dfg.graph);
 		free(this->dfg.graph);
@@ -232,12 +250,15 @@ static void errorStackToString(struct am_io_error_stack* s, std::string& msg)
 	}
 }
 
-/* Reads the trace file whose filename including its path is given from disk and
- * sets it as the trace for this Aftermath session.
+/* Parses the trace file whose filename including its path is given and returns
+ * the newly allocated trace. If filter is non-NULL, only the events matching
+ * the filter are loaded.
  *
  * Throws an exception on error.
  */
-void AftermathSession::loadTrace(const char* filename)
+struct am_trace* AftermathSession::parseTraceFile(
+	const char* filename,
+	const struct am_io_load_filter* filter)
 {
 	struct am_trace* trace;
 	struct am_io_context ioctx;
@@ -264,7 +285,7 @@ void AftermathSession::loadTrace(const char* filename)
 						 "for reading");
 		}
 
-		if(am_dsk_load_trace(&ioctx, &trace)) {
+		if(am_dsk_load_trace_filtered(&ioctx, &trace, filter)) {
 			std::string msg;
 
 			errorStackToString(&ioctx.error_stack, msg);
@@ -278,7 +299,174 @@ void AftermathSession::loadTrace(const char* filename)
 
 	am_io_context_destroy(&ioctx);
 	am_frame_type_registry_destroy(&frame_types);
-	this->setTrace(trace);
+
+	return trace;
+}
+
+/* Reads the trace file whose filename including its path is given from disk
+ * and returns the newly allocated trace. If filter is non-NULL, only the events
+ * matching the filter are loaded.
+ *
+ * Complete traces are loaded from the trace cache next to the trace file if
+ * the cache is up to date. Otherwise, the trace file is parsed and the cache is
+ * rewritten for the next time the trace is opened. If the cache cannot be read
+ * at all, the trace file is parsed without rewriting the cache.
+ *
+ * Throws an exception on error.
+ */
+struct am_trace* AftermathSession::loadTraceFile(
+	const char* filename,
+	const struct am_io_load_filter* filter,
+	bool outOfCore)
+{
+	struct am_trace* trace;
+	char* cachename = NULL;
+	int ret = 2;
+
+	if(!filter && (cachename = am_trace_cache_filename(filename)))
+		ret = am_trace_cache_load(cachename, filename, &trace);
+
+	if(ret != 0) {
+		try {
+			trace = AftermathSession::parseTraceFile(filename,
+								 filter);
+		} catch(...) {
+			free(cachename);
+			throw;
+		}
+
+		/* A cache that cannot be written only slows down the next
+		 * time the trace is opened. If the cache could not be read
+		 * for reasons unrelated to its contents (e.g., missing
+		 * permissions), it is left untouched. */
+		if(cachename && ret == 2)
+			am_trace_cache_write(trace, cachename);
+	}
+
+	free(cachename);
+
+	if(outOfCore && am_trace_spill_event_arrays(trace, NULL)) {
+		am_trace_destroy(trace);
+		free(trace);
+
+		throw AftermathException("Could not move events to a "
+					 "memory-mapped cache file");
+	}
+
+	return trace;
+}
+
+/* Reads the trace file whose filename including its path is given from disk and
+ * sets it as the trace for this Aftermath session. If window is non-NULL, only
+ * the events overlapping with the window are loaded and further windows of the
+ * same width are loaded on demand by pageTraceWindow().
+ *
+ * Throws an exception on error.
+ */
+void AftermathSession::loadTrace(const char* filename,
+				 const struct am_interval* window)
+{
+	struct am_io_load_filter filter = { };
+	struct am_time_offset width;
+
+	if(!window) {
+		this->setTrace(AftermathSession::loadTraceFile(
+			filename, NULL, this->outOfCore));
+		this->traceWindow.partial = false;
+		return;
+	}
+
+	filter.interval = *window;
+	am_interval_duration(window, &width);
+
+	this->setTrace(AftermathSession::loadTraceFile(
+			filename, &filter, this->outOfCore));
+
+	this->traceWindow.partial = true;
+	this->traceWindow.filename = filename;
+	this->traceWindow.loaded = *window;
+	this->traceWindow.width = width.abs;
+}
+
+/* Replaces the trace of the session with t, propagates the new trace to all
+ * trace nodes of the DFG and destroys the previous trace. */
+void AftermathSession::replaceTrace(struct am_trace* t)
+{
+	struct am_trace* old = this->trace;
+	struct am_dfg_node* n;
+
+	/* Nodes must not access the trace while it is replaced */
+	this->dfgProcessor.sync();
+
+	this->setTrace(t);
+
+	if(this->dfg.graph) {
+		am_dfg_graph_for_each_node(this->dfg.graph, n) {
+			if(strcmp(n->type->name, "am::core::trace") == 0)
+				((struct am_dfg_node_trace*)n)->trace = t;
+		}
+
+		/* All consumers of the previous trace must have been updated
+		 * before it can be destroyed */
+		this->scheduleDFG();
+	}
+
+	if(old) {
+		am_trace_destroy(old);
+		free(old);
+	}
+}
+
+/* If only a window of the trace has been loaded and if the interval visible
+ * is not covered by the loaded window, a new window of the same width
+ * centered around the middle of visible is loaded and replaces the trace of
+ * the session. If visible is wider than the window, a new window is only
+ * loaded if the middle of visible is not within the middle half of the
+ * loaded window. Returns true if a new window has been loaded, otherwise
+ * false.
+ *
+ * Throws an exception on error.
+ */
+bool AftermathSession::pageTraceWindow(const struct am_interval* visible)
+{
+	struct am_io_load_filter filter = { };
+	struct am_interval* loaded = &this->traceWindow.loaded;
+	am_timestamp_t width = this->traceWindow.width;
+	am_timestamp_t middle;
+	struct am_time_offset d;
+
+	if(!this->traceWindow.partial)
+		return false;
+
+	am_interval_duration(visible, &d);
+	middle = am_interval_middle(visible);
+
+	if(d.abs <= width) {
+		if(visible->start >= loaded->start &&
+		   visible->end <= loaded->end)
+		{
+			return false;
+		}
+	} else {
+		if(middle >= loaded->start + width / 4 &&
+		   middle <= loaded->end - width / 4)
+		{
+			return false;
+		}
+	}
+
+	filter.interval.start = middle;
+	am_timestamp_sub_sat(&filter.interval.start, width / 2);
+	filter.interval.end = filter.interval.start;
+	am_timestamp_add_sat(&filter.interval.end, width - 1);
+
+	this->replaceTrace(AftermathSession::loadTraceFile(
+				   this->traceWindow.filename.c_str(),
+				   &filter, this->outOfCore));
+
+	*loaded = filter.interval;
+
+	return true;
 }
 
 /* Loads a DFG graph from the specified location. */
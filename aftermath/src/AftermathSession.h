@@ -20,6 +20,7 @@
 
 #include <map>
 #include <cstdint>
+#include <string>
 #include "Exception.h"
 #include "gui/AftermathGUI.h"
 #include "dfg/DFGQTProcessor.h"
@@ -29,6 +30,7 @@ extern "C" {
 	#include <aftermath/core/dfg_node_type_registry.h>
 	#include <aftermath/core/dfg_type_registry.h>
 	#include <aftermath/core/dfg_graph.h>
+	#include <aftermath/core/io_context.h>
 	#include <aftermath/render/dfg/dfg_coordinate_mapping.h>
 	#include <aftermath/render/timeline/layer.h>
 }
@@ -89,6 +91,7 @@ class AftermathSession {
 		struct am_dfg_coordinate_mapping* getDFGCoordinateMapping() noexcept;
 
 		void setTrace(struct am_trace* t) noexcept;
+		void setOutOfCore(bool outOfCore) noexcept;
 		void setDFG(struct am_dfg_graph* g) noexcept;
 		void setDFGCoordinateMapping(struct am_dfg_coordinate_mapping* m) noexcept;
 		void scheduleDFG();
@@ -100,11 +103,21 @@ class AftermathSession {
 		DFGQTProcessor& getDFGProcessor();
 		DFGQTProcessor* getDFGProcessorp();
 
-		void loadTrace(const char* filename);
+		void loadTrace(const char* filename,
+			       const struct am_interval* window = NULL);
 		void loadDFG(const char* filename);
+		bool pageTraceWindow(const struct am_interval* visible);
 
 	protected:
 		void cleanup();
+		static struct am_trace* parseTraceFile(
+			const char* filename,
+			const struct am_io_load_filter* filter);
+		static struct am_trace* loadTraceFile(
+			const char* filename,
+			const struct am_io_load_filter* filter,
+			bool outOfCore);
+		void replaceTrace(struct am_trace* t);
 
 		struct {
 			struct am_dfg_graph* graph;
@@ -114,6 +127,19 @@ class AftermathSession {
 		} dfg;
 
 		struct am_trace* trace;
+
+		/* If only a window of the trace is loaded, further windows of
+		 * the same width are loaded on demand from the trace file */
+		struct {
+			bool partial;
+			std::string filename;
+			struct am_interval loaded;
+			am_timestamp_t width;
+		} traceWindow;
+
+		/* Move events to a memory-mapped cache file after loading */
+		bool outOfCore;
+
 		struct am_timeline_render_layer_type_registry rltr;
 
 		AftermathGUI gui;
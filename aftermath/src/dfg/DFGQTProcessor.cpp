@@ -16,20 +16,72 @@
  */
 
 #include "DFGQTProcessor.h"
-#include <iostream>
+#include <QCoreApplication>
+#include <QEvent>
+#include <algorithm>
 
 extern "C" {
 	#include <aftermath/core/dfg_schedule.h>
 }
 
+/* Default minimum time in milliseconds between the start of two evaluations */
+#define DFG_QT_PROCESSOR_DEFAULT_MIN_INTERVAL 16
+
+/* Event posted by the evaluating thread when a node must be processed on the
+ * GUI thread */
+static const QEvent::Type GUITaskEventType =
+	(QEvent::Type)QEvent::registerEventType();
+
+/* Event posted by the evaluating thread at the end of an evaluation */
+static const QEvent::Type EvaluationFinishedEventType =
+	(QEvent::Type)QEvent::registerEventType();
+
+DFGQTProcessorThread::DFGQTProcessorThread(DFGQTProcessor* processor)
+	: processor(processor)
+{
+}
+
+void DFGQTProcessorThread::run()
+{
+	this->processor->evaluate();
+}
+
 DFGQTProcessor::DFGQTProcessor()
-	: enabled(true)
+	: dfgGraph(NULL), enabled(true),
+	  minInterval(DFG_QT_PROCESSOR_DEFAULT_MIN_INTERVAL),
+	  busy(false), cancel(0), inGUITask(false), quit(false), thread(NULL)
 {
+	this->guiTask.requested = false;
+
+	this->evaluationTimer.setSingleShot(true);
+	QObject::connect(&this->evaluationTimer, &QTimer::timeout,
+			 this, &DFGQTProcessor::startEvaluation);
+
+	this->lastEvaluation.start();
+
+	/* Without a pool, the scheduler starts workers for each evaluation */
+	this->schedulePoolValid =
+		!am_dfg_schedule_pool_init(&this->schedulePool, 0);
 }
 
-/* Associate a DFG graph with the processor */
+DFGQTProcessor::~DFGQTProcessor()
+{
+	this->stopThread();
+
+	if(this->schedulePoolValid)
+		am_dfg_schedule_pool_destroy(&this->schedulePool);
+}
+
+/* Associate a DFG graph with the processor. Pending triggers for the nodes of
+ * the previous graph are discarded. */
 void DFGQTProcessor::setDFG(struct am_dfg_graph* g) noexcept
 {
+	this->sync();
+
+	this->lock.lock();
+	this->pending.clear();
+	this->lock.unlock();
+
 	this->dfgGraph = g;
 }
 
@@ -39,26 +91,296 @@ struct am_dfg_graph* DFGQTProcessor::getDFG() noexcept
 	return this->dfgGraph;
 }
 
-/* Evaluates the associated graph. The node n is the node that triggered the
- * evaluation. */
+/* Sets the minimum time in milliseconds between the start of two
+ * evaluations */
+void DFGQTProcessor::setMinInterval(int ms)
+{
+	this->minInterval = ms;
+}
+
+/* Adds the node n that triggered an evaluation to the pending nodes and
+ * schedules an evaluation. If an evaluation involving n is in progress, it is
+ * cancelled. */
 void DFGQTProcessor::DFGNodeTriggered(struct am_dfg_node* n)
 {
 	if(!this->dfgGraph)
 		return;
 
-	if(!this->enabled)
+	/* Widgets updated during the processing of their node must not trigger
+	 * another evaluation */
+	if(this->inGUITask)
+		return;
+
+	this->lock.lock();
+
+	if(std::find(this->pending.begin(), this->pending.end(), n) ==
+	   this->pending.end())
+	{
+		this->pending.push_back(n);
+	}
+
+	if(this->busy &&
+	   std::find(this->inFlight.begin(), this->inFlight.end(), n) !=
+	   this->inFlight.end())
+	{
+		__atomic_store_n(&this->cancel, 1, __ATOMIC_RELEASE);
+	}
+
+	this->lock.unlock();
+
+	this->scheduleEvaluation();
+}
+
+/* Starts the evaluation timer if nodes are pending and if no evaluation is in
+ * progress, such that evaluations start at most every minInterval
+ * milliseconds. */
+void DFGQTProcessor::scheduleEvaluation()
+{
+	qint64 elapsed;
+	bool start;
+
+	if(!this->enabled || this->evaluationTimer.isActive())
+		return;
+
+	this->lock.lock();
+	start = !this->busy && !this->pending.empty();
+	this->lock.unlock();
+
+	if(!start)
 		return;
 
-	this->disable();
+	elapsed = this->lastEvaluation.elapsed();
 
-	try {
-		am_dfg_schedule_component(n);
-	} catch(...) {
-		this->enable();
-		throw;
+	if(elapsed >= this->minInterval)
+		this->evaluationTimer.start(0);
+	else
+		this->evaluationTimer.start(this->minInterval - elapsed);
+}
+
+/* Hands all pending nodes over to the evaluating thread */
+void DFGQTProcessor::startEvaluation()
+{
+	if(!this->enabled || !this->dfgGraph)
+		return;
+
+	if(!this->thread) {
+		this->thread = new DFGQTProcessorThread(this);
+		this->thread->start();
 	}
 
-	this->enable();
+	this->lock.lock();
+
+	if(this->busy || this->pending.empty()) {
+		this->lock.unlock();
+		return;
+	}
+
+	this->inFlight.swap(this->pending);
+	__atomic_store_n(&this->cancel, 0, __ATOMIC_RELEASE);
+	this->busy = true;
+	this->cond.wakeAll();
+
+	this->lock.unlock();
+
+	this->lastEvaluation.restart();
+}
+
+/* Main loop of the evaluating thread: evaluates the components of the nodes
+ * handed over by startEvaluation() until the processor is destroyed. */
+void DFGQTProcessor::evaluate()
+{
+	struct am_dfg_schedule_params params;
+	std::vector<struct am_dfg_node*> nodes;
+	size_t i;
+	int ret;
+
+	params.process_unsafe = DFGQTProcessor::processNodeOnGUIThread;
+	params.data = this;
+	params.cancel = &this->cancel;
+	params.pool = this->schedulePoolValid ? &this->schedulePool : NULL;
+
+	this->lock.lock();
+
+	for(;;) {
+		while(!this->quit && !this->busy)
+			this->cond.wait(&this->lock);
+
+		if(this->quit)
+			break;
+
+		nodes = this->inFlight;
+		this->lock.unlock();
+
+		ret = 0;
+
+		for(i = 0; i < nodes.size(); i++)
+			if((ret = am_dfg_schedule_component_params(nodes[i],
+								   &params)) == 2)
+				break;
+
+		this->lock.lock();
+
+		/* Components that have not been evaluated completely must be
+		 * evaluated again */
+		if(ret == 2) {
+			for(; i < nodes.size(); i++) {
+				if(std::find(this->pending.begin(),
+					     this->pending.end(),
+					     nodes[i]) == this->pending.end())
+				{
+					this->pending.push_back(nodes[i]);
+				}
+			}
+		}
+
+		this->inFlight.clear();
+		this->busy = false;
+		this->cond.wakeAll();
+
+		QCoreApplication::postEvent(
+			this, new QEvent(EvaluationFinishedEventType));
+	}
+
+	this->lock.unlock();
+}
+
+/* Called by the scheduler on the evaluating thread for each node of a type that
+ * is not thread-safe. Requests processing of the node on the GUI thread and
+ * waits until processing has finished. Returns 0 on success, otherwise 1. */
+int DFGQTProcessor::processNodeOnGUIThread(struct am_dfg_node* n,
+					   struct list_head* sched_list,
+					   void* data)
+{
+	DFGQTProcessor* p = (DFGQTProcessor*)data;
+	int ret;
+
+	p->lock.lock();
+
+	p->guiTask.node = n;
+	p->guiTask.sched_list = sched_list;
+	p->guiTask.ret = 1;
+	p->guiTask.requested = true;
+	p->cond.wakeAll();
+
+	QCoreApplication::postEvent(p, new QEvent(GUITaskEventType));
+
+	while(p->guiTask.requested)
+		p->cond.wait(&p->lock);
+
+	ret = p->guiTask.ret;
+
+	p->lock.unlock();
+
+	return ret;
+}
+
+/* Processes the node requested by the evaluating thread, if any. Must be called
+ * from the GUI thread. */
+void DFGQTProcessor::runGUITask()
+{
+	struct am_dfg_node* n;
+	struct list_head* sched_list;
+	int ret;
+
+	if(this->inGUITask)
+		return;
+
+	this->lock.lock();
+
+	if(!this->guiTask.requested) {
+		this->lock.unlock();
+		return;
+	}
+
+	n = this->guiTask.node;
+	sched_list = this->guiTask.sched_list;
+
+	this->lock.unlock();
+
+	this->inGUITask = true;
+	ret = am_dfg_schedule_process_node(n, sched_list);
+	this->inGUITask = false;
+
+	this->lock.lock();
+	this->guiTask.ret = ret;
+	this->guiTask.requested = false;
+	this->cond.wakeAll();
+	this->lock.unlock();
+}
+
+/* Cancels the evaluation in progress, if any, and waits until the evaluating
+ * thread is idle. The nodes of a cancelled evaluation remain pending. Must be
+ * called from the GUI thread before the graph or any data accessed by its nodes
+ * is modified. Calls during the processing of a node on the GUI thread have no
+ * effect, since the evaluation cannot finish before the node has been
+ * processed. */
+void DFGQTProcessor::sync()
+{
+	if(this->inGUITask)
+		return;
+
+	this->lock.lock();
+
+	if(this->busy)
+		__atomic_store_n(&this->cancel, 1, __ATOMIC_RELEASE);
+
+	while(this->busy) {
+		if(this->guiTask.requested) {
+			this->lock.unlock();
+			this->runGUITask();
+			this->lock.lock();
+		} else {
+			this->cond.wait(&this->lock);
+		}
+	}
+
+	this->lock.unlock();
+}
+
+/* Removes all pending triggers for the node n. Must be called before n is
+ * removed from the graph. */
+void DFGQTProcessor::discardNode(struct am_dfg_node* n)
+{
+	this->sync();
+
+	this->lock.lock();
+
+	this->pending.erase(std::remove(this->pending.begin(),
+					this->pending.end(), n),
+			    this->pending.end());
+
+	this->lock.unlock();
+}
+
+/* Terminates the evaluating thread */
+void DFGQTProcessor::stopThread()
+{
+	if(!this->thread)
+		return;
+
+	this->sync();
+
+	this->lock.lock();
+	this->quit = true;
+	this->cond.wakeAll();
+	this->lock.unlock();
+
+	this->thread->wait();
+	delete this->thread;
+	this->thread = NULL;
+}
+
+bool DFGQTProcessor::event(QEvent* event)
+{
+	if(event->type() == GUITaskEventType) {
+		this->runGUITask();
+		return true;
+	} else if(event->type() == EvaluationFinishedEventType) {
+		this->scheduleEvaluation();
+		return true;
+	}
+
+	return QObject::event(event);
 }
 
 void DFGQTProcessor::enable()
@@ -71,9 +393,19 @@ void DFGQTProcessor::disable()
 	this->setEnabled(false);
 }
 
+/* Enables or disables evaluations. Triggers received while the processor is
+ * disabled remain pending and are evaluated once the processor is enabled
+ * again. Disabling the processor cancels the evaluation in progress. */
 void DFGQTProcessor::setEnabled(bool b)
 {
 	this->enabled = b;
+
+	if(b) {
+		this->scheduleEvaluation();
+	} else {
+		this->evaluationTimer.stop();
+		this->sync();
+	}
 }
 
 bool DFGQTProcessor::isEnabled()
@@ -18,23 +18,60 @@
 #ifndef AM_DFG_QT_PROCESSOR_H
 #define AM_DFG_QT_PROCESSOR_H
 
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+#include <vector>
 
 extern "C" {
 	#include <aftermath/core/dfg_graph.h>
 	#include <aftermath/core/dfg_schedule.h>
 }
 
+class DFGQTProcessor;
+
+/* Thread evaluating the DFG on behalf of a DFGQTProcessor */
+class DFGQTProcessorThread : public QThread {
+	public:
+		DFGQTProcessorThread(DFGQTProcessor* processor);
+
+	protected:
+		virtual void run();
+
+		DFGQTProcessor* processor;
+};
+
 /**
  * Proxy that can be associated with the processDFGNodeSignal of a widget with
  * an associated DFG node and that triggers evalation of a DFG graph upon
  * reception of the signal.
+ *
+ * Triggers are not evaluated immediately, but added to a queue of pending
+ * nodes, such that multiple triggers for the same node (e.g., from a series of
+ * mouse moves) are merged into a single evaluation of the latest state. The
+ * pending nodes are evaluated on a separate thread at most once every
+ * minInterval milliseconds. Nodes of types that are not thread-safe (e.g.,
+ * nodes associated with widgets) are processed on the GUI thread, such that
+ * their results are applied from the GUI thread.
+ *
+ * If a node is triggered again while an evaluation involving the node is in
+ * progress, the result of the evaluation is stale and the evaluation is
+ * cancelled. The nodes of a cancelled evaluation remain pending.
+ *
+ * Any modification of the graph or of data accessed by its nodes (e.g., the
+ * trace) must be preceded by a call to sync() or disable().
  */
 class DFGQTProcessor : public QObject {
 	Q_OBJECT
 
+	friend class DFGQTProcessorThread;
+
 	public:
 		DFGQTProcessor();
+		~DFGQTProcessor();
 
 		void setDFG(struct am_dfg_graph* g) noexcept;
 		struct am_dfg_graph* getDFG() noexcept;
@@ -44,12 +81,73 @@ class DFGQTProcessor : public QObject {
 		void setEnabled(bool b);
 		bool isEnabled();
 
+		void setMinInterval(int ms);
+		void sync();
+		void discardNode(struct am_dfg_node* n);
+
+		virtual bool event(QEvent* event);
+
 	public slots:
 		void DFGNodeTriggered(struct am_dfg_node* n);
 
 	protected:
+		static int processNodeOnGUIThread(struct am_dfg_node* n,
+						  struct list_head* sched_list,
+						  void* data);
+		void scheduleEvaluation();
+		void startEvaluation();
+		void runGUITask();
+		void evaluate();
+		void stopThread();
+
 		struct am_dfg_graph* dfgGraph;
 		bool enabled;
+
+		/* Minimum time between the start of two evaluations */
+		int minInterval;
+		QTimer evaluationTimer;
+		QElapsedTimer lastEvaluation;
+
+		/* Protects all members below */
+		QMutex lock;
+
+		/* Signaled when a GUI task is requested or completed and when
+		 * an evaluation starts or finishes */
+		QWaitCondition cond;
+
+		/* Nodes triggered since the start of the last evaluation and
+		 * nodes of the evaluation in progress */
+		std::vector<struct am_dfg_node*> pending;
+		std::vector<struct am_dfg_node*> inFlight;
+
+		/* True from the start of an evaluation until its end */
+		bool busy;
+
+		/* Set to 1 in order to cancel the evaluation in progress; read
+		 * by the scheduler */
+		int cancel;
+
+		/* Node of a type that is not thread-safe that the evaluating
+		 * thread has requested to be processed on the GUI thread */
+		struct {
+			bool requested;
+			struct am_dfg_node* node;
+			struct list_head* sched_list;
+			int ret;
+		} guiTask;
+
+		/* True while a GUI task is executed. Triggers emitted by
+		 * widgets in response to the processing of their own node are
+		 * ignored. */
+		bool inGUITask;
+
+		bool quit;
+		DFGQTProcessorThread* thread;
+
+		/* Workers processing independent nodes, kept across
+		 * evaluations; only used if schedulePoolValid is true */
+		struct am_dfg_schedule_pool schedulePool;
+		bool schedulePoolValid;
 };
 
 #endif
@@ -173,7 +173,6 @@ void DFGNodePropertyDialog::commitProperty(struct am_dfg_property* p)
 	auto it = this->propEditMap.find(p);
 	QLineEdit* e = it->second;
 	void* prop_val;
-	auto nfuns = &this->dfgNode->type->functions;
 
 	if(!(prop_val = malloc(p->type->sample_size))) {
 		throw Exception(std::string("Could not allocate memory for "
@@ -188,7 +187,7 @@ void DFGNodePropertyDialog::commitProperty(struct am_dfg_property* p)
 				p->name + "' from string");
 	}
 
-	if(nfuns->set_property(this->dfgNode, p, prop_val)) {
+	if(am_dfg_node_set_property(this->dfgNode, p, prop_val)) {
 		if(p->type->destroy_samples)
 			p->type->destroy_samples(p->type, 1, prop_val);
 
@@ -703,6 +703,8 @@ void DFGWidget::mouseReleasePort(const struct am_point* screen_pos)
 		if(am_dfg_ports_connected(pout, pin))
 			return;
 
+		emit graphAboutToChange(this->graph);
+
 		if((pin->node->type->functions.pre_connect &&
 		    pin->node->type->functions.pre_connect(pin->node, pin, pout, sizeof(buf)-1, buf)) ||
 		   (pout->node->type->functions.pre_connect &&
@@ -721,6 +723,7 @@ void DFGWidget::mouseReleasePort(const struct am_point* screen_pos)
 		emit portsConnected(this->graph, pout, pin);
 	} else {
 		if(this->draggedPort.disconnectPort) {
+			emit graphAboutToChange(this->graph);
 			am_dfg_port_disconnect(this->draggedPort.port,
 					       this->draggedPort.disconnectPort);
 		}
@@ -814,11 +817,13 @@ void DFGWidget::keyPressEvent(QKeyEvent* event)
 			am_dfg_renderer_get_selected_connection(&this->renderer,
 								&c.src,
 								&c.dst);
+			emit graphAboutToChange(this->graph);
 			am_dfg_port_disconnect(c.src, c.dst);
 			am_dfg_renderer_unset_selected_connection(
 				&this->renderer);
 		} else if(am_dfg_renderer_has_selected_node(&this->renderer)) {
 			n = am_dfg_renderer_get_selected_node(&this->renderer);
+			emit nodeAboutToBeRemoved(this->graph, n);
 			am_dfg_graph_remove_node(this->graph, n);
 			am_dfg_node_destroy(n);
 			free(n);
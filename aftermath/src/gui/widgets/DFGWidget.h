@@ -223,6 +223,9 @@ class DFGWidget : public CairoWidget {
 		void portsConnected(struct am_dfg_graph* g,
 				    struct am_dfg_port* psrc,
 				    struct am_dfg_port* pdst);
+		void graphAboutToChange(struct am_dfg_graph* g);
+		void nodeAboutToBeRemoved(struct am_dfg_graph* g,
+					  struct am_dfg_node* n);
 
 	protected slots:
 		void showContextMenu(const QPoint& p);
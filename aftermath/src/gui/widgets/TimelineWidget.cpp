@@ -16,7 +16,9 @@
  */
 
 #include "TimelineWidget.h"
+#include <QCoreApplication>
 #include <QMouseEvent>
+#include <QRunnable>
 
 extern "C" {
 	#include "../../dfg/nodes/gui/timeline.h"
@@ -36,10 +38,94 @@ extern "C" {
 		void* data)
 	{
 		TimelineWidget* tl = (TimelineWidget*)data;
+		tl->invalidateTiles(layer);
 		tl->update();
 	}
+
+	/* Callback function that is invoked by the renderer for each lane of a
+	 * lane render layer to be drawn */
+	static void timeline_widget_draw_lane(
+		struct am_timeline_renderer*,
+		struct am_timeline_lane_render_layer* l,
+		struct am_hierarchy_node* n,
+		cairo_t* cr,
+		void* data)
+	{
+		TimelineWidget* tl = (TimelineWidget*)data;
+		tl->drawLaneFromTiles(l, n, cr);
+	}
+
+	/* Callback function that is invoked for each tile required for drawing
+	 * a lane that is not in the cache */
+	static void timeline_widget_tile_miss(
+		const struct am_timeline_tile_key* key,
+		void* data)
+	{
+		TimelineWidget* tl = (TimelineWidget*)data;
+		tl->requestTile(key);
+	}
 }
 
+/* Maximum number of tiles kept in the cache of a timeline */
+#define TIMELINE_WIDGET_MAX_TILES 512
+
+/* Event posted to the timeline widget once a tile has been rendered */
+class TileRenderedEvent : public QEvent {
+	public:
+		static const QEvent::Type TYPE;
+
+		TileRenderedEvent(const struct am_timeline_tile_key& key,
+				  cairo_surface_t* surface,
+				  unsigned int generation)
+			: QEvent(TYPE), key(key), surface(surface),
+			  generation(generation)
+		{ }
+
+		/* The surface is only destroyed if it has not been handed
+		 * over to the tile cache */
+		virtual ~TileRenderedEvent()
+		{
+			if(this->surface)
+				cairo_surface_destroy(this->surface);
+		}
+
+		struct am_timeline_tile_key key;
+		cairo_surface_t* surface;
+		unsigned int generation;
+};
+
+const QEvent::Type TileRenderedEvent::TYPE =
+	(QEvent::Type)QEvent::registerEventType();
+
+/* Job rendering a single tile on a thread of the tile pool */
+class TileRenderJob : public QRunnable {
+	public:
+		TileRenderJob(QObject* receiver,
+			      const struct am_timeline_tile_key& key,
+			      unsigned int generation)
+			: receiver(receiver), key(key), generation(generation)
+		{ }
+
+		virtual void run()
+		{
+			cairo_surface_t* surface;
+
+			/* Post even if rendering has failed, such that the
+			 * tile is removed from the set of pending tiles */
+			surface = am_timeline_tile_render(&this->key);
+
+			QCoreApplication::postEvent(
+				this->receiver,
+				new TileRenderedEvent(this->key, surface,
+						      this->generation));
+		}
+
+	protected:
+		QObject* receiver;
+		struct am_timeline_tile_key key;
+		unsigned int generation;
+};
+
 TimelineWidget::TimelineWidget(QWidget* parent)
 	: super(parent), mouseMode(MOUSE_MODE_NONE),
 	  zoom({1100, 1000}),
@@ -49,13 +135,21 @@ TimelineWidget::TimelineWidget(QWidget* parent)
 	  currentSelection(NULL),
 	  lastHierarchyNodeUnderCursor(NULL),
 	  lastTimestampUnderCursor(0),
-	  initialPropertiesSet(false)
+	  initialPropertiesSet(false),
+	  tileGeneration(0)
 {
 	this->dragStart.visibleInterval = { 0, 0 };
 
 	if(am_timeline_renderer_init(&this->renderer))
 		throw TimelineWidgetException();
 
+	am_timeline_tile_cache_init(&this->tileCache,
+				    TIMELINE_WIDGET_MAX_TILES);
+
+	am_timeline_renderer_set_draw_lane_fun(&this->renderer,
+					       timeline_widget_draw_lane,
+					       this);
+
 	am_timeline_renderer_layer_appearance_change_callback_init(
 		&this->apperance_change_cb,
 		timeline_widget_layer_appearance_callback,
@@ -103,6 +197,7 @@ void TimelineWidget::resizeEvent(QResizeEvent* event)
  */
 void TimelineWidget::setTrace(struct am_trace* t)
 {
+	this->waitForTiles();
 	am_timeline_renderer_set_trace(&this->renderer, t);
 }
 
@@ -111,6 +206,8 @@ void TimelineWidget::setTrace(struct am_trace* t)
  */
 void TimelineWidget::setHierarchy(struct am_hierarchy* h)
 {
+	this->waitForTiles();
+
 	if(am_timeline_renderer_set_hierarchy(&this->renderer, h))
 		throw TimelineWidgetException();
 }
@@ -125,6 +222,7 @@ void TimelineWidget::setVisibleInterval(const struct am_interval* i)
 	am_timeline_renderer_set_visible_interval(&this->renderer, i);
 
 	this->update();
+	emit visibleIntervalChanged();
 
 	if(this->dfgNode) {
 		am_dfg_port_mask_reset(&this->dfgNode->required_mask);
@@ -198,6 +296,7 @@ void TimelineWidget::storeSelectionIntervals(struct am_interval* out, size_t max
  */
 void TimelineWidget::addLayer(struct am_timeline_render_layer* l)
 {
+	this->waitForTiles();
 	am_timeline_renderer_add_layer(&this->renderer, l);
 
 	if(strcmp(l->type->name, "selection") == 0) {
@@ -215,11 +314,101 @@ void TimelineWidget::addLayer(struct am_timeline_render_layer* l)
 
 TimelineWidget::~TimelineWidget()
 {
+	/* Jobs still running might access the layers */
+	this->tilePool.waitForDone();
+
 	am_timeline_renderer_unregister_layer_appearance_change_callback(
 		&this->renderer,
 		&this->apperance_change_cb);
 
 	am_timeline_renderer_destroy(&this->renderer);
+	am_timeline_tile_cache_destroy(&this->tileCache);
+}
+
+/* Draws the lane for the hierarchy node n of the lane render layer l from the
+ * tile cache and requests rendering of missing tiles. */
+void TimelineWidget::drawLaneFromTiles(struct am_timeline_lane_render_layer* l,
+				       struct am_hierarchy_node* n,
+				       cairo_t* cr)
+{
+	am_timeline_tile_cache_draw_lane(&this->tileCache, &this->renderer,
+					 l, n, cr,
+					 timeline_widget_tile_miss, this);
+}
+
+/* Starts rendering of the tile with the given key on the tile pool, unless
+ * rendering of the tile has already been requested. */
+void TimelineWidget::requestTile(const struct am_timeline_tile_key* key)
+{
+	if(!this->pendingTiles.insert(*key).second)
+		return;
+
+	this->tilePool.start(new TileRenderJob(this, *key,
+					       this->tileGeneration));
+}
+
+/* Discards the tiles rendered by the layer l or all tiles if l is NULL. Tiles
+ * still being rendered are discarded upon completion. */
+void TimelineWidget::invalidateTiles(struct am_timeline_render_layer* l)
+{
+	/* Lane render layers embed a render layer as their first member */
+	struct am_timeline_lane_render_layer* ll =
+		(struct am_timeline_lane_render_layer*)l;
+	bool pending = !l;
+
+	for(auto& key: this->pendingTiles) {
+		if(key.layer == ll) {
+			pending = true;
+			break;
+		}
+	}
+
+	/* Only discard tiles being rendered if they are affected */
+	if(pending) {
+		this->tileGeneration++;
+		this->pendingTiles.clear();
+	}
+
+	if(l)
+		am_timeline_tile_cache_invalidate_layer(&this->tileCache, ll);
+	else
+		am_timeline_tile_cache_invalidate_all(&this->tileCache);
+}
+
+/* Waits for all tile jobs to finish and discards all tiles. Must be called
+ * before any modification of the trace, the hierarchy or the set of layers,
+ * since tile jobs access these without synchronization. */
+void TimelineWidget::waitForTiles()
+{
+	this->tilePool.waitForDone();
+	this->invalidateTiles();
+}
+
+bool TimelineWidget::event(QEvent* event)
+{
+	TileRenderedEvent* tre;
+
+	if(event->type() != TileRenderedEvent::TYPE)
+		return super::event(event);
+
+	tre = static_cast<TileRenderedEvent*>(event);
+
+	/* Tiles of an earlier generation might not reflect the current
+	 * appearance of their layer */
+	if(tre->generation != this->tileGeneration)
+		return true;
+
+	this->pendingTiles.erase(tre->key);
+
+	if(tre->surface &&
+	   !am_timeline_tile_cache_insert(&this->tileCache, &tre->key,
+					  tre->surface))
+	{
+		tre->surface = NULL;
+		this->update();
+	}
+
+	return true;
 }
 
 /**
@@ -812,6 +1001,7 @@ void TimelineWidget::handleZoomEvent(double x, enum zoomDirection direction)
 	am_timeline_renderer_set_visible_interval(r, &i_new);
 
 	this->update();
+	emit visibleIntervalChanged();
 	this->processDFGNode();
 }
 
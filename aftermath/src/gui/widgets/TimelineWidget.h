@@ -19,9 +19,12 @@
 #define TIMELINEWIDGET_H
 
 #include "CairoWidgetWithDFGNode.h"
+#include <QThreadPool>
+#include <set>
 
 extern "C" {
 	#include <aftermath/render/timeline/renderer.h>
+	#include <aftermath/render/timeline/tile_cache.h>
 }
 
 struct am_timeline_entity;
@@ -30,6 +33,8 @@ struct am_timeline_entity;
  * Widget encapsulating the time line renderer showing events over time.
  */
 class TimelineWidget : public CairoWidgetWithDFGNode {
+	Q_OBJECT
+
 	public:
 		typedef CairoWidgetWithDFGNode super;
 		class TimelineWidgetException {};
@@ -51,6 +56,17 @@ class TimelineWidget : public CairoWidgetWithDFGNode {
 
 		struct am_timeline_renderer* getRenderer();
 
+		void drawLaneFromTiles(struct am_timeline_lane_render_layer* l,
+				       struct am_hierarchy_node* n,
+				       cairo_t* cr);
+		void requestTile(const struct am_timeline_tile_key* key);
+		void invalidateTiles(struct am_timeline_render_layer* l = NULL);
+
+	signals:
+		/* Emitted whenever the visible interval has been changed,
+		 * either programmatically or through user interaction */
+		void visibleIntervalChanged();
+
 	protected:
 		enum zoomDirection {
 			ZOOM_IN,
@@ -63,6 +79,9 @@ class TimelineWidget : public CairoWidgetWithDFGNode {
 		virtual void mousePressEvent(QMouseEvent* event);
 		virtual void mouseReleaseEvent(QMouseEvent* event);
 		virtual void wheelEvent(QWheelEvent* event);
+		virtual bool event(QEvent* event);
+
+		void waitForTiles();
 
 		virtual bool handleMouseMoveHierarchyLayerItem(
 			QMouseEvent* event,
@@ -138,6 +157,25 @@ class TimelineWidget : public CairoWidgetWithDFGNode {
 		am_timestamp_t lastTimestampUnderCursor;
 
 		bool initialPropertiesSet;
+
+		/* Orders tile keys for the set of pending tiles */
+		struct TileKeyLess {
+			bool operator()(const struct am_timeline_tile_key& a,
+					const struct am_timeline_tile_key& b) const
+			{
+				return am_timeline_tile_key_cmp(&a, &b) < 0;
+			}
+		};
+
+		/* Lanes are composed from tiles rendered by the threads of
+		 * tilePool. Tiles that have been requested, but whose
+		 * rendering has not finished yet are kept in pendingTiles. Any
+		 * invalidation increments tileGeneration, such that tiles
+		 * rendered for an earlier generation are discarded. */
+		QThreadPool tilePool;
+		struct am_timeline_tile_cache tileCache;
+		std::set<struct am_timeline_tile_key, TileKeyLess> pendingTiles;
+		unsigned int tileGeneration;
 };
 
 #endif
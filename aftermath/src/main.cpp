@@ -31,6 +31,8 @@ extern "C" {
 	#include <getopt.h>
 }
 
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
@@ -43,6 +45,9 @@ struct am_options {
 		std::string ui_filename;
 		bool print_usage;
 		bool dfg_safe_mode;
+		bool partial;
+		struct am_interval window;
+		bool out_of_core;
 };
 
 static void print_usage(void)
@@ -50,14 +55,55 @@ static void print_usage(void)
 	std::cout << "Aftermath, a graphical tool for trace-based performance "
 		"analysis of parallel programs.\n"
 		"\n"
-		"  Usage: aftermath [-p profile_path] [-d dfg_file] [-u ui_file] trace_file\n"
+		"  Usage: aftermath [-p profile_path] [-d dfg_file] [-u ui_file]\n"
+		"                   [-w start:end] [-m] trace_file\n"
 		"\n"
 		"  -h             Display this help message.\n"
 		"  -p profile     Load DFG and user interface from the profile with the given\n"
 		"                 name.\n"
 		"  -d dfg_file    Load DFG definition from dfg_file.\n"
+		"  -m             Keep events in a memory-mapped cache file next to the\n"
+		"                 trace file instead of on the heap.\n"
 		"  -u ui_file     Load user interface from ui_file.\n"
-		"  -s             Ignore errors during initial scheduling of DFG.\n";
+		"  -s             Ignore errors during initial scheduling of DFG.\n"
+		"  -w start:end   Only load the events of the trace within [start, end].\n"
+		"                 Windows of the same width are loaded on demand as the\n"
+		"                 visible interval of a timeline moves.\n"
+		"\n"
+		"  Each time a trace is loaded entirely (i.e., without -w) from the trace\n"
+		"  file, a cache file <trace_file>.amcache is written next to the trace\n"
+		"  file, from which the trace is loaded quickly the next time it is\n"
+		"  opened. An existing cache file that cannot be read (e.g., due to\n"
+		"  missing permissions) is left untouched.\n";
+}
+
+/* Parses a window of the form start:end from str and stores the result in
+ * *window. Throws an exception if parsing fails. */
+static void parse_window(struct am_interval* window, const char* str)
+{
+	const char* pend;
+	char* end;
+
+	errno = 0;
+	window->start = strtoull(str, &end, 10);
+
+	if(errno || end == str || *end != ':')
+		goto out_err;
+
+	pend = end + 1;
+	window->end = strtoull(pend, &end, 10);
+
+	if(errno || end == pend || *end != '\0' ||
+	   window->end < window->start)
+	{
+		goto out_err;
+	}
+
+	return;
+
+out_err:
+	throw AftermathException(std::string("Invalid window \"") +
+				 str + "\".");
 }
 
 /* Parses the options from the argument list argv and sets the options in o
@@ -65,7 +111,7 @@ static void print_usage(void)
  */
 static void parse_options(struct am_options* o, int argc, char** argv)
 {
-	static const char* options_str = "hd:p:su:";
+	static const char* options_str = "hd:mp:su:w:";
 	int opt;
 
 	/* Default values */
@@ -75,6 +121,8 @@ static void parse_options(struct am_options* o, int argc, char** argv)
 	o->print_usage = false;
 	o->profile_name = "";
 	o->dfg_safe_mode = false;
+	o->partial = false;
+	o->out_of_core = false;
 
 	opterr = 0;
 
@@ -83,6 +131,9 @@ static void parse_options(struct am_options* o, int argc, char** argv)
 			case 'd':
 				o->dfg_filename = optarg;
 				break;
+			case 'm':
+				o->out_of_core = true;
+				break;
 			case 'p':
 				o->profile_name = optarg;
 				break;
@@ -92,6 +143,10 @@ static void parse_options(struct am_options* o, int argc, char** argv)
 			case 'u':
 				o->ui_filename = optarg;
 				break;
+			case 'w':
+				parse_window(&o->window, optarg);
+				o->partial = true;
+				break;
 			case 'h':
 				o->print_usage = 1;
 				break;
@@ -160,7 +215,9 @@ int aftermath_main(const struct am_options* o,
 		QShortcut guiManagerShortcut(QKeySequence(Qt::Key_F12),
 					     &mainWindow);
 
-		session.loadTrace(o->trace_filename.c_str());
+		session.setOutOfCore(o->out_of_core);
+		session.loadTrace(o->trace_filename.c_str(),
+				  o->partial ? &o->window : NULL);
 		factory.buildGUI(&gui, o->ui_filename.c_str());
 		session.loadDFG(o->dfg_filename.c_str());
 
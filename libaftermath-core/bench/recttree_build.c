@@ -0,0 +1,244 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+/* Compares the time needed to build a rect tree sequentially with the time
+ * needed for parallel construction with exact and approximate medians. The
+ * trees are checked against a linear scan for a set of random queries.
+ *
+ * Usage: recttree_build [-t num_workers] [num_nodes ...]
+ */
+
+#include <aftermath/core/ansi_extras.h>
+#include <aftermath/core/indexes/recttree.h>
+#include <aftermath/core/parallel.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_QUERIES 16
+#define MAX_DEPTH 100
+
+struct bench_node {
+	struct am_recttree_node rtnode;
+	double start[2];
+	double end[2];
+};
+
+struct bench_query {
+	double start[2];
+	double end[2];
+	size_t count;
+};
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Places the nodes randomly on a plane whose size grows with the number of
+ * nodes. Like the nodes of a candidate tree, the nodes are arranged in rows,
+ * such that many nodes share the same y coordinate. */
+static void init_nodes(struct bench_node* nodes, size_t num_nodes)
+{
+	double width = num_nodes * 10.0;
+
+	for(size_t i = 0; i < num_nodes; i++) {
+		nodes[i].start[0] = width * (rand() / (double)RAND_MAX);
+		nodes[i].start[1] = (rand() % 64) * 80.0;
+		nodes[i].end[0] = nodes[i].start[0] + 100.0;
+		nodes[i].end[1] = nodes[i].start[1] + 50.0;
+
+		nodes[i].rtnode.kdnode.coordinates = nodes[i].start;
+		nodes[i].rtnode.hyperrect_end = nodes[i].end;
+	}
+}
+
+static int count_cb(struct am_recttree_node* n, void* data)
+{
+	(*(size_t*)data)++;
+	return 0;
+}
+
+/* Generates random queries and determines the number of overlapping nodes with
+ * a linear scan */
+static void init_queries(struct bench_query* queries,
+			 const struct bench_node* nodes,
+			 size_t num_nodes)
+{
+	double width = num_nodes * 10.0;
+
+	for(size_t i = 0; i < NUM_QUERIES; i++) {
+		queries[i].start[0] = width * (rand() / (double)RAND_MAX);
+		queries[i].start[1] = (rand() % 64) * 80.0;
+		queries[i].end[0] = queries[i].start[0] + width / 100.0;
+		queries[i].end[1] = queries[i].start[1] + 500.0;
+		queries[i].count = 0;
+
+		for(size_t j = 0; j < num_nodes; j++) {
+			if(am_hyperrectangle_intersect_p(2,
+							 queries[i].start,
+							 queries[i].end,
+							 nodes[j].start,
+							 nodes[j].end))
+			{
+				queries[i].count++;
+			}
+		}
+	}
+}
+
+/* Builds a rect tree and checks the results for all queries. Returns 0 on
+ * success, otherwise 1. */
+static int run(const char* name,
+	       struct am_recttree_node** ptrs,
+	       struct bench_node* nodes,
+	       size_t num_nodes,
+	       const struct bench_query* queries,
+	       unsigned int num_workers,
+	       enum am_kdtree_split_strategy strategy,
+	       double* seconds)
+{
+	struct am_recttree t;
+	size_t count;
+	double start;
+
+	for(size_t i = 0; i < num_nodes; i++)
+		ptrs[i] = &nodes[i].rtnode;
+
+	am_recttree_init(&t, 2);
+
+	start = now();
+
+	if(am_recttree_build_parallel(&t, ptrs, num_nodes, MAX_DEPTH,
+				      num_workers, strategy))
+	{
+		fprintf(stderr, "%s: could not build tree\n", name);
+		return 1;
+	}
+
+	*seconds = now() - start;
+
+	for(size_t i = 0; i < NUM_QUERIES; i++) {
+		count = 0;
+		am_recttree_query_callback(&t, queries[i].start, queries[i].end,
+					   count_cb, &count);
+
+		if(count != queries[i].count) {
+			fprintf(stderr, "%s: query %zu returned %zu instead of "
+				"%zu nodes\n", name, i, count, queries[i].count);
+			am_recttree_destroy(&t);
+			return 1;
+		}
+	}
+
+	printf("  %-24s %8.3f s  depth %zu\n", name, *seconds,
+	       am_kdtree_depth(&t.kdtree));
+
+	am_recttree_destroy(&t);
+
+	return 0;
+}
+
+static int bench(size_t num_nodes, unsigned int num_workers)
+{
+	struct bench_query queries[NUM_QUERIES];
+	struct am_recttree_node** ptrs;
+	struct bench_node* nodes;
+	double seq;
+	double par;
+	double approx;
+	int ret = 1;
+
+	if(!(nodes = calloc(num_nodes, sizeof(*nodes))))
+		goto out;
+
+	if(!(ptrs = calloc(num_nodes, sizeof(*ptrs))))
+		goto out_nodes;
+
+	init_nodes(nodes, num_nodes);
+	init_queries(queries, nodes, num_nodes);
+
+	printf("%zu nodes, %u workers:\n", num_nodes, num_workers);
+
+	if(run("sequential", ptrs, nodes, num_nodes, queries,
+	       1, AM_KDTREE_SPLIT_MEDIAN, &seq) ||
+	   run("parallel", ptrs, nodes, num_nodes, queries,
+	       num_workers, AM_KDTREE_SPLIT_MEDIAN, &par) ||
+	   run("parallel, approx. median", ptrs, nodes, num_nodes, queries,
+	       num_workers, AM_KDTREE_SPLIT_APPROX_MEDIAN, &approx))
+	{
+		goto out_ptrs;
+	}
+
+	printf("  speedup %.2fx (parallel), %.2fx (approx. median)\n",
+	       seq / par, seq / approx);
+
+	ret = 0;
+
+out_ptrs:
+	free(ptrs);
+out_nodes:
+	free(nodes);
+out:
+	return ret;
+}
+
+int main(int argc, char** argv)
+{
+	static const size_t default_sizes[] = { 100000, 1000000, 10000000 };
+	unsigned int num_workers = am_parallel_num_cpus();
+	size_t num_nodes;
+	int first = 1;
+
+	srand(42);
+
+	if(argc > 2 && strcmp(argv[1], "-t") == 0) {
+		if(sscanf(argv[2], "%u", &num_workers) != 1 || num_workers == 0) {
+			fprintf(stderr, "Invalid number of workers: %s\n",
+				argv[2]);
+			return 1;
+		}
+
+		first = 3;
+	}
+
+	if(argc <= first) {
+		for(size_t i = 0; i < AM_ARRAY_SIZE(default_sizes); i++)
+			if(bench(default_sizes[i], num_workers))
+				return 1;
+
+		return 0;
+	}
+
+	for(int i = first; i < argc; i++) {
+		if(sscanf(argv[i], "%zu", &num_nodes) != 1) {
+			fprintf(stderr, "Invalid number of nodes: %s\n", argv[i]);
+			return 1;
+		}
+
+		if(bench(num_nodes, num_workers))
+			return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1 @@
+.//../../../src///column_store.h
\ No newline at end of file
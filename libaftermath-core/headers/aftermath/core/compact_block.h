@@ -0,0 +1 @@
+../../../src/compact_block.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../src/dfg/nodes/state_event_range_attributes.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../src/dfg/types/event_range.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/io_array_cache.h
\ No newline at end of file
@@ -0,0 +1 @@
+.//../../../src///key_sort.h
\ No newline at end of file
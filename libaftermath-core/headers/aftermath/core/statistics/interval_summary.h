@@ -0,0 +1 @@
+../../../../src/statistics/interval_summary.h
\ No newline at end of file
@@ -0,0 +1 @@
+.//../../../src///timestamp_calibration_array.h
\ No newline at end of file
@@ -0,0 +1 @@
+.//../../../src///trace_cache.h
\ No newline at end of file
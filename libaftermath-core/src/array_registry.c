@@ -171,6 +171,85 @@ int am_array_registry_add(struct am_array_registry* r,
 	e->free = free;
 	e->init = init;
 	e->destroy = destroy;
+	e->for_each_relocatable = NULL;
+	e->for_each_sortable = NULL;
 
 	return 0;
 }
+
+/* Marks the arrays of an already registered type as relocatable by
+ * associating for_each_relocatable with the type. Returns 0 on success or 1 if
+ * the type is unknown to the registry. */
+int
+am_array_registry_set_relocatable(struct am_array_registry* r,
+				  const char* type,
+				  int (*for_each_relocatable)(
+					  void* a,
+					  am_array_registry_relocatable_fun_t f,
+					  void* data))
+{
+	struct am_array_registry_entry* e;
+
+	if(!(e = am_array_registry_find(r, type)))
+		return 1;
+
+	e->for_each_relocatable = for_each_relocatable;
+
+	return 0;
+}
+
+/* Invokes f on each relocatable typed array that is part of the array a of
+ * type type. If the type is unknown or if its arrays are not relocatable,
+ * nothing happens. Returns 0 on success or the first non-zero value returned by
+ * f. */
+int am_array_registry_for_each_relocatable(struct am_array_registry* r,
+					   const char* type,
+					   void* a,
+					   am_array_registry_relocatable_fun_t f,
+					   void* data)
+{
+	struct am_array_registry_entry* e;
+
+	if(!(e = am_array_registry_find(r, type)) || !e->for_each_relocatable)
+		return 0;
+
+	return e->for_each_relocatable(a, f, data);
+}
+
+/* Marks the arrays of an already registered type as sortable by associating
+ * for_each_sortable with the type. Returns 0 on success or 1 if the type is
+ * unknown to the registry. */
+int
+am_array_registry_set_sortable(struct am_array_registry* r,
+			       const char* type,
+			       int (*for_each_sortable)(
+				       void* a,
+				       am_array_registry_sortable_fun_t f,
+				       void* data))
+{
+	struct am_array_registry_entry* e;
+
+	if(!(e = am_array_registry_find(r, type)))
+		return 1;
+
+	e->for_each_sortable = for_each_sortable;
+
+	return 0;
+}
+
+/* Invokes f on each sortable typed array that is part of the array a of type
+ * type. If the type is unknown or if its arrays are not sortable, nothing
+ * happens. Returns 0 on success or the first non-zero value returned by f. */
+int am_array_registry_for_each_sortable(struct am_array_registry* r,
+					const char* type,
+					void* a,
+					am_array_registry_sortable_fun_t f,
+					void* data)
+{
+	struct am_array_registry_entry* e;
+
+	if(!(e = am_array_registry_find(r, type)) || !e->for_each_sortable)
+		return 0;
+
+	return e->for_each_sortable(a, f, data);
+}
@@ -23,6 +23,23 @@
 
 #define AM_ACC_ARRAY_REGISTRY_ENTRY_TYPE(x) ((x).type)
 
+/* Callback invoked for a relocatable array a with elements of element_size
+ * bytes. Returns 0 on success, otherwise 1. */
+typedef int (*am_array_registry_relocatable_fun_t)(
+	struct am_typed_array_generic* a,
+	size_t element_size,
+	void* data);
+
+/* Callback invoked for a sortable array a with elements of element_size bytes
+ * that must be sorted in ascending order of the unsigned 64-bit key located
+ * key_offset bytes after the start of each element. Returns 0 on success,
+ * otherwise 1. */
+typedef int (*am_array_registry_sortable_fun_t)(
+	struct am_typed_array_generic* a,
+	size_t element_size,
+	size_t key_offset,
+	void* data);
+
 /* Single entry specifiying common operations for an event array type */
 struct am_array_registry_entry {
 	const char* type;
@@ -31,6 +48,23 @@ struct am_array_registry_entry {
 	void (*free)(void* a);
 	int (*init)(void* a);
 	void (*destroy)(void* a);
+
+	/* Optional function invoking f on each typed array that is part of a
+	 * and whose elements may be moved to a different address once the
+	 * array is complete, i.e., elements that do not own memory and that
+	 * are never referenced by pointers. NULL if the array type cannot be
+	 * relocated. */
+	int (*for_each_relocatable)(void* a,
+				    am_array_registry_relocatable_fun_t f,
+				    void* data);
+
+	/* Optional function invoking f on each typed array that is part of a
+	 * and whose elements are ordered by a timestamp, such that the array
+	 * can be verified and sorted after loading. Requires the elements to
+	 * be relocatable. NULL if the array type has no such order. */
+	int (*for_each_sortable)(void* a,
+				 am_array_registry_sortable_fun_t f,
+				 void* data);
 };
 
 AM_DECL_TYPED_ARRAY(am_array_registry, struct am_array_registry_entry)
@@ -59,6 +93,34 @@ am_array_registry_add(struct am_array_registry* r,
 		      int (*init)(void* a),
 		      void (*destroy)(void* a));
 
+int
+am_array_registry_set_relocatable(struct am_array_registry* r,
+				  const char* type,
+				  int (*for_each_relocatable)(
+					  void* a,
+					  am_array_registry_relocatable_fun_t f,
+					  void* data));
+
+int am_array_registry_for_each_relocatable(struct am_array_registry* r,
+					   const char* type,
+					   void* a,
+					   am_array_registry_relocatable_fun_t f,
+					   void* data);
+
+int
+am_array_registry_set_sortable(struct am_array_registry* r,
+			       const char* type,
+			       int (*for_each_sortable)(
+				       void* a,
+				       am_array_registry_sortable_fun_t f,
+				       void* data));
+
+int am_array_registry_for_each_sortable(struct am_array_registry* r,
+					const char* type,
+					void* a,
+					am_array_registry_sortable_fun_t f,
+					void* data);
+
 void* am_array_registry_allocate_array(struct am_array_registry* r,
 				       const char* type,
 				       int* type_found);
@@ -0,0 +1,234 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "column_store.h"
+#include <aftermath/core/safe_alloc.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Initializes an empty column store without a cache file */
+void am_column_store_init(struct am_column_store* s)
+{
+	s->fd = -1;
+	s->size = 0;
+	am_column_store_mapping_array_init(&s->mappings);
+}
+
+/* Creates the cache file of a column store in the same directory as
+ * path_prefix with a name starting with the last component of path_prefix,
+ * e.g., a prefix /path/to/trace.ost creates a file
+ * /path/to/trace.ost.columns.XXXXXX. Returns 0 on success, otherwise 1. */
+int am_column_store_open(struct am_column_store* s, const char* path_prefix)
+{
+	static const char suffix[] = ".columns.XXXXXX";
+	char* path;
+	size_t len;
+
+	len = strlen(path_prefix);
+
+	if(am_size_add_safe(&len, len, sizeof(suffix)))
+		goto out_err;
+
+	if(!(path = malloc(len)))
+		goto out_err;
+
+	strcpy(path, path_prefix);
+	strcat(path, suffix);
+
+	if((s->fd = mkstemp(path)) == -1)
+		goto out_err_free;
+
+	/* The file only needs to be reachable through the file descriptor */
+	if(unlink(path))
+		goto out_err_close;
+
+	free(path);
+
+	return 0;
+
+out_err_close:
+	close(s->fd);
+	s->fd = -1;
+	unlink(path);
+out_err_free:
+	free(path);
+out_err:
+	return 1;
+}
+
+/* Destroys a column store. The elements of all arrays added to the store
+ * become inaccessible and the arrays are reset to empty arrays, such that they
+ * can be destroyed safely afterwards. */
+void am_column_store_destroy(struct am_column_store* s)
+{
+	struct am_column_store_mapping* m;
+
+	for(size_t i = 0; i < s->mappings.num_elements; i++) {
+		m = &s->mappings.elements[i];
+
+		if(m->array) {
+			m->array->elements = NULL;
+			m->array->num_elements = 0;
+			m->array->num_free = 0;
+		}
+	}
+
+	for(size_t i = 0; i < s->mappings.num_elements; i++) {
+		m = &s->mappings.elements[i];
+
+		if(m->addr)
+			munmap(m->addr, m->size);
+	}
+
+	am_column_store_mapping_array_destroy(&s->mappings);
+
+	if(s->fd != -1)
+		close(s->fd);
+}
+
+/* Writes size bytes from buf to the file descriptor fd at offset off. Returns 0
+ * on success, otherwise 1. */
+static int am_column_store_pwrite(int fd, const void* buf, size_t size, off_t off)
+{
+	const char* pos = buf;
+	ssize_t written;
+
+	while(size > 0) {
+		written = pwrite(fd, pos, size, off);
+
+		if(written == -1) {
+			if(errno == EINTR)
+				continue;
+
+			return 1;
+		}
+
+		pos += written;
+		off += written;
+		size -= written;
+	}
+
+	return 0;
+}
+
+/* Returns true if the elements of a have already been moved to the store */
+static int am_column_store_contains(const struct am_column_store* s,
+				    const struct am_typed_array_generic* a)
+{
+	for(size_t i = 0; i < s->mappings.num_elements; i++)
+		if(s->mappings.elements[i].array == a)
+			return 1;
+
+	return 0;
+}
+
+/* Appends an entry for a mapping and / or an array to the store. Returns 0 on
+ * success, otherwise 1. */
+static int am_column_store_append(struct am_column_store* s,
+				  struct am_typed_array_generic* a,
+				  void* addr,
+				  size_t size)
+{
+	struct am_column_store_mapping* m;
+
+	if(am_column_store_mapping_array_reserve_end(&s->mappings))
+		return 1;
+
+	m = &s->mappings.elements[s->mappings.num_elements - 1];
+	m->array = a;
+	m->addr = addr;
+	m->size = size;
+
+	return 0;
+}
+
+/* Transfers ownership of the mapping of size bytes at addr to the store. The
+ * mapping is unmapped when the store is destroyed. Returns 0 on success,
+ * otherwise 1. */
+int am_column_store_add_mapping(struct am_column_store* s,
+				void* addr,
+				size_t size)
+{
+	return am_column_store_append(s, NULL, addr, size);
+}
+
+/* Registers an array whose elements reside in a mapping that has been passed
+ * to the store with am_column_store_add_mapping(). The array is reset to an
+ * empty array when the store is destroyed. Returns 0 on success, otherwise
+ * 1. */
+int am_column_store_adopt_array(struct am_column_store* s,
+				struct am_typed_array_generic* a)
+{
+	return am_column_store_append(s, a, NULL, 0);
+}
+
+/* Moves the elements of a complete array a with elements of element_size bytes
+ * to the cache file of the store and replaces the heap buffer of a with a
+ * mapping of the file. Empty arrays and arrays that have already been added
+ * are left untouched. The cache file must have been created with
+ * am_column_store_open(). Returns 0 on success, otherwise 1. On failure, the
+ * array remains unmodified. */
+int am_column_store_add(struct am_column_store* s,
+			struct am_typed_array_generic* a,
+			size_t element_size)
+{
+	size_t size;
+	off_t off;
+	long page_size;
+	void* addr;
+
+	if(a->num_elements == 0 || am_column_store_contains(s, a))
+		return 0;
+
+	if(s->fd == -1)
+		return 1;
+
+	if(am_size_mul_safe(&size, a->num_elements, element_size))
+		return 1;
+
+	if((page_size = sysconf(_SC_PAGESIZE)) <= 0)
+		return 1;
+
+	/* Mappings must start at a page boundary within the file */
+	off = ((s->size + page_size - 1) / page_size) * page_size;
+
+	if(am_column_store_pwrite(s->fd, a->elements, size, off))
+		return 1;
+
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, off);
+
+	if(addr == MAP_FAILED)
+		return 1;
+
+	if(am_column_store_append(s, a, addr, size)) {
+		munmap(addr, size);
+		return 1;
+	}
+
+	s->size = off + size;
+
+	free(a->elements);
+	a->elements = addr;
+	a->num_free = 0;
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_COLUMN_STORE_H
+#define AM_COLUMN_STORE_H
+
+/* A column store keeps complete, immutable typed arrays out of core: the
+ * elements of each array added to the store are written to a cache file and
+ * the array's heap buffer is replaced with a shared memory mapping of the
+ * file. The array structures themselves are left untouched, such that all
+ * accessors continue to work, but residency of the elements is managed by the
+ * page cache of the operating system rather than by the heap.
+ *
+ * The cache file is unlinked right after its creation and is thus removed
+ * automatically when the store is destroyed or when the process terminates.
+ * A store may also take ownership of existing mappings with arrays whose
+ * elements reside in these mappings (e.g., for a trace cache).
+ *
+ * Arrays added to the store must not grow or shrink anymore and must not be
+ * destroyed before the store, since their buffers cannot be passed to
+ * realloc() or free().
+ */
+
+#include <aftermath/core/typed_array.h>
+#include <sys/types.h>
+
+/* A mapping owned by the store and / or an array whose elements reside in a
+ * mapping owned by the store. Either array or addr may be NULL. */
+struct am_column_store_mapping {
+	struct am_typed_array_generic* array;
+	void* addr;
+	size_t size;
+};
+
+AM_DECL_TYPED_ARRAY(am_column_store_mapping_array,
+		    struct am_column_store_mapping)
+
+struct am_column_store {
+	/* File descriptor of the unlinked cache file or -1 if no cache file
+	 * has been created */
+	int fd;
+
+	/* Current size of the cache file in bytes */
+	off_t size;
+
+	struct am_column_store_mapping_array mappings;
+};
+
+void am_column_store_init(struct am_column_store* s);
+int am_column_store_open(struct am_column_store* s, const char* path_prefix);
+void am_column_store_destroy(struct am_column_store* s);
+int am_column_store_add(struct am_column_store* s,
+			struct am_typed_array_generic* a,
+			size_t element_size);
+int am_column_store_add_mapping(struct am_column_store* s,
+				void* addr,
+				size_t size);
+int am_column_store_adopt_array(struct am_column_store* s,
+				struct am_typed_array_generic* a);
+
+#endif
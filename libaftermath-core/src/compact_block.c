@@ -0,0 +1,545 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * ************************************************************************
+ * * THIS FILE IS PART OF THE CODE RELEASED UNDER THE LGPL, VERSION 2.1   *
+ * * UNLIKE THE MAJORITY OF THE CODE OF LIBAFTERMATH-CORE, RELEASED UNDER *
+ * * THE GPL, VERSION 2.                                                  *
+ * ************************************************************************
+ *
+ * This file can be redistributed it and/or modified under the terms of
+ * the GNU Lesser General Public License version 2.1 as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+
+#include "compact_block.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Maximum number of fields of a frame type that can be encoded */
+#define AM_COMPACT_BLOCK_MAX_FIELDS 32
+
+/* Per-type state of the encoder and the decoder */
+struct am_compact_block_type {
+	uint32_t id;
+	size_t num_fields;
+
+	/* Size in bytes of a frame in the regular on-disk format, including
+	 * the type ID */
+	size_t raw_size;
+
+	/* Layout characters of the fields, including
+	 * AM_COMPACT_BLOCK_FIELD_DELTA for delta-encoded fields */
+	unsigned char fields[AM_COMPACT_BLOCK_MAX_FIELDS];
+
+	/* Value of each field of the previous frame of this type */
+	uint64_t prev[AM_COMPACT_BLOCK_MAX_FIELDS];
+
+	/* Total number of bytes needed for the direct and the delta encoding
+	 * of each field */
+	size_t cost_direct[AM_COMPACT_BLOCK_MAX_FIELDS];
+	size_t cost_delta[AM_COMPACT_BLOCK_MAX_FIELDS];
+};
+
+/* Returns the width in bytes of a field with the layout character c or 0 if c
+ * is not a valid layout character. */
+static inline size_t am_compact_block_field_width(unsigned char c)
+{
+	switch(c & ~AM_COMPACT_BLOCK_FIELD_DELTA) {
+		case 'b': case 'B': return 1;
+		case 'h': case 'H': return 2;
+		case 'i': case 'I': case 'c': return 4;
+		case 'q': case 'Q': case 'T': return 8;
+	}
+
+	return 0;
+}
+
+static inline int am_compact_block_field_signed(unsigned char c)
+{
+	c &= ~AM_COMPACT_BLOCK_FIELD_DELTA;
+
+	return c == 'b' || c == 'h' || c == 'i' || c == 'q';
+}
+
+/* Reads a little-endian integer with w bytes from p. If is_signed is true, the
+ * value is sign-extended to 64 bits. */
+static inline uint64_t am_compact_block_load(const unsigned char* p,
+					     size_t w,
+					     int is_signed)
+{
+	uint64_t v = 0;
+
+	for(size_t i = 0; i < w; i++)
+		v |= ((uint64_t)p[i]) << (8 * i);
+
+	if(is_signed && w < 8 && (v >> (8 * w - 1)) & 1)
+		v |= ~(uint64_t)0 << (8 * w);
+
+	return v;
+}
+
+/* Writes the w least significant bytes of v to p in little-endian order */
+static inline void am_compact_block_store(unsigned char* p,
+					  size_t w,
+					  uint64_t v)
+{
+	for(size_t i = 0; i < w; i++)
+		p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static inline uint64_t am_compact_block_zigzag(uint64_t v)
+{
+	return (v << 1) ^ (uint64_t)((int64_t)v >> 63);
+}
+
+static inline uint64_t am_compact_block_unzigzag(uint64_t v)
+{
+	return (v >> 1) ^ (~(v & 1) + 1);
+}
+
+/* Returns the number of bytes of the variable-length encoding of v */
+static inline size_t am_compact_block_varint_size(uint64_t v)
+{
+	size_t ret = 1;
+
+	while(v >= 0x80) {
+		v >>= 7;
+		ret++;
+	}
+
+	return ret;
+}
+
+/* Writes the variable-length encoding of v to p and returns the number of
+ * bytes written. */
+static inline size_t am_compact_block_varint_put(unsigned char* p, uint64_t v)
+{
+	size_t ret = 0;
+
+	while(v >= 0x80) {
+		p[ret++] = (v & 0x7F) | 0x80;
+		v >>= 7;
+	}
+
+	p[ret++] = v;
+
+	return ret;
+}
+
+/* Reads a variable-length integer from *p, which must not exceed end, into *v
+ * and advances *p. Returns 0 on success, otherwise 1. */
+static inline int am_compact_block_varint_get(const unsigned char** p,
+					      const unsigned char* end,
+					      uint64_t* v)
+{
+	uint64_t ret = 0;
+
+	for(unsigned int shift = 0; shift < 64; shift += 7) {
+		if(*p == end)
+			return 1;
+
+		ret |= ((uint64_t)(**p & 0x7F)) << shift;
+
+		if(!(*(*p)++ & 0x80)) {
+			*v = ret;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* Initializes the type t with the ID id from a zero-terminated layout
+ * string. Returns 0 on success or 1 if the layout is invalid. */
+static int am_compact_block_type_init(struct am_compact_block_type* t,
+				      uint32_t id,
+				      const char* layout)
+{
+	size_t w;
+
+	t->id = id;
+	t->num_fields = 0;
+	t->raw_size = sizeof(uint32_t);
+
+	for(; layout[t->num_fields]; t->num_fields++) {
+		if(t->num_fields == AM_COMPACT_BLOCK_MAX_FIELDS)
+			return 1;
+
+		if(!(w = am_compact_block_field_width(layout[t->num_fields])))
+			return 1;
+
+		t->fields[t->num_fields] = layout[t->num_fields];
+		t->prev[t->num_fields] = 0;
+		t->cost_direct[t->num_fields] = 0;
+		t->cost_delta[t->num_fields] = 0;
+		t->raw_size += w;
+	}
+
+	return 0;
+}
+
+/* Returns true if the frame of type t at p belongs to the event collection
+ * with the ID collection_id, otherwise false. */
+static int am_compact_block_frame_in_collection(
+	const struct am_compact_block_type* t,
+	const unsigned char* p,
+	uint32_t collection_id)
+{
+	p += sizeof(uint32_t);
+
+	for(size_t i = 0; i < t->num_fields; i++) {
+		if(t->fields[i] == 'c' &&
+		   am_compact_block_load(p, 4, 0) != collection_id)
+		{
+			return 0;
+		}
+
+		p += am_compact_block_field_width(t->fields[i]);
+	}
+
+	return 1;
+}
+
+/* Returns the index of the type with the ID id in types or -1 if there is no
+ * such type. */
+static inline int am_compact_block_find_type(
+	const struct am_compact_block_type* types,
+	size_t num_types,
+	uint32_t id)
+{
+	for(size_t i = 0; i < num_types; i++)
+		if(types[i].id == id)
+			return i;
+
+	return -1;
+}
+
+/* Encodes the frames in regular on-disk format starting at raw, which all
+ * belong to the event collection with the ID collection_id, into a compact
+ * block. Layout_fun provides the layouts of the frame types given their
+ * IDs. Encoding stops at the end of the raw data, at the first frame that
+ * cannot be encoded (e.g., because its type has no layout or because it
+ * belongs to a different event collection) or if the frame would exceed the
+ * maximum number of types per block.
+ *
+ * On success, *out points to a newly allocated buffer with the *out_size bytes
+ * of the encoded block, *consumed is set to the number of bytes of raw that
+ * have been encoded and *num_frames to the number of frames of the block. The
+ * lowest and highest value of all timestamp fields of the encoded frames are
+ * returned in *min_timestamp and *max_timestamp. If the frames do not have any
+ * timestamps, *min_timestamp is set to UINT64_MAX and *max_timestamp to 0.
+ *
+ * Returns 0 on success, 1 on error and 2 if the first frame cannot be
+ * encoded.
+ */
+int am_compact_block_encode(const void* raw,
+			    size_t raw_size,
+			    uint32_t collection_id,
+			    am_compact_block_layout_fun_t layout_fun,
+			    void** out,
+			    size_t* out_size,
+			    size_t* consumed,
+			    uint64_t* num_frames,
+			    uint64_t* min_timestamp,
+			    uint64_t* max_timestamp)
+{
+	const unsigned char* in = raw;
+	const unsigned char* p;
+	unsigned char* o;
+	struct am_compact_block_type* types;
+	struct am_compact_block_type* t;
+	const char* layout;
+	size_t num_types = 0;
+	size_t pos = 0;
+	size_t size = 0;
+	size_t w;
+	uint64_t n = 0;
+	uint64_t v;
+	uint64_t tmin = UINT64_MAX;
+	uint64_t tmax = 0;
+	uint32_t id;
+	int idx;
+	int ret = 1;
+
+	if(!(types = malloc(AM_COMPACT_BLOCK_MAX_TYPES * sizeof(*types))))
+		goto out;
+
+	/* First pass: determine the frames of the block and the cheapest
+	 * encoding for each field */
+	while(raw_size - pos >= sizeof(uint32_t)) {
+		id = am_compact_block_load(in + pos, sizeof(uint32_t), 0);
+
+		if((idx = am_compact_block_find_type(types, num_types, id)) < 0) {
+			if(num_types == AM_COMPACT_BLOCK_MAX_TYPES)
+				break;
+
+			if(!(layout = layout_fun(id)))
+				break;
+
+			if(am_compact_block_type_init(&types[num_types],
+						      id, layout))
+			{
+				break;
+			}
+
+			idx = num_types;
+		}
+
+		t = &types[idx];
+
+		if(raw_size - pos < t->raw_size ||
+		   !am_compact_block_frame_in_collection(t, in + pos,
+							 collection_id))
+		{
+			break;
+		}
+
+		if((size_t)idx == num_types)
+			num_types++;
+
+		p = in + pos + sizeof(uint32_t);
+		size += am_compact_block_varint_size(idx);
+
+		for(size_t i = 0; i < t->num_fields; i++) {
+			w = am_compact_block_field_width(t->fields[i]);
+
+			if(t->fields[i] != 'c') {
+				v = am_compact_block_load(
+					p, w, am_compact_block_field_signed(
+						t->fields[i]));
+
+				t->cost_direct[i] += am_compact_block_varint_size(
+					am_compact_block_field_signed(t->fields[i]) ?
+					am_compact_block_zigzag(v) : v);
+
+				t->cost_delta[i] += am_compact_block_varint_size(
+					am_compact_block_zigzag(v - t->prev[i]));
+
+				t->prev[i] = v;
+
+				if(t->fields[i] == 'T') {
+					tmin = (v < tmin) ? v : tmin;
+					tmax = (v > tmax) ? v : tmax;
+				}
+			}
+
+			p += w;
+		}
+
+		pos += t->raw_size;
+		n++;
+	}
+
+	if(n == 0) {
+		ret = 2;
+		goto out_types;
+	}
+
+	size += am_compact_block_varint_size(num_types);
+
+	for(size_t j = 0; j < num_types; j++) {
+		t = &types[j];
+		size += am_compact_block_varint_size(t->id);
+		size += am_compact_block_varint_size(t->num_fields);
+		size += t->num_fields;
+
+		for(size_t i = 0; i < t->num_fields; i++) {
+			if(t->fields[i] == 'c')
+				continue;
+
+			if(t->cost_delta[i] < t->cost_direct[i]) {
+				t->fields[i] |= AM_COMPACT_BLOCK_FIELD_DELTA;
+				size += t->cost_delta[i];
+			} else {
+				size += t->cost_direct[i];
+			}
+
+			t->prev[i] = 0;
+		}
+	}
+
+	if(!(*out = malloc(size)))
+		goto out_types;
+
+	/* Second pass: emit the type table and the encoded frames */
+	o = *out;
+	o += am_compact_block_varint_put(o, num_types);
+
+	for(size_t j = 0; j < num_types; j++) {
+		t = &types[j];
+		o += am_compact_block_varint_put(o, t->id);
+		o += am_compact_block_varint_put(o, t->num_fields);
+		memcpy(o, t->fields, t->num_fields);
+		o += t->num_fields;
+	}
+
+	pos = 0;
+
+	for(uint64_t f = 0; f < n; f++) {
+		id = am_compact_block_load(in + pos, sizeof(uint32_t), 0);
+		idx = am_compact_block_find_type(types, num_types, id);
+		t = &types[idx];
+		p = in + pos + sizeof(uint32_t);
+
+		o += am_compact_block_varint_put(o, idx);
+
+		for(size_t i = 0; i < t->num_fields; i++) {
+			w = am_compact_block_field_width(t->fields[i]);
+
+			if(t->fields[i] != 'c') {
+				v = am_compact_block_load(
+					p, w, am_compact_block_field_signed(
+						t->fields[i]));
+
+				if(t->fields[i] & AM_COMPACT_BLOCK_FIELD_DELTA) {
+					o += am_compact_block_varint_put(
+						o, am_compact_block_zigzag(
+							v - t->prev[i]));
+				} else if(am_compact_block_field_signed(
+						  t->fields[i]))
+				{
+					o += am_compact_block_varint_put(
+						o, am_compact_block_zigzag(v));
+				} else {
+					o += am_compact_block_varint_put(o, v);
+				}
+
+				t->prev[i] = v;
+			}
+
+			p += w;
+		}
+
+		pos += t->raw_size;
+	}
+
+	*out_size = size;
+	*consumed = pos;
+	*num_frames = n;
+	*min_timestamp = tmin;
+	*max_timestamp = tmax;
+	ret = 0;
+
+out_types:
+	free(types);
+out:
+	return ret;
+}
+
+/* Decodes the compact block of in_size bytes at in with num_frames frames of
+ * the event collection with the ID collection_id into the regular on-disk
+ * format. The decoded frames must occupy exactly raw_size bytes, which must be
+ * available at out. Returns 0 on success, otherwise 1.
+ */
+int am_compact_block_decode(const void* in,
+			    size_t in_size,
+			    uint32_t collection_id,
+			    void* out,
+			    size_t raw_size,
+			    uint64_t num_frames)
+{
+	const unsigned char* p = in;
+	const unsigned char* end = p + in_size;
+	unsigned char* o = out;
+	struct am_compact_block_type* types;
+	struct am_compact_block_type* t;
+	char layout[AM_COMPACT_BLOCK_MAX_FIELDS + 1];
+	uint64_t num_types;
+	uint64_t id;
+	uint64_t num_fields;
+	uint64_t idx;
+	uint64_t v;
+	size_t pos = 0;
+	size_t w;
+	int ret = 1;
+
+	if(!(types = malloc(AM_COMPACT_BLOCK_MAX_TYPES * sizeof(*types))))
+		goto out;
+
+	if(am_compact_block_varint_get(&p, end, &num_types) ||
+	   num_types > AM_COMPACT_BLOCK_MAX_TYPES)
+	{
+		goto out_types;
+	}
+
+	for(size_t j = 0; j < num_types; j++) {
+		if(am_compact_block_varint_get(&p, end, &id) ||
+		   id > UINT32_MAX ||
+		   am_compact_block_varint_get(&p, end, &num_fields) ||
+		   num_fields > AM_COMPACT_BLOCK_MAX_FIELDS ||
+		   (size_t)(end - p) < num_fields)
+		{
+			goto out_types;
+		}
+
+		for(size_t i = 0; i < num_fields; i++)
+			layout[i] = p[i] & ~AM_COMPACT_BLOCK_FIELD_DELTA;
+
+		layout[num_fields] = '\0';
+
+		if(am_compact_block_type_init(&types[j], id, layout))
+			goto out_types;
+
+		memcpy(types[j].fields, p, num_fields);
+		p += num_fields;
+	}
+
+	for(uint64_t f = 0; f < num_frames; f++) {
+		if(am_compact_block_varint_get(&p, end, &idx) ||
+		   idx >= num_types)
+		{
+			goto out_types;
+		}
+
+		t = &types[idx];
+
+		if(raw_size - pos < t->raw_size)
+			goto out_types;
+
+		am_compact_block_store(o + pos, sizeof(uint32_t), t->id);
+		pos += sizeof(uint32_t);
+
+		for(size_t i = 0; i < t->num_fields; i++) {
+			w = am_compact_block_field_width(t->fields[i]);
+
+			if(t->fields[i] == 'c') {
+				v = collection_id;
+			} else {
+				if(am_compact_block_varint_get(&p, end, &v))
+					goto out_types;
+
+				if(t->fields[i] & AM_COMPACT_BLOCK_FIELD_DELTA)
+					v = t->prev[i] + am_compact_block_unzigzag(v);
+				else if(am_compact_block_field_signed(t->fields[i]))
+					v = am_compact_block_unzigzag(v);
+
+				t->prev[i] = v;
+			}
+
+			am_compact_block_store(o + pos, w, v);
+			pos += w;
+		}
+	}
+
+	if(pos != raw_size || p != end)
+		goto out_types;
+
+	ret = 0;
+
+out_types:
+	free(types);
+out:
+	return ret;
+}
@@ -0,0 +1,83 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * ************************************************************************
+ * * THIS FILE IS PART OF THE CODE RELEASED UNDER THE LGPL, VERSION 2.1   *
+ * * UNLIKE THE MAJORITY OF THE CODE OF LIBAFTERMATH-CORE, RELEASED UNDER *
+ * * THE GPL, VERSION 2.                                                  *
+ * ************************************************************************
+ *
+ * This file can be redistributed it and/or modified under the terms of
+ * the GNU Lesser General Public License version 2.1 as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+
+#ifndef AM_COMPACT_BLOCK_H
+#define AM_COMPACT_BLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A compact block stores a sequence of frames of a single event collection
+ * with a more compact encoding than the regular on-disk format. Each frame
+ * type appearing in the block is described by a layout string (see
+ * am_default_on_disk_type_compact_layout()) with one character per integer
+ * field of the frame. All values are stored as LEB128 variable-length
+ * integers, signed values in zigzag encoding. For each field of each frame
+ * type, the encoder decides whether it is cheaper to store the values
+ * directly or the difference to the value of the same field of the previous
+ * frame of the same type, which is typically the case for timestamps.
+ *
+ * Encoded block:
+ *
+ *   varint num_types
+ *   num_types times:
+ *     varint type_id
+ *     varint num_fields
+ *     num_fields bytes: layout character, or'ed with
+ *                       AM_COMPACT_BLOCK_FIELD_DELTA if delta-encoded
+ *   for each frame:
+ *     varint index of the frame type in the table above
+ *     varint for each field, except for the event collection ID
+ */
+
+/* Maximum number of distinct frame types in a single block */
+#define AM_COMPACT_BLOCK_MAX_TYPES 32
+
+/* Flag for fields whose values are delta-encoded */
+#define AM_COMPACT_BLOCK_FIELD_DELTA 0x80
+
+/* Function returning the layout of a frame type given its type ID or NULL if
+ * the frame type cannot be encoded */
+typedef const char* (*am_compact_block_layout_fun_t)(uint32_t type_id);
+
+int am_compact_block_encode(const void* raw,
+			    size_t raw_size,
+			    uint32_t collection_id,
+			    am_compact_block_layout_fun_t layout_fun,
+			    void** out,
+			    size_t* out_size,
+			    size_t* consumed,
+			    uint64_t* num_frames,
+			    uint64_t* min_timestamp,
+			    uint64_t* max_timestamp);
+
+int am_compact_block_decode(const void* in,
+			    size_t in_size,
+			    uint32_t collection_id,
+			    void* out,
+			    size_t raw_size,
+			    uint64_t num_frames);
+
+#endif
@@ -43,6 +43,34 @@
 		prefix##_destroy(a);				\
 	}
 
+/* Declares a function for an array registry entry that marks an array of
+ * elements without owned memory as a single relocatable array. */
+#define AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION(prefix)	\
+	static int prefix##_default_for_each_relocatable(		\
+		void* a,						\
+		am_array_registry_relocatable_fun_t f,			\
+		void* data)						\
+	{								\
+		return f(AM_TYPED_ARRAY_GENERIC(a),			\
+			 sizeof(prefix##_element_type),			\
+			 data);						\
+	}
+
+/* Declares a function for an array registry entry that marks an array as a
+ * single sortable array whose elements are ordered by the timestamp key_field
+ * (e.g., interval.start). */
+#define AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION(prefix, key_field)	\
+	static int prefix##_default_for_each_sortable(				\
+		void* a,							\
+		am_array_registry_sortable_fun_t f,				\
+		void* data)							\
+	{									\
+		return f(AM_TYPED_ARRAY_GENERIC(a),				\
+			 sizeof(prefix##_element_type),				\
+			 offsetof(prefix##_element_type, key_field),		\
+			 data);							\
+	}
+
 /* Registers an array type at an array registry with the functions generated by
  * AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS by invoking
  * am_array_registry_add.
@@ -54,4 +82,18 @@
 			      prefix##_default_init,	\
 			      prefix##_default_destroy)
 
+/* Marks an array type registered with AM_DEFAULT_ARRAY_REGISTRY_REGISTER as
+ * relocatable using the function generated by
+ * AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION. */
+#define AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, prefix, name)	\
+	am_array_registry_set_relocatable(r, name,			\
+		prefix##_default_for_each_relocatable)
+
+/* Marks an array type registered with AM_DEFAULT_ARRAY_REGISTRY_REGISTER as
+ * sortable using the function generated by
+ * AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION. */
+#define AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, prefix, name)	\
+	am_array_registry_set_sortable(r, name,			\
+		prefix##_default_for_each_sortable)
+
 #endif
@@ -25,6 +25,7 @@
 #include <aftermath/core/counter_event_array_collection.h>
 #include <aftermath/core/state_event_array.h>
 #include <aftermath/core/measurement_interval_array.h>
+#include <aftermath/core/timestamp_calibration_array.h>
 #include <aftermath/core/openstream_task_type_array.h>
 #include <aftermath/core/openstream_task_instance_array.h>
 #include <aftermath/core/openstream_task_period_array.h>
@@ -52,11 +53,13 @@
 
 #include <aftermath/core/on_disk_meta.h>
 
+#include <stddef.h>
 #include <stdlib.h>
 
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_state_description_array)
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_counter_description_array)
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_measurement_interval_array)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_timestamp_calibration_array)
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_openstream_task_type_array)
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_openstream_task_instance_array)
 
@@ -86,6 +89,65 @@ AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_telamon_candidate_select_action_arra
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_telamon_candidate_select_child_action_array)
 AM_DECL_DEFAULT_ARRAY_REGISTRY_FUNCTIONS(am_telamon_thread_trace_array)
 
+/* Event arrays that are never the target of a join and that may thus be moved
+ * to out-of-core storage once the trace has been loaded. */
+AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION(am_state_event_array)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION(am_openstream_task_period_array)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION(am_openmp_task_period_array)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION(am_openmp_iteration_period_array)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_RELOCATABLE_FUNCTION(am_tensorflow_node_execution_array)
+
+/* Event arrays whose elements must be ordered by their start timestamp for the
+ * binary searches in interval_array.h */
+AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION(am_state_event_array, interval.start)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION(am_openstream_task_period_array, interval.start)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION(am_openmp_task_period_array, interval.start)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION(am_openmp_iteration_period_array, interval.start)
+AM_DECL_DEFAULT_ARRAY_REGISTRY_SORTABLE_FUNCTION(am_tensorflow_node_execution_array, interval.start)
+
+/* The arrays of a counter event array collection are relocatable, but the
+ * collection itself is not. */
+static int am_counter_event_array_collection_default_for_each_relocatable(
+	void* a,
+	am_array_registry_relocatable_fun_t f,
+	void* data)
+{
+	struct am_counter_event_array_collection* c = a;
+
+	for(size_t i = 0; i < c->num_elements; i++) {
+		if(f(AM_TYPED_ARRAY_GENERIC(&c->elements[i]),
+		     sizeof(am_counter_event_array_element_type),
+		     data))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* The arrays of a counter event array collection are ordered by the timestamps
+ * of the samples */
+static int am_counter_event_array_collection_default_for_each_sortable(
+	void* a,
+	am_array_registry_sortable_fun_t f,
+	void* data)
+{
+	struct am_counter_event_array_collection* c = a;
+
+	for(size_t i = 0; i < c->num_elements; i++) {
+		if(f(AM_TYPED_ARRAY_GENERIC(&c->elements[i]),
+		     sizeof(am_counter_event_array_element_type),
+		     offsetof(am_counter_event_array_element_type, time),
+		     data))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
 int am_build_default_trace_array_registry(struct am_array_registry* r)
 {
 	if(AM_DEFAULT_ARRAY_REGISTRY_REGISTER(r, am_state_description_array,
@@ -94,6 +156,8 @@ int am_build_default_trace_array_registry(struct am_array_registry* r)
 					      "am::core::counter_description") ||
 	   AM_DEFAULT_ARRAY_REGISTRY_REGISTER(r, am_measurement_interval_array,
 					      "am::core::measurement_interval") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_REGISTER(r, am_timestamp_calibration_array,
+					      "am::core::timestamp_calibration") ||
 	   AM_DEFAULT_ARRAY_REGISTRY_REGISTER(r, am_openstream_task_type_array,
 					      "am::openstream::task_type") ||
 	   AM_DEFAULT_ARRAY_REGISTRY_REGISTER(r, am_openstream_task_instance_array,
@@ -144,6 +208,38 @@ int am_build_default_trace_array_registry(struct am_array_registry* r)
 		return 1;
 	}
 
+	if(AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, am_state_event_array,
+						      "am::core::state_event") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, am_counter_event_array_collection,
+						      "am::core::counter_event") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, am_openstream_task_period_array,
+						      "am::openstream::task_period") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, am_openmp_task_period_array,
+						      "am::openmp::task_period") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, am_openmp_iteration_period_array,
+						      "am::openmp::iteration_period") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_RELOCATABLE(r, am_tensorflow_node_execution_array,
+						      "am::tensorflow::node_execution"))
+	{
+		return 1;
+	}
+
+	if(AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, am_state_event_array,
+						   "am::core::state_event") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, am_counter_event_array_collection,
+						   "am::core::counter_event") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, am_openstream_task_period_array,
+						   "am::openstream::task_period") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, am_openmp_task_period_array,
+						   "am::openmp::task_period") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, am_openmp_iteration_period_array,
+						   "am::openmp::iteration_period") ||
+	   AM_DEFAULT_ARRAY_REGISTRY_SET_SORTABLE(r, am_tensorflow_node_execution_array,
+						   "am::tensorflow::node_execution"))
+	{
+		return 1;
+	}
+
 	if(am_build_default_meta_array_registry(r))
 		return 1;
 
@@ -319,3 +319,229 @@ class GenerateWriteWithDefaultIDFunction(TemplatedGenerateFunctionTag,
             template_type = aftermath.templates.dsk.WriteWithDefaultIDFunction)
 
         WriteWithDefaultIDFunction.__init__(self)
+
+class CompactLayout(Tag):
+    """Describes the layout of a frame for the compact encoding of frames
+    within compact blocks. The layout is a string with one character per integer
+    field of the flattened frame: 'B', 'H', 'I' and 'Q' stand for unsigned
+    integers with 8, 16, 32 and 64 bits, 'b', 'h', 'i' and 'q' for their signed
+    counterparts, 'T' for unsigned 64-bit integers holding a timestamp and 'c'
+    for the 32-bit ID of the event collection of the frame, which is not stored
+    in the encoded frame.
+
+    A field holds a timestamp if the conversion to the in-memory representation
+    maps it onto a field of type am_timestamp_t.
+
+    Only frames with a fixed size that belong to an event collection have a
+    layout."""
+
+    __codes = { 8 : "b", 16 : "h", 32 : "i", 64 : "q" }
+
+    def __getTimestampFields(self, t):
+        """Returns the list of fields of the on-disk compound type t that are
+        converted into timestamps in memory"""
+
+        conv_tag = t.getTagInheriting(aftermath.tags.dsk.tomem.ConversionFunction)
+
+        if conv_tag is None:
+            return []
+
+        return [ dsk_field for (dsk_field, mem_field) in conv_tag.getFieldMap()
+                 if mem_field.getType() is aftermath.types.base.am_timestamp_t ]
+
+    def __getFieldLayout(self, t, is_timestamp = False):
+        """Returns the layout string for a value of type t or None if t cannot be
+        encoded compactly. If is_timestamp is True, the value is a timestamp."""
+
+        if t.isCompound():
+            ret = ""
+            ts_fields = self.__getTimestampFields(t)
+
+            for field in t.getFields():
+                if field.isPointer() or field.isArray():
+                    return None
+
+                flayout = self.__getFieldLayout(field.getType(),
+                                                field in ts_fields)
+
+                if flayout is None:
+                    return None
+
+                ret += flayout
+
+            return ret
+        elif isinstance(t, aftermath.types.FixedWidthIntegerType):
+            code = self.__codes.get(t.getNumBits())
+
+            if code is None:
+                return None
+
+            if is_timestamp and code == "q" and not t.isSigned():
+                return "T"
+
+            return code if t.isSigned() else code.upper()
+
+        return None
+
+    def getLayout(self):
+        """Returns the layout string of the associated frame type or None if the
+        frame type does not support compact encoding"""
+
+        t = self.getType()
+        ecoll_tag = t.getTagInheriting(
+            aftermath.tags.dsk.tomem.GeneratePerEventCollectionArrayFunction)
+        ecoll_sub_tag = t.getTagInheriting(
+            aftermath.tags.dsk.tomem.GeneratePerEventCollectionSubArrayFunction)
+
+        if ecoll_tag:
+            ecoll_field = ecoll_tag.getEventCollectionDskIDField()
+        elif ecoll_sub_tag:
+            ecoll_field = ecoll_sub_tag.getEventCollectionIDDskField()
+        else:
+            return None
+
+        if ecoll_field.getType() is not aftermath.types.builtin.uint32_t:
+            return None
+
+        ret = ""
+        ts_fields = self.__getTimestampFields(t)
+
+        for field in t.getFields():
+            if field.isPointer() or field.isArray():
+                return None
+
+            if field is ecoll_field:
+                ret += "c"
+                continue
+
+            flayout = self.__getFieldLayout(field.getType(),
+                                            field in ts_fields)
+
+            if flayout is None:
+                return None
+
+            ret += flayout
+
+        return ret
+
+class FrameSize(Tag):
+    """Describes how the size of a frame in its regular on-disk format can be
+    determined from the raw bytes of the frame. The size is described as a list
+    of steps, each of which is a tuple (kind, size), where size is a C
+    expression:
+
+      ("fixed", size): the next size bytes belong to the frame
+      ("count", size): the next size bytes are an unsigned integer with the
+                       number of elements of the next array
+      ("array", size): the frame continues with an array of elements of size
+                       bytes each
+
+    Strings are represented as a count followed by an array of characters."""
+
+    def __getFixedSize(self, t):
+        """Returns a C expression for the size of the on-disk type t or None if
+        the size is not fixed"""
+
+        steps = self.__getTypeSteps(t)
+
+        if any(kind != "fixed" for (kind, size) in steps):
+            return None
+
+        return " + ".join([ size for (kind, size) in steps ])
+
+    def __getFieldSteps(self, field):
+        """Returns the list of steps for the field `field`"""
+
+        if field.isArray() or field.isPointer():
+            raise Exception("Cannot determine the on-disk size of field '" +
+                            field.getName() + "'")
+
+        return self.__getTypeSteps(field.getType())
+
+    def __getTypeSteps(self, t):
+        """Returns the list of steps for a value of the on-disk type t"""
+
+        if t is aftermath.types.on_disk.am_dsk_string:
+            return [ ("count", "sizeof(uint32_t)"), ("array", "1") ]
+
+        if not t.isCompound():
+            return [ ("fixed", "sizeof(" + t.getCType() + ")") ]
+
+        array_tag = t.getTagInheriting(GenerateArrayReadFunction)
+        steps = []
+
+        if array_tag:
+            num_field = array_tag.getNumElementsField()
+
+            for field in array_tag.getVerbatimFields():
+                if field is num_field:
+                    steps.append(("count", "sizeof(" +
+                                  field.getType().getCType() + ")"))
+                else:
+                    steps += self.__getFieldSteps(field)
+
+            element_size = self.__getFixedSize(
+                array_tag.getArrayField().getType())
+
+            if element_size is None:
+                raise Exception("Elements of the array of type '" +
+                                t.getName() + "' do not have a fixed size")
+
+            steps.append(("array", element_size))
+        else:
+            for field in t.getFields():
+                steps += self.__getFieldSteps(field)
+
+        return steps
+
+    def getSteps(self):
+        """Returns the list of steps for the fields of the associated frame
+        type, without the type ID preceding the frame. Consecutive fields with a
+        fixed size are merged into a single step."""
+
+        steps = []
+
+        for (kind, size) in self.__getTypeSteps(self.getType()):
+            if kind == "fixed" and steps and steps[-1][0] == "fixed":
+                steps[-1] = ("fixed", steps[-1][1] + " + " + size)
+            else:
+                steps.append((kind, size))
+
+        return steps
+
+    def getCollectionIDOffset(self):
+        """Returns a C expression for the offset of the ID of the event
+        collection of a frame relative to the end of the type ID preceding the
+        frame or None if the frame does not belong to an event collection or if
+        the offset is not fixed."""
+
+        t = self.getType()
+        ecoll_tag = t.getTagInheriting(
+            aftermath.tags.dsk.tomem.GeneratePerEventCollectionArrayFunction)
+        ecoll_sub_tag = t.getTagInheriting(
+            aftermath.tags.dsk.tomem.GeneratePerEventCollectionSubArrayFunction)
+
+        if ecoll_tag:
+            ecoll_field = ecoll_tag.getEventCollectionDskIDField()
+        elif ecoll_sub_tag:
+            ecoll_field = ecoll_sub_tag.getEventCollectionIDDskField()
+        else:
+            return None
+
+        if ecoll_field.getType() is not aftermath.types.builtin.uint32_t:
+            return None
+
+        offset = [ "0" ]
+
+        for field in t.getFields():
+            if field is ecoll_field:
+                return " + ".join(offset)
+
+            size = self.__getFixedSize(field.getType())
+
+            if size is None or field.isArray() or field.isPointer():
+                return None
+
+            offset.append(size)
+
+        return None
@@ -0,0 +1,122 @@
+# Author: Andi Drebes <andi@drebesium.org>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as published
+# by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+# USA.
+
+from aftermath.tags import Tag
+from aftermath.types import CompoundType, FieldList
+from aftermath.util import enforce_type, enforce_type_list
+import aftermath
+
+class Column(object):
+    """A single column of a columnar representation, storing the values of a
+    (possibly nested) field of all elements"""
+
+    def __init__(self, path, field):
+        """`path` is the list of field names leading from the compound type to
+        the field, `field` is the field at the end of the path"""
+
+        self.__path = path
+        self.__field = field
+
+    def getName(self):
+        """Returns the name of the column in the generated structure (e.g.,
+        "interval_start" for the path interval.start)"""
+
+        return "_".join(self.__path)
+
+    def getAccessExpression(self):
+        """Returns the expression accessing the field relative to an element
+        (e.g., "interval.start")"""
+
+        return ".".join(self.__path)
+
+    def getField(self):
+        return self.__field
+
+    def getType(self):
+        return self.__field.getType()
+
+    def getComment(self):
+        return self.__field.getComment()
+
+class GenerateColumns(Tag):
+    """Generates a columnar representation (structure of arrays) for arrays of the
+    tagged type, with one contiguous column for each of the selected fields, as
+    well as functions initializing, building and destroying the columns."""
+
+    def __init__(self, field_paths, struct_name = None):
+        """`field_paths` is a list of strings, each of which designates a field
+        of the type or a field of an embedded compound field using dots as
+        separators (e.g., "interval.start").
+
+        `struct_name` is the name of the generated structure. If None, the name
+        is derived automatically by appending "_columns" to the type's name.
+        """
+
+        super(GenerateColumns, self).__init__()
+
+        enforce_type_list(field_paths, str)
+        enforce_type(struct_name, [str, type(None)])
+
+        self.__field_paths = field_paths
+        self.__struct_name = struct_name
+
+    def getStructName(self):
+        if self.__struct_name is None:
+            return self.getType().getName()+"_columns"
+        else:
+            return self.__struct_name
+
+    def getStructType(self):
+        """Returns a dummy compound type for the generated structure that can be
+        used in function signatures"""
+
+        return CompoundType(
+            name = self.getStructName(),
+            entity = None,
+            fields = FieldList([]),
+            comment = None)
+
+    def getColumns(self):
+        """Returns a list of Column instances for the selected fields"""
+
+        ret = []
+
+        for path in self.__field_paths:
+            t = self.getType()
+            field = None
+            names = path.split(".")
+
+            for name in names:
+                if not isinstance(t, CompoundType):
+                    raise Exception("Field path '" + path + "' of type '" +
+                                    self.getType().getName() + "' does not "
+                                    "designate a field")
+
+                field = t.getFields().getFieldByName(name)
+
+                if field.isPointer() or field.isArray():
+                    raise Exception("Field '" + name + "' of path '" + path +
+                                    "' cannot be stored in a column")
+
+                t = field.getType()
+
+            if isinstance(t, CompoundType):
+                raise Exception("Field path '" + path + "' does not designate "
+                                "a non-compound field")
+
+            ret.append(Column(names, field))
+
+        return ret
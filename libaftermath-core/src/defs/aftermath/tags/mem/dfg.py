@@ -27,7 +27,9 @@ class DeclareConstPointerType(Tag):
 class DeclareEventMappingOverlappingIntervalExtractionNode(Tag):
     """Declares a DFG node type that extracts constant pointers to all instances of
     the type in all event mappings present at the input port that overlap with
-    at least one of the intervals at another input port.
+    at least one of the intervals at another input port. Also declares a DFG
+    type for ranges of contiguous instances of the type, a variant of the node
+    returning such ranges and a node expanding ranges into constant pointers.
     """
 
     def __init__(self, stripname_plural, port_name, include_file,
@@ -10,6 +10,11 @@
 {{template.getSignature()}}
 {
 	{{dsk_type.getCType()}} f;
+	{%- set apply_filter = ecoll_id_field and timestamp_accessors %}
+	{%- if apply_filter %}
+	am_timestamp_t tmin;
+	am_timestamp_t tmax;
+	{%- endif %}
 	int ret = 1;
 
 	if({{read_tag.getFunctionName()}}(ctx, &f))
@@ -25,6 +30,28 @@
 	}
 	{%- endif %}
 
+	{%- if apply_filter %}
+{# #}
+	/* Skip events not matching the load filter; their timestamps still
+	 * contribute to the bounds of the trace */
+	tmin = f.{{timestamp_accessors[0]}};
+	tmax = f.{{timestamp_accessors[0]}};
+	{%- for accessor in timestamp_accessors[1:] %}
+{# #}
+	if(f.{{accessor}} < tmin)
+		tmin = f.{{accessor}};
+
+	if(f.{{accessor}} > tmax)
+		tmax = f.{{accessor}};
+	{%- endfor %}
+{# #}
+	if(!am_io_context_load_event(ctx, f.{{ecoll_id_field.getName()}}, tmin, tmax)) {
+		am_io_context_extend_bounds(ctx, tmin, tmax);
+		ret = 0;
+		goto {{out_dest}};
+	}
+	{%- endif %}
+
 	{%- set process_tag = dsk_type.getTagInheriting(aftermath.tags.process.ProcessFunction) %}
 	{%- if process_tag %}
 {# #}
@@ -35,7 +62,7 @@
 	ret = 0;
 {# #}
 {%- if dsk_type.hasDestructor() %}
-{%- if assert_tag or process_tag %}
+{%- if assert_tag or process_tag or apply_filter %}
 out_err_destroy:
 {%- endif %}
 	{{dsk_type.getDestructorName()}}(&f);
@@ -4,14 +4,22 @@
  *
  * Returns 0 on success, otherwise 1.
  */
+{%- set is_frame = gen_tag.hasTypeParam() or gen_tag.hasConstantTypeID() %}
 {{ template.getSignature() }}
 {
+{%- if is_frame %}
+	size_t old_used;
+{%- else %}
 	size_t old_used = wb->used;
+{%- endif %}
 {%- if gen_tag.hasConstantTypeID() %}
 	uint32_t type_id = {{ gen_tag.getConstantTypeID() }};
 {%- endif %}
 {# #}
-{%- if gen_tag.hasTypeParam() or gen_tag.hasConstantTypeID() %}
+{%- if is_frame %}
+retry:
+	old_used = wb->used;
+
 	if(am_dsk_uint32_t_write_to_buffer(wb, &type_id))
 		goto out_err;
 {# #}
@@ -27,5 +35,13 @@
 
 out_err:
 	wb->used = old_used;
+{%- if is_frame %}
+
+	/* Frames are never split; retry if the buffer could be replaced by a
+	 * buffer with more space */
+	if(!am_write_buffer_make_room(wb))
+		goto retry;
+{# #}
+{%- endif %}
 	return 1;
 }
@@ -159,7 +159,57 @@ class LoadFunction(FunctionTemplate, Jinja2FileTemplate):
                       is_pointer = True)
             ]))
 
-        self.addDefaultArguments(dsk_type = dsk_type, **reqtags)
+        self.addDefaultArguments(
+            dsk_type = dsk_type,
+            ecoll_id_field = self.__getEventCollectionIDField(dsk_type),
+            timestamp_accessors = self.__getTimestampAccessors(dsk_type),
+            **reqtags)
+
+    def __getEventCollectionIDField(self, t):
+        """Returns the field of the on-disk type t containing the ID of the event
+        collection the in-memory representation is stored in or None if t is
+        not stored per event collection"""
+
+        tag = t.getTagInheriting(
+            tags.dsk.tomem.GeneratePerEventCollectionArrayFunction)
+
+        if tag is not None:
+            return tag.getEventCollectionDskIDField()
+
+        tag = t.getTagInheriting(
+            tags.dsk.tomem.GeneratePerEventCollectionSubArrayFunction)
+
+        if tag is not None:
+            return tag.getEventCollectionIDDskField()
+
+        return None
+
+    def __getTimestampAccessors(self, t, prefix = ""):
+        """Returns the accessors relative to an instance of the on-disk compound
+        type t of all fields that are converted into timestamps in memory"""
+
+        conv_tag = t.getTagInheriting(tags.dsk.tomem.ConversionFunction)
+        ret = []
+
+        if conv_tag is None:
+            return ret
+
+        ts_fields = [ dsk_field for (dsk_field, mem_field)
+                      in conv_tag.getFieldMap()
+                      if mem_field.getType() is aftermath.types.base.am_timestamp_t ]
+
+        for field in t.getFields():
+            if field.isPointer() or field.isArray():
+                continue
+
+            if field.getType().isCompound():
+                ret += self.__getTimestampAccessors(
+                    field.getType(),
+                    prefix + field.getName() + ".")
+            elif field in ts_fields:
+                ret.append(prefix + field.getName())
+
+        return ret
 
 
 class ProcessFunction(FunctionTemplate, Jinja2FileTemplate):
@@ -14,10 +14,14 @@
 # Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
 # USA.
 
-from aftermath.templates import FunctionTemplate, Jinja2FileTemplate
+from aftermath.templates import FunctionTemplate, \
+    Jinja2FileTemplate, \
+    Jinja2StringTemplate
 from aftermath import tags
 from aftermath.types import Field, FieldList
 import aftermath.types
+import aftermath.types.base
+import aftermath.types.builtin
 import os
 
 
@@ -46,3 +50,242 @@ class GenerateProcessCollectSourcesFunction(FunctionTemplate, Jinja2FileTemplate
                       is_pointer = True)
             ]))
         self.addDefaultArguments(**reqtags)
+
+class ColumnsDefinition(Jinja2StringTemplate):
+    """Template generating the structure definition in C for the columnar
+    representation of a type tagged with tags.mem.columns.GenerateColumns"""
+
+    def __init__(self, t):
+        reqtags = self.requireTags(t, {
+            "gen_tag" : tags.mem.columns.GenerateColumns
+        })
+
+        template_content = """
+        /* Columnar representation of an array of {{t.getEntity()}}s */
+        struct {{gen_tag.getStructName()}} {
+        	/* Number of elements in each column */
+        	size_t num_elements;
+        {% for col in gen_tag.getColumns() %}
+        	/* {{col.getComment()}} */
+        	{{col.getType().getCType()}}* {{col.getName()}};
+        {% endfor -%}
+        };"""
+
+        super(ColumnsDefinition, self).__init__(
+            template_content = template_content)
+        self.addDefaultArguments(t = t, **reqtags)
+
+class ColumnsInitFunction(FunctionTemplate, Jinja2StringTemplate):
+    """Template implementing the function initializing an empty columnar
+    representation"""
+
+    def __init__(self, t):
+        reqtags = self.requireTags(t, {
+            "gen_tag" : tags.mem.columns.GenerateColumns
+        })
+
+        gen_tag = reqtags["gen_tag"]
+
+        FunctionTemplate.__init__(
+            self,
+            function_name = gen_tag.getStructName() + "_init",
+            return_type = aftermath.types.builtin.void,
+            arglist = FieldList([
+                Field(name = "c",
+                      field_type = gen_tag.getStructType(),
+                      is_pointer = True)
+            ]))
+
+        template_content = """
+        /* Initializes an empty columnar representation of {{t.getEntity()}}s */
+        {{template.getSignature()}}
+        {
+        	c->num_elements = 0;
+        {%- for col in gen_tag.getColumns() %}
+        	c->{{col.getName()}} = NULL;
+        {%- endfor %}
+        }"""
+
+        Jinja2StringTemplate.__init__(self, template_content)
+        self.addDefaultArguments(t = t, **reqtags)
+
+class ColumnsDestroyFunction(FunctionTemplate, Jinja2StringTemplate):
+    """Template implementing the function destroying a columnar representation"""
+
+    def __init__(self, t):
+        reqtags = self.requireTags(t, {
+            "gen_tag" : tags.mem.columns.GenerateColumns
+        })
+
+        gen_tag = reqtags["gen_tag"]
+
+        FunctionTemplate.__init__(
+            self,
+            function_name = gen_tag.getStructName() + "_destroy",
+            return_type = aftermath.types.builtin.void,
+            arglist = FieldList([
+                Field(name = "c",
+                      field_type = gen_tag.getStructType(),
+                      is_pointer = True)
+            ]))
+
+        template_content = """
+        /* Destroys a columnar representation of {{t.getEntity()}}s */
+        {{template.getSignature()}}
+        {
+        {%- for col in gen_tag.getColumns() %}
+        	free(c->{{col.getName()}});
+        {%- endfor %}
+        }"""
+
+        Jinja2StringTemplate.__init__(self, template_content)
+        self.addDefaultArguments(t = t, **reqtags)
+
+class ColumnsBuildFunction(FunctionTemplate, Jinja2StringTemplate):
+    """Template implementing the function filling a columnar representation with
+    the fields from an array of structures"""
+
+    def __init__(self, t):
+        reqtags = self.requireTags(t, {
+            "gen_tag" : tags.mem.columns.GenerateColumns
+        })
+
+        gen_tag = reqtags["gen_tag"]
+
+        FunctionTemplate.__init__(
+            self,
+            function_name = gen_tag.getStructName() + "_build",
+            return_type = aftermath.types.builtin.int,
+            arglist = FieldList([
+                Field(name = "c",
+                      field_type = gen_tag.getStructType(),
+                      is_pointer = True),
+                Field(name = "elements",
+                      field_type = t,
+                      is_pointer = True,
+                      is_const = True),
+                Field(name = "num_elements",
+                      field_type = aftermath.types.builtin.size_t)
+            ]))
+
+        template_content = """
+        /* Replaces the contents of the columns c with the fields of the
+         * num_elements {{t.getEntity()}}s at elements. Returns 0 on success,
+         * otherwise 1. */
+        {{template.getSignature()}}
+        {
+        	struct {{gen_tag.getStructName()}} tmp;
+
+        	{{gen_tag.getStructName()}}_init(&tmp);
+        {% for col in gen_tag.getColumns() %}
+        	if(!(tmp.{{col.getName()}} = am_alloc_array_safe(
+        		     num_elements, sizeof(tmp.{{col.getName()}}[0]))) &&
+        	   num_elements > 0)
+        	{
+        		goto out_err;
+        	}
+        {% endfor %}
+        	for(size_t i = 0; i < num_elements; i++) {
+        {%- for col in gen_tag.getColumns() %}
+        		tmp.{{col.getName()}}[i] = elements[i].{{col.getAccessExpression()}};
+        {%- endfor %}
+        	}
+
+        	tmp.num_elements = num_elements;
+
+        	{{gen_tag.getStructName()}}_destroy(c);
+        	*c = tmp;
+
+        	return 0;
+
+        out_err:
+        	{{gen_tag.getStructName()}}_destroy(&tmp);
+        	return 1;
+        }"""
+
+        Jinja2StringTemplate.__init__(self, template_content)
+        self.addDefaultArguments(t = t, **reqtags)
+
+class TraceCacheLayouts(Jinja2StringTemplate):
+    """Template generating the table of element layouts used by the trace cache
+    to relocate pointers and strings of the elements of in-memory arrays. The
+    table is sorted by the identifiers of the types."""
+
+    def __init__(self, types):
+        layouts = []
+
+        for t in types:
+            if not t.isCompound() or not t.hasIdent():
+                continue
+
+            (fields, supported) = self.__collectFields(t, "")
+
+            layouts.append({
+                "t" : t,
+                "fields" : fields,
+                "supported" : supported
+            })
+
+        layouts.sort(key = lambda l: l["t"].getIdent())
+
+        template_content = """
+        {%- for l in layouts %}
+        {%- if l.fields %}
+        static const struct am_trace_cache_field am_trace_cache_fields_{{l.t.getName()}}[] = {
+        {%- for (kind, path) in l.fields %}
+        	{ {{kind}}, offsetof({{l.t.getCType()}}, {{path}}) }{{ "," if not loop.last }}
+        {%- endfor %}
+        };
+        {% endif %}
+        {%- endfor %}
+        const struct am_trace_cache_layout am_trace_cache_layouts[] = {
+        {%- for l in layouts %}
+        	{
+        		.ident = "{{l.t.getIdent()}}",
+        		.element_size = sizeof({{l.t.getCType()}}),
+        		{%- if l.fields %}
+        		.fields = am_trace_cache_fields_{{l.t.getName()}},
+        		.num_fields = {{l.fields|length}},
+        		{%- else %}
+        		.fields = NULL,
+        		.num_fields = 0,
+        		{%- endif %}
+        		.supported = {{ 1 if l.supported else 0 }}
+        	}{{ "," if not loop.last }}
+        {%- endfor %}
+        };
+
+        const size_t am_trace_cache_num_layouts = {{layouts|length}};"""
+
+        Jinja2StringTemplate.__init__(self, template_content)
+        self.addDefaultArguments(layouts = layouts)
+
+    def __collectFields(self, t, prefix):
+        """Returns a tuple composed of a list of (kind, path) tuples for the
+        pointers and strings of the compound type t and a boolean indicating
+        whether all other fields can be copied verbatim."""
+
+        fields = []
+        supported = True
+
+        for f in t.getFields():
+            path = prefix + f.getName()
+            ft = f.getType()
+
+            if f.isPointer():
+                if f.isArray() or f.isOwned() or \
+                   f.getPointerDepth() != 1 or \
+                   not ft.isCompound():
+                    supported = False
+                else:
+                    fields.append(("AM_TRACE_CACHE_FIELD_POINTER", path))
+            elif ft is aftermath.types.base.am_string or \
+                 ft is aftermath.types.builtin.charp:
+                fields.append(("AM_TRACE_CACHE_FIELD_STRING", path))
+            elif ft.isCompound():
+                (subfields, subsupported) = \
+                    self.__collectFields(ft, path + ".")
+                fields += subfields
+                supported = supported and subsupported
+
+        return (fields, supported)
@@ -1,7 +1,7 @@
 /* Appends a new element pointed to by 'e' at the end of the
  * per-event-collection array for a {{mem_type.getEntity()}} for the event
  * collection identified by 'ecoll_id'. If the array does not exist, a new array
- * is created.
+ * is created. The address of the array is cached in the I/O context.
  *
  * Returns 0 on success, otherwise 1.
  */
@@ -10,25 +10,34 @@
 	struct am_trace* t = ctx->trace;
 	struct {{event_array_struct_name}}* arr;
 	struct am_event_collection* ecoll;
+	static const char ident[] = "{{event_array_ident}}";
 	size_t idx;
 
-	if(!(ecoll = am_event_collection_array_find(&t->event_collections,
-						    ecoll_id)))
+	if(!(arr = am_io_array_cache_lookup(&ctx->array_cache, ecoll_id,
+					    ident)))
 	{
-		AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
-			      "Could not find event collection with id "
-			      "%" AM_EVENT_COLLECTION_ID_T_FMT ".",
-			      ecoll_id);
-	}
+		if(!(ecoll = am_event_collection_array_find(
+			     &t->event_collections, ecoll_id)))
+		{
+			AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
+				      "Could not find event collection with id "
+				      "%" AM_EVENT_COLLECTION_ID_T_FMT ".",
+				      ecoll_id);
+		}
 
-	if(!(arr = am_event_collection_find_or_add_event_array(
-		     &ctx->trace->array_registry,
-		     ecoll,
-		     "{{event_array_ident}}")))
-	{
-		AM_IOERR_RET1_NA(ctx, AM_IOERR_FIND_RELATED,
-				 "Could not find / add event collection array "
-				 "for type {{mem_type.getEntity()}}.");
+		if(!(arr = am_event_collection_find_or_add_event_array(
+			     &ctx->trace->array_registry,
+			     ecoll,
+			     ident)))
+		{
+			AM_IOERR_RET1_NA(ctx, AM_IOERR_FIND_RELATED,
+					 "Could not find / add event collection "
+					 "array for type "
+					 "{{mem_type.getEntity()}}.");
+		}
+
+		am_io_array_cache_insert(&ctx->array_cache, ecoll_id, ident,
+					 arr);
 	}
 
 	if({{event_array_struct_name}}_appendp(arr, e)) {
@@ -2,7 +2,8 @@
  * per-event-collection sub-array for a {{mem_type.getEntity()}} for the event
  * collection identified by 'ecoll_id' and the sub-array identified by
  * 'sub_id'. If the array and / or sub-array do(es) not exist, new array(s)
- * is/are created.
+ * is/are created. The address of the per-event-collection array is cached in
+ * the I/O context.
  *
  * Returns 0 on success, otherwise 1.
  */
@@ -12,24 +13,33 @@
 	struct {{ecoll_array_struct_name}}* ecoll_arr;
 	struct {{event_array_struct_name}}* sub_arr;
 	struct am_event_collection* ecoll;
+	static const char ident[] = "{{event_array_ident}}";
 
-	if(!(ecoll = am_event_collection_array_find(&t->event_collections,
-						    ecoll_id)))
+	if(!(ecoll_arr = am_io_array_cache_lookup(&ctx->array_cache,
+						  ecoll_id, ident)))
 	{
-		AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
-			      "Could not find event collection with id "
-			      "%" AM_EVENT_COLLECTION_ID_T_FMT ".",
-			      ecoll_id);
-	}
+		if(!(ecoll = am_event_collection_array_find(
+			     &t->event_collections, ecoll_id)))
+		{
+			AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
+				      "Could not find event collection with id "
+				      "%" AM_EVENT_COLLECTION_ID_T_FMT ".",
+				      ecoll_id);
+		}
 
-	if(!(ecoll_arr = am_event_collection_find_or_add_event_array(
-		     &ctx->trace->array_registry,
-		     ecoll,
-		     "{{event_array_ident}}")))
-	{
-		AM_IOERR_RET1_NA(ctx, AM_IOERR_FIND_RELATED,
-				 "Could not find / add event collection array "
-				 "for type {{mem_type.getEntity()}}.");
+		if(!(ecoll_arr = am_event_collection_find_or_add_event_array(
+			     &ctx->trace->array_registry,
+			     ecoll,
+			     ident)))
+		{
+			AM_IOERR_RET1_NA(ctx, AM_IOERR_FIND_RELATED,
+					 "Could not find / add event collection "
+					 "array for type "
+					 "{{mem_type.getEntity()}}.");
+		}
+
+		am_io_array_cache_insert(&ctx->array_cache, ecoll_id, ident,
+					 ecoll_arr);
 	}
 
 	if(!(sub_arr = {{ecoll_array_struct_name}}_find_or_add(ecoll_arr, sub_id))) {
@@ -1,13 +1,14 @@
 /* Checks whether the minimum and maximum timestamps of a trace need to be
- * updated from a {{t.getEntity()}}. */
+ * updated from a {{t.getEntity()}}. The bounds are accumulated in the I/O
+ * context and copied to the trace once all frames have been read. */
 {{ template.getSignature() }}
 {
 	{%- for accessor in gen_tag.getAccessors() %}
-	if(e->{{accessor}} < ctx->trace->bounds.start)
-		ctx->trace->bounds.start = e->{{accessor}};
+	if(e->{{accessor}} < ctx->bounds.start)
+		ctx->bounds.start = e->{{accessor}};
 
-	if(e->{{accessor}} > ctx->trace->bounds.end)
-		ctx->trace->bounds.end = e->{{accessor}};
+	if(e->{{accessor}} > ctx->bounds.end)
+		ctx->bounds.end = e->{{accessor}};
 {# #}
 	{%- endfor %}
 	return 0;
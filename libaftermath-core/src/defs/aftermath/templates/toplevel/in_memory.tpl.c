@@ -17,6 +17,9 @@
  */
 
 #include <aftermath/core/in_memory.h>
+#include <aftermath/core/safe_alloc.h>
+#include <aftermath/core/trace_cache.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 {% for t in aftermath.config.getMemTypes().filterByTag(aftermath.tags.GenerateDestructor) -%}
@@ -26,3 +29,13 @@
 {% for t in aftermath.config.getMemTypes().filterByTag(aftermath.tags.GenerateDefaultConstructor) -%}
 {{ aftermath.templates.DefaultConstructor(t) }}
 {% endfor -%}
+
+{% for t in aftermath.config.getMemTypes().filterByTag(aftermath.tags.mem.columns.GenerateColumns) -%}
+{{ aftermath.templates.mem.ColumnsInitFunction(t) }}
+
+{{ aftermath.templates.mem.ColumnsDestroyFunction(t) }}
+
+{{ aftermath.templates.mem.ColumnsBuildFunction(t) }}
+{% endfor -%}
+
+{{ aftermath.templates.mem.TraceCacheLayouts(aftermath.config.getMemTypes()) }}
@@ -20,6 +20,7 @@
 #define AM_IN_MEMORY_H
 
 #include <aftermath/core/base_types.h>
+#include <stddef.h>
 
 {% set mem_types = aftermath.config.getMemTypes() %}
 
@@ -38,6 +39,14 @@
 {{ aftermath.templates.StructDefinition(t) }}
 {% endfor -%}
 
+{% for t in mem_types.filterByTag(aftermath.tags.mem.columns.GenerateColumns) -%}
+{{ aftermath.templates.mem.ColumnsDefinition(t) }}
+
+{{ aftermath.templates.mem.ColumnsInitFunction(t).getPrototype() }}
+{{ aftermath.templates.mem.ColumnsDestroyFunction(t).getPrototype() }}
+{{ aftermath.templates.mem.ColumnsBuildFunction(t).getPrototype() }}
+{% endfor -%}
+
 {% for t in mem_types.filterByTag(aftermath.tags.GenerateDestructor) -%}
 {{ aftermath.templates.Destructor(t).getPrototype() }}
 {% endfor -%}
@@ -30,7 +30,8 @@
 /* A node extracting all {{t.getEntity()}} instances all event mappings on input
  * overlapping with at least one of the intervals provided at the "intervals"
  * input port. If the port is disconnected, all events of the mapping will be
- * output. */
+ * output. A second node outputs the events as ranges and a third node
+ * expands such ranges into individual references. */
 AM_DFG_DECL_EVENT_MAPPING_EXTRACT_OVERLAPPING_INTERVAL_NODE(
 	{{tag.getStripNamePlural()}}, "{{tag.getPortName()}}", "{{tag.getCapitalizedHumanReadablePlural()}}", "{{t.getIdent()}}")
 
@@ -39,7 +40,9 @@ AM_DFG_DECL_EVENT_MAPPING_EXTRACT_OVERLAPPING_INTERVAL_NODE(
 AM_DFG_ADD_BUILTIN_NODE_TYPES(
 	{% for t in mem_types.filterByTag(aftermath.tags.mem.dfg.DeclareEventMappingOverlappingIntervalExtractionNode) -%}
 	{% set tag = t.getTagInheriting(aftermath.tags.mem.dfg.DeclareEventMappingOverlappingIntervalExtractionNode) -%}
-	&am_dfg_event_mapping_{{tag.getStripNamePlural()}}_node_type{% if not loop.last %},{% endif %}
+	&am_dfg_event_mapping_{{tag.getStripNamePlural()}}_node_type,
+	&am_dfg_event_mapping_{{tag.getStripNamePlural()}}_ranges_node_type,
+	&am_dfg_event_range_{{tag.getStripNamePlural()}}_expand_node_type{% if not loop.last %},{% endif %}
 	{% endfor -%}
 )
 
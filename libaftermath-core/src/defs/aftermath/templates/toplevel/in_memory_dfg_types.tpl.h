@@ -19,6 +19,7 @@
 #ifndef AM_IN_MEMORY_DFG_TYPES_H
 #define AM_IN_MEMORY_DFG_TYPES_H
 
+#include <aftermath/core/dfg/types/event_range.h>
 #include <aftermath/core/dfg/types/generic.h>
 #include <aftermath/core/in_memory.h>
 
@@ -66,11 +67,25 @@ AM_DFG_DECL_BUILTIN_TYPE(
 	am_dfg_type_generic_plain_copy_samples,
 	NULL, NULL, NULL)
 
+{% endfor -%}
+{% for t in mem_types.filterByTag(aftermath.tags.mem.dfg.DeclareEventMappingOverlappingIntervalExtractionNode) -%}
+/* DFG type for contiguous ranges of {{t.getName()}} */
+AM_DFG_DECL_BUILTIN_TYPE(
+	am_dfg_type_event_range_{{t.getStripName()}},
+	"am::core::event_range<{{t.getIdent()}}>",
+	sizeof(struct am_dfg_event_range),
+	NULL,
+	am_dfg_type_generic_plain_copy_samples,
+	NULL, NULL, NULL)
+
 {% endfor -%}
 AM_DFG_ADD_BUILTIN_TYPES(
 {%- for t in mem_types.filterByTag(aftermath.tags.mem.dfg.DeclareConstPointerType) %}
 	&am_dfg_type_const_{{t.getStripName()}},
 {%- endfor -%}
+{%- for t in mem_types.filterByTag(aftermath.tags.mem.dfg.DeclareEventMappingOverlappingIntervalExtractionNode) %}
+	&am_dfg_type_event_range_{{t.getStripName()}},
+{%- endfor %}
 	&am_dfg_type_const_trace,
 	&am_dfg_type_const_event_mapping,
 	&am_dfg_type_const_hierarchy,
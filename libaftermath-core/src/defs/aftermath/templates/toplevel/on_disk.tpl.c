@@ -30,6 +30,7 @@
 #include <aftermath/core/openstream_task_type_array.h>
 #include <aftermath/core/state_description_array.h>
 #include <aftermath/core/state_event_array.h>
+#include <aftermath/core/timestamp_calibration_array.h>
 #include <aftermath/core/counter_event_array_collection.h>
 
 #include <aftermath/core/telamon_candidate_array.h>
@@ -44,11 +45,16 @@
 #include <aftermath/core/tensorflow_node_array.h>
 #include <aftermath/core/tensorflow_node_execution_array.h>
 
+#include <aftermath/core/compact_block.h>
 #include <aftermath/core/on_disk.h>
 #include <aftermath/core/on_disk_default_type_ids.h>
 #include <aftermath/core/in_memory_inline.h>
 #include <aftermath/core/on_disk_meta.h>
+#include <aftermath/core/parallel.h>
+#include <aftermath/core/ptr.h>
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -74,13 +80,20 @@ static inline int am_dsk_read(struct am_io_context* ctx,
 			      void* buf,
 			      size_t size)
 {
+	int ret;
+
 	if(size == 0)
 		return 0;
 
-	if(fread(buf, size, 1, ctx->fp) != 1) {
+	if(am_io_context_is_mapped(ctx))
+		ret = am_io_context_map_read(ctx, buf, size);
+	else
+		ret = (fread(buf, size, 1, ctx->fp) != 1);
+
+	if(ret) {
 		AM_IOERR_RET1(ctx, AM_IOERR_READ,
 			      "Could not read %zu bytes at offset %jd.",
-			      ftello(ctx->fp));
+			      size, (intmax_t)am_io_context_tell(ctx));
 	}
 
 	return 0;
@@ -195,10 +208,12 @@ static inline int am_dsk_header_assert(struct am_io_context* ctx,
 	if(f->magic != AM_TRACE_MAGIC)
 		AM_IOERR_RET1_NA(ctx, AM_IOERR_MAGIC, "Wrong file type.");
 
-	if(f->version != AM_TRACE_VERSION) {
+	if(f->version < AM_TRACE_MIN_VERSION || f->version > AM_TRACE_VERSION) {
 		AM_IOERR_RET1(ctx, AM_IOERR_VERSION,
-			      "Wrong file version: expected %"PRIu64", but got "
-			      "%" PRIu64 ".", AM_TRACE_VERSION, f->version);
+			      "Wrong file version: expected %d to %d, but "
+			      "got %" PRIu32 ".",
+			      AM_TRACE_MIN_VERSION, AM_TRACE_VERSION,
+			      f->version);
 	}
 
 	return 0;
@@ -213,6 +228,36 @@ static inline int am_dsk_state_event_assert(struct am_io_context* ctx,
 	return 0;
 }
 
+/* Marks the frame type ft, whose ID has just been associated, as to be loaded
+ * if it is listed in the load filter of the I/O context */
+static inline void
+am_dsk_load_filter_add_frame_type(struct am_io_context* ctx,
+				  const struct am_frame_type* ft)
+{
+	/* Blocks contain events of any type and are filtered by their
+	 * contents */
+	static const char* block_types[] = {
+		"am_dsk_compact_block",
+		"am_dsk_frame_block"
+	};
+
+	const struct am_io_load_filter* f = ctx->load_filter;
+
+	for(size_t i = 0; i < AM_ARRAY_SIZE(block_types); i++)
+		if(strcmp(ft->name, block_types[i]) == 0)
+			goto out_load;
+
+	for(size_t i = 0; i < f->num_frame_types; i++)
+		if(strcmp(ft->name, f->frame_types[i]) == 0)
+			goto out_load;
+
+	ctx->load_frame_types[ft->seq_id] = 0;
+	return;
+
+out_load:
+	ctx->load_frame_types[ft->seq_id] = 1;
+}
+
 /* Associates the frame type specified in the frame type ID association
  * structure fti with the specified ID in the context's frame type registry.
  *
@@ -256,6 +301,9 @@ am_dsk_frame_type_id_process(struct am_io_context* ctx,
 			      id_size, namez);
 	}
 
+	if(ctx->load_frame_types)
+		am_dsk_load_filter_add_frame_type(ctx, ft);
+
 	ret = 0;
 
 out_err_free:
@@ -513,56 +561,784 @@ out:
 	return ret;
 }
 
-/* Reads and processes all frames of a trace file. The file pointer of the I/O
- * context must be positioned at the beginning of the first frame to read (i.e.,
- * the file header must have been skipped). Returns 0 on success, otherwise 1.
- */
-static int am_dsk_read_frames(struct am_io_context* ctx)
+/* Reads the ID of the next frame from the trace file and looks up the
+ * corresponding frame type, which is returned in *ft. Returns 0 on success, 1
+ * on error and 2 if the end of the file has been reached. */
+static int am_dsk_read_frame_type(struct am_io_context* ctx,
+				  struct am_frame_type** ft)
 {
 	uint32_t type_id;
 	size_t type_id_size;
+	int ret;
+
+	if(am_io_context_is_mapped(ctx))
+		ret = am_dsk_uint32_t_read_map(ctx, &type_id);
+	else
+		ret = am_dsk_uint32_t_read_fp(ctx->fp, &type_id);
+
+	if(ret) {
+		if(am_io_context_eof(ctx)) {
+			return 2;
+		} else {
+			AM_IOERR_RET1_NA(
+				ctx, AM_IOERR_CONVERT,
+				"Could not read frame type ID.");
+		}
+	}
+
+	if(am_safe_size_from_u32(&type_id_size, type_id)) {
+		AM_IOERR_RET1(ctx, AM_IOERR_CONVERT,
+			      "Could not convert frame type ID "
+			      "%" PRIu32 ".",
+			      type_id);
+	}
+
+	if(!(*ft = am_frame_type_registry_by_id(ctx->frame_types,
+						type_id_size)))
+	{
+		AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
+			      "Could not find frame type with ID "
+			      "%zu.",
+			      type_id_size);
+	}
+
+	return 0;
+}
+
+/* Reads a single frame of type ft, whose type ID has already been read, without
+ * processing it. Returns 0 on success, otherwise 1. */
+static int am_dsk_skip_frame(struct am_io_context* ctx,
+			     struct am_frame_type* ft)
+{
+	void* frame;
+	int ret = 1;
+
+	if(!(frame = am_dsk_malloc(ctx, ft->size)))
+		goto out;
+
+	if(ft->read(ctx, frame)) {
+		AM_IOERR_GOTO(ctx, out_free, AM_IOERR_READ_FRAME,
+			      "Could not read frame of type %s.",
+			      ft->name);
+	}
+
+	if(ft->destroy)
+		ft->destroy(frame);
+
+	ret = 0;
+
+out_free:
+	free(frame);
+out:
+	return ret;
+}
+
+/* Loads a single frame of type ft, whose type ID has already been read. Frames
+ * of per-event-collection types excluded by the load filter of the I/O context
+ * are skipped. Returns 0 on success, otherwise 1. */
+static inline int am_dsk_load_frame(struct am_io_context* ctx,
+				    struct am_frame_type* ft)
+{
+	if(ft->per_event_collection && ft->read &&
+	   !am_io_context_load_frame_type(ctx, ft))
+	{
+		return am_dsk_skip_frame(ctx, ft);
+	}
+
+	if(ft->load) {
+		if(ft->load(ctx)) {
+			AM_IOERR_RET1(ctx, AM_IOERR_LOAD_FRAME,
+				      "Could not load frame of type "
+				      "%s.",
+				      ft->name);
+		}
+	}
+
+	return 0;
+}
+
+/* Reads and processes all frames of a trace file sequentially. Returns 0 on
+ * success, otherwise 1. */
+static int am_dsk_read_frames_sequential(struct am_io_context* ctx)
+{
 	struct am_frame_type* ft;
+	int ret;
 
-	while(!feof(ctx->fp)) {
-		if(am_dsk_uint32_t_read_fp(ctx->fp, &type_id)) {
-			if(feof(ctx->fp)) {
-				return 0;
-			} else {
-				AM_IOERR_RET1_NA(
-					ctx, AM_IOERR_CONVERT,
-					"Could not read frame type ID.");
+	while(!am_io_context_eof(ctx)) {
+		if((ret = am_dsk_read_frame_type(ctx, &ft)))
+			return (ret == 2) ? 0 : 1;
+
+		if(am_dsk_load_frame(ctx, ft))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Reads the header of a compact block without the encoded frames. Returns 0
+ * on success, otherwise 1. */
+static int am_dsk_compact_block_read_header(struct am_io_context* ctx,
+					    struct am_dsk_compact_block* dsk)
+{
+	if(am_dsk_uint32_t_read(ctx, &dsk->collection_id) ||
+	   am_dsk_uint32_t_read(ctx, &dsk->flags) ||
+	   am_dsk_uint64_t_read(ctx, &dsk->num_frames) ||
+	   am_dsk_uint64_t_read(ctx, &dsk->raw_size) ||
+	   am_dsk_uint64_t_read(ctx, &dsk->size))
+	{
+		AM_IOERR_RET1_NA(ctx, AM_IOERR_READ_FIELD,
+				 "Could not read header of compact block.");
+	}
+
+	if(dsk->flags != 0) {
+		AM_IOERR_RET1(ctx, AM_IOERR_ASSERT,
+			      "Unsupported flags %" PRIu32 " for compact "
+			      "block.", dsk->flags);
+	}
+
+	return 0;
+}
+
+/* Reads and discards size bytes from fp, e.g., if fp is a pipe and cannot be
+ * repositioned. Returns 0 on success, otherwise 1. */
+static int am_dsk_discard_fp(FILE* fp, size_t size)
+{
+	char buf[4096];
+	size_t chunk;
+
+	while(size > 0) {
+		chunk = (size < sizeof(buf)) ? size : sizeof(buf);
+
+		if(fread(buf, chunk, 1, fp) != 1)
+			return 1;
+
+		size -= chunk;
+	}
+
+	return 0;
+}
+
+/* Skips size bytes of the trace file, e.g., the payload of a block whose
+ * header has just been read. Returns 0 on success, otherwise 1. */
+static int am_dsk_skip(struct am_io_context* ctx, uint64_t size)
+{
+	size_t ssize;
+	int ret;
+
+	if(am_safe_size_from_u64(&ssize, size) || ssize > INT64_MAX) {
+		AM_IOERR_RET1(ctx, AM_IOERR_CONVERT,
+			      "Invalid number of bytes to skip: %" PRIu64 ".",
+			      size);
+	}
+
+	if(am_io_context_is_mapped(ctx))
+		ret = !am_io_context_map_advance(ctx, ssize);
+	else if(fseeko(ctx->fp, (off_t)ssize, SEEK_CUR))
+		ret = am_dsk_discard_fp(ctx->fp, ssize);
+	else
+		ret = 0;
+
+	if(ret) {
+		AM_IOERR_RET1(ctx, AM_IOERR_READ,
+			      "Could not skip %zu bytes.", ssize);
+	}
+
+	return 0;
+}
+
+/* Reads the frame of the per-event-collection type ft at the current position
+ * in order to determine the ID of its event collection, which is returned in
+ * *collection_id. *Frame is a buffer of *frame_size bytes for the frame, which
+ * is enlarged if necessary. Returns 0 on success, otherwise 1. */
+static int am_dsk_read_frame_collection_id(struct am_io_context* ctx,
+					   struct am_frame_type* ft,
+					   void** frame,
+					   size_t* frame_size,
+					   uint32_t* collection_id)
+{
+	void* tmp;
+
+	if(ft->size > *frame_size) {
+		if(!(tmp = realloc(*frame, ft->size))) {
+			AM_IOERR_RET1(ctx, AM_IOERR_ALLOC,
+				      "Could not allocate space for frame "
+				      "type %s.",
+				      ft->name);
+		}
+
+		*frame = tmp;
+		*frame_size = ft->size;
+	}
+
+	if(ft->read(ctx, *frame)) {
+		AM_IOERR_RET1(ctx, AM_IOERR_READ_FRAME,
+			      "Could not read frame of type %s.",
+			      ft->name);
+	}
+
+	memcpy(collection_id,
+	       AM_PTR_ADD(*frame, ft->ecoll_id_offset),
+	       sizeof(*collection_id));
+
+	if(ft->destroy)
+		ft->destroy(*frame);
+
+	return 0;
+}
+
+/* Loads the frames of a block of the event collection with the ID
+ * collection_id from the memory mapping of the I/O context until the end of
+ * the mapping. Since blocks are loaded concurrently with the frames of other
+ * event collections, a block may only contain frames of per-event-collection
+ * types that belong to the event collection of the block. If verify_collection
+ * is zero, the frames are known to belong to the event collection of the block
+ * (e.g., because the event collection has been set by the decoder of a
+ * compact block) and only the types of the frames are verified. Returns 0 on
+ * success, otherwise 1. */
+static int am_dsk_block_frames_load(struct am_io_context* ctx,
+				    uint32_t collection_id,
+				    int verify_collection)
+{
+	struct am_frame_type* ft;
+	uint32_t frame_collection_id;
+	size_t frame_size = 0;
+	size_t offset;
+	void* frame = NULL;
+	int ret = 1;
+	int rt;
+
+	while(!am_io_context_eof(ctx)) {
+		if((rt = am_dsk_read_frame_type(ctx, &ft))) {
+			if(rt == 2)
+				break;
+			else
+				goto out;
+		}
+
+		if(!ft->per_event_collection || !ft->read) {
+			AM_IOERR_GOTO(ctx, out, AM_IOERR_ASSERT,
+				      "Frame of type %s does not belong to an "
+				      "event collection and cannot be part of "
+				      "a block.",
+				      ft->name);
+		}
+
+		if(verify_collection) {
+			offset = ctx->map_pos;
+
+			if(am_dsk_read_frame_collection_id(ctx, ft, &frame,
+							   &frame_size,
+							   &frame_collection_id))
+			{
+				goto out;
+			}
+
+			if(frame_collection_id != collection_id) {
+				AM_IOERR_GOTO(ctx, out, AM_IOERR_ASSERT,
+					      "Frame of type %s for event "
+					      "collection %" PRIu32 " in block "
+					      "of event collection %" PRIu32 ".",
+					      ft->name, frame_collection_id,
+					      collection_id);
 			}
+
+			ctx->map_pos = offset;
 		}
 
-		if(am_safe_size_from_u32(&type_id_size, type_id)) {
-			AM_IOERR_RET1(ctx, AM_IOERR_CONVERT,
-				      "Could not convert frame type ID "
-				      "%" PRIu32 ".",
-				      type_id);
+		if(am_dsk_load_frame(ctx, ft))
+			goto out;
+	}
+
+	ret = 0;
+
+out:
+	free(frame);
+
+	return ret;
+}
+
+/* Loads the frames following the header of a block of frames of the event
+ * collection with the ID collection_id. Size is the size of the payload of the
+ * block in bytes and raw_size the size of the frames of the block in their
+ * regular on-disk format. If compact is non-zero, the payload is decoded into
+ * a temporary buffer first; otherwise the frames are read directly from the
+ * payload. Returns 0 on success, otherwise 1. */
+static int am_dsk_block_payload_load(struct am_io_context* ctx,
+				     uint32_t collection_id,
+				     int compact,
+				     uint64_t num_frames,
+				     uint64_t raw_size_u64,
+				     uint64_t size_u64)
+{
+	const void* payload;
+	char* map_base;
+	size_t map_size;
+	size_t map_pos;
+	size_t raw_size;
+	size_t size;
+	void* buf = NULL;
+	void* raw = NULL;
+	int ret = 1;
+	int rt;
+
+	if(am_safe_size_from_u64(&size, size_u64) ||
+	   am_safe_size_from_u64(&raw_size, raw_size_u64) ||
+	   (!compact && raw_size != size))
+	{
+		AM_IOERR_GOTO_NA(ctx, out, AM_IOERR_CONVERT,
+				 "Invalid size of block.");
+	}
+
+	if(am_io_context_is_mapped(ctx)) {
+		if(!(payload = am_io_context_map_advance(ctx, size))) {
+			AM_IOERR_GOTO(ctx, out, AM_IOERR_READ,
+				      "Could not read %zu bytes of block.",
+				      size);
 		}
+	} else {
+		if(!(buf = am_dsk_malloc(ctx, size)))
+			goto out;
 
-		if(!(ft = am_frame_type_registry_by_id(ctx->frame_types,
-						       type_id_size)))
+		if(am_dsk_read(ctx, buf, size))
+			goto out_buf;
+
+		payload = buf;
+	}
+
+	if(compact) {
+		if(!(raw = am_dsk_malloc(ctx, raw_size)))
+			goto out_buf;
+
+		if(am_compact_block_decode(payload, size, collection_id,
+					   raw, raw_size, num_frames))
 		{
-			AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
-				      "Could not find frame type with ID "
-				      "%zu.",
-				      type_id_size);
+			AM_IOERR_GOTO_NA(ctx, out_raw, AM_IOERR_CONVERT,
+					 "Could not decode compact block.");
 		}
+	}
 
-		if(ft->load) {
-			if(ft->load(ctx)) {
-				AM_IOERR_RET1(ctx, AM_IOERR_LOAD_FRAME,
-					      "Could not load frame of type "
-					      "%s.",
-					      ft->name);
-			}
+	/* Serve all reads from the frames of the block until its end */
+	map_base = ctx->map_base;
+	map_size = ctx->map_size;
+	map_pos = ctx->map_pos;
+
+	ctx->map_base = compact ? raw : (void*)payload;
+	ctx->map_size = raw_size;
+	ctx->map_pos = 0;
+
+	rt = am_dsk_block_frames_load(ctx, collection_id, !compact);
+
+	ctx->map_base = map_base;
+	ctx->map_size = map_size;
+	ctx->map_pos = map_pos;
+
+	if(rt) {
+		AM_IOERR_GOTO_NA(ctx, out_raw, AM_IOERR_READ_FRAMES,
+				 "Could not read frames of block.");
+	}
+
+	ret = 0;
+
+out_raw:
+	free(raw);
+out_buf:
+	free(buf);
+out:
+	return ret;
+}
+
+/* Reads the header of a compact block and skips the encoded frames, such that
+ * the current position is at the beginning of the next frame. Returns 0 on
+ * success, otherwise 1. */
+static int am_dsk_compact_block_read(struct am_io_context* ctx,
+				     struct am_dsk_compact_block* dsk)
+{
+	if(am_dsk_compact_block_read_header(ctx, dsk))
+		return 1;
+
+	return am_dsk_skip(ctx, dsk->size);
+}
+
+/* Loads all frames of a compact block. The frames are decoded into their
+ * regular on-disk format in a temporary buffer, from which they are then read
+ * and processed as any other frame. Returns 0 on success, otherwise 1. */
+static int am_dsk_compact_block_load(struct am_io_context* ctx)
+{
+	struct am_dsk_compact_block b;
+
+	if(am_dsk_compact_block_read_header(ctx, &b))
+		return 1;
+
+	if(!am_io_context_load_event(ctx, b.collection_id,
+				     0, AM_TIMESTAMP_T_MAX))
+	{
+		return am_dsk_skip(ctx, b.size);
+	}
+
+	return am_dsk_block_payload_load(ctx, b.collection_id, 1,
+					 b.num_frames, b.raw_size, b.size);
+}
+
+/* Reads the header of a frame block without the frames. Returns 0 on success,
+ * otherwise 1. */
+static int am_dsk_frame_block_read_header(struct am_io_context* ctx,
+					  struct am_dsk_frame_block* dsk)
+{
+	if(am_dsk_uint32_t_read(ctx, &dsk->collection_id) ||
+	   am_dsk_uint32_t_read(ctx, &dsk->flags) ||
+	   am_dsk_uint64_t_read(ctx, &dsk->num_frames) ||
+	   am_dsk_uint64_t_read(ctx, &dsk->raw_size) ||
+	   am_dsk_uint64_t_read(ctx, &dsk->size) ||
+	   am_dsk_interval_read(ctx, &dsk->interval))
+	{
+		AM_IOERR_RET1_NA(ctx, AM_IOERR_READ_FIELD,
+				 "Could not read header of frame block.");
+	}
+
+	if(dsk->flags & ~AM_DSK_FRAME_BLOCK_FLAG_COMPACT) {
+		AM_IOERR_RET1(ctx, AM_IOERR_ASSERT,
+			      "Unsupported flags %" PRIu32 " for frame "
+			      "block.", dsk->flags);
+	}
+
+	return 0;
+}
+
+/* Reads the header of a frame block and skips its frames, such that the
+ * current position is at the beginning of the next frame. Returns 0 on
+ * success, otherwise 1. */
+static int am_dsk_frame_block_read(struct am_io_context* ctx,
+				   struct am_dsk_frame_block* dsk)
+{
+	if(am_dsk_frame_block_read_header(ctx, dsk))
+		return 1;
+
+	return am_dsk_skip(ctx, dsk->size);
+}
+
+/* Loads all frames of a frame block. If none of the frames can match the load
+ * filter of the I/O context, the block is skipped without decoding its frames.
+ * Returns 0 on success, otherwise 1. */
+static int am_dsk_frame_block_load(struct am_io_context* ctx)
+{
+	struct am_dsk_frame_block b;
+
+	if(am_dsk_frame_block_read_header(ctx, &b))
+		return 1;
+
+	if(!am_io_context_load_event(ctx, b.collection_id,
+				     b.interval.start, b.interval.end))
+	{
+		/* Blocks without timestamps have an unknown interval */
+		if(b.interval.start != 0 || b.interval.end != UINT64_MAX) {
+			am_io_context_extend_bounds(ctx, b.interval.start,
+						    b.interval.end);
+		}
+
+		return am_dsk_skip(ctx, b.size);
+	}
+
+	return am_dsk_block_payload_load(
+		ctx, b.collection_id,
+		b.flags & AM_DSK_FRAME_BLOCK_FLAG_COMPACT,
+		b.num_frames, b.raw_size, b.size);
+}
+
+/* Reference to a frame whose loading has been deferred */
+struct am_dsk_frame_ref {
+	/* Offset of the frame in the trace file, right after its type ID */
+	size_t offset;
+
+	/* Type of the frame */
+	struct am_frame_type* ft;
+};
+
+AM_DECL_TYPED_ARRAY(am_dsk_frame_ref_array, struct am_dsk_frame_ref)
+
+/* All deferred frames of an event collection in the order of their
+ * appearance in the trace file */
+struct am_dsk_frame_shard {
+	am_event_collection_id_t collection_id;
+	struct am_dsk_frame_ref_array frames;
+};
+
+#define AM_DSK_FRAME_SHARD_ACC_COLLECTION_ID(x) ((x).collection_id)
+
+static inline void am_dsk_frame_shard_destroy(struct am_dsk_frame_shard* s)
+{
+	am_dsk_frame_ref_array_destroy(&s->frames);
+}
+
+AM_DECL_TYPED_ARRAY_WITH_ELEMENT_DESTRUCTOR(am_dsk_frame_shard_array,
+					    struct am_dsk_frame_shard,
+					    am_dsk_frame_shard_destroy)
+
+AM_DECL_TYPED_ARRAY_BSEARCH(am_dsk_frame_shard_array,
+			    struct am_dsk_frame_shard,
+			    am_event_collection_id_t,
+			    AM_DSK_FRAME_SHARD_ACC_COLLECTION_ID,
+			    AM_VALCMP_PTR)
+
+AM_DECL_TYPED_ARRAY_INSERTPOS(am_dsk_frame_shard_array,
+			      struct am_dsk_frame_shard,
+			      am_event_collection_id_t,
+			      AM_DSK_FRAME_SHARD_ACC_COLLECTION_ID,
+			      AM_VALCMP_PTR)
+
+AM_DECL_TYPED_ARRAY_RESERVE_SORTED(am_dsk_frame_shard_array,
+				   struct am_dsk_frame_shard,
+				   am_event_collection_id_t)
+
+/* Returns the shard for the event collection with the ID collection_id. If no
+ * such shard exists, a new shard is created. Returns NULL on failure. */
+static struct am_dsk_frame_shard*
+am_dsk_frame_shard_array_find_or_add(struct am_dsk_frame_shard_array* a,
+				     am_event_collection_id_t collection_id)
+{
+	struct am_dsk_frame_shard* s;
+
+	if((s = am_dsk_frame_shard_array_bsearch(a, collection_id)))
+		return s;
+
+	if(!(s = am_dsk_frame_shard_array_reserve_sorted(a, collection_id)))
+		return NULL;
+
+	s->collection_id = collection_id;
+	am_dsk_frame_ref_array_init(&s->frames);
+
+	return s;
+}
+
+/* Per-thread data for loading deferred frames */
+struct am_dsk_shard_worker {
+	/* Private I/O context sharing the trace, the mapping and all other
+	 * data with the I/O context used for loading, except for the error
+	 * stack, the current position, the bounds and the array cache */
+	struct am_io_context ctx;
+
+	/* Index of the shard whose loading failed or SIZE_MAX */
+	size_t failed_shard;
+};
+
+struct am_dsk_shard_load_data {
+	struct am_dsk_frame_shard_array* shards;
+	struct am_dsk_shard_worker* workers;
+};
+
+/* Loads all deferred frames of the shard with the index idx. Returns 0 on
+ * success, otherwise 1. */
+static int am_dsk_load_shard(void* data, size_t idx, unsigned int worker)
+{
+	struct am_dsk_shard_load_data* d = data;
+	struct am_dsk_shard_worker* w = &d->workers[worker];
+	struct am_dsk_frame_shard* s = &d->shards->elements[idx];
+	struct am_dsk_frame_ref* ref;
+
+	for(size_t i = 0; i < s->frames.num_elements; i++) {
+		ref = &s->frames.elements[i];
+		w->ctx.map_pos = ref->offset;
+
+		if(am_dsk_load_frame(&w->ctx, ref->ft)) {
+			w->failed_shard = idx;
+			return 1;
 		}
 	}
 
 	return 0;
 }
 
+/* Loads the deferred frames of all shards using num_threads threads. Each
+ * shard is processed entirely by a single thread, such that the frames of an
+ * event collection are processed in the same order as they appear in the
+ * trace file. Returns 0 on success, otherwise 1. */
+static int am_dsk_load_shards(struct am_io_context* ctx,
+			      struct am_dsk_frame_shard_array* shards,
+			      unsigned int num_threads)
+{
+	struct am_dsk_shard_load_data d;
+	struct am_dsk_shard_worker* failed = NULL;
+	struct am_dsk_shard_worker* w;
+	unsigned int num_init = 0;
+	int ret = 1;
+
+	if(!(d.workers = calloc(num_threads, sizeof(*d.workers)))) {
+		AM_IOERR_GOTO_NA(ctx, out, AM_IOERR_ALLOC,
+				 "Could not allocate worker data.");
+	}
+
+	d.shards = shards;
+
+	for(; num_init < num_threads; num_init++) {
+		w = &d.workers[num_init];
+		w->ctx = *ctx;
+		w->ctx.bounds.start = AM_TIMESTAMP_T_MAX;
+		w->ctx.bounds.end = 0;
+		w->failed_shard = SIZE_MAX;
+		am_io_array_cache_reset(&w->ctx.array_cache);
+
+		if(am_io_error_stack_definit(&w->ctx.error_stack)) {
+			AM_IOERR_GOTO_NA(ctx, out_destroy, AM_IOERR_INIT,
+					 "Could not initialize error stack.");
+		}
+	}
+
+	if(am_parallel_for(shards->num_elements, num_threads,
+			   am_dsk_load_shard, &d))
+	{
+		/* Report the error for the shard with the lowest index, such
+		 * that the error does not depend on scheduling */
+		for(unsigned int i = 0; i < num_threads; i++) {
+			w = &d.workers[i];
+
+			if(w->failed_shard != SIZE_MAX &&
+			   (!failed || w->failed_shard < failed->failed_shard))
+			{
+				failed = w;
+			}
+		}
+
+		if(failed) {
+			am_io_error_stack_move(&ctx->error_stack,
+					       &failed->ctx.error_stack);
+		}
+
+		AM_IOERR_GOTO_NA(ctx, out_destroy, AM_IOERR_LOAD_FRAME,
+				 "Could not load frames of event collection.");
+	}
+
+	for(unsigned int i = 0; i < num_threads; i++) {
+		w = &d.workers[i];
+
+		if(w->ctx.bounds.start < ctx->bounds.start)
+			ctx->bounds.start = w->ctx.bounds.start;
+
+		if(w->ctx.bounds.end > ctx->bounds.end)
+			ctx->bounds.end = w->ctx.bounds.end;
+	}
+
+	ret = 0;
+
+out_destroy:
+	for(unsigned int i = 0; i < num_init; i++)
+		am_io_error_stack_destroy(&d.workers[i].ctx.error_stack);
+
+	free(d.workers);
+out:
+	return ret;
+}
+
+/* Reads and processes all frames of a memory-mapped trace file using
+ * num_threads threads. Frames are scanned sequentially and all frames that do
+ * not belong to a specific event collection (e.g., descriptions, hierarchies,
+ * frame type IDs) are processed immediately. Frames of per-event-collection
+ * types are only decoded in order to determine their event collection and
+ * their size and are then loaded in parallel, with event collections
+ * distributed among the threads. Returns 0 on success, otherwise 1. */
+static int am_dsk_read_frames_sharded(struct am_io_context* ctx,
+				      unsigned int num_threads)
+{
+	struct am_dsk_frame_shard_array shards;
+	struct am_dsk_frame_shard* shard;
+	struct am_dsk_frame_ref ref;
+	struct am_frame_type* ft;
+	uint32_t collection_id;
+	size_t frame_size = 0;
+	size_t offset;
+	void* frame = NULL;
+	int ret = 1;
+	int rt;
+
+	am_dsk_frame_shard_array_init(&shards);
+
+	while(!am_io_context_eof(ctx)) {
+		if((rt = am_dsk_read_frame_type(ctx, &ft))) {
+			if(rt == 2)
+				break;
+			else
+				goto out;
+		}
+
+		if(!ft->per_event_collection || !ft->load || !ft->read) {
+			if(am_dsk_load_frame(ctx, ft))
+				goto out;
+
+			continue;
+		}
+
+		offset = ctx->map_pos;
+
+		if(am_dsk_read_frame_collection_id(ctx, ft, &frame, &frame_size,
+						   &collection_id))
+		{
+			goto out;
+		}
+
+		if(!am_io_context_load_frame_type(ctx, ft))
+			continue;
+
+		/* Frames for undefined event collections are processed right
+		 * away in order to report the same error as for sequential
+		 * loading */
+		if(!am_event_collection_array_find(&ctx->trace->event_collections,
+						   collection_id))
+		{
+			ctx->map_pos = offset;
+
+			if(am_dsk_load_frame(ctx, ft))
+				goto out;
+
+			continue;
+		}
+
+		if(!(shard = am_dsk_frame_shard_array_find_or_add(
+			     &shards, collection_id)))
+		{
+			AM_IOERR_GOTO_NA(ctx, out, AM_IOERR_ALLOC,
+					 "Could not allocate shard.");
+		}
+
+		ref.offset = offset;
+		ref.ft = ft;
+
+		if(am_dsk_frame_ref_array_appendp(&shard->frames, &ref)) {
+			AM_IOERR_GOTO_NA(ctx, out, AM_IOERR_ALLOC,
+					 "Could not add frame reference.");
+		}
+	}
+
+	if(shards.num_elements > 0) {
+		if(am_dsk_load_shards(ctx, &shards, num_threads))
+			goto out;
+	}
+
+	ret = 0;
+
+out:
+	free(frame);
+	am_dsk_frame_shard_array_destroy(&shards);
+
+	return ret;
+}
+
+/* Reads and processes all frames of a trace file. The file pointer of the I/O
+ * context must be positioned at the beginning of the first frame to read (i.e.,
+ * the file header must have been skipped). If the trace file is mapped into
+ * memory and more than one thread may be used, the frames of the different
+ * event collections are loaded in parallel. Returns 0 on success, otherwise 1.
+ */
+static int am_dsk_read_frames(struct am_io_context* ctx)
+{
+	unsigned int num_threads = ctx->num_threads;
+
+	if(num_threads == 0)
+		num_threads = am_parallel_num_cpus();
+
+	if(am_io_context_is_mapped(ctx) && num_threads > 1)
+		return am_dsk_read_frames_sharded(ctx, num_threads);
+	else
+		return am_dsk_read_frames_sequential(ctx);
+}
+
 static int am_dsk_header_verify(struct am_io_context* ctx)
 {
 	struct am_dsk_header h;
@@ -612,6 +1388,47 @@ int am_dsk_teardown(struct am_io_context* ctx)
 	return 0;
 }
 
+/* Sets the load filter of the I/O context to f. If f restricts the frame
+ * types, an empty table of frame types to load is allocated, which is
+ * populated as frame type IDs are associated with frame types. Returns 0 on
+ * success, otherwise 1. */
+static int am_dsk_set_load_filter(struct am_io_context* ctx,
+				  const struct am_io_load_filter* f)
+{
+	for(size_t i = 1; i < f->num_collection_ids; i++) {
+		if(f->collection_ids[i-1] >= f->collection_ids[i]) {
+			AM_IOERR_RET1_NA(ctx, AM_IOERR_ASSERT,
+					 "Event collection IDs of load filter "
+					 "are not sorted.");
+		}
+	}
+
+	for(size_t i = 0; i < f->num_frame_types; i++) {
+		if(!am_frame_type_registry_find(ctx->frame_types,
+						f->frame_types[i]))
+		{
+			AM_IOERR_RET1(ctx, AM_IOERR_FIND_RELATED,
+				      "Could not find type \"%s\".",
+				      f->frame_types[i]);
+		}
+	}
+
+	if(f->num_frame_types > 0) {
+		if(!(ctx->load_frame_types =
+		     calloc(ctx->frame_types->max_types,
+			    sizeof(*ctx->load_frame_types))))
+		{
+			AM_IOERR_RET1_NA(ctx, AM_IOERR_ALLOC,
+					 "Could not allocate frame type "
+					 "table.");
+		}
+	}
+
+	ctx->load_filter = f;
+
+	return 0;
+}
+
 /* Loads a trace from disk into memory. A pointer to the newly allocated trace
  * data structure is stored in *pt. Ctx is a pointer to an already initialized
  * I/O context. If an error occurs, the error stack of the I/O context is set
@@ -619,6 +1436,21 @@ int am_dsk_teardown(struct am_io_context* ctx)
  * returning. Returns 0 on sucess, otherwise 1.
  */
 int am_dsk_load_trace(struct am_io_context* ctx, struct am_trace** pt)
+{
+	return am_dsk_load_trace_filtered(ctx, pt, NULL);
+}
+
+/* Loads a trace from disk into memory like am_dsk_load_trace, but only
+ * materializes the events matching the load filter f. Frame blocks whose
+ * interval or event collection does not match the filter are skipped without
+ * decoding their frames. The bounds of the loaded trace cover all events of
+ * the trace file, including the events that have been skipped, such that
+ * other parts of the trace can be loaded on demand. If f is NULL, all events
+ * are loaded. Returns 0 on success, otherwise 1.
+ */
+int am_dsk_load_trace_filtered(struct am_io_context* ctx,
+			       struct am_trace** pt,
+			       const struct am_io_load_filter* f)
 {
 	struct am_trace* t;
 
@@ -639,11 +1471,33 @@ int am_dsk_load_trace(struct am_io_context* ctx, struct am_trace** pt)
 				 "Invalid header.");
 	}
 
+	ctx->bounds.start = AM_TIMESTAMP_T_MAX;
+	ctx->bounds.end = 0;
+
+	if(f && am_dsk_set_load_filter(ctx, f)) {
+		AM_IOERR_GOTO_NA(ctx, out_err_trace_destroy, AM_IOERR_INIT,
+				 "Could not set load filter.");
+	}
+
 	if(am_dsk_read_frames(ctx)) {
-		AM_IOERR_GOTO_NA(ctx, out_err_trace_destroy, AM_IOERR_READ_FRAMES,
+		AM_IOERR_GOTO_NA(ctx, out_err_filter, AM_IOERR_READ_FRAMES,
 				 "Could not read frames.");
 	}
 
+	free(ctx->load_frame_types);
+	ctx->load_frame_types = NULL;
+	ctx->load_filter = NULL;
+
+	t->bounds = ctx->bounds;
+
+	/* Events of a collection written by multiple threads or by a converter
+	 * may be out of order */
+	if(am_trace_sort_event_arrays(t, 0, NULL)) {
+		AM_IOERR_GOTO_NA(ctx, out_err_trace_destroy,
+				 AM_IOERR_POSTPROCESS,
+				 "Could not sort event arrays.");
+	}
+
 	if(am_dsk_postprocess(ctx)) {
 		AM_IOERR_GOTO_NA(ctx, out_err_trace_destroy,
 				 AM_IOERR_POSTPROCESS, "Postprocessing failed.");
@@ -666,6 +1520,10 @@ int am_dsk_load_trace(struct am_io_context* ctx, struct am_trace** pt)
 
 	return 0;
 
+out_err_filter:
+	free(ctx->load_frame_types);
+	ctx->load_frame_types = NULL;
+	ctx->load_filter = NULL;
 out_err_trace_destroy:
 	am_trace_destroy(t);
 out_err_trace_free:
@@ -676,6 +1534,154 @@ out_err:
 	return 1;
 }
 
+/* Sets the current position of the I/O context to the offset off in the trace
+ * file. Returns 0 on success, otherwise 1. */
+static int am_dsk_seek(struct am_io_context* ctx, uint64_t off)
+{
+	if(am_io_context_is_mapped(ctx)) {
+		if(off > ctx->map_size)
+			return 1;
+
+		ctx->map_pos = off;
+
+		return 0;
+	}
+
+	if(off > INT64_MAX)
+		return 1;
+
+	return fseeko(ctx->fp, (off_t)off, SEEK_SET) != 0;
+}
+
+/* Returns the size in bytes of the trace file of the I/O context in *size.
+ * Returns 0 on success, otherwise 1. */
+static int am_dsk_file_size(struct am_io_context* ctx, uint64_t* size)
+{
+	off_t pos;
+	off_t end;
+
+	if(am_io_context_is_mapped(ctx)) {
+		*size = ctx->map_size;
+		return 0;
+	}
+
+	if((pos = ftello(ctx->fp)) < 0 ||
+	   fseeko(ctx->fp, 0, SEEK_END) ||
+	   (end = ftello(ctx->fp)) < 0 ||
+	   fseeko(ctx->fp, pos, SEEK_SET))
+	{
+		return 1;
+	}
+
+	*size = end;
+
+	return 0;
+}
+
+/* Reads the index of all frame blocks of a trace file from the end of the
+ * file. The frame type IDs of the trace must already have been associated
+ * with the frame types, i.e., the frames preceding the first frame block must
+ * have been read. On success, *entries points to a newly allocated array of
+ * *num_entries index entries, sorted by offset, and the position of the I/O
+ * context is left unchanged.
+ *
+ * Returns 0 on success, 1 on error and 2 if the trace file does not end with
+ * an index (e.g., because it does not contain any frame blocks or because the
+ * file cannot be accessed randomly).
+ */
+int am_dsk_read_frame_block_index(struct am_io_context* ctx,
+				  struct am_dsk_frame_block_index_entry** entries,
+				  size_t* num_entries)
+{
+	struct am_dsk_frame_block_index_entry* e = NULL;
+	struct am_dsk_frame_block_index idx;
+	struct am_frame_type* ft;
+	uint64_t file_size;
+	uint32_t type_id;
+	size_t type_id_size;
+	size_t num;
+	off_t pos;
+	int ret = 2;
+	int err;
+
+	if((pos = am_io_context_tell(ctx)) < 0 ||
+	   am_dsk_file_size(ctx, &file_size) ||
+	   file_size < AM_DSK_FRAME_BLOCK_INDEX_SIZE ||
+	   am_dsk_seek(ctx, file_size - AM_DSK_FRAME_BLOCK_INDEX_SIZE))
+	{
+		goto out;
+	}
+
+	/* The type ID is read without pushing an error, since the file might
+	 * just not end with an index */
+	if(am_io_context_is_mapped(ctx))
+		err = am_dsk_uint32_t_read_map(ctx, &type_id);
+	else
+		err = am_dsk_uint32_t_read_fp(ctx->fp, &type_id);
+
+	if(err ||
+	   am_safe_size_from_u32(&type_id_size, type_id) ||
+	   !(ft = am_frame_type_registry_by_id(ctx->frame_types,
+					       type_id_size)) ||
+	   strcmp(ft->name, "am_dsk_frame_block_index"))
+	{
+		goto out_seek;
+	}
+
+	ret = 1;
+
+	if(am_dsk_frame_block_index_read(ctx, &idx))
+		goto out_seek;
+
+	if(am_safe_size_from_u64(&num, idx.num_entries) ||
+	   idx.first_entry_offset > file_size)
+	{
+		AM_IOERR_GOTO_NA(ctx, out_seek, AM_IOERR_ASSERT,
+				 "Invalid frame block index.");
+	}
+
+	if(num > 0 && !(e = am_alloc_array_safe(num, sizeof(*e)))) {
+		AM_IOERR_GOTO_NA(ctx, out_seek, AM_IOERR_ALLOC,
+				 "Could not allocate frame block index.");
+	}
+
+	if(am_dsk_seek(ctx, idx.first_entry_offset)) {
+		AM_IOERR_GOTO_NA(ctx, out_free, AM_IOERR_READ,
+				 "Could not seek to frame block index.");
+	}
+
+	for(size_t i = 0; i < num; i++) {
+		if(am_dsk_read_frame_type(ctx, &ft))
+			goto out_free;
+
+		if(strcmp(ft->name, "am_dsk_frame_block_index_entry")) {
+			AM_IOERR_GOTO(ctx, out_free, AM_IOERR_ASSERT,
+				      "Unexpected frame of type \"%s\" in "
+				      "frame block index.", ft->name);
+		}
+
+		if(am_dsk_frame_block_index_entry_read(ctx, &e[i]))
+			goto out_free;
+	}
+
+	if(am_dsk_seek(ctx, pos)) {
+		AM_IOERR_GOTO_NA(ctx, out_free, AM_IOERR_READ,
+				 "Could not restore file position.");
+	}
+
+	*entries = e;
+	*num_entries = num;
+
+	return 0;
+
+out_free:
+	free(e);
+out_seek:
+	am_dsk_seek(ctx, pos);
+out:
+	return ret;
+}
+
 /* Registers all builtin frame types at the frame type registry r. Returns 0 on
  * success, otherwise 1. */
 int am_dsk_register_frame_types(struct am_frame_type_registry* r)
@@ -704,8 +1710,38 @@ int am_dsk_register_frame_types(struct am_frame_type_registry* r)
 	{
 		return 1;
 	}
+	{%- set ecoll_tag = t.getTagInheriting(aftermath.tags.dsk.tomem.GeneratePerEventCollectionArrayFunction) %}
+	{%- set ecoll_sub_tag = t.getTagInheriting(aftermath.tags.dsk.tomem.GeneratePerEventCollectionSubArrayFunction) %}
+	{%- if ecoll_tag or ecoll_sub_tag %}
+	{%- if ecoll_tag %}
+	{%- set ecoll_field = ecoll_tag.getEventCollectionDskIDField() %}
+	{%- else %}
+	{%- set ecoll_field = ecoll_sub_tag.getEventCollectionIDDskField() %}
+	{%- endif %}
+
+	if(!(ft = am_frame_type_registry_find(r, "{{t.getName()}}")))
+		return 1;
+
+	am_frame_type_set_per_event_collection(
+		ft, offsetof({{t.getCType()}}, {{ecoll_field.getName()}}));
+	{%- endif %}
 	{%- endfor %}
 
+	/* All frames of a block belong to the same event collection,
+	 * such that blocks can be loaded in parallel like any other frame of
+	 * an event collection */
+	if(!(ft = am_frame_type_registry_find(r, "am_dsk_compact_block")))
+		return 1;
+
+	am_frame_type_set_per_event_collection(
+		ft, offsetof(struct am_dsk_compact_block, collection_id));
+
+	if(!(ft = am_frame_type_registry_find(r, "am_dsk_frame_block")))
+		return 1;
+
+	am_frame_type_set_per_event_collection(
+		ft, offsetof(struct am_dsk_frame_block, collection_id));
+
 	if(!(ft = am_frame_type_registry_find(r, "am_dsk_frame_type_id")))
 		return 1;
 
@@ -754,12 +1790,12 @@ int am_dsk_dump_frames(struct am_io_context* ctx,
 	if(start_offs > 0 || end_offs != 0)
 		check_offsets = 1;
 
-	while(!feof(ctx->fp)) {
+	while(!am_io_context_eof(ctx)) {
 		if(check_offsets || dump_offsets)
-			frame_start_offs = ftello(ctx->fp);
+			frame_start_offs = am_io_context_tell(ctx);
 
 		if(am_dsk_uint32_t_read(ctx, &type_id)) {
-			if(feof(ctx->fp))
+			if(am_io_context_eof(ctx))
 				return 0;
 			else
 				return 1;
@@ -836,7 +1872,7 @@ int am_dsk_dump_frames(struct am_io_context* ctx,
 		}
 
 		if(check_offsets) {
-			frame_end_offs = ftello(ctx->fp);
+			frame_end_offs = am_io_context_tell(ctx);
 
 			/* Do not dump frames which occure before the start
 			 * offset */
@@ -917,7 +1953,7 @@ int am_dsk_dump_trace(struct am_io_context* ctx,
 		goto out_ctx;
 
 	/* Check if header needs to be dumped */
-	if(start_offs < ftello(ctx->fp)) {
+	if(start_offs < am_io_context_tell(ctx)) {
 		if(dump_offsets)
 			puts("# Offset: 0");
 
@@ -927,7 +1963,7 @@ int am_dsk_dump_trace(struct am_io_context* ctx,
 		header_dumped = 1;
 	}
 
-	if(end_offs == 0 || ftello(ctx->fp) <= end_offs) {
+	if(end_offs == 0 || am_io_context_tell(ctx) <= end_offs) {
 		if(header_dumped)
 			puts("\n");
 
@@ -46,14 +46,33 @@ static inline int am_dsk_float_read_fp(FILE* fp, float* out)
 	return 0;
 }
 
+/* Reads a float from the memory mapping of an I/O context without pushing an
+ * error onto the error stack. Returns 0 on success, otherwise 1. */
+static inline int am_dsk_float_read_map(struct am_io_context* ctx, float* out)
+{
+	if(am_io_context_map_read(ctx, out, sizeof(*out)))
+		return 1;
+
+	*out = am_float32_letoh(*out);
+
+	return 0;
+}
+
 static inline int am_dsk_float_read(struct am_io_context* ctx,
 				    float* out)
 {
-	if(am_dsk_float_read_fp(ctx->fp, out)) {
+	int ret;
+
+	if(am_io_context_is_mapped(ctx))
+		ret = am_dsk_float_read_map(ctx, out);
+	else
+		ret = am_dsk_float_read_fp(ctx->fp, out);
+
+	if(ret) {
 		am_io_error_stack_push(&ctx->error_stack,
 				       AM_IOERR_READ,
 				       "Could not read float at offset %jd.",
-				       ftello(ctx->fp));
+				       (intmax_t)am_io_context_tell(ctx));
 
 		return 1;
 	}
@@ -79,14 +98,33 @@ static inline int am_dsk_double_read_fp(FILE* fp, double* out)
 	return 0;
 }
 
+/* Reads a double from the memory mapping of an I/O context without pushing an
+ * error onto the error stack. Returns 0 on success, otherwise 1. */
+static inline int am_dsk_double_read_map(struct am_io_context* ctx, double* out)
+{
+	if(am_io_context_map_read(ctx, out, sizeof(*out)))
+		return 1;
+
+	*out = am_double64_letoh(*out);
+
+	return 0;
+}
+
 static inline int am_dsk_double_read(struct am_io_context* ctx,
 				     double* out)
 {
-	if(am_dsk_double_read_fp(ctx->fp, out)) {
+	int ret;
+
+	if(am_io_context_is_mapped(ctx))
+		ret = am_dsk_double_read_map(ctx, out);
+	else
+		ret = am_dsk_double_read_fp(ctx->fp, out);
+
+	if(ret) {
 		am_io_error_stack_push(&ctx->error_stack,
 				       AM_IOERR_READ,
 				       "Could not read double at offset %jd.",
-				       ftello(ctx->fp));
+				       (intmax_t)am_io_context_tell(ctx));
 
 		return 1;
 	}
@@ -116,15 +154,46 @@ static inline int am_dsk_double_read(struct am_io_context* ctx,
 		return 0;							\
 	}
 
+/* Declares a function am_dsk_<type>_read_map_noconv, which reads an integer
+ * from the memory mapping of an I/O context without byte order conversion and
+ * without pushing an error onto the error stack. */
+#define AM_DECL_ON_DISK_READ_INT_MAP_NOCONV_FUN(type)				\
+	static inline int							\
+	am_dsk_##type##_read_map_noconv(struct am_io_context* ctx, type* out)	\
+	{									\
+		return am_io_context_map_read(ctx, out, sizeof(*out));		\
+	}
+
+#define AM_DECL_ON_DISK_READ_INT_MAP_FUN(type, bits)				\
+	AM_DECL_ON_DISK_READ_INT_MAP_NOCONV_FUN(type)				\
+										\
+	static inline int							\
+	am_dsk_##type##_read_map(struct am_io_context* ctx, type* out)		\
+	{									\
+		if(am_dsk_##type##_read_map_noconv(ctx, out))			\
+			return 1;						\
+										\
+		*out = am_int##bits##_letoh(*out);				\
+										\
+		return 0;							\
+	}
+
 #define AM_DECL_ON_DISK_READ_INT_FUN(type, bits)				\
 	static inline int am_dsk_##type##_read(struct am_io_context* ctx,	\
 						   type* out)			\
 	{									\
-		if(am_dsk_##type##_read_fp(ctx->fp, out)) {			\
+		int ret;							\
+										\
+		if(am_io_context_is_mapped(ctx))				\
+			ret = am_dsk_##type##_read_map(ctx, out);		\
+		else								\
+			ret = am_dsk_##type##_read_fp(ctx->fp, out);		\
+										\
+		if(ret) {							\
 			am_io_error_stack_push(&ctx->error_stack,		\
 				AM_IOERR_READ,					\
 				 "Could not read " #type " at offset %jd.",	\
-				 ftello(ctx->fp));				\
+				 (intmax_t)am_io_context_tell(ctx));		\
 										\
 			return 1;						\
 		}								\
@@ -143,6 +212,17 @@ AM_DECL_ON_DISK_READ_INT_FP_FUN(uint32_t, 32)
 AM_DECL_ON_DISK_READ_INT_FP_FUN(int64_t, 64)
 AM_DECL_ON_DISK_READ_INT_FP_FUN(uint64_t, 64)
 
+AM_DECL_ON_DISK_READ_INT_MAP_NOCONV_FUN(int8_t)
+#define am_dsk_int8_t_read_map am_dsk_int8_t_read_map_noconv
+AM_DECL_ON_DISK_READ_INT_MAP_NOCONV_FUN(uint8_t)
+#define am_dsk_uint8_t_read_map am_dsk_uint8_t_read_map_noconv
+AM_DECL_ON_DISK_READ_INT_MAP_FUN(int16_t, 16)
+AM_DECL_ON_DISK_READ_INT_MAP_FUN(uint16_t, 16)
+AM_DECL_ON_DISK_READ_INT_MAP_FUN(int32_t, 32)
+AM_DECL_ON_DISK_READ_INT_MAP_FUN(uint32_t, 32)
+AM_DECL_ON_DISK_READ_INT_MAP_FUN(int64_t, 64)
+AM_DECL_ON_DISK_READ_INT_MAP_FUN(uint64_t, 64)
+
 AM_DECL_ON_DISK_READ_INT_FUN(int8_t, 8)
 AM_DECL_ON_DISK_READ_INT_FUN(uint8_t, 8)
 AM_DECL_ON_DISK_READ_INT_FUN(int16_t, 16)
@@ -270,6 +350,12 @@ AM_DECL_ON_DISK_WRITE_INT_FUN(uint64_t, 64)
 
 int am_dsk_register_frame_types(struct am_frame_type_registry* r);
 int am_dsk_load_trace(struct am_io_context* ctx, struct am_trace** pt);
+int am_dsk_load_trace_filtered(struct am_io_context* ctx,
+			       struct am_trace** pt,
+			       const struct am_io_load_filter* f);
+int am_dsk_read_frame_block_index(struct am_io_context* ctx,
+				  struct am_dsk_frame_block_index_entry** entries,
+				  size_t* num_entries);
 int am_dsk_dump_trace(struct am_io_context* ctx,
 		      const char* filename,
 		      off_t start_offs,
@@ -25,6 +25,8 @@
 /* Do not use system header-style include (i.e., <aftermath/core/...>, since
  * this file is shipped with other libraries */
 #include "on_disk_default_type_ids.h"
+#include <stddef.h>
+#include <stdint.h>
 
 {% set dsk_types = aftermath.config.getDskTypes() -%}
 
@@ -34,3 +36,140 @@ struct am_default_on_disk_type_ids am_default_on_disk_type_ids = {
 {# #}	.{{t.getName()}} = {{loop.index + 1}},
 {% endfor -%}
 };
+
+/* Returns the layout for the compact encoding of frames of the type with the
+ * default type ID id (see am_compact_block_encode()) or NULL if frames of the
+ * type cannot be encoded compactly. */
+const char* am_default_on_disk_type_compact_layout(uint32_t id)
+{
+{%- for t in dsk_types.filterByTag(aftermath.tags.dsk.Frame) %}
+{%- set layout = t.getTagInheriting(aftermath.tags.dsk.CompactLayout).getLayout() %}
+{%- if layout %}
+	if(id == am_default_on_disk_type_ids.{{t.getName()}})
+		return "{{layout}}";
+{# #}
+{%- endif %}
+{%- endfor %}
+	return NULL;
+}
+
+/* Reads an unsigned little-endian integer with w bytes from p */
+static inline uint64_t am_default_on_disk_type_load(const unsigned char* p,
+						    size_t w)
+{
+	uint64_t v = 0;
+
+	for(size_t i = 0; i < w; i++)
+		v |= ((uint64_t)p[i]) << (8 * i);
+
+	return v;
+}
+
+/* Advances *pos by num elements of element_size bytes each. Returns 0 on
+ * success or 1 if less than num * element_size bytes are left before avail. */
+static inline int am_default_on_disk_type_skip(size_t avail,
+					       size_t* pos,
+					       uint64_t num,
+					       size_t element_size)
+{
+	if(*pos > avail || num > (avail - *pos) / element_size)
+		return 1;
+
+	*pos += num * element_size;
+
+	return 0;
+}
+
+/* Determines the size of the frame in regular on-disk format starting at buf,
+ * including its type ID, assuming that the type of the frame is identified by
+ * its default type ID. Avail is the number of bytes available at buf. On
+ * success, the size is returned in *size.
+ *
+ * Returns 0 on success, 1 if the type ID is unknown and 2 if the frame is
+ * truncated.
+ */
+int am_default_on_disk_type_frame_size(const void* buf,
+				       size_t avail,
+				       size_t* size)
+{
+	const unsigned char* p = buf;
+	size_t pos = sizeof(uint32_t);
+	uint64_t num = 0;
+	uint32_t id;
+
+	if(avail < sizeof(uint32_t))
+		return 2;
+
+	id = am_default_on_disk_type_load(p, sizeof(uint32_t));
+{# #}
+{%- for t in dsk_types.filterByTag(aftermath.tags.dsk.Frame) %}
+	if(id == am_default_on_disk_type_ids.{{t.getName()}}) {
+{%- for (kind, step_size) in t.getTagInheriting(aftermath.tags.dsk.FrameSize).getSteps() %}
+{%- if kind == "fixed" %}
+		if(am_default_on_disk_type_skip(avail, &pos, 1,
+						 {{step_size}}))
+			return 2;
+{%- elif kind == "count" %}
+		if(am_default_on_disk_type_skip(avail, &pos, 1,
+						 {{step_size}}))
+			return 2;
+
+		num = am_default_on_disk_type_load(p + pos - {{step_size}},
+						   {{step_size}});
+{%- else %}
+		if(am_default_on_disk_type_skip(avail, &pos, num,
+						 {{step_size}}))
+			return 2;
+{%- endif %}
+{# #}
+{%- endfor %}
+		*size = pos;
+		return 0;
+	}
+{# #}
+{%- endfor %}
+	return 1;
+}
+
+/* Determines the ID of the event collection of the frame in regular on-disk
+ * format of size bytes starting at buf, assuming that the type of the frame is
+ * identified by its default type ID. On success, the ID is returned in
+ * *collection_id.
+ *
+ * Returns 0 on success or 1 if the frame does not belong to an event collection
+ * or if the size of the frame is insufficient.
+ */
+int am_default_on_disk_type_frame_collection_id(const void* buf,
+						size_t size,
+						uint32_t* collection_id)
+{
+	const unsigned char* p = buf;
+	size_t offset;
+	uint32_t id;
+
+	if(size < sizeof(uint32_t))
+		return 1;
+
+	id = am_default_on_disk_type_load(p, sizeof(uint32_t));
+{# #}
+{%- for t in dsk_types.filterByTag(aftermath.tags.dsk.Frame) %}
+{%- set offset = t.getTagInheriting(aftermath.tags.dsk.FrameSize).getCollectionIDOffset() %}
+{%- if offset %}
+	if(id == am_default_on_disk_type_ids.{{t.getName()}}) {
+		offset = sizeof(uint32_t) + {{offset}};
+		goto found;
+	}
+{# #}
+{%- endif %}
+{%- endfor %}
+	return 1;
+
+found:
+	if(size < offset || size - offset < sizeof(uint32_t))
+		return 1;
+
+	*collection_id = am_default_on_disk_type_load(p + offset,
+						      sizeof(uint32_t));
+
+	return 0;
+}
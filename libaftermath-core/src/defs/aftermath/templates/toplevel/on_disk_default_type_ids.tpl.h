@@ -26,6 +26,7 @@
 #define AM_ON_DISK_DEFAULT_TYPE_IDS_H
 
 #include <inttypes.h>
+#include <stddef.h>
 
 {% set dsk_types = aftermath.config.getDskTypes() -%}
 
@@ -40,4 +41,14 @@ struct am_default_on_disk_type_ids {
 
 extern struct am_default_on_disk_type_ids am_default_on_disk_type_ids;
 
+const char* am_default_on_disk_type_compact_layout(uint32_t id);
+
+int am_default_on_disk_type_frame_size(const void* buf,
+				       size_t avail,
+				       size_t* size);
+
+int am_default_on_disk_type_frame_collection_id(const void* buf,
+						size_t size,
+						uint32_t* collection_id);
+
 #endif
@@ -28,7 +28,22 @@
 #include <stdint.h>
 
 #define AM_TRACE_MAGIC 0x5654534f
-#define AM_TRACE_VERSION 18
+
+/* Version of the trace format that is written and oldest version that can
+ * still be read. Version 19 introduced compact blocks of frames (see
+ * am_dsk_compact_block). Version 20 replaced them with frame blocks, which
+ * carry their size and time range and which are located by a trailing index
+ * (see am_dsk_frame_block and am_dsk_frame_block_index). */
+#define AM_TRACE_VERSION 20
+#define AM_TRACE_MIN_VERSION 18
+
+/* The frames of a frame block are compactly encoded (see compact_block.h)
+ * rather than stored in their regular on-disk format */
+#define AM_DSK_FRAME_BLOCK_FLAG_COMPACT (1 << 0)
+
+/* Size in bytes of the trailing am_dsk_frame_block_index frame, including
+ * its type ID */
+#define AM_DSK_FRAME_BLOCK_INDEX_SIZE (sizeof(uint32_t) + 2 * sizeof(uint64_t))
 
 {% for t in aftermath.config.getDskTypes().filterByTag(aftermath.tags.Compound) -%}
 {{ aftermath.templates.StructDefinition(t) }}
@@ -97,6 +97,10 @@ class Type(object):
         """Returns the name without preceding "am_" (if present)"""
         return re.sub("^am_", "", self.__name)
 
+    def hasIdent(self):
+        """Returns True if an identifier string has been set for the type"""
+        return bool(self.__ident)
+
     def getIdent(self):
         if not self.__ident:
             raise Exception("Identifier string for type " + \
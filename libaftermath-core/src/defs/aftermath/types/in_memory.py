@@ -54,7 +54,11 @@ am_counter_event = InMemoryCompoundType(
     entity = "counter event",
     comment = "A counter event",
     ident = "am::core::counter_event",
-    tags = [ tags.mem.dfg.DeclareConstPointerType() ],
+    tags = [
+        tags.mem.dfg.DeclareConstPointerType(),
+        tags.mem.columns.GenerateColumns(
+            field_paths = [ "time", "value" ])
+    ],
 
     fields = FieldList([
         Field(
@@ -101,6 +105,29 @@ am_measurement_interval = InMemoryCompoundType(
 
 #################################################################################
 
+am_timestamp_calibration = InMemoryCompoundType(
+    name = "am_timestamp_calibration",
+    entity = "timestamp calibration",
+    comment = "Frequency and offset of the timestamp counter of a CPU",
+    ident = "am::core::timestamp_calibration",
+
+    fields = FieldList([
+        Field(
+            name = "cpu",
+            field_type = aftermath.types.builtin.uint32_t,
+            comment = "Number of the CPU"),
+        Field(
+            name = "ticks_per_second",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Frequency of the timestamp counter"),
+        Field(
+            name = "offset",
+            field_type = aftermath.types.builtin.int64_t,
+            comment = "Value by which the counter of the CPU is ahead " + \
+            "of the counter of the reference CPU")]))
+
+#################################################################################
+
 am_time_offset = InMemoryCompoundType(
     name = "am_time_offset",
     entity = "timestamp difference",
@@ -160,7 +187,9 @@ am_state_event = InMemoryCompoundType(
             stripname_plural = "state_events",
             port_name = "state events",
             include_file = "<aftermath/core/state_event_array.h>",
-            title_hrplural_cap = "State Events")
+            title_hrplural_cap = "State Events"),
+        tags.mem.columns.GenerateColumns(
+            field_paths = [ "interval.start", "interval.end", "state_idx" ])
     ],
 
     fields = FieldList([
@@ -208,6 +237,7 @@ am_source_location = InMemoryCompoundType(
 toplevel_types = TypeList([
     am_counter_event,
     am_measurement_interval,
+    am_timestamp_calibration,
     am_counter_description,
     am_state_description,
     am_state_event,
@@ -49,7 +49,9 @@ class Frame(OnDiskCompoundType):
             tags.dsk.GenerateWriteToBufferWithDefaultIDFunction(),
             tags.dsk.GenerateWriteDefaultIDToBufferFunction(),
             tags.dsk.GenerateWriteWithDefaultIDFunction(),
-            tags.dsk.GenerateWriteDefaultIDFunction())
+            tags.dsk.GenerateWriteDefaultIDFunction(),
+            tags.dsk.CompactLayout(),
+            tags.dsk.FrameSize())
 
         # A frame is always preceded by an integer indicating its type
         self.getTagInheriting(tags.dsk.WriteFunction).setTypeParam(True)
@@ -217,6 +219,32 @@ tags.dsk.tomem.add_per_trace_array_tags(
 
 #################################################################################
 
+am_dsk_timestamp_calibration = Frame(
+    name = "am_dsk_timestamp_calibration",
+    entity = "on-disk timestamp calibration",
+    comment = "Frequency of the timestamp counter and offset of the " + \
+              "counter of a CPU, measured when tracing starts",
+    fields = FieldList([
+        Field(
+            name = "cpu",
+            field_type = aftermath.types.builtin.uint32_t,
+            comment = "Number of the CPU"),
+        Field(
+            name = "ticks_per_second",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Frequency of the timestamp counter"),
+        Field(
+            name = "offset",
+            field_type = aftermath.types.builtin.int64_t,
+            comment = "Value by which the counter of the CPU is ahead " + \
+            "of the counter of the reference CPU")]))
+
+tags.dsk.tomem.add_per_trace_array_tags(
+    am_dsk_timestamp_calibration,
+    aftermath.types.in_memory.am_timestamp_calibration)
+
+#################################################################################
+
 am_dsk_hierarchy_node = Frame(
     name = "am_dsk_hierarchy_node",
     entity = "on-disk hierarchy node",
@@ -402,6 +430,166 @@ am_dsk_hierarchy_description.addTag(tags.process.ProcessFunction())
 
 ################################################################################
 
+am_dsk_compact_block = EventFrame(
+    name = "am_dsk_compact_block",
+    entity = "on-disk compact block",
+    comment = "Header of a block of compactly encoded frames of an event " + \
+              "collection; the encoded frames immediately follow the " + \
+              "header (trace format version 19, superseded by " + \
+              "am_dsk_frame_block)",
+    fields = FieldList([
+        Field(
+            name = "flags",
+            field_type = aftermath.types.builtin.uint32_t,
+            comment = "Flags for the encoding of the block (reserved, " + \
+            "must be 0)"),
+        Field(
+            name = "num_frames",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Number of frames encoded in the block"),
+        Field(
+            name = "raw_size",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Size in bytes of the frames of the block in the " + \
+            "regular on-disk format"),
+        Field(
+            name = "size",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Size in bytes of the encoded frames following " + \
+            "the header")]))
+
+# The encoded frames are not part of the header and are handled by hand-written
+# read and load functions
+am_dsk_compact_block.removeTags(
+    tags.dsk.GenerateReadFunction,
+    tags.dsk.GenerateLoadFunction)
+
+am_dsk_compact_block.addTags(
+    tags.dsk.ReadFunction(),
+    tags.dsk.LoadFunction())
+
+################################################################################
+
+am_dsk_compact_block_index_entry = EventFrame(
+    name = "am_dsk_compact_block_index_entry",
+    entity = "on-disk compact block index entry",
+    comment = "Entry of the index of all compact blocks of a trace file",
+    fields = FieldList([
+        Field(
+            name = "offset",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Offset of the compact block in the trace file"),
+        Field(
+            name = "num_frames",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Number of frames encoded in the block")]))
+
+################################################################################
+
+am_dsk_compact_block_index = Frame(
+    name = "am_dsk_compact_block_index",
+    entity = "on-disk compact block index",
+    comment = "Last frame of a trace file with compact blocks, locating " + \
+              "the index entries for the blocks",
+    fields = FieldList([
+        Field(
+            name = "first_entry_offset",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Offset of the first index entry in the trace file"),
+        Field(
+            name = "num_entries",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Number of index entries")]))
+
+################################################################################
+
+am_dsk_frame_block = EventFrame(
+    name = "am_dsk_frame_block",
+    entity = "on-disk frame block",
+    comment = "Header of a block of frames of an event collection; the " + \
+              "frames immediately follow the header, either in their " + \
+              "regular on-disk format or compactly encoded. All frames " + \
+              "of the block must belong to the event collection",
+    fields = FieldList([
+        Field(
+            name = "flags",
+            field_type = aftermath.types.builtin.uint32_t,
+            comment = "Flags for the encoding of the block (see " + \
+            "AM_DSK_FRAME_BLOCK_FLAG_*)"),
+        Field(
+            name = "num_frames",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Number of frames in the block"),
+        Field(
+            name = "raw_size",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Size in bytes of the frames of the block in the " + \
+            "regular on-disk format"),
+        Field(
+            name = "size",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Size in bytes of the frames following the header"),
+        Field(
+            name = "interval",
+            field_type = am_dsk_interval,
+            comment = "Interval covering all timestamps of the frames " + \
+            "of the block; [0, UINT64_MAX] if unknown")]))
+
+# The frames of the block are not part of the header and are handled by
+# hand-written read and load functions
+am_dsk_frame_block.removeTags(
+    tags.dsk.GenerateReadFunction,
+    tags.dsk.GenerateLoadFunction)
+
+am_dsk_frame_block.addTags(
+    tags.dsk.ReadFunction(),
+    tags.dsk.LoadFunction())
+
+################################################################################
+
+am_dsk_frame_block_index_entry = EventFrame(
+    name = "am_dsk_frame_block_index_entry",
+    entity = "on-disk frame block index entry",
+    comment = "Entry of the index of all frame blocks of a trace file",
+    fields = FieldList([
+        Field(
+            name = "offset",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Offset of the frame block in the trace file"),
+        Field(
+            name = "size",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Total size in bytes of the frame block, including " + \
+            "its type ID and its header"),
+        Field(
+            name = "num_frames",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Number of frames in the block"),
+        Field(
+            name = "interval",
+            field_type = am_dsk_interval,
+            comment = "Interval covering all timestamps of the frames " + \
+            "of the block")]))
+
+################################################################################
+
+am_dsk_frame_block_index = Frame(
+    name = "am_dsk_frame_block_index",
+    entity = "on-disk frame block index",
+    comment = "Last frame of a trace file with frame blocks, locating " + \
+              "the index entries for the blocks",
+    fields = FieldList([
+        Field(
+            name = "first_entry_offset",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Offset of the first index entry in the trace file"),
+        Field(
+            name = "num_entries",
+            field_type = aftermath.types.builtin.uint64_t,
+            comment = "Number of index entries")]))
+
+################################################################################
+
 all_types = TypeList([
     am_dsk_interval,
     am_dsk_string,
@@ -409,6 +597,7 @@ all_types = TypeList([
     am_dsk_header,
     am_dsk_counter_event,
     am_dsk_measurement_interval,
+    am_dsk_timestamp_calibration,
     am_dsk_hierarchy_node,
     am_dsk_frame_type_id,
     am_dsk_event_collection,
@@ -416,7 +605,13 @@ all_types = TypeList([
     am_dsk_state_event,
     am_dsk_counter_description,
     am_dsk_event_mapping,
-    am_dsk_hierarchy_description
+    am_dsk_hierarchy_description,
+    am_dsk_compact_block,
+    am_dsk_compact_block_index_entry,
+    am_dsk_compact_block_index,
+    am_dsk_frame_block,
+    am_dsk_frame_block_index_entry,
+    am_dsk_frame_block_index
 ])
 
 aftermath.config.addDskTypes(*all_types)
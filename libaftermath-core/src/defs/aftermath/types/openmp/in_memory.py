@@ -89,6 +89,10 @@ am_openmp_iteration_period = InMemoryCompoundType(
     entity = "OpenMP iteration execution period",
     comment = "An OpenMP iteration execution period",
     ident = "am::openmp::iteration_period",
+    tags = [
+        tags.mem.columns.GenerateColumns(
+            field_paths = [ "interval.start", "interval.end" ])
+    ],
 
         fields = FieldList([
             Field(
@@ -24,7 +24,7 @@
 #define AM_DFG_MINMAX_NODE_DECL(FUN, FUN_CAP, TPREFIX, TPREFIX_CAP)		\
 	int am_dfg_##TPREFIX##_##FUN##_node_process(struct am_dfg_node* n);	\
 										\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_##TPREFIX##_##FUN##_node_type,				\
 		"am::core::statistics::" #TPREFIX "::" #FUN,			\
 		#TPREFIX_CAP " " #FUN_CAP,					\
@@ -38,7 +38,8 @@
 			{ "out", "am::core::" #TPREFIX, AM_DFG_PORT_OUT },	\
 		),								\
 		AM_DFG_PORT_DEPS(),						\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_MINMAX_NODE_DECL(max, Maximum,  uint8,  Uint8)
 AM_DFG_MINMAX_NODE_DECL(max, Maximum, uint16, Uint16)
@@ -69,7 +70,7 @@ AM_DFG_MINMAX_NODE_DECL(min, Minimum, int64, Int64)
 #define AM_DFG_AVG_NODE_DECL(TPREFIX, TPREFIX_CAP)				\
 	int am_dfg_##TPREFIX##_avg_node_process(struct am_dfg_node* n);	\
 										\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_##TPREFIX##_avg_node_type,				\
 		"am::core::statistics::" #TPREFIX "::average",			\
 		#TPREFIX_CAP " Average",					\
@@ -83,7 +84,8 @@ AM_DFG_MINMAX_NODE_DECL(min, Minimum, int64, Int64)
 			{ "out", "am::core::" #TPREFIX, AM_DFG_PORT_OUT },	\
 		),								\
 		AM_DFG_PORT_DEPS(),						\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_AVG_NODE_DECL( int8,  Int8)
 AM_DFG_AVG_NODE_DECL(int16, Int16)
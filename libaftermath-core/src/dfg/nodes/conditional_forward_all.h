@@ -23,7 +23,7 @@
 
 int am_dfg_conditional_forward_all_node_process(struct am_dfg_node* n);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_conditional_forward_all_node_type,
 	"am::core::filter::conditional_forward::all",
 	"Conditional Forward (all)",
@@ -42,7 +42,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "control", "am::core::bool", AM_DFG_PORT_IN },
 		{ "out", "am::core::any", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_conditional_forward_all_node_type)
 
@@ -45,7 +45,7 @@ int am_dfg_double_constant_node_to_object_notation(
 	struct am_dfg_node* n,
 	struct am_object_notation_node_group* g);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_double_constant_node_type,
 	"am::core::double_constant",
 	"Double Constant",
@@ -64,7 +64,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 	AM_DFG_NODE_PROPERTIES(
 		{ "value", "Value", "am::core::double" },
 		{ "num_samples", "Num samples", "am::core::uint64" },
-	)
+	),
+	AM_DFG_NODE_TYPE_MEMOIZABLE
 )
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_double_constant_node_type)
@@ -50,7 +50,7 @@ int am_dfg_double_to_string_node_to_object_notation(
 /**
  * Node that converts doubles into their string representations
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_double_to_string_node_type,
 	"am::core::double::to_string",
 	"Double -> String",
@@ -74,7 +74,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "pretty_print", "Pretty print", "am::core::bool" },
 		{ "max_significant_digits",
 		  "Significant digits",
-		  "am::core::uint8" } ))
+		  "am::core::uint8" } ),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_double_to_string_node_type)
 
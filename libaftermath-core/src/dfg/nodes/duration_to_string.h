@@ -26,7 +26,7 @@ int am_dfg_duration_to_string_node_process(struct am_dfg_node* n);
 /**
  * Node that converts durations into their string representations
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_duration_to_string_node_type,
 	"am::core::duration::to_string",
 	"Duration -> String",
@@ -41,7 +41,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "out", "am::core::string",
 				AM_DFG_PORT_OUT | AM_DFG_PORT_MANDATORY }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_duration_to_string_node_type)
 
@@ -20,6 +20,7 @@
 #define AM_DFG_NODE_EVENT_MAPPING_COMMON_H
 
 #include <aftermath/core/dfg_node.h>
+#include <aftermath/core/dfg/types/event_range.h>
 #include <aftermath/core/event_collection.h>
 #include <aftermath/core/event_mapping.h>
 #include <aftermath/core/interval.h>
@@ -28,12 +29,23 @@
 /* Declares a node "am::core::event_mapping_<NAMES>" that takes a vector of
  * event mappings and a vector of intervals as an input and that returns all
  * events of DFG type IDENT of that mapping whose interval overlaps with at
- * least one of the input intervals. */
+ * least one of the input intervals.
+ *
+ * Also declares a node "am::core::event_mapping_<NAMES>_ranges" with the same
+ * semantics, but which returns the events as ranges of contiguous events
+ * referencing the event arrays of the trace directly instead of a pointer for
+ * each event and a node "am::core::event_range<IDENT>::expand" converting such
+ * ranges into pointers to the individual events for nodes that are not aware
+ * of ranges. */
 #define AM_DFG_DECL_EVENT_MAPPING_EXTRACT_OVERLAPPING_INTERVAL_NODE(		\
 	NAMES, PORT_NAME, HRNAMES, IDENT)					\
 	int am_dfg_event_mapping_##NAMES##_node_process(struct am_dfg_node* n); \
+	int am_dfg_event_mapping_##NAMES##_ranges_node_process(		\
+		struct am_dfg_node* n);					\
+	int am_dfg_event_range_##NAMES##_expand_node_process(			\
+		struct am_dfg_node* n);					\
 										\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_event_mapping_##NAMES##_node_type,			\
 		"am::core::event_mapping_" #NAMES,				\
 		"Event Mapping: " HRNAMES,					\
@@ -48,13 +60,90 @@
 			{ "intervals", "am::core::interval", AM_DFG_PORT_IN },	\
 			{ PORT_NAME, "const " IDENT "*", AM_DFG_PORT_OUT }),	\
 		AM_DFG_PORT_DEPS(),						\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)					\
+										\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
+		am_dfg_event_mapping_##NAMES##_ranges_node_type,		\
+		"am::core::event_mapping_" #NAMES "_ranges",			\
+		"Event Mapping: " HRNAMES " (Ranges)",			\
+		sizeof(struct am_dfg_node),					\
+		AM_DFG_DEFAULT_PORT_DEPS_PURE_FUNCTIONAL,			\
+		AM_DFG_NODE_FUNCTIONS({					\
+			.process = am_dfg_event_mapping_##NAMES##_ranges_node_process \
+		}),								\
+		AM_DFG_NODE_PORTS(						\
+			{ "event mapping", "const am::core::event_mapping*",	\
+					AM_DFG_PORT_IN },			\
+			{ "intervals", "am::core::interval", AM_DFG_PORT_IN },	\
+			{ PORT_NAME, "am::core::event_range<" IDENT ">",	\
+					AM_DFG_PORT_OUT }),			\
+		AM_DFG_PORT_DEPS(),						\
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)					\
+										\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
+		am_dfg_event_range_##NAMES##_expand_node_type,		\
+		"am::core::event_range<" IDENT ">::expand",			\
+		"Expand Ranges: " HRNAMES,					\
+		sizeof(struct am_dfg_node),					\
+		AM_DFG_DEFAULT_PORT_DEPS_PURE_FUNCTIONAL,			\
+		AM_DFG_NODE_FUNCTIONS({					\
+			.process = am_dfg_event_range_##NAMES##_expand_node_process \
+		}),								\
+		AM_DFG_NODE_PORTS(						\
+			{ "ranges", "am::core::event_range<" IDENT ">",	\
+					AM_DFG_PORT_IN },			\
+			{ PORT_NAME, "const " IDENT "*", AM_DFG_PORT_OUT }),	\
+		AM_DFG_PORT_DEPS(),						\
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
-/* Implements the processing function for a node declared with
+/* Implements the processing functions for the nodes declared with
  * AM_DFG_DECL_EVENT_MAPPING_EXTRACT_OVERLAPPING_INTERVAL_NODE. */
 #define AM_DFG_IMPL_EVENT_MAPPING_EXTRACT_OVERLAPPING_INTERVAL_NODE(		\
 	NAMES, TEVENT, TEVENT_ARRAY, IDENT)					\
-	int am_dfg_event_mapping_##NAMES##_node_process(struct am_dfg_node* n)	\
+	/* Writes pointers to the nevents events starting at estart to the	\
+	 * output port pout. Returns 0 on success, otherwise 1. */		\
+	static int am_dfg_event_mapping_##NAMES##_emit_pointers(		\
+		struct am_dfg_port* pout,					\
+		struct TEVENT* estart,						\
+		size_t nevents)						\
+	{									\
+		struct TEVENT** events_out;					\
+										\
+		if(!(events_out = am_dfg_buffer_reserve(pout->buffer, nevents))) \
+			return 1;						\
+										\
+		for(size_t i = 0; i < nevents; i++)				\
+			events_out[i] = estart+i;				\
+										\
+		return 0;							\
+	}									\
+										\
+	/* Writes a single range for the nevents events starting at estart to \
+	 * the output port pout. Returns 0 on success, otherwise 1. */	\
+	static int am_dfg_event_mapping_##NAMES##_emit_range(			\
+		struct am_dfg_port* pout,					\
+		struct TEVENT* estart,						\
+		size_t nevents)						\
+	{									\
+		struct am_dfg_event_range r = {				\
+			.first = estart,					\
+			.num_events = nevents					\
+		};								\
+										\
+		return am_dfg_buffer_write(pout->buffer, 1, &r);		\
+	}									\
+										\
+	/* Common processing function for the pointer and range variant of	\
+	 * the node. For each contiguous sequence of events that needs to be	\
+	 * output, emit is invoked with the output port, the address of the	\
+	 * first event and the number of events. Returns 0 on success,	\
+	 * otherwise 1. */						\
+	static int am_dfg_event_mapping_##NAMES##_extract(			\
+		struct am_dfg_node* n,						\
+		int (*emit)(struct am_dfg_port*, struct TEVENT*, size_t))	\
 	{									\
 		struct am_dfg_port* pmappings = &n->ports[0];			\
 		struct am_dfg_port* pintervals = &n->ports[1];			\
@@ -72,7 +161,6 @@
 		const struct am_interval* filter_interval;			\
 		struct TEVENT* estart;						\
 		struct TEVENT* eend;						\
-		struct TEVENT** events_out;					\
 		size_t nfilter_intervals = 0;					\
 		int ret = 1;							\
 		size_t nevents;						\
@@ -125,6 +213,9 @@
 						continue;			\
 					}					\
 										\
+					if(arr->num_elements == 0)		\
+						continue;			\
+										\
 					if(!sorted_intervals) {		\
 						estart = arr->elements;	\
 						eend = &arr->elements[arr->num_elements-1]; \
@@ -144,15 +235,8 @@
 					if(am_size_inc_safe(&nevents, 1))	\
 						goto out_free;			\
 										\
-					if(!(events_out = am_dfg_buffer_reserve( \
-						   pevents->buffer,		\
-						   nevents)))			\
-					{					\
+					if(emit(pevents, estart, nevents))	\
 						goto out_free;			\
-					}					\
-										\
-					for(size_t i = 0; i < nevents; i++)	\
-						events_out[i] = estart+i;	\
 				}						\
 			}							\
 		}								\
@@ -164,6 +248,55 @@
 	out:									\
 		return ret;							\
 	}									\
-
+										\
+	int am_dfg_event_mapping_##NAMES##_node_process(struct am_dfg_node* n)	\
+	{									\
+		return am_dfg_event_mapping_##NAMES##_extract(			\
+			n, am_dfg_event_mapping_##NAMES##_emit_pointers);	\
+	}									\
+										\
+	int am_dfg_event_mapping_##NAMES##_ranges_node_process(		\
+		struct am_dfg_node* n)						\
+	{									\
+		return am_dfg_event_mapping_##NAMES##_extract(			\
+			n, am_dfg_event_mapping_##NAMES##_emit_range);		\
+	}									\
+										\
+	int am_dfg_event_range_##NAMES##_expand_node_process(			\
+		struct am_dfg_node* n)						\
+	{									\
+		struct am_dfg_port* pranges = &n->ports[0];			\
+		struct am_dfg_port* pevents = &n->ports[1];			\
+		const struct am_dfg_event_range* ranges;			\
+		const struct TEVENT* e;					\
+		const struct TEVENT** events_out;				\
+		size_t nranges;						\
+		size_t nevents;						\
+		size_t k = 0;							\
+										\
+		if(!am_dfg_port_is_connected(pranges) ||			\
+		   !am_dfg_port_is_connected(pevents))				\
+		{								\
+			return 0;						\
+		}								\
+										\
+		ranges = pranges->buffer->data;				\
+		nranges = pranges->buffer->num_samples;			\
+		nevents = am_dfg_event_ranges_num_events(ranges, nranges);	\
+										\
+		if(nevents == 0)						\
+			return 0;						\
+										\
+		if(!(events_out = am_dfg_buffer_reserve(pevents->buffer,	\
+							nevents)))		\
+		{								\
+			return 1;						\
+		}								\
+										\
+		am_dfg_event_ranges_for_each(struct TEVENT, ranges, nranges, e) \
+			events_out[k++] = e;					\
+										\
+		return 0;							\
+	}
 
 #endif
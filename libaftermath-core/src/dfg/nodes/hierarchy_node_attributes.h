@@ -24,7 +24,7 @@
 int am_dfg_hierarchy_node_attributes_node_process(struct am_dfg_node* n);
 
 /* Node extracting the attributes of hierarchy node structures */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_hierarchy_node_attributes_node_type,
 	"am::core::hierarchy_node::attributes",
 	"Hierarchy Node Attributes",
@@ -39,7 +39,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 				AM_DFG_PORT_OUT },
 		{ "name", "am::core::string", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_hierarchy_node_attributes_node_type)
 
@@ -50,7 +50,7 @@ int am_dfg_hierarchy_node_selector_node_to_object_notation(
 
 /* Node selecting hierarchy nodes from a set of hierarchies whose name matches a
  * name provided as a property */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_hierarchy_node_selector_node_type,
 	"am::core::hierarchy_node_selector",
 	"Hierarchy Node Selector",
@@ -72,7 +72,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "nodes", "const am::core::hierarchy_node*", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
 	AM_DFG_NODE_PROPERTIES(
-		{ "name", "Name", "am::core::string" }))
+		{ "name", "Name", "am::core::string" }),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_hierarchy_node_selector_node_type)
 
@@ -51,7 +51,7 @@ int am_dfg_hierarchy_selector_node_to_object_notation(
 /* A node that selects all hierarchies from a set of traces whose name matches
  * a name provided as a property
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_hierarchy_selector_node_type,
 	"am::core::hierarchy_selector",
 	"Hierarchy Selector",
@@ -73,7 +73,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "hierarchies", "const am::core::hierarchy*", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
 	AM_DFG_NODE_PROPERTIES(
-		{ "name", "Name", "am::core::string" }))
+		{ "name", "Name", "am::core::string" }),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_hierarchy_selector_node_type)
 
@@ -28,7 +28,7 @@
 	/**									\
 	 * Node that extracts the attributes of a histogram			\
 	 */									\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_histogram_##TPREFIX##_attributes_node_type,		\
 		"am::core::histogram1d<" #TPREFIX ">::attributes",		\
 		"Histogram Attributes <" #TPREFIX ">",				\
@@ -46,7 +46,8 @@
 			{ "right", "am::core::" #TPREFIX, AM_DFG_PORT_OUT },	\
 			{ "num_bins", "am::core::uint64", AM_DFG_PORT_OUT }),	\
 		AM_DFG_PORT_DEPS(),						\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_DECL_HISTOGRAM_ATTRIBUTES_NODE( int8)
 AM_DFG_DECL_HISTOGRAM_ATTRIBUTES_NODE(int16)
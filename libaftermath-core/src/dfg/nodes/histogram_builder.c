@@ -64,18 +64,9 @@
 										\
 		/* Scan for minimum and maximum value */			\
 		if(hb->auto_min_max) {						\
-			for(size_t i = 0; i < pin->buffer->num_samples; i++) {	\
-				if(samples_uint[i] > max)			\
-					max = samples_uint[i];			\
-										\
-				if(samples_uint[i] < min)			\
-					min = samples_uint[i];			\
-			}							\
-										\
-			if(pin->buffer->num_samples == 0) {			\
-				min = 0;					\
-				max = 0;					\
-			}							\
+			am_histogram1d_##TPREFIX##_find_min_max(		\
+				samples_uint, pin->buffer->num_samples,	\
+				&min, &max);					\
 		} else {							\
 			min = hb->min;						\
 			max = hb->max;						\
@@ -88,12 +79,11 @@
 			goto out_err_free;					\
 		}								\
 										\
-		for(size_t i = 0; i < pin->buffer->num_samples; i++)		\
-			if(am_histogram1d_##TPREFIX##_add_sample(		\
-				   h, samples_uint[i]))			\
-			{							\
-				goto out_err_destroy;				\
-			}							\
+		if(am_histogram1d_##TPREFIX##_add_samples(			\
+			   h, samples_uint, pin->buffer->num_samples))		\
+		{								\
+			goto out_err_destroy;					\
+		}								\
 										\
 		if(am_dfg_buffer_write(pout->buffer, 1, &h))			\
 			goto out_err_destroy;					\
@@ -276,18 +266,8 @@ int am_dfg_histogram_builder_double_node_process(
 
 	/* Scan for minimum and maximum value */
 	if(hb->auto_min_max) {
-		for(size_t i = 0; i < pin->buffer->num_samples; i++) {
-			if(samples[i] > max)
-				max = samples[i];
-
-			if(samples[i] < min)
-				min = samples[i];
-		}
-
-		if(pin->buffer->num_samples == 0) {
-			min = 0;
-			max = 0;
-		}
+		am_histogram1d_double_find_min_max(
+			samples, pin->buffer->num_samples, &min, &max);
 	} else {
 		min = hb->min;
 		max = hb->max;
@@ -300,12 +280,11 @@ int am_dfg_histogram_builder_double_node_process(
 		goto out_err_free;
 	}
 
-	for(size_t i = 0; i < pin->buffer->num_samples; i++)
-		if(am_histogram1d_double_add_sample(
-			   h, samples[i]))
-		{
-			goto out_err_destroy;
-		}
+	if(am_histogram1d_double_add_samples(
+		   h, samples, pin->buffer->num_samples))
+	{
+		goto out_err_destroy;
+	}
 
 	if(am_dfg_buffer_write(pout->buffer, 1, &h))
 		goto out_err_destroy;
@@ -58,7 +58,7 @@
 	/**									\
 	 * Node that creates a ##TPREFIX histogram from a series of ##TPREFIX \
 	 * values */								\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_histogram_builder_##TPREFIX##_node_type,		\
 		"am::core::statistics::histogram_builder<" #TPREFIX ">",	\
 		"Histogram builder <" #TPREFIX ">",				\
@@ -85,7 +85,8 @@
 				"am::core::bool" },				\
 			{ "min", "Minimum", "am::core::" #TPREFIX },		\
 			{ "max", "Maximum", "am::core::" #TPREFIX }		\
-		))
+		),								\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_HISTOGRAM_BUILDER_DECL_INT( int8_t,  int8)
 AM_DFG_HISTOGRAM_BUILDER_DECL_INT(int16_t, int16)
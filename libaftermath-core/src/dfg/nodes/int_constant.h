@@ -46,7 +46,7 @@
 		struct am_dfg_node* n,						\
 		struct am_object_notation_node_group* g);			\
 										\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_##TPREFIX##_constant_node_type,				\
 		"am::core::" #TPREFIX "_constant",				\
 		#TPREFIX_CAP " Constant",					\
@@ -65,7 +65,8 @@
 		AM_DFG_NODE_PROPERTIES(					\
 			{ "value", "Value", "am::core::" #TPREFIX },		\
 			{ "num_samples", "Num samples", "am::core::uint64" },	\
-		)								\
+		),								\
+		AM_DFG_NODE_TYPE_MEMOIZABLE					\
 	)
 
 AM_DFG_INT_CONSTANT_NODE_DECL(uint8,  Uint8)
@@ -24,7 +24,7 @@
 #define AM_DECL_INT_TO_STRING_NODE_TYPE(SUFFIX, SUFFIX_CAP)			\
 	int am_dfg_##SUFFIX##_to_string_node_process(struct am_dfg_node* n);	\
 										\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_##SUFFIX##_to_string_node_type,				\
 		"am::core::" #SUFFIX "::to_string",				\
 		#SUFFIX_CAP " -> String",					\
@@ -37,7 +37,8 @@
 			{ "in", "am::core::" #SUFFIX, AM_DFG_PORT_IN },	\
 			{ "out", "am::core::string", AM_DFG_PORT_OUT }),	\
 		AM_DFG_PORT_DEPS(),						\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DECL_INT_TO_STRING_NODE_TYPE(uint8,  Uint8)
 AM_DECL_INT_TO_STRING_NODE_TYPE(uint16, Uint16)
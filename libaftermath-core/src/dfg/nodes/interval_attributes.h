@@ -27,7 +27,7 @@ int am_dfg_interval_attributes_node_process(struct am_dfg_node* n);
  * Node that extracts the attributes (start, end) of a duration and makes them
  * available at two separate output ports.
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_interval_attributes_node_type,
 	"am::core::interval::attributes",
 	"Interval Attributes",
@@ -42,7 +42,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "start", "am::core::timestamp", AM_DFG_PORT_OUT },
 		{ "end", "am::core::timestamp", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_interval_attributes_node_type)
 
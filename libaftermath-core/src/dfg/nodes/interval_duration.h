@@ -26,7 +26,7 @@ int am_dfg_interval_duration_node_process(struct am_dfg_node* n);
 /**
  * Node that calculates the durations of intervals.
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_interval_duration_node_type,
 	"am::core::interval::duration",
 	"Interval Duration",
@@ -40,7 +40,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 				AM_DFG_PORT_IN | AM_DFG_PORT_MANDATORY },
 		{ "duration", "am::core::duration", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_interval_duration_node_type)
 
@@ -23,7 +23,7 @@
 
 int am_dfg_folding_and_node_process(struct am_dfg_node* n);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_folding_and_node_type,
 	"am::core::logic::and::folding",
 	"Logical and (folding)",
@@ -36,11 +36,12 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "am::core::bool", AM_DFG_PORT_IN },
 		{ "out", "am::core::bool", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 int am_dfg_folding_or_node_process(struct am_dfg_node* n);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_folding_or_node_type,
 	"am::core::logic::or::folding",
 	"Logical or (folding)",
@@ -53,11 +54,12 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "am::core::bool", AM_DFG_PORT_IN },
 		{ "out", "am::core::bool", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 int am_dfg_pairwise_and_node_process(struct am_dfg_node* n);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_pairwise_and_node_type,
 	"am::core::logic::and::pairwise",
 	"Logical and (pairwise)",
@@ -71,11 +73,12 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "b", "am::core::bool", AM_DFG_PORT_IN },
 		{ "out", "am::core::bool", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 int am_dfg_pairwise_or_node_process(struct am_dfg_node* n);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_pairwise_or_node_type,
 	"am::core::logic::or::pairwise",
 	"Logical or (pairwise)",
@@ -89,7 +92,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "b", "am::core::bool", AM_DFG_PORT_IN },
 		{ "out", "am::core::bool", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(
 	&am_dfg_folding_and_node_type,
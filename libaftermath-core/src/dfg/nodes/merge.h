@@ -45,7 +45,7 @@ int am_dfg_merge_node_pre_connect(
  */
 
 #define AM_DECL_MERGE_NODE_TYPE(N, ...)				\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(					\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(				\
 		am_dfg_merge##N##_node_type,				\
 		"am::core::merge" #N,					\
 		"Merge " #N " Inputs",					\
@@ -62,7 +62,8 @@ int am_dfg_merge_node_pre_connect(
 			__VA_ARGS__,					\
 			{ "out", "am::core::any", AM_DFG_PORT_OUT }), \
 		AM_DFG_PORT_DEPS(),					\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),				\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 
 AM_DECL_MERGE_NODE_TYPE(
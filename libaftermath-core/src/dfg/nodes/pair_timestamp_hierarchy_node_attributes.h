@@ -27,7 +27,7 @@ int am_dfg_pair_timestamp_hierarchy_attributes_node_process(struct am_dfg_node*
  * Node that extracts the attributes of a pair composed of a timestamp and a
  * hierarchy node and makes them available at two separate output ports.
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_pair_timestamp_hierarchy_attributes_node_type,
 	"am::core::pair<am::core::timestamp,const_am::core::hierarchy_node>::attributes",
 	"Pair<Timestamp,Hierarchy Node> Attributes",
@@ -41,7 +41,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "timestamp", "am::core::timestamp", AM_DFG_PORT_OUT },
 		{ "hierarchy node", "const am::core::hierarchy_node*", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_pair_timestamp_hierarchy_attributes_node_type)
 
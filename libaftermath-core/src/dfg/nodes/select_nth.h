@@ -64,7 +64,7 @@ int am_dfg_select_nth_node_get_property(
  * Node that selects the N-th sample from an input port. If N is negative, the
  * selected index is relative to the last index.
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_select_nth_node_type,
 	"am::core::select_nth",
 	"Select N-th",
@@ -87,7 +87,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 	AM_DFG_PORT_DEPS(),
 	AM_DFG_NODE_PROPERTIES(
 		{ "N", "N", "am::core::int64" },
-		{ "fail_if_no_input", "Fail if no input", "am::core::bool" }))
+		{ "fail_if_no_input", "Fail if no input", "am::core::bool" }),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_select_nth_node_type)
 
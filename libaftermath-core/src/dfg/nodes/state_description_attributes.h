@@ -24,7 +24,7 @@
 int am_dfg_state_description_attributes_node_process(struct am_dfg_node* n);
 
 /* Node extracting individual fields from astream of state descriptions */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_state_description_attributes_node_type,
 	"am::core::state_description::attributes",
 	"State Description Attributes",
@@ -37,7 +37,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "const am::core::state_description*", AM_DFG_PORT_IN },
 		{ "name", "am::core::string", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_state_description_attributes_node_type)
 
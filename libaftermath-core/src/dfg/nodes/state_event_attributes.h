@@ -25,7 +25,7 @@ int am_dfg_state_event_attributes_node_process(struct am_dfg_node* n);
 
 /* Node extracting individual fields of state events from a stream of state
  * events */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_state_event_attributes_node_type,
 	"am::core::state_event::attributes",
 	"State Event Attributes",
@@ -39,7 +39,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "interval", "am::core::interval", AM_DFG_PORT_OUT },
 		{ "state index", "am::core::uint64", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_state_event_attributes_node_type)
 
@@ -0,0 +1,85 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "state_event_range_attributes.h"
+#include <aftermath/core/dfg/types/event_range.h>
+#include <aftermath/core/in_memory.h>
+#include <aftermath/core/interval.h>
+
+int am_dfg_state_event_range_attributes_node_process(struct am_dfg_node* n)
+{
+	struct am_dfg_port* pin = &n->ports[0];
+	struct am_dfg_port* pinterval = &n->ports[1];
+	struct am_dfg_port* pindex = &n->ports[2];
+	struct am_dfg_port* pduration = &n->ports[3];
+	const struct am_dfg_event_range* ranges;
+	const struct am_state_event* e;
+	struct am_interval* intervals;
+	struct am_time_offset* durations;
+	uint64_t* indexes;
+	size_t nranges;
+	size_t nin;
+	size_t i;
+
+	if(!am_dfg_port_is_connected(pin))
+		return 0;
+
+	ranges = pin->buffer->data;
+	nranges = pin->buffer->num_samples;
+
+	if((nin = am_dfg_event_ranges_num_events(ranges, nranges)) == 0)
+		return 0;
+
+	if(am_dfg_port_is_connected(pinterval)) {
+		if(!(intervals = am_dfg_buffer_reserve(pinterval->buffer, nin)))
+			return 1;
+
+		i = 0;
+		am_dfg_event_ranges_for_each(struct am_state_event,
+					     ranges, nranges, e)
+		{
+			intervals[i++] = e->interval;
+		}
+	}
+
+	if(am_dfg_port_is_connected(pindex)) {
+		if(!(indexes = am_dfg_buffer_reserve(pindex->buffer, nin)))
+			return 1;
+
+		i = 0;
+		am_dfg_event_ranges_for_each(struct am_state_event,
+					     ranges, nranges, e)
+		{
+			indexes[i++] = e->state_idx;
+		}
+	}
+
+	if(am_dfg_port_is_connected(pduration)) {
+		if(!(durations = am_dfg_buffer_reserve(pduration->buffer, nin)))
+			return 1;
+
+		i = 0;
+		am_dfg_event_ranges_for_each(struct am_state_event,
+					     ranges, nranges, e)
+		{
+			am_interval_duration(&e->interval, &durations[i++]);
+		}
+	}
+
+	return 0;
+}
@@ -53,7 +53,7 @@ int am_dfg_string_concat_node_to_object_notation(
 /**
  * Node that converts timestamps into their string representations
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_string_concat_node_type,
 	"am::core::string_concat",
 	"String Concatenator",
@@ -75,7 +75,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 				AM_DFG_PORT_OUT | AM_DFG_PORT_MANDATORY }),
 	AM_DFG_PORT_DEPS(),
 	AM_DFG_NODE_PROPERTIES(
-		{ "separator", "Separator", "am::core::string" }))
+		{ "separator", "Separator", "am::core::string" }),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_string_concat_node_type)
 
@@ -46,7 +46,7 @@ int am_dfg_string_constant_node_to_object_notation(
 	struct am_dfg_node* n,
 	struct am_object_notation_node_group* g);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_string_constant_node_type,
 	"am::core::string_constant",
 	"String Constant",
@@ -66,7 +66,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 	AM_DFG_NODE_PROPERTIES(
 		{ "value", "Value", "am::core::string" },
 		{ "num_samples", "Num samples", "am::core::uint64" },
-	)
+	),
+	AM_DFG_NODE_TYPE_MEMOIZABLE
 )
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_string_constant_node_type)
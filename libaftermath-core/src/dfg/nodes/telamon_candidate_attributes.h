@@ -24,7 +24,7 @@
 int am_dfg_telamon_candidate_attributes_node_process(struct am_dfg_node* n);
 
 /* Node extracting the attributes of hierarchy structures */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_telamon_candidate_attributes_node_type,
 	"am::telamon::candidate::attributes",
 	"Telamon Candidate Attributes",
@@ -43,7 +43,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "perfmodel_bound", "am::core::double", AM_DFG_PORT_OUT },
 		{ "perfmodel_bound_valid", "am::core::bool", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_telamon_candidate_attributes_node_type)
 
@@ -24,7 +24,7 @@
 int am_dfg_telamon_candidate_tree_roots_node_process(struct am_dfg_node* n);
 
 /* Node extracting all roots of telamon candidate trees of a trace */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_telamon_candidate_tree_roots_node_type,
 	"am::telamon::candidate_tree::roots",
 	"Telamon Candidate Tree Roots",
@@ -37,7 +37,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "const am::core::trace*", AM_DFG_PORT_IN },
 		{ "roots", "const am::telamon::candidate*", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_telamon_candidate_tree_roots_node_type)
 
@@ -25,7 +25,7 @@
 	int am_dfg_telamon_candidate_type_filter_##FILTER_TYPE##_node_process(	\
 		struct am_dfg_node* n);					\
 										\
-	AM_DFG_DECL_BUILTIN_NODE_TYPE(						\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(					\
 		am_dfg_telamon_candidate_type_filter_##FILTER_TYPE##_node_type, \
 		"am::telamon::candidate::filter::" #FILTER_TYPE,		\
 		"Telamon " FILTER_TYPE_CAP,					\
@@ -51,7 +51,8 @@
 					AM_DFG_PORT_DEP_PUSH_NEW, "out"),	\
 			AM_DFG_PORT_DEP(AM_DFG_PORT_DEP_ON_NEW, "in",		\
 					AM_DFG_PORT_DEP_PULL_OLD, "time")),	\
-		AM_DFG_NODE_PROPERTIES())
+		AM_DFG_NODE_PROPERTIES(),					\
+		AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_TELAMON_CANDIDATE_TYPE_FILTER_NODE_DECL(unknown, "Yet Unknown Nodes")
 AM_DFG_TELAMON_CANDIDATE_TYPE_FILTER_NODE_DECL(any_internal, "Any Internal Node")
@@ -71,7 +72,7 @@ AM_DFG_TELAMON_CANDIDATE_TYPE_FILTER_NODE_DECL(implementation_deadend, "Implemen
 int am_dfg_telamon_candidate_type_filter_perfmodel_lowest_n_node_process(
 	struct am_dfg_node* n);
 
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_telamon_candidate_type_filter_perfmodel_lowest_n_node_type,
 	"am::telamon::candidate::filter::perfmodel_lowest_n",
 	"Telamon Performance Model Lowest N",
@@ -110,7 +111,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 				AM_DFG_PORT_DEP_PULL_OLD, "time"),
 		AM_DFG_PORT_DEP(AM_DFG_PORT_DEP_ON_NEW, "N",
 				AM_DFG_PORT_DEP_PULL_OLD, "in")),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(
 	&am_dfg_telamon_candidate_type_filter_unknown_node_type,
@@ -25,7 +25,7 @@ int am_dfg_tensorflow_node_attributes_node_process(struct am_dfg_node* n);
 
 /* Node extracting individual fields of TensorFlow node from a stream of
  * TensorFlow nodes */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_tensorflow_node_attributes_node_type,
 	"am::tensorflow::node::attributes",
 	"TensorFlow Node Attributes",
@@ -38,7 +38,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "const am::tensorflow::node*", AM_DFG_PORT_IN },
 		{ "name", "am::core::string", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_tensorflow_node_attributes_node_type)
 
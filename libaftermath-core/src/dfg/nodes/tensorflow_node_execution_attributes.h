@@ -25,7 +25,7 @@ int am_dfg_tensorflow_node_execution_attributes_node_process(struct am_dfg_node*
 
 /* Node extracting individual fields of TensorFlow node executions from a stream
  * of TensorFlow node executions */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_tensorflow_node_execution_attributes_node_type,
 	"am::tensorflow::node_execution::attributes",
 	"TensorFlow Node Execution Attributes",
@@ -39,7 +39,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "interval", "am::core::interval", AM_DFG_PORT_OUT },
 		{ "node", "const am::tensorflow::node*", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_tensorflow_node_execution_attributes_node_type)
 
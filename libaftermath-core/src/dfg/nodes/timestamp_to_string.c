@@ -18,6 +18,9 @@
 
 #include "timestamp_to_string.h"
 #include <aftermath/core/base_types.h>
+#include <aftermath/core/timestamp_calibration_array.h>
+#include <aftermath/core/trace.h>
+#include <inttypes.h>
 
 #if AM_TIMESTAMP_T_BITS != 64 || AM_TIMESTAMP_T_SIGNED != 0
 #error "Assuming am_timestamp_t to be an unsigned 64 bit value, but it isn't"
@@ -33,30 +36,181 @@ int am_dfg_timestamp_to_string_node_init(struct am_dfg_node* n)
 	return 0;
 }
 
+/* Returns the frequency of the timestamp counter recorded in the last trace
+ * available on the port ptrace or 0 if no trace is available or if the trace
+ * does not contain any timestamp calibration. */
+static uint64_t
+am_dfg_timestamp_to_string_node_ticks_per_second(struct am_dfg_port* ptrace)
+{
+	struct am_timestamp_calibration_array* tca;
+	struct am_trace** traces;
+	struct am_trace* t;
+
+	if(!am_dfg_port_activated_and_has_data(ptrace))
+		return 0;
+
+	traces = ptrace->buffer->data;
+	t = traces[ptrace->buffer->num_samples-1];
+
+	if(!(tca = am_trace_find_trace_array(
+		     t, "am::core::timestamp_calibration")) ||
+	   tca->num_elements == 0)
+	{
+		return 0;
+	}
+
+	return tca->elements[0].ticks_per_second;
+}
+
+/* Converts a number of timestamp counter ticks into nanoseconds for a counter
+ * running at ticks_per_second. */
+static inline uint64_t am_dfg_timestamp_to_string_ticks_to_ns(
+	am_timestamp_t ticks,
+	uint64_t ticks_per_second)
+{
+	/* Split into whole seconds and the remainder to avoid overflows */
+	return (ticks / ticks_per_second) * 1000000000 +
+		((ticks % ticks_per_second) * 1000000000) / ticks_per_second;
+}
+
+/* Returns the number of decimal digits of v (at least 1) */
+static inline size_t am_dfg_timestamp_to_string_num_digits(uint64_t v)
+{
+	size_t n = 1;
+
+	while(v >= 10) {
+		v /= 10;
+		n++;
+	}
+
+	return n;
+}
+
+/* Formats a duration of ns nanoseconds as seconds. If pretty printing, the
+ * value is scaled to s, ms, us or ns and printed with at most max_sigd
+ * significant digits. As for am_siformat_u64(), remaining digits are
+ * truncated, trailing zeros after the decimal dot are omitted and digits
+ * before the decimal dot are never omitted. Otherwise, the full value is
+ * printed in seconds with nanosecond precision. Returns 0 if the entire
+ * formatted string fitted into buf and 1 if characters were omitted. */
+static int am_dfg_timestamp_to_string_format_ns(uint64_t ns,
+						int pretty_print,
+						size_t max_sigd,
+						char* buf,
+						size_t max_len)
+{
+	static const struct {
+		uint64_t div;
+		size_t frac_digits;
+		const char* unit;
+	} units[] = {
+		{ 1000000000, 9, "s" },
+		{ 1000000, 6, "ms" },
+		{ 1000, 3, "us" },
+		{ 1, 0, "ns" }
+	};
+	uint64_t int_part;
+	uint64_t frac;
+	size_t int_digits;
+	size_t frac_digits = 0;
+	size_t i;
+	int ret;
+
+	if(!pretty_print) {
+		ret = snprintf(buf, max_len, "%" PRIu64 ".%09" PRIu64 "s",
+			       ns / 1000000000, ns % 1000000000);
+
+		return (ret < 0 || (size_t)ret >= max_len);
+	}
+
+	for(i = 0; i < AM_ARRAY_SIZE(units) - 1; i++)
+		if(ns >= units[i].div)
+			break;
+
+	int_part = ns / units[i].div;
+	frac = ns % units[i].div;
+	int_digits = am_dfg_timestamp_to_string_num_digits(int_part);
+
+	/* Digits after the dot within the significant digits, truncated to
+	 * the precision of the unit */
+	if(max_sigd > int_digits) {
+		frac_digits = max_sigd - int_digits;
+
+		if(frac_digits > units[i].frac_digits)
+			frac_digits = units[i].frac_digits;
+	}
+
+	for(size_t j = frac_digits; j < units[i].frac_digits; j++)
+		frac /= 10;
+
+	/* Omit trailing zeros */
+	while(frac_digits > 0 && frac % 10 == 0) {
+		frac /= 10;
+		frac_digits--;
+	}
+
+	if(frac_digits > 0) {
+		ret = snprintf(buf, max_len, "%" PRIu64 ".%0*" PRIu64 "%s",
+			       int_part, (int)frac_digits, frac, units[i].unit);
+	} else {
+		ret = snprintf(buf, max_len, "%" PRIu64 "%s",
+			       int_part, units[i].unit);
+	}
+
+	return (ret < 0 || (size_t)ret >= max_len);
+}
+
+/* Marks the string str of allocated size alloc_bytes as truncated by replacing
+ * its last character with a '+' or by appending a '+' if there is enough
+ * space. */
+static void am_dfg_timestamp_to_string_mark_truncated(char* str,
+						      size_t alloc_bytes)
+{
+	size_t gen_len = strlen(str);
+
+	if(gen_len < alloc_bytes-1) {
+		str[gen_len] = '+';
+		str[gen_len+1] = '\0';
+	} else {
+		if(gen_len > 0) {
+			str[gen_len-1] = '+';
+		} else if(alloc_bytes > 1) {
+			str[0] = '+';
+			str[1] = '\0';
+		}
+	}
+}
+
 int am_dfg_timestamp_to_string_node_process(struct am_dfg_node* n)
 {
 	struct am_dfg_timestamp_to_string_node* tts = (typeof(tts))n;
 	struct am_dfg_port* pin = &n->ports[0];
 	struct am_dfg_port* pout = &n->ports[1];
+	struct am_dfg_port* ptrace = &n->ports[2];
 	am_timestamp_t* timestamps;
 	size_t old_num_samples;
+	uint64_t ticks_per_second;
 	char* str;
 	size_t alloc_bytes;
-	size_t gen_len;
 
 	if(!am_dfg_port_is_connected(pin) || !am_dfg_port_is_connected(pout))
 		return 0;
 
 	old_num_samples = pout->buffer->num_samples;
 	timestamps = pin->buffer->data;
+	ticks_per_second = am_dfg_timestamp_to_string_node_ticks_per_second(ptrace);
 
 	if(tts->pretty_print) {
 		/* If pretty printing: at most the maximum number of digits
 		 * before the dot, then the dot, then the maximum number of
-		 * significant digits, the si prefix and the terminating '\0'
-		 * character. */
+		 * significant digits, the si prefix or a unit of at most two
+		 * characters and the terminating '\0' character. */
 		alloc_bytes = AM_TIMESTAMP_T_MAX_DECIMAL_DIGITS + 1 +
-			tts->max_significant_digits + 1 + 1;
+			tts->max_significant_digits + 2 + 1;
+	} else if(ticks_per_second) {
+		/* Seconds, the dot, nine digits for the nanoseconds, the unit
+		 * and the terminating '\0' character. */
+		alloc_bytes = AM_TIMESTAMP_T_MAX_DECIMAL_DIGITS + 1 + 9 + 1 + 1;
 	} else {
 		alloc_bytes = AM_TIMESTAMP_T_MAX_DECIMAL_DIGITS+1;
 	}
@@ -67,26 +221,27 @@ int am_dfg_timestamp_to_string_node_process(struct am_dfg_node* n)
 		if(!(str = malloc(alloc_bytes)))
 			goto out_err;
 
-		if(tts->pretty_print) {
+		if(ticks_per_second) {
+			if(am_dfg_timestamp_to_string_format_ns(
+				   am_dfg_timestamp_to_string_ticks_to_ns(
+					   timestamps[i], ticks_per_second),
+				   tts->pretty_print,
+				   tts->max_significant_digits,
+				   str,
+				   alloc_bytes))
+			{
+				am_dfg_timestamp_to_string_mark_truncated(
+					str, alloc_bytes);
+			}
+		} else if(tts->pretty_print) {
 			if(am_siformat_u64(timestamps[i],
 					   tts->max_significant_digits,
 					   str,
 					   alloc_bytes))
 			{
 				/* Characters were omitted, add final '+' */
-				gen_len = strlen(str);
-
-				if(gen_len < alloc_bytes-1) {
-					str[gen_len] = '+';
-					str[gen_len+1] = '\0';
-				} else {
-					if(gen_len > 0) {
-						str[gen_len-1] = '+';
-					} else if(alloc_bytes > 1) {
-						str[0] = '+';
-						str[1] = '\0';
-					}
-				}
+				am_dfg_timestamp_to_string_mark_truncated(
+					str, alloc_bytes);
 			}
 		} else {
 			snprintf(str, AM_TIMESTAMP_T_MAX_DECIMAL_DIGITS,
@@ -48,9 +48,11 @@ int am_dfg_timestamp_to_string_node_to_object_notation(
 	struct am_dfg_node* n, struct am_object_notation_node_group* g);
 
 /**
- * Node that converts timestamps into their string representations
+ * Node that converts timestamps into their string representations. If a trace
+ * with a timestamp calibration is connected to the trace port, timestamps are
+ * converted to seconds using the calibrated frequency.
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_timestamp_to_string_node_type,
 	"am::core::timestamp::to_string",
 	"Timestamp -> String",
@@ -68,13 +70,15 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "am::core::timestamp",
 				AM_DFG_PORT_IN | AM_DFG_PORT_MANDATORY },
 		{ "out", "am::core::string",
-				AM_DFG_PORT_OUT | AM_DFG_PORT_MANDATORY }),
+				AM_DFG_PORT_OUT | AM_DFG_PORT_MANDATORY },
+		{ "trace", "const am::core::trace*", AM_DFG_PORT_IN }),
 	AM_DFG_PORT_DEPS(),
 	AM_DFG_NODE_PROPERTIES(
 		{ "pretty_print", "Pretty print", "am::core::bool" },
 		{ "max_significant_digits",
 		  "Significant digits",
-		  "am::core::uint8" } ))
+		  "am::core::uint8" } ),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_timestamp_to_string_node_type)
 
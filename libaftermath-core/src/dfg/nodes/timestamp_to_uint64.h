@@ -30,7 +30,7 @@ int am_dfg_timestamp_to_uint64_node_process(struct am_dfg_node* n);
  * FIXME: Provide such functionality with cast operators rather than actual
  * nodes
  */
-AM_DFG_DECL_BUILTIN_NODE_TYPE(
+AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(
 	am_dfg_timestamp_to_uint64_node_type,
 	"am::core::timestamp::to_uint64",
 	"Timestamp -> Uint64",
@@ -43,7 +43,8 @@ AM_DFG_DECL_BUILTIN_NODE_TYPE(
 		{ "in", "am::core::timestamp", AM_DFG_PORT_IN },
 		{ "out", "am::core::uint64", AM_DFG_PORT_OUT }),
 	AM_DFG_PORT_DEPS(),
-	AM_DFG_NODE_PROPERTIES())
+	AM_DFG_NODE_PROPERTIES(),
+	AM_DFG_NODE_TYPE_MEMOIZABLE)
 
 AM_DFG_ADD_BUILTIN_NODE_TYPES(&am_dfg_timestamp_to_uint64_node_type)
 
@@ -23,6 +23,7 @@ int am_dfg_trace_node_init(struct am_dfg_node* n)
 	struct am_dfg_node_trace* t = (typeof(t))n;
 
 	t->trace = NULL;
+	t->last_trace = NULL;
 
 	return 0;
 }
@@ -32,5 +33,11 @@ int am_dfg_trace_node_process(struct am_dfg_node* n)
 	struct am_dfg_node_trace* t = (typeof(t))n;
 	struct am_dfg_port* ptrace = &n->ports[0];
 
+	/* Consumers must not reuse data derived from a previous trace */
+	if(t->trace != t->last_trace) {
+		am_dfg_output_port_inc_generation(ptrace);
+		t->last_trace = t->trace;
+	}
+
 	return am_dfg_buffer_write(ptrace->buffer, 1, &t->trace);
 }
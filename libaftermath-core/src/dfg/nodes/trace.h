@@ -25,11 +25,17 @@
 struct am_dfg_node_trace {
 	struct am_dfg_node n;
 	struct am_trace* trace;
+
+	/* Trace written to the output port by the last invocation */
+	struct am_trace* last_trace;
 };
 
 int am_dfg_trace_node_init(struct am_dfg_node* n);
 int am_dfg_trace_node_process(struct am_dfg_node* n);
 
+/* Not memoizable, since the trace provided by the node is set by the
+ * application and not derived from inputs or properties. The node announces a
+ * new trace to memoized consumers by itself. */
 AM_DFG_DECL_BUILTIN_NODE_TYPE(
 	am_dfg_trace_node_type,
 	"am::core::trace",
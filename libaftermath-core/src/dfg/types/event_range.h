@@ -0,0 +1,59 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+#ifndef AM_DFG_TYPE_EVENT_RANGE_H
+#define AM_DFG_TYPE_EVENT_RANGE_H
+
+#include <stddef.h>
+
+/* A range of contiguous events of the same type within an event array. The
+ * range references the events in-place, i.e., the events are not copied and
+ * the range remains valid as long as the trace containing the events is
+ * alive. The type of the events is given by the DFG type of the port the range
+ * is transmitted on (e.g., "am::core::event_range<am::core::state_event>"
+ * carries ranges of struct am_state_event). */
+struct am_dfg_event_range {
+	/* Address of the first event of the range */
+	const void* first;
+
+	/* Number of events in the range */
+	size_t num_events;
+};
+
+/* Returns the total number of events of all num_ranges ranges. */
+static inline size_t
+am_dfg_event_ranges_num_events(const struct am_dfg_event_range* ranges,
+			       size_t num_ranges)
+{
+	size_t ret = 0;
+
+	for(size_t i = 0; i < num_ranges; i++)
+		ret += ranges[i].num_events;
+
+	return ret;
+}
+
+/* Iterates over all events of type T of the num_ranges ranges starting at
+ * ranges. The variable pevent is set to the address of the current event. */
+#define am_dfg_event_ranges_for_each(T, ranges, num_ranges, pevent)		\
+	for(size_t __am_range_i = 0; __am_range_i < (num_ranges); __am_range_i++) \
+		for(pevent = (const T*)(ranges)[__am_range_i].first;		\
+		    pevent < ((const T*)(ranges)[__am_range_i].first) +	\
+			    (ranges)[__am_range_i].num_events;		\
+		    pevent++)
+
+#endif
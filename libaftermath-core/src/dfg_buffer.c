@@ -21,6 +21,106 @@
 #include <string.h>
 #include <stdint.h>
 
+/* Initializes an empty buffer pool */
+void am_dfg_buffer_pool_init(struct am_dfg_buffer_pool* p)
+{
+	pthread_mutex_init(&p->lock, NULL);
+	p->num_blocks = 0;
+}
+
+/* Frees all blocks of a buffer pool and destroys the pool */
+void am_dfg_buffer_pool_destroy(struct am_dfg_buffer_pool* p)
+{
+	for(size_t i = 0; i < p->num_blocks; i++)
+		free(p->blocks[i].data);
+
+	pthread_mutex_destroy(&p->lock);
+}
+
+/* Adds a block of size bytes to a buffer pool. If the pool is full, either the
+ * smallest block of the pool or the new block is freed, whichever is
+ * smaller. */
+static void am_dfg_buffer_pool_put(struct am_dfg_buffer_pool* p,
+				   void* data,
+				   size_t size)
+{
+	size_t pos;
+
+	pthread_mutex_lock(&p->lock);
+
+	if(p->num_blocks == AM_DFG_BUFFER_POOL_MAX_BLOCKS) {
+		if(p->blocks[0].size >= size) {
+			pthread_mutex_unlock(&p->lock);
+			free(data);
+			return;
+		}
+
+		free(p->blocks[0].data);
+		memmove(&p->blocks[0], &p->blocks[1],
+			(p->num_blocks - 1) * sizeof(p->blocks[0]));
+		p->num_blocks--;
+	}
+
+	for(pos = p->num_blocks; pos > 0; pos--) {
+		if(p->blocks[pos - 1].size <= size)
+			break;
+
+		p->blocks[pos] = p->blocks[pos - 1];
+	}
+
+	p->blocks[pos].data = data;
+	p->blocks[pos].size = size;
+	p->num_blocks++;
+
+	pthread_mutex_unlock(&p->lock);
+}
+
+/* Removes the smallest block with at least min_size bytes from a buffer pool
+ * and stores its size in *size. Blocks that are more than four times larger
+ * than requested are not handed out in order to prevent small buffers from
+ * holding large amounts of memory. Returns the block or NULL if no suitable
+ * block is available. */
+static void* am_dfg_buffer_pool_get(struct am_dfg_buffer_pool* p,
+				    size_t min_size,
+				    size_t* size)
+{
+	void* ret = NULL;
+
+	pthread_mutex_lock(&p->lock);
+
+	for(size_t i = 0; i < p->num_blocks; i++) {
+		if(p->blocks[i].size < min_size)
+			continue;
+
+		if(p->blocks[i].size / 4 > min_size)
+			break;
+
+		ret = p->blocks[i].data;
+		*size = p->blocks[i].size;
+
+		memmove(&p->blocks[i], &p->blocks[i + 1],
+			(p->num_blocks - i - 1) * sizeof(p->blocks[0]));
+		p->num_blocks--;
+		break;
+	}
+
+	pthread_mutex_unlock(&p->lock);
+
+	return ret;
+}
+
+/* Moves all blocks from the pool src to the pool dst. Blocks that do not fit
+ * into dst are freed. */
+void am_dfg_buffer_pool_move(struct am_dfg_buffer_pool* dst,
+			     struct am_dfg_buffer_pool* src)
+{
+	for(size_t i = 0; i < src->num_blocks; i++)
+		am_dfg_buffer_pool_put(dst, src->blocks[i].data,
+				       src->blocks[i].size);
+
+	src->num_blocks = 0;
+}
+
 /*
  * Initialize an empty buffer of type sample_type
  */
@@ -32,64 +132,145 @@ void am_dfg_buffer_init(struct am_dfg_buffer* b,
 	b->num_refs = 0;
 	b->max_samples = 0;
 	b->sample_type = sample_type;
+	b->pool = NULL;
 
 	INIT_LIST_HEAD(&b->list);
 }
 
+/* Associates a buffer with a buffer pool. Pool may be NULL, in which case
+ * storage is allocated and freed directly. */
+void am_dfg_buffer_set_pool(struct am_dfg_buffer* b,
+			    struct am_dfg_buffer_pool* pool)
+{
+	b->pool = pool;
+}
+
+/* Releases the storage of a buffer, either to its pool or by freeing it. The
+ * buffer must not contain any samples. */
+static void am_dfg_buffer_release_storage(struct am_dfg_buffer* b)
+{
+	if(b->data && b->pool) {
+		am_dfg_buffer_pool_put(b->pool, b->data,
+				       b->max_samples *
+				       b->sample_type->sample_size);
+	} else {
+		free(b->data);
+	}
+
+	b->data = NULL;
+	b->max_samples = 0;
+}
+
+/* Changes the capacity of a buffer to exactly new_max_samples samples, which
+ * must not be less than the current number of samples. If the buffer does not
+ * have any storage yet, storage is taken from the buffer's pool if
+ * possible, in which case the capacity might be slightly larger.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_dfg_buffer_set_capacity(struct am_dfg_buffer* b,
+				      size_t new_max_samples)
+{
+	size_t sample_size = b->sample_type->sample_size;
+	size_t num_bytes;
+	size_t block_size;
+	void* tmp;
+
+	if(new_max_samples == b->max_samples)
+		return 0;
+
+	/* Need to treat 0 samples separately, since realloc() used by
+	 * am_realloc_array_safe() might return a NULL pointer for zero-byte
+	 * allocations, which shouldn't be considered an error. */
+	if(new_max_samples == 0) {
+		am_dfg_buffer_release_storage(b);
+		return 0;
+	}
+
+	if(!b->data && b->pool && sample_size > 0) {
+		if(am_size_mul_safe(&num_bytes, new_max_samples, sample_size))
+			return 1;
+
+		if((tmp = am_dfg_buffer_pool_get(b->pool, num_bytes,
+						 &block_size)))
+		{
+			b->data = tmp;
+			b->max_samples = block_size / sample_size;
+			return 0;
+		}
+	}
+
+	if(!(tmp = am_realloc_array_safe(b->data, new_max_samples, sample_size)))
+		return 1;
+
+	b->data = tmp;
+	b->max_samples = new_max_samples;
+
+	return 0;
+}
+
 /* Resize a buffer such that a total of num_samples samples can be stored in
  * it. Does not invoke any constructor for samples that are allocated, but calls
- * the destructor for samples that are freed.
+ * the destructor for samples that are freed. The capacity of the buffer is
+ * not reduced, unless the buffer shrinks to zero samples, in which case its
+ * storage is returned to the buffer's pool. Use am_dfg_buffer_shrink_to_fit()
+ * to release unused storage of a non-empty buffer.
  *
  * Returns 0 on success, otherwise 1.
  */
 int am_dfg_buffer_resize(struct am_dfg_buffer* b, size_t new_num_samples)
 {
-	void* tmp;
 	void* destroy_start;
 	const struct am_dfg_type* t = b->sample_type;
 
 	/* If we're shrinking: invoke destructors for elements that will be
 	 * lost */
-	if(new_num_samples < b->num_samples && t->destroy_samples) {
-		if(!(destroy_start = am_array_element_ptr_safe(b->data,
-							       b->num_samples,
-							       t->sample_size)))
-		{
-			return 1;
-		}
-
-		t->destroy_samples(b->sample_type,
-				   b->num_samples - new_num_samples,
-				   destroy_start);
-
-		/* Already assign new number of samples to leave buffer in
-		 * correct state even if shrinking below fails */
-		b->num_samples = new_num_samples;
-	}
-
-	if(new_num_samples != b->max_samples) {
-		/* Need to treat 0 samples separately, since realloc() used by
-		 * am_realloc_array_safe() might return a NULL pointer for
-		 * zero-byte allocations, which shouldn't be considered an
-		 * error. */
-		if(new_num_samples != 0) {
-			if(!(tmp = am_realloc_array_safe(
+	if(new_num_samples < b->num_samples) {
+		if(t->destroy_samples) {
+			if(!(destroy_start = am_array_element_ptr_safe(
 				     b->data, new_num_samples,
-				     b->sample_type->sample_size)))
+				     t->sample_size)))
 			{
 				return 1;
 			}
 
-			b->data = tmp;
-		} else {
-			free(b->data);
-			b->data = NULL;
+			t->destroy_samples(b->sample_type,
+					   b->num_samples - new_num_samples,
+					   destroy_start);
 		}
 
-		b->max_samples = new_num_samples;
+		b->num_samples = new_num_samples;
 	}
 
-	return 0;
+	if(new_num_samples == 0) {
+		am_dfg_buffer_release_storage(b);
+		return 0;
+	}
+
+	return am_dfg_buffer_reserve_capacity(b, new_num_samples);
+}
+
+/* Makes sure that a buffer can hold at least num_samples samples without
+ * reallocation. The number of samples present in the buffer is not changed.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_dfg_buffer_reserve_capacity(struct am_dfg_buffer* b, size_t num_samples)
+{
+	if(num_samples <= b->max_samples)
+		return 0;
+
+	return am_dfg_buffer_set_capacity(b, num_samples);
+}
+
+/* Reduces the capacity of a buffer to the number of samples present in the
+ * buffer. The storage of an empty buffer is released entirely.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_dfg_buffer_shrink_to_fit(struct am_dfg_buffer* b)
+{
+	return am_dfg_buffer_set_capacity(b, b->num_samples);
 }
 
 /* Reserves space for num_samples samples and returns a pointer to the first of
@@ -99,6 +280,7 @@ int am_dfg_buffer_resize(struct am_dfg_buffer* b, size_t new_num_samples)
 void* am_dfg_buffer_reserve(struct am_dfg_buffer* b, size_t num_samples)
 {
 	size_t new_size;
+	size_t new_max;
 	size_t old_size = b->num_samples;
 	void* ret;
 
@@ -106,10 +288,21 @@ void* am_dfg_buffer_reserve(struct am_dfg_buffer* b, size_t num_samples)
 	if(am_size_add_safe(&new_size, b->num_samples, num_samples))
 		return NULL;
 
-	/* Resize necessary? */
-	if(new_size > b->max_samples)
-		if(am_dfg_buffer_resize(b, new_size))
+	/* Grow geometrically, such that appending samples one by one only
+	 * causes a logarithmic number of reallocations */
+	if(new_size > b->max_samples) {
+		if(am_size_mul_safe(&new_max, b->max_samples, 2))
+			new_max = new_size;
+
+		if(new_max < new_size)
+			new_max = new_size;
+
+		if(new_max < AM_DFG_BUFFER_MIN_GROW_SAMPLES)
+			new_max = AM_DFG_BUFFER_MIN_GROW_SAMPLES;
+
+		if(am_dfg_buffer_set_capacity(b, new_max))
 			return NULL;
+	}
 
 	ret = am_array_element_ptr_safe(b->data, old_size,
 					b->sample_type->sample_size);
@@ -281,7 +474,7 @@ void am_dfg_buffer_reset(struct am_dfg_buffer* b)
 void am_dfg_buffer_destroy(struct am_dfg_buffer* b)
 {
 	am_dfg_buffer_reset(b);
-	free(b->data);
+	am_dfg_buffer_release_storage(b);
 }
 
 /* Increase the number of references to the buffer by one */
@@ -305,10 +498,8 @@ void am_dfg_buffer_change_type(struct am_dfg_buffer* b,
 		return;
 
 	am_dfg_buffer_reset(b);
+	am_dfg_buffer_release_storage(b);
 
-	free(b->data);
-	b->data = NULL;
 	b->sample_type = sample_type;
-	b->max_samples = 0;
 }
 
@@ -20,6 +20,40 @@
 #define AM_DFG_BUFFER_H
 
 #include <aftermath/core/dfg_type.h>
+#include <pthread.h>
+
+/* Maximum number of free storage blocks kept by a buffer pool */
+#define AM_DFG_BUFFER_POOL_MAX_BLOCKS 32
+
+/* Minimum number of samples allocated when a buffer grows by appending
+ * samples */
+#define AM_DFG_BUFFER_MIN_GROW_SAMPLES 8
+
+struct am_dfg_buffer_pool_block {
+	void* data;
+
+	/* Size of the block in bytes */
+	size_t size;
+};
+
+/* Pool of storage released by buffers (e.g., when the sample type of a buffer
+ * changes, when a buffer is resized to zero samples or when a buffer is
+ * destroyed). Buffers associated with a pool take
+ * their initial storage from the pool if a suitable block is available. The
+ * pool may be accessed concurrently by buffers processed by different
+ * threads. */
+struct am_dfg_buffer_pool {
+	pthread_mutex_t lock;
+
+	/* Free blocks, sorted by increasing size */
+	struct am_dfg_buffer_pool_block blocks[AM_DFG_BUFFER_POOL_MAX_BLOCKS];
+	size_t num_blocks;
+};
+
+void am_dfg_buffer_pool_init(struct am_dfg_buffer_pool* p);
+void am_dfg_buffer_pool_destroy(struct am_dfg_buffer_pool* p);
+void am_dfg_buffer_pool_move(struct am_dfg_buffer_pool* dst,
+			     struct am_dfg_buffer_pool* src);
 
 /*
  * Buffer for data exchanges between nodes
@@ -43,6 +77,10 @@ struct am_dfg_buffer {
 
 	/* Number of references to this buffer */
 	int num_refs;
+
+	/* Pool from which storage is taken and to which storage is released;
+	 * NULL if storage is allocated and freed directly */
+	struct am_dfg_buffer_pool* pool;
 };
 
 void am_dfg_buffer_init(struct am_dfg_buffer* b,
@@ -53,8 +91,12 @@ void am_dfg_buffer_change_type(struct am_dfg_buffer* b,
 void am_dfg_buffer_destroy(struct am_dfg_buffer* b);
 void am_dfg_buffer_inc_ref(struct am_dfg_buffer* b);
 void am_dfg_buffer_dec_ref(struct am_dfg_buffer* b);
+void am_dfg_buffer_set_pool(struct am_dfg_buffer* b,
+			    struct am_dfg_buffer_pool* pool);
 
 int am_dfg_buffer_resize(struct am_dfg_buffer* b, size_t num_samples);
+int am_dfg_buffer_reserve_capacity(struct am_dfg_buffer* b, size_t num_samples);
+int am_dfg_buffer_shrink_to_fit(struct am_dfg_buffer* b);
 int am_dfg_buffer_write(struct am_dfg_buffer* b, size_t num_samples, void* data);
 void* am_dfg_buffer_reserve(struct am_dfg_buffer* b, size_t num_samples);
 int am_dfg_buffer_shrink(struct am_dfg_buffer* b, size_t num_samples);
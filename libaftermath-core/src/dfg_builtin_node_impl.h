@@ -31,7 +31,7 @@
 					     DEFAULT_PORTDEPS,		\
 					     FUNCTIONS, PORTS,		\
 					     EXPLICIT_PORT_DEPS,	\
-					     PROPERTIES)		\
+					     PROPERTIES, FLAGS)		\
 	static struct am_dfg_static_port_type_def ID##_ports[] = {	\
 		AM_MACRO_ARG_PROTECT PORTS				\
 	};								\
@@ -55,7 +55,8 @@
 		.num_properties = AM_ARRAY_SIZE(ID##_properties),	\
 		.properties = ID##_properties,				\
 		.num_port_deps = AM_ARRAY_SIZE(ID##_port_deps),	\
-		.port_deps = ID##_port_deps				\
+		.port_deps = ID##_port_deps,				\
+		.flags = FLAGS						\
 	};
 
 /* Generates a NULL-terminated list of static node type definitions for a header
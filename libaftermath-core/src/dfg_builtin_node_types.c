@@ -131,6 +131,10 @@
 #define DEFS_NAME() state_event_attributes_defs
 #include <aftermath/core/dfg/nodes/state_event_attributes.h>
 
+#undef DEFS_NAME
+#define DEFS_NAME() state_event_range_attributes_defs
+#include <aftermath/core/dfg/nodes/state_event_range_attributes.h>
+
 #undef DEFS_NAME
 #define DEFS_NAME() string_constant_defs
 #include <aftermath/core/dfg/nodes/string_constant.h>
@@ -209,6 +213,7 @@ static struct am_dfg_static_node_type_def** defsets[] = {
 	select_nth_defs,
 	state_description_attributes_defs,
 	state_event_attributes_defs,
+	state_event_range_attributes_defs,
 	string_concat_defs,
 	string_constant_defs,
 	string_format_defs,
@@ -225,9 +230,13 @@ static struct am_dfg_static_node_type_def** defsets[] = {
 };
 
 /* Register the builtin node types at the node type registry ntr using the type
- * registry tr. Returns 0 on success, otherwise 1. */
+ * registry tr. Since the builtin node types only operate on their ports and on
+ * read-only trace data, they are registered as thread-safe. Node types whose
+ * output only depends on their inputs and properties are declared as
+ * memoizable individually. Returns 0 on success, otherwise 1. */
 int am_dfg_builtin_node_types_register(struct am_dfg_node_type_registry* ntr,
 				       struct am_dfg_type_registry* tr)
 {
-	return am_dfg_node_type_registry_add_static(ntr, tr, defsets);
+	return am_dfg_node_type_registry_add_static_flags(
+		ntr, tr, defsets, AM_DFG_NODE_TYPE_THREAD_SAFE);
 }
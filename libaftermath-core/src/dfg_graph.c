@@ -23,17 +23,24 @@ void am_dfg_graph_init(struct am_dfg_graph* g, long flags)
 {
 	am_dfg_node_idtree_init(&g->id_tree);
 	INIT_LIST_HEAD(&g->buffers);
+	am_dfg_buffer_pool_init(&g->buffer_pool);
 
 	g->flags = flags;
 }
 
-/* Reset all buffers used by any node in the graph */
+/* Reset all buffers used by any node in the graph. Since the buffers do not
+ * contain any data produced by the nodes afterwards, memoized data of all nodes
+ * is invalidated. */
 void am_dfg_graph_reset_buffers(const struct am_dfg_graph* g)
 {
 	struct am_dfg_buffer* b;
+	struct am_dfg_node* n;
 
 	am_dfg_graph_for_each_buffer(g, b)
 		am_dfg_buffer_reset(b);
+
+	am_dfg_graph_for_each_node(g, n)
+		am_dfg_node_invalidate_memo(n);
 }
 
 /* Destroy a graph. According to the flags buffers and nodes are destroyed /
@@ -57,7 +64,13 @@ void am_dfg_graph_destroy(struct am_dfg_graph* g)
 			am_dfg_buffer_destroy(b);
 			free(b);
 		}
+	} else {
+		/* Buffers outlive the graph and its pool */
+		am_dfg_graph_for_each_buffer(g, b)
+			am_dfg_buffer_set_pool(b, NULL);
 	}
+
+	am_dfg_buffer_pool_destroy(&g->buffer_pool);
 }
 
 /* Add a node to the graph */
@@ -163,6 +176,7 @@ int am_dfg_graph_connectp(struct am_dfg_graph* g,
 			goto out_err_unc_src;
 
 		am_dfg_buffer_init(buffer, src_port->type->type);
+		am_dfg_buffer_set_pool(buffer, &g->buffer_pool);
 		am_dfg_graph_add_buffer(g, buffer);
 
 		dst_port->buffer = buffer;
@@ -426,6 +440,7 @@ int am_dfg_graph_merge(struct am_dfg_graph* dst, struct am_dfg_graph* g)
 	struct am_dfg_node* ndst_hid;
 	struct am_dfg_node* nsrc_lid;
 	struct am_dfg_node* n;
+	struct am_dfg_buffer* b;
 	long id = 0;
 
 	if(dst->flags != g->flags)
@@ -459,6 +474,10 @@ int am_dfg_graph_merge(struct am_dfg_graph* dst, struct am_dfg_graph* g)
 			return 1;
 	}
 
+	am_dfg_graph_for_each_buffer(g, b)
+		am_dfg_buffer_set_pool(b, &dst->buffer_pool);
+
+	am_dfg_buffer_pool_move(&dst->buffer_pool, &g->buffer_pool);
 	list_splice(&g->buffers, &dst->buffers);
 
 	return 0;
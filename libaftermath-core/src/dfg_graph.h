@@ -49,6 +49,9 @@ struct am_dfg_graph {
 	/* All buffers referenced by any node in the graph */
 	struct list_head buffers;
 
+	/* Pool recycling the storage released by the buffers of the graph */
+	struct am_dfg_buffer_pool buffer_pool;
+
 	long flags;
 };
 
@@ -121,6 +121,8 @@ int am_dfg_port_connect_onesided(struct am_dfg_port* p,
 	if(am_dfg_port_is_input_port(p))
 		p->generation = 0;
 
+	am_dfg_node_invalidate_memo(p->node);
+
 	return 0;
 }
 
@@ -135,6 +137,7 @@ int am_dfg_port_disconnect_onesided(struct am_dfg_port* p,
 	void* tmp;
 
 	am_dfg_buffer_dec_ref(p->buffer);
+	am_dfg_node_invalidate_memo(p->node);
 
 	for(size_t i = 0; i < p->num_connections; i++) {
 		if(p->connections[i] == other) {
@@ -267,6 +270,7 @@ int am_dfg_node_type_build_noinit(struct am_dfg_node_type* nt,
 	nt->instance_size = instance_size;
 	nt->num_ports = num_ports;
 	nt->num_properties = num_properties;
+	nt->flags = 0;
 	nt->functions.init = NULL;
 	nt->functions.destroy = NULL;
 	nt->functions.process = NULL;
@@ -500,6 +504,7 @@ int am_dfg_node_type_builds(struct am_dfg_node_type* nt,
 	}
 
 	nt->functions = sdef->functions;
+	nt->flags = sdef->flags;
 
 	if(am_dfg_node_type_build_explicit_masks(nt, sdef))
 		goto out_err_ports;
@@ -703,6 +708,9 @@ int am_dfg_node_instantiate(struct am_dfg_node* n,
 
 	INIT_LIST_HEAD(&n->sched_list);
 
+	n->memo_valid = 0;
+	n->memo_mask = 0;
+
 	if(n->type->functions.init)
 		if(n->type->functions.init(n))
 			goto out_err_init;
@@ -817,6 +825,24 @@ int am_dfg_node_is_well_connected(const struct am_dfg_node* n)
 	return 1;
 }
 
+/* Sets the property of a node n to a value using the node type's set_property
+ * function and invalidates any memoized output of the node. Returns 0 on
+ * success, otherwise 1. */
+int am_dfg_node_set_property(struct am_dfg_node* n,
+			     const struct am_dfg_property* property,
+			     const void* value)
+{
+	if(!n->type->functions.set_property)
+		return 1;
+
+	if(n->type->functions.set_property(n, property, value))
+		return 1;
+
+	am_dfg_node_invalidate_memo(n);
+
+	return 0;
+}
+
 /*
  * Destroy a node n, including all of its ports.
  */
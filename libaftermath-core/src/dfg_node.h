@@ -525,6 +525,22 @@ struct am_dfg_node_type_functions {
 			    void** value);
 };
 
+enum am_dfg_node_type_flag {
+	/* Nodes of this type only access their own ports and data that is not
+	 * modified during scheduling, such that they may be processed
+	 * concurrently with other nodes on any thread. Nodes of types without
+	 * this flag (e.g., nodes interacting with a user interface) are always
+	 * processed by the thread invoking the scheduler. */
+	AM_DFG_NODE_TYPE_THREAD_SAFE = (1 << 0),
+
+	/* The data produced by nodes of this type only depends on the data
+	 * read from their input ports and on their properties. The scheduler
+	 * skips processing of such nodes if neither the data on their input
+	 * ports nor their properties have changed since the last invocation
+	 * and reuses the data left on the output ports by that invocation. */
+	AM_DFG_NODE_TYPE_MEMOIZABLE = (1 << 1)
+};
+
 /* A node type */
 struct am_dfg_node_type {
 	/* The name of this node type */
@@ -539,6 +555,7 @@ struct am_dfg_node_type {
 	/* The number of ports */
 	size_t num_ports;
 
+	/* Flags from enum am_dfg_node_type_flag */
 	long flags;
 
 	/* Functions associated to the node type (processing, allocations, port
@@ -558,6 +575,21 @@ struct am_dfg_node_type {
 	struct am_dfg_property* properties;
 };
 
+/* Returns true if nodes of the type nt may be processed on any thread. */
+static inline int
+am_dfg_node_type_is_thread_safe(const struct am_dfg_node_type* nt)
+{
+	return nt->flags & AM_DFG_NODE_TYPE_THREAD_SAFE;
+}
+
+/* Returns true if the output of nodes of the type nt may be reused if their
+ * inputs and properties have not changed. */
+static inline int
+am_dfg_node_type_is_memoizable(const struct am_dfg_node_type* nt)
+{
+	return nt->flags & AM_DFG_NODE_TYPE_MEMOIZABLE;
+}
+
 /* Default size of a node instance */
 #define AM_DFG_NODE_DEFAULT_SIZE sizeof(struct am_dfg_node)
 
@@ -596,6 +628,9 @@ struct am_dfg_static_node_type_def {
 
 	/* Pointer to a static array of explicit port dependencies */
 	struct am_dfg_static_port_dep_word* port_deps;
+
+	/* Flags from enum am_dfg_node_type_flag */
+	long flags;
 };
 
 #define am_dfg_node_for_each_port(n, p)		\
@@ -719,7 +754,9 @@ struct am_dfg_node {
 	/* The node's port instances */
 	struct am_dfg_port* ports;
 
-	/* Number of remaining dependencies (used for scheduling) */
+	/* Number of remaining dependencies (used for scheduling). Might be
+	 * decremented concurrently by multiple producers and must thus only
+	 * be modified atomically during processing. */
 	size_t num_deps_remaining;
 
 	/* Marking used by the scheduler / cycle checker */
@@ -752,8 +789,25 @@ struct am_dfg_node {
 
 	/* Used by the scheduler to maintain lists of nodes */
 	struct list_head sched_list;
+
+	/* For nodes of a memoizable type: true if the buffers of the output
+	 * ports still contain the data produced by the last invocation of the
+	 * node's process function. Any change of the node's properties or
+	 * connections invalidates the memoized data. */
+	int memo_valid;
+
+	/* Ports that were activated during the invocation that produced the
+	 * memoized data */
+	uint64_t memo_mask;
 };
 
+/* Invalidates the output data memoized for a node n, such that n is processed
+ * again upon the next invocation of the scheduler. */
+static inline void am_dfg_node_invalidate_memo(struct am_dfg_node* n)
+{
+	n->memo_valid = 0;
+}
+
 /* Returns the zero-based index of the port p within its node. */
 static inline size_t am_dfg_port_index(const struct am_dfg_port* p)
 {
@@ -921,6 +975,9 @@ int am_dfg_node_is_root(const struct am_dfg_node* n);
 int am_dfg_node_is_root_ign(const struct am_dfg_node* n,
 			    const struct am_dfg_port* ignore_src,
 			    const struct am_dfg_port* ignore_dst);
+int am_dfg_node_set_property(struct am_dfg_node* n,
+			     const struct am_dfg_property* property,
+			     const void* value);
 
 struct am_object_notation_node*
 am_dfg_node_to_object_notation(struct am_dfg_node* n);
@@ -988,11 +1045,26 @@ am_dfg_node_from_object_notation(struct am_dfg_node_type* nt,
 				      INSTANCE_SIZE, DEFAULT_PORT_DEPS,	\
 				      FUNCTIONS, PORTS, EXPLICIT_PORT_DEPS,	\
 				      PROPERTIES)				\
+	AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(ID, NODE_TYPE_NAME,		\
+					    NODE_TYPE_HRNAME,			\
+					    INSTANCE_SIZE, DEFAULT_PORT_DEPS,	\
+					    FUNCTIONS, PORTS,			\
+					    EXPLICIT_PORT_DEPS, PROPERTIES, 0)
+
+/* Same as AM_DFG_DECL_BUILTIN_NODE_TYPE, but additionally sets the flags of
+ * the node type to FLAGS (values from enum am_dfg_node_type_flag). */
+#define AM_DFG_DECL_BUILTIN_NODE_TYPE_FLAGS(ID, NODE_TYPE_NAME,		\
+					    NODE_TYPE_HRNAME,			\
+					    INSTANCE_SIZE, DEFAULT_PORT_DEPS,	\
+					    FUNCTIONS, PORTS,			\
+					    EXPLICIT_PORT_DEPS, PROPERTIES,	\
+					    FLAGS)				\
 	AM_DFG_DECL_BUILTIN_NODE_TYPE_SWITCH(ID, NODE_TYPE_NAME,		\
 					     NODE_TYPE_HRNAME,			\
 					     INSTANCE_SIZE, DEFAULT_PORT_DEPS,	\
 					     FUNCTIONS, PORTS,			\
-					     EXPLICIT_PORT_DEPS, PROPERTIES)
+					     EXPLICIT_PORT_DEPS, PROPERTIES,	\
+					     FLAGS)
 
 /* Adds the nodes associated to the identifiers passed as arguments to the list
  * of builtin DFG nodes. There can only be one invocation of
@@ -195,6 +195,20 @@ int am_dfg_node_type_registry_add_static(
 	struct am_dfg_node_type_registry* ntr,
 	struct am_dfg_type_registry* tr,
 	struct am_dfg_static_node_type_def*** defsets)
+{
+	return am_dfg_node_type_registry_add_static_flags(ntr, tr, defsets, 0);
+}
+
+/* Same as am_dfg_node_type_registry_add_static, but adds flags (values from
+ * enum am_dfg_node_type_flag) to the flags of each registered node type.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_dfg_node_type_registry_add_static_flags(
+	struct am_dfg_node_type_registry* ntr,
+	struct am_dfg_type_registry* tr,
+	struct am_dfg_static_node_type_def*** defsets,
+	long flags)
 {
 	struct am_dfg_static_node_type_def*** pcurr_defset;
 	struct am_dfg_static_node_type_def** curr_defset;
@@ -221,6 +235,8 @@ int am_dfg_node_type_registry_add_static(
 				goto out_err;
 			}
 
+			nt->flags |= flags;
+
 			list_add(&nt->list, &types);
 		}
 	}
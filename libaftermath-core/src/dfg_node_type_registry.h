@@ -96,4 +96,10 @@ int am_dfg_node_type_registry_add_static(
 	struct am_dfg_type_registry* tr,
 	struct am_dfg_static_node_type_def*** defsets);
 
+int am_dfg_node_type_registry_add_static_flags(
+	struct am_dfg_node_type_registry* ntr,
+	struct am_dfg_type_registry* tr,
+	struct am_dfg_static_node_type_def*** defsets,
+	long flags);
+
 #endif
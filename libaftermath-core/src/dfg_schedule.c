@@ -19,6 +19,8 @@
 #include <aftermath/core/dfg_schedule.h>
 #include <aftermath/core/safe_alloc.h>
 #include <aftermath/core/bits.h>
+#include <aftermath/core/parallel.h>
+#include <pthread.h>
 
 enum am_dfg_schedule_marking {
 	/* No marking */
@@ -76,20 +78,63 @@ static void am_dfg_schedule_mark_component(struct am_dfg_node* n,
 	n->marking = m;
 }
 
-/* Resets a node and all of its ports and buffers */
-void am_dfg_schedule_reset_node(struct am_dfg_node* n)
+/* Resets the buffers of all output ports of a node n */
+static void am_dfg_schedule_reset_output_buffers(struct am_dfg_node* n)
 {
 	struct am_dfg_port* p;
 
+	am_dfg_node_for_each_output_port(n, p)
+		if(p->buffer)
+			am_dfg_buffer_reset(p->buffer);
+}
+
+/* Returns true if the node n is memoizable and if the data left on its output
+ * ports by the last invocation of its process function can be reused, given
+ * that the ports in active_mask are activated. This is the case if the same
+ * input ports are activated, if no new data has been produced on any connected
+ * input port since and if no output port is activated that was not activated
+ * during the last invocation. */
+static int am_dfg_schedule_memo_hit(const struct am_dfg_node* n,
+				    uint64_t active_mask)
+{
+	struct am_dfg_port* p;
+	uint64_t in_ports = 0;
+	uint64_t active_in;
+	uint64_t active_out;
+
+	if(!n->memo_valid || !am_dfg_node_type_is_memoizable(n->type))
+		return 0;
+
+	am_dfg_node_for_each_input_port(n, p) {
+		in_ports |= am_dfg_port_mask_bits(p);
+
+		if(am_dfg_port_is_connected(p) &&
+		   p->generation != p->connections[0]->generation)
+		{
+			return 0;
+		}
+	}
+
+	active_in = active_mask & in_ports;
+	active_out = active_mask & ~in_ports;
+
+	return active_in == (n->memo_mask & in_ports) &&
+		(active_out & n->memo_mask) == active_out;
+}
+
+/* Resets a node and all of its ports and buffers */
+void am_dfg_schedule_reset_node(struct am_dfg_node* n)
+{
 	INIT_LIST_HEAD(&n->sched_list);
 	n->num_deps_remaining = 0;
 
 	am_dfg_port_mask_reset(&n->negotiated_mask);
 	am_dfg_port_mask_reset(&n->propagated_mask);
 
-	am_dfg_node_for_each_output_port(n, p)
-		if(p->buffer)
-			am_dfg_buffer_reset(p->buffer);
+	/* Output buffers of nodes with memoized data are only reset if the
+	 * node actually needs to be processed again */
+	if(!n->memo_valid)
+		am_dfg_schedule_reset_output_buffers(n);
 
 	n->marking = AM_DFG_SCHEDULE_MARK_RESET;
 }
@@ -370,18 +415,17 @@ int am_dfg_schedule_process_node(struct am_dfg_node* n,
 	uint64_t req_mask;
 	uint64_t tmp;
 	size_t i;
+	size_t deps;
 	uint64_t omittable_ports;
+	uint64_t active_mask;
 	int skip_execution;
+	int memo_hit;
 
-	if(n->num_deps_remaining != 0)
+	if(__atomic_load_n(&n->num_deps_remaining, __ATOMIC_ACQUIRE) != 0)
 		return 1;
 
 	n->marking = AM_DFG_SCHEDULE_MARK_PROCESSING;
 
-	/* Update the data generation of each output port markes as new */
-	am_dfg_node_for_each_masked_port(n, n->negotiated_mask.push_new, p, tmp)
-		am_dfg_output_port_inc_generation(p);
-
 	out_mask = n->negotiated_mask.push_new | n->negotiated_mask.push_old;
 	in_mask = n->negotiated_mask.pull_new | n->negotiated_mask.pull_old;
 	req_mask = out_mask | in_mask;
@@ -393,11 +437,54 @@ int am_dfg_schedule_process_node(struct am_dfg_node* n,
 	}
 
 	skip_execution = (req_mask == omittable_ports);
+	active_mask = req_mask & ~omittable_ports;
+
+	/* The data on the output ports is only the same as at the last push
+	 * if the memoized data is reused */
+	memo_hit = !skip_execution && am_dfg_schedule_memo_hit(n, active_mask);
+
+	if(!memo_hit) {
+		/* Update the data generation of each output port markes as
+		 * new */
+		am_dfg_node_for_each_masked_port(n, n->negotiated_mask.push_new,
+						 p, tmp)
+		{
+			am_dfg_output_port_inc_generation(p);
+		}
 
-	if(!skip_execution && n->type->functions.process)
+		/* Processing a memoizable node again might yield different
+		 * data than the memoized data (e.g., after a change of its
+		 * properties), even on ports that have not been marked as
+		 * new. Consumers must not reuse their own memoized data. */
+		if(!skip_execution && am_dfg_node_type_is_memoizable(n->type)) {
+			am_dfg_node_for_each_masked_port(
+				n,
+				active_mask & n->negotiated_mask.push_old &
+				~n->negotiated_mask.push_new,
+				p, tmp)
+			{
+				am_dfg_output_port_inc_generation(p);
+			}
+		}
+
+		/* Buffers still contain memoized data if resetting has been
+		 * omitted */
+		if(n->memo_valid) {
+			am_dfg_schedule_reset_output_buffers(n);
+			am_dfg_node_invalidate_memo(n);
+		}
+	}
+
+	if(!skip_execution && !memo_hit && n->type->functions.process) {
 		if(n->type->functions.process(n))
 			return 1;
 
+		if(am_dfg_node_type_is_memoizable(n->type)) {
+			n->memo_valid = 1;
+			n->memo_mask = active_mask;
+		}
+	}
+
 	/* Update generation of all connected and requested input ports */
 	am_dfg_node_for_each_masked_port(n, in_mask, p, tmp)
 		if(am_dfg_port_is_connected(p))
@@ -407,15 +494,23 @@ int am_dfg_schedule_process_node(struct am_dfg_node* n,
 	am_dfg_node_for_each_masked_port(n, out_mask, p, tmp) {
 		am_dfg_port_for_each_connected_port_safe(p, pother, i) {
 			if(am_dfg_port_activated(pother)) {
+				/* The counter might be decremented concurrently
+				 * by other producers of the consumer; only the
+				 * producer satisfying the last dependency
+				 * enqueues the consumer. */
+				deps = __atomic_fetch_sub(
+					&pother->node->num_deps_remaining, 1,
+					__ATOMIC_ACQ_REL);
+
 				/* If the synchronization counter is already 0
 				 * something must have gone wrong.
 				 *
 				 * FIXME: rather use assert() for these kinds
 				 * of situations */
-				if(pother->node->num_deps_remaining == 0)
+				if(deps == 0)
 					return 1;
 
-				if(--pother->node->num_deps_remaining == 0) {
+				if(deps == 1) {
 					list_add(&pother->node->sched_list,
 						 sched_list);
 				}
@@ -454,22 +549,432 @@ int am_dfg_schedule_converge_deps(struct list_head* sched_list)
 	return 0;
 }
 
-/* Schedules all the nodes in a list as well as all of their descendants when
- * these get activated. All nodes in sched_list must be scheduling roots.
+/* Maximum number of threads processing nodes concurrently, including the
+ * thread invoking the scheduler. 0 means one thread per online processor. */
+static unsigned int am_dfg_schedule_max_threads = 0;
+
+/* Sets the maximum number of threads processing nodes concurrently, including
+ * the thread invoking the scheduler, to n. If n is 0, one thread per online
+ * processor is used. A value of 1 disables concurrent processing. The setting
+ * applies to pools initialized afterwards without an explicit maximum. */
+void am_dfg_schedule_set_max_threads(unsigned int n)
+{
+	am_dfg_schedule_max_threads = n;
+}
+
+/* Returns true if the invocation of the scheduler with the parameters p has
+ * been cancelled. */
+static inline int
+am_dfg_schedule_params_cancelled(const struct am_dfg_schedule_params* p)
+{
+	return p->cancel && __atomic_load_n(p->cancel, __ATOMIC_ACQUIRE);
+}
+
+/* Processes a node n on behalf of the thread that has invoked the scheduler
+ * with the parameters p. Nodes of types that are not thread-safe are processed
+ * through the processing function of the parameters, if specified.
  *
  * Returns 0 on success, otherwise 1.
  */
-int am_dfg_schedule_nodes(struct list_head* sched_list)
+static inline int
+am_dfg_schedule_process_node_caller(struct am_dfg_node* n,
+				    struct list_head* sched_list,
+				    const struct am_dfg_schedule_params* p)
+{
+	if(p->process_unsafe && !am_dfg_node_type_is_thread_safe(n->type))
+		return p->process_unsafe(n, sched_list, p->data);
+
+	return am_dfg_schedule_process_node(n, sched_list);
+}
+
+/* State shared by all threads processing the nodes of a single invocation of
+ * the scheduler. Protected by the lock of the pool providing the workers. */
+struct am_dfg_schedule_executor {
+	/* Pool providing the worker threads */
+	struct am_dfg_schedule_pool* pool;
+
+	/* Ready nodes that may be processed by any thread */
+	struct list_head ready;
+
+	/* Ready nodes that must be processed by the thread that has invoked
+	 * the scheduler */
+	struct list_head ready_caller;
+
+	/* Number of nodes currently being processed */
+	unsigned int num_busy;
+
+	/* Number of threads waiting for ready nodes */
+	unsigned int num_idle;
+
+	/* Number of workers of the pool participating in the invocation */
+	unsigned int num_attached;
+
+	/* Set to 1 as soon as processing of a node has failed */
+	int failed;
+
+	/* Set to 1 if processing has been cancelled before all ready nodes
+	 * have been processed */
+	int cancelled;
+
+	/* Parameters of the invocation of the scheduler */
+	const struct am_dfg_schedule_params* params;
+};
+
+static void* am_dfg_schedule_pool_worker(void* arg);
+
+/* Initializes a pool of worker threads for the scheduler that can be reused
+ * across invocations (see struct am_dfg_schedule_params). Max_threads is the
+ * maximum number of threads processing nodes concurrently, including the
+ * thread invoking the scheduler. If max_threads is 0, the value set with
+ * am_dfg_schedule_set_max_threads() is used. Workers are only started once
+ * independent nodes are ready and remain available until the pool is
+ * destroyed.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_dfg_schedule_pool_init(struct am_dfg_schedule_pool* pool,
+			      unsigned int max_threads)
+{
+	if(max_threads == 0)
+		max_threads = am_dfg_schedule_max_threads;
+
+	if(max_threads == 0)
+		max_threads = am_parallel_num_cpus();
+
+	pool->workers = NULL;
+	pool->num_workers = 0;
+	pool->max_workers = (max_threads > 1) ? max_threads - 1 : 0;
+	pool->num_waiting = 0;
+	pool->executor = NULL;
+	pool->epoch = 0;
+	pool->shutdown = 0;
+
+	if(pool->max_workers > 0) {
+		if(!(pool->workers = calloc(pool->max_workers,
+					    sizeof(*pool->workers))))
+		{
+			goto out_err;
+		}
+	}
+
+	if(pthread_mutex_init(&pool->lock, NULL))
+		goto out_err_workers;
+
+	if(pthread_cond_init(&pool->cond, NULL))
+		goto out_err_mutex;
+
+	return 0;
+
+out_err_mutex:
+	pthread_mutex_destroy(&pool->lock);
+out_err_workers:
+	free(pool->workers);
+out_err:
+	return 1;
+}
+
+/* Terminates all workers of a pool and destroys the pool. The pool must not be
+ * used by any invocation of the scheduler. */
+void am_dfg_schedule_pool_destroy(struct am_dfg_schedule_pool* pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	pool->shutdown = 1;
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	for(unsigned int i = 0; i < pool->num_workers; i++)
+		pthread_join(pool->workers[i], NULL);
+
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->workers);
+}
+
+/* Moves the nodes from the list l to the front of the ready lists of the
+ * executor e, depending on whether their types are thread-safe. As for
+ * sequential scheduling, the most recently activated nodes are processed
+ * first. Must be called with the pool's lock held. */
+static void
+am_dfg_schedule_executor_add_ready(struct am_dfg_schedule_executor* e,
+				   struct list_head* l)
+{
+	struct list_head ready = LIST_HEAD_INIT(ready);
+	struct list_head ready_caller = LIST_HEAD_INIT(ready_caller);
+	struct am_dfg_node* n;
+
+	while((n = am_dfg_schedule_list_pop_front(l))) {
+		if(am_dfg_node_type_is_thread_safe(n->type))
+			list_add_tail(&n->sched_list, &ready);
+		else
+			list_add_tail(&n->sched_list, &ready_caller);
+	}
+
+	list_splice(&ready, &e->ready);
+	list_splice(&ready_caller, &e->ready_caller);
+
+	pthread_cond_broadcast(&e->pool->cond);
+}
+
+/* Returns true if no node is ready or being processed or if processing has
+ * been cancelled and no node is being processed, i.e., if all threads can
+ * stop processing. Must be called with the pool's lock held. */
+static inline int
+am_dfg_schedule_executor_finished(struct am_dfg_schedule_executor* e)
+{
+	if(e->num_busy != 0)
+		return 0;
+
+	if(e->failed || e->cancelled)
+		return 1;
+
+	if(list_empty(&e->ready) && list_empty(&e->ready_caller))
+		return 1;
+
+	if(am_dfg_schedule_params_cancelled(e->params)) {
+		e->cancelled = 1;
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Takes the next ready node that the calling thread is allowed to process from
+ * the executor e or returns NULL if no such node is available. If further
+ * nodes that could be processed concurrently remain and no other thread is
+ * idle, an additional worker is started. Must be called with the pool's lock
+ * held. */
+static struct am_dfg_node*
+am_dfg_schedule_executor_take(struct am_dfg_schedule_executor* e, int caller)
+{
+	struct am_dfg_schedule_pool* pool = e->pool;
+	struct am_dfg_node* n = NULL;
+
+	if(e->failed || e->cancelled)
+		return NULL;
+
+	if(caller)
+		n = am_dfg_schedule_list_pop_front(&e->ready_caller);
+
+	if(!n)
+		n = am_dfg_schedule_list_pop_front(&e->ready);
+
+	if(!n)
+		return NULL;
+
+	/* Waiting workers of the pool join the invocation on their own */
+	if(!list_empty(&e->ready) &&
+	   e->num_idle == 0 &&
+	   pool->num_waiting == 0 &&
+	   pool->num_workers < pool->max_workers)
+	{
+		if(!pthread_create(&pool->workers[pool->num_workers], NULL,
+				   am_dfg_schedule_pool_worker, pool))
+		{
+			pool->num_workers++;
+		}
+	}
+
+	e->num_busy++;
+
+	return n;
+}
+
+/* Processing loop of a thread of the executor e. Caller indicates whether the
+ * thread is the thread that has invoked the scheduler. Must be called with the
+ * pool's lock held. */
+static void am_dfg_schedule_executor_run(struct am_dfg_schedule_executor* e,
+					 int caller)
+{
+	struct list_head local = LIST_HEAD_INIT(local);
+	struct am_dfg_schedule_pool* pool = e->pool;
+	struct am_dfg_node* n;
+	int ret;
+
+	while(!am_dfg_schedule_executor_finished(e)) {
+		if(!(n = am_dfg_schedule_executor_take(e, caller))) {
+			e->num_idle++;
+			pthread_cond_wait(&pool->cond, &pool->lock);
+			e->num_idle--;
+			continue;
+		}
+
+		pthread_mutex_unlock(&pool->lock);
+
+		if(caller)
+			ret = am_dfg_schedule_process_node_caller(n, &local,
+								  e->params);
+		else
+			ret = am_dfg_schedule_process_node(n, &local);
+
+		pthread_mutex_lock(&pool->lock);
+
+		if(ret)
+			e->failed = 1;
+
+		e->num_busy--;
+		am_dfg_schedule_executor_add_ready(e, &local);
+	}
+
+	pthread_cond_broadcast(&pool->cond);
+}
+
+/* Main loop of a worker of a pool: participates in each invocation of the
+ * scheduler using the pool until the pool is destroyed. */
+static void* am_dfg_schedule_pool_worker(void* arg)
+{
+	struct am_dfg_schedule_pool* pool = arg;
+	struct am_dfg_schedule_executor* e;
+	uint64_t epoch = 0;
+
+	pthread_mutex_lock(&pool->lock);
+
+	while(!pool->shutdown) {
+		/* Only join invocations that have not been processed by this
+		 * worker yet */
+		if(!pool->executor || pool->epoch == epoch) {
+			pool->num_waiting++;
+			pthread_cond_wait(&pool->cond, &pool->lock);
+			pool->num_waiting--;
+			continue;
+		}
+
+		e = pool->executor;
+		epoch = pool->epoch;
+
+		e->num_attached++;
+		am_dfg_schedule_executor_run(e, 0);
+		e->num_attached--;
+
+		pthread_cond_broadcast(&pool->cond);
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+/* Schedules all the nodes in sched_list as well as all of their descendants
+ * using the calling thread and the workers of the pool. Nodes whose
+ * dependencies are satisfied are processed concurrently if their types are
+ * thread-safe; all other nodes are processed by the calling thread or through
+ * the processing function of the parameters p.
+ *
+ * Returns 0 on success, 1 on failure and 2 if scheduling has been cancelled.
+ */
+static int
+am_dfg_schedule_nodes_parallel(struct list_head* sched_list,
+			       struct am_dfg_schedule_pool* pool,
+			       const struct am_dfg_schedule_params* p)
+{
+	struct am_dfg_schedule_executor e;
+
+	e.pool = pool;
+	INIT_LIST_HEAD(&e.ready);
+	INIT_LIST_HEAD(&e.ready_caller);
+	e.num_busy = 0;
+	e.num_idle = 0;
+	e.num_attached = 0;
+	e.failed = 0;
+	e.cancelled = 0;
+	e.params = p;
+
+	pthread_mutex_lock(&pool->lock);
+
+	/* Only one invocation at a time per pool */
+	while(pool->executor)
+		pthread_cond_wait(&pool->cond, &pool->lock);
+
+	pool->executor = &e;
+	pool->epoch++;
+
+	am_dfg_schedule_executor_add_ready(&e, sched_list);
+	am_dfg_schedule_executor_run(&e, 1);
+
+	/* Workers must have left the executor before it goes out of scope */
+	while(e.num_attached > 0)
+		pthread_cond_wait(&pool->cond, &pool->lock);
+
+	pool->executor = NULL;
+	pthread_cond_broadcast(&pool->cond);
+
+	pthread_mutex_unlock(&pool->lock);
+
+	if(e.failed)
+		return 1;
+	else if(e.cancelled)
+		return 2;
+
+	return 0;
+}
+
+/* Schedules all the nodes in sched_list as well as all of their descendants
+ * using the workers of the pool, one after another if the pool has no workers.
+ *
+ * Returns 0 on success, 1 on failure and 2 if scheduling has been cancelled.
+ */
+static int
+am_dfg_schedule_nodes_pool(struct list_head* sched_list,
+			   struct am_dfg_schedule_pool* pool,
+			   const struct am_dfg_schedule_params* p)
 {
 	struct am_dfg_node* niter;
 
-	while((niter = am_dfg_schedule_list_pop_front(sched_list)))
-		if(am_dfg_schedule_process_node(niter, sched_list))
+	if(pool->max_workers > 0)
+		return am_dfg_schedule_nodes_parallel(sched_list, pool, p);
+
+	while((niter = am_dfg_schedule_list_pop_front(sched_list))) {
+		if(am_dfg_schedule_params_cancelled(p))
+			return 2;
+
+		if(am_dfg_schedule_process_node_caller(niter, sched_list, p))
 			return 1;
+	}
 
 	return 0;
 }
 
+/* Schedules all the nodes in a list as well as all of their descendants when
+ * these get activated using the parameters p. All nodes in sched_list must be
+ * scheduling roots. Independent nodes of thread-safe types might be processed
+ * concurrently by the workers of the pool of the parameters or, if no pool is
+ * specified, by workers started for this invocation only (see
+ * am_dfg_schedule_set_max_threads()).
+ *
+ * Returns 0 on success, 1 on failure and 2 if scheduling has been cancelled.
+ */
+static int
+am_dfg_schedule_nodes_params(struct list_head* sched_list,
+			     const struct am_dfg_schedule_params* p)
+{
+	struct am_dfg_schedule_pool pool;
+	int ret;
+
+	if(p->pool)
+		return am_dfg_schedule_nodes_pool(sched_list, p->pool, p);
+
+	if(am_dfg_schedule_pool_init(&pool, 0))
+		return 1;
+
+	ret = am_dfg_schedule_nodes_pool(sched_list, &pool, p);
+	am_dfg_schedule_pool_destroy(&pool);
+
+	return ret;
+}
+
+/* Schedules all the nodes in a list as well as all of their descendants when
+ * these get activated. All nodes in sched_list must be scheduling roots.
+ * Independent nodes of thread-safe types might be processed concurrently (see
+ * am_dfg_schedule_set_max_threads()).
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_dfg_schedule_nodes(struct list_head* sched_list)
+{
+	static const struct am_dfg_schedule_params p = { NULL, NULL, NULL, NULL };
+
+	return am_dfg_schedule_nodes_params(sched_list, &p);
+}
+
 /* Attempts to schedule all the nodes of a graph g by setting all input ports to
  * "input old", such that they request data even if the producer does not
  * provide any new data. Nothe that this does not necessarily mean that all
@@ -507,14 +1012,19 @@ int am_dfg_schedule_graph(const struct am_dfg_graph* g)
 	return 0;
 }
 
-/* Tries to schedule n. Masks for the minimum input and output dependencies must
- * be set prior to the call. Requirements are propagated within the connected
- * component that, belongs to, including additional requirements of n itself
- * that arise from requirements of its consumers and producers.
+/* Same as am_dfg_schedule_component(), but uses the parameters p for the
+ * invocation of the scheduler, e.g., to process the nodes from a thread
+ * different from the thread owning the nodes of types that are not thread-safe
+ * or to cancel scheduling.
  *
- * Returns 0 on success, otherwise 1.
+ * If scheduling is cancelled, the nodes of the component that have not been
+ * processed yet keep the data from their last invocation and a subsequent
+ * invocation of the scheduler on the same component is safe.
+ *
+ * Returns 0 on success, 1 on failure and 2 if scheduling has been cancelled.
  */
-int am_dfg_schedule_component(struct am_dfg_node* n)
+int am_dfg_schedule_component_params(struct am_dfg_node* n,
+				     const struct am_dfg_schedule_params* p)
 {
 	struct list_head sched_list = LIST_HEAD_INIT(sched_list);
 
@@ -536,8 +1046,19 @@ int am_dfg_schedule_component(struct am_dfg_node* n)
 	if(list_empty(&sched_list))
 		return 1;
 
-	if(am_dfg_schedule_nodes(&sched_list))
-		return 1;
+	return am_dfg_schedule_nodes_params(&sched_list, p);
+}
 
-	return 0;
+/* Tries to schedule n. Masks for the minimum input and output dependencies must
+ * be set prior to the call. Requirements are propagated within the connected
+ * component that, belongs to, including additional requirements of n itself
+ * that arise from requirements of its consumers and producers.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_dfg_schedule_component(struct am_dfg_node* n)
+{
+	static const struct am_dfg_schedule_params p = { NULL, NULL, NULL, NULL };
+
+	return (am_dfg_schedule_component_params(n, &p) == 0) ? 0 : 1;
 }
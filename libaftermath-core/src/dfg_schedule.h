@@ -20,10 +20,83 @@
 #define AM_DFG_SCHEDULE_H
 
 #include <aftermath/core/dfg_graph.h>
+#include <pthread.h>
+#include <stdint.h>
+
+/* Function processing a node n of a type that is not thread-safe on behalf of
+ * the thread that has invoked the scheduler. The function must process the
+ * node using am_dfg_schedule_process_node(n, sched_list), e.g., by delegating
+ * the call to another thread, and may only return once processing has
+ * finished. Must return 0 on success, otherwise 1. */
+typedef int (*am_dfg_schedule_process_fun_t)(struct am_dfg_node* n,
+					     struct list_head* sched_list,
+					     void* data);
+
+struct am_dfg_schedule_executor;
+
+/* Worker threads processing nodes concurrently that are kept across
+ * invocations of the scheduler. A pool is used by at most one invocation at a
+ * time; concurrent invocations using the same pool are serialized. */
+struct am_dfg_schedule_pool {
+	/* Protects the pool and the state of the invocation in progress */
+	pthread_mutex_t lock;
+
+	/* Signaled when nodes become ready, when an invocation starts or ends
+	 * and when the pool is destroyed */
+	pthread_cond_t cond;
+
+	/* Worker threads started so far and maximum number of workers */
+	pthread_t* workers;
+	unsigned int num_workers;
+	unsigned int max_workers;
+
+	/* Number of workers waiting for an invocation to join */
+	unsigned int num_waiting;
+
+	/* Invocation in progress or NULL */
+	struct am_dfg_schedule_executor* executor;
+
+	/* Incremented for each invocation, such that workers join each
+	 * invocation only once */
+	uint64_t epoch;
+
+	/* Set to 1 when the workers must terminate */
+	int shutdown;
+};
+
+/* Parameters for a single invocation of the scheduler */
+struct am_dfg_schedule_params {
+	/* If non-NULL, all nodes of types that are not thread-safe are
+	 * processed through this function instead of being processed directly
+	 * by the thread that has invoked the scheduler. Data is passed
+	 * verbatim to the function. */
+	am_dfg_schedule_process_fun_t process_unsafe;
+	void* data;
+
+	/* If non-NULL, the scheduler stops processing further nodes as soon as
+	 * the value pointed to becomes non-zero. Nodes being processed when
+	 * the value changes are processed completely. */
+	const int* cancel;
+
+	/* If non-NULL, nodes are processed concurrently by the workers of this
+	 * pool. Otherwise, workers are started for the invocation and
+	 * terminated at its end. */
+	struct am_dfg_schedule_pool* pool;
+};
 
 int am_dfg_schedule_graph(const struct am_dfg_graph* g);
 int am_dfg_schedule_component(struct am_dfg_node* n);
+int am_dfg_schedule_component_params(struct am_dfg_node* n,
+				     const struct am_dfg_schedule_params* p);
+int am_dfg_schedule_process_node(struct am_dfg_node* n,
+				 struct list_head* sched_list);
 
 void am_dfg_schedule_reset_node(struct am_dfg_node* n);
 
+void am_dfg_schedule_set_max_threads(unsigned int n);
+
+int am_dfg_schedule_pool_init(struct am_dfg_schedule_pool* pool,
+			      unsigned int max_threads);
+void am_dfg_schedule_pool_destroy(struct am_dfg_schedule_pool* pool);
+
 #endif
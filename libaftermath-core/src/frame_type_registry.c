@@ -91,6 +91,8 @@ int am_frame_type_registry_add(struct am_frame_type_registry* r,
 	ft->read = read;
 	ft->destroy = destroy;
 	ft->dump_stdout = dump_stdout;
+	ft->per_event_collection = 0;
+	ft->ecoll_id_offset = 0;
 
 	if(am_frame_type_tree_insert(&r->name_tree, ft))
 		goto out_err_free_name;
@@ -64,6 +64,14 @@ struct am_frame_type {
 	 * lines whould be indented. */
 	int (*dump_stdout)(struct am_io_context* ctx, void* frame, size_t indent,
 			   size_t next_indent);
+
+	/* If non-zero, processing a frame of this type only modifies data
+	 * associated to a single event collection, whose ID is stored as a
+	 * uint32_t at offset ecoll_id_offset within a frame read by the read
+	 * function. Frames for different event collections can then be loaded
+	 * concurrently. */
+	int per_event_collection;
+	size_t ecoll_id_offset;
 };
 
 /* Red-black-tree for lookup of frame types by name */
@@ -114,6 +122,16 @@ int am_frame_type_registry_add(struct am_frame_type_registry* r,
 						  size_t indent,
 						  size_t next_indent));
 
+/* Marks the frame type ft as a frame type whose frames only modify data of the
+ * event collection whose ID is stored at offset ecoll_id_offset of a frame. */
+static inline void
+am_frame_type_set_per_event_collection(struct am_frame_type* ft,
+				       size_t ecoll_id_offset)
+{
+	ft->per_event_collection = 1;
+	ft->ecoll_id_offset = ecoll_id_offset;
+}
+
 int am_frame_type_registry_set_id(struct am_frame_type_registry* r,
 				  struct am_frame_type* ft,
 				  size_t seq_id);
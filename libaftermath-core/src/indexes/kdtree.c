@@ -18,8 +18,11 @@
 
 #include <aftermath/core/indexes/kdtree.h>
 #include <aftermath/core/bsearch.h>
-#include <aftermath/core/qselect.h>
+#include <aftermath/core/parallel.h>
 #include <aftermath/core/ptr.h>
+#include <aftermath/core/qselect.h>
+#include <aftermath/core/safe_alloc.h>
+#include <string.h>
 
 #define AM_KDTREE_NODE_PCMP(a, b) \
 	AM_VALCMP_EXPR((*a)->coordinates[*data], (*b)->coordinates[*data])
@@ -30,79 +33,416 @@ AM_DECL_QSELECT_NTH_GREATEST_SUFFIX_DATA_ARG(
 	AM_KDTREE_NODE_PCMP,
 	size_t)
 
+/* Number of sampled coordinates used to estimate the median when splitting
+ * with AM_KDTREE_SPLIT_APPROX_MEDIAN */
+#define AM_KDTREE_MEDIAN_SAMPLE_SIZE 127
+
+/* Arrays with less nodes are always split on the exact median */
+#define AM_KDTREE_APPROX_MEDIAN_MIN_NODES 4096
+
+/* Trees with less nodes are built sequentially */
+#define AM_KDTREE_PARALLEL_MIN_NODES 16384
+
+/* Number of independent subtrees per worker generated before the subtrees are
+ * built in parallel */
+#define AM_KDTREE_PARALLEL_TASKS_PER_WORKER 4
+
+#define AM_KDTREE_DOUBLE_CMP(a, b) AM_VALCMP_EXPR(*a, *b)
+
+AM_DECL_QSELECT_NTH_GREATEST_SUFFIX(am_kdtree_, _doubles, double,
+				    AM_KDTREE_DOUBLE_CMP)
+
+/* Parameters shared by all steps of the construction of a k-d-tree */
+struct am_kdtree_build_ctx {
+	size_t num_dimensions;
+	size_t max_depth;
+	enum am_kdtree_split_strategy strategy;
+	am_kdtree_node_built_fun_t node_built;
+	void* data;
+
+	/* Start of the array of node pointers */
+	struct am_kdtree_node** nodes;
+};
+
 void am_kdtree_init(struct am_kdtree* t, size_t num_dimensions)
 {
 	t->num_dimensions = num_dimensions;
+	t->root = NULL;
 }
 
-/* Recursively splits an array of k-d-tree node pointers on the median values
- * for the dimensions starting with dimension d.
+/* Reorders the num_nodes > 1 nodes using an estimate of the median for the
+ * given dimension, such that all nodes before the index returned in
+ * *median_idx have a lower or equal coordinate and all nodes after the index
+ * have a greater or equal coordinate. */
+static void am_kdtree_split_approx(struct am_kdtree_node** nodes,
+				   size_t num_nodes,
+				   size_t dim,
+				   size_t* median_idx)
+{
+	double sample[AM_KDTREE_MEDIAN_SAMPLE_SIZE];
+	size_t stride = num_nodes / AM_KDTREE_MEDIAN_SAMPLE_SIZE;
+	struct am_kdtree_node* tmp;
+	size_t max_idx = 0;
+	size_t i = 0;
+	size_t j = num_nodes - 1;
+	double pivot;
+
+	for(size_t k = 0; k < AM_KDTREE_MEDIAN_SAMPLE_SIZE; k++)
+		sample[k] = nodes[k * stride]->coordinates[dim];
+
+	pivot = *am_kdtree_qselect_nth_greatest_doubles_arg(
+		sample, AM_KDTREE_MEDIAN_SAMPLE_SIZE,
+		AM_KDTREE_MEDIAN_SAMPLE_SIZE / 2, NULL);
+
+	/* Hoare partitioning; since the pivot is a coordinate of one of the
+	 * nodes, both scans stop within the array. Nodes with the same
+	 * coordinate as the pivot are distributed evenly. */
+	for(;;) {
+		while(nodes[i]->coordinates[dim] < pivot)
+			i++;
+
+		while(nodes[j]->coordinates[dim] > pivot)
+			j--;
+
+		if(i >= j)
+			break;
+
+		tmp = nodes[i];
+		nodes[i] = nodes[j];
+		nodes[j] = tmp;
+
+		i++;
+		j--;
+	}
+
+	/* The split node is the greatest node of the lower partition [0; j] */
+	for(size_t k = 1; k <= j; k++)
+		if(nodes[k]->coordinates[dim] > nodes[max_idx]->coordinates[dim])
+			max_idx = k;
+
+	tmp = nodes[max_idx];
+	nodes[max_idx] = nodes[j];
+	nodes[j] = tmp;
+
+	*median_idx = j;
+}
+
+/* Selects the node that splits the num_nodes > 0 nodes for the dimension
+ * associated with depth and reorders the nodes, such that the nodes before the
+ * split node have a lower or equal coordinate and all nodes after the split
+ * node a greater or equal coordinate. The index of the split node is returned
+ * in *median_idx.
  *
- * max_depth is the maximum allowed depth of recursive calls; If recursion
- * exceeds this limit, the function aborts.
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_kdtree_split_nodes(const struct am_kdtree_build_ctx* ctx,
+				 struct am_kdtree_node** nodes,
+				 size_t num_nodes,
+				 size_t depth,
+				 size_t* median_idx)
+{
+	size_t dimension = depth % ctx->num_dimensions;
+	struct am_kdtree_node** median;
+
+	if(ctx->strategy == AM_KDTREE_SPLIT_APPROX_MEDIAN &&
+	   num_nodes >= AM_KDTREE_APPROX_MEDIAN_MIN_NODES)
+	{
+		am_kdtree_split_approx(nodes, num_nodes, dimension, median_idx);
+		return 0;
+	}
+
+	/* Sort according to current dimension */
+	if(!(median = am_kdtree_nodes_qselect_nth_greatest_ptrs(
+		     nodes, num_nodes, num_nodes / 2, &dimension)))
+	{
+		return 1;
+	}
+
+	*median_idx = AM_ARRAY_INDEX(nodes, median);
+
+	return 0;
+}
+
+/* Recursively splits an array of k-d-tree node pointers and stores the root of
+ * the resulting subtree at depth curr_depth in *out.
  *
  * Returns 0 on success, otherwise 1 (e.g., if the maximum depth was exceeded).
  */
-int am_kdtree_split(struct am_kdtree_node** out,
-		    size_t dimension,
-		    size_t num_dimensions,
-		    struct am_kdtree_node** nodes,
-		    size_t num_nodes,
-		    size_t max_depth,
-		    size_t curr_depth)
+static int am_kdtree_build_subtree(const struct am_kdtree_build_ctx* ctx,
+				   struct am_kdtree_node** out,
+				   struct am_kdtree_node** nodes,
+				   size_t num_nodes,
+				   size_t curr_depth)
 {
-	size_t next_dimension = (dimension + 1) % num_dimensions;
 	size_t median_idx;
-	struct am_kdtree_node** median;
 
-	if(curr_depth > max_depth)
+	if(curr_depth > ctx->max_depth)
 		return 1;
 
 	if(num_nodes == 0) {
 		*out = NULL;
-	} else if(num_nodes == 1) {
+		return 0;
+	}
+
+	if(num_nodes == 1) {
+		median_idx = 0;
 		*out = nodes[0];
 		(*out)->smaller = NULL;
 		(*out)->greater = NULL;
-	} else if(num_nodes > 1) {
-		/* Sort according to current dimension */
-		if(!(median = am_kdtree_nodes_qselect_nth_greatest_ptrs(
-			     nodes, num_nodes, num_nodes / 2, &dimension)))
-		{
-			return 1;
-		}
+		goto out;
+	}
+
+	if(am_kdtree_split_nodes(ctx, nodes, num_nodes, curr_depth, &median_idx))
+		return 1;
 
-		median_idx = AM_ARRAY_INDEX(nodes, median);
-		*out = nodes[median_idx];
+	*out = nodes[median_idx];
 
-		/* Nodes with current dimension smaller */
-		if(am_kdtree_split(&(*out)->smaller,
-				   next_dimension,
-				   num_dimensions,
-				   &nodes[0],
-				   median_idx,
-				   max_depth,
+	/* Nodes with current dimension smaller */
+	if(am_kdtree_build_subtree(ctx, &(*out)->smaller,
+				   &nodes[0], median_idx,
 				   curr_depth + 1))
-		{
-			return 1;
-		}
+	{
+		return 1;
+	}
 
-		/* Nodes with current dimension greater */
-		if(am_kdtree_split(&(*out)->greater,
-				   next_dimension,
-				   num_dimensions,
+	/* Nodes with current dimension greater */
+	if(am_kdtree_build_subtree(ctx, &(*out)->greater,
 				   &nodes[median_idx+1],
 				   (num_nodes - median_idx) - 1,
-				   max_depth,
 				   curr_depth + 1))
+	{
+		return 1;
+	}
+
+out:
+	if(ctx->node_built) {
+		ctx->node_built(*out, curr_depth,
+				AM_ARRAY_INDEX(ctx->nodes, &nodes[median_idx]),
+				ctx->data);
+	}
+
+	return 0;
+}
+
+/* Subtree to be built during parallel construction of a k-d-tree */
+struct am_kdtree_build_task {
+	/* Where the pointer to the root of the subtree is stored */
+	struct am_kdtree_node** out;
+
+	struct am_kdtree_node** nodes;
+	size_t num_nodes;
+	size_t depth;
+
+	/* Index of the split node in the entire array of nodes; set once
+	 * the nodes of the task have been split */
+	size_t split_idx;
+};
+
+/* Data passed to the workers during parallel construction */
+struct am_kdtree_build_level {
+	const struct am_kdtree_build_ctx* ctx;
+
+	/* Tasks of the current level */
+	struct am_kdtree_build_task* tasks;
+
+	/* Two child tasks per task of the current level; unused for the last
+	 * level */
+	struct am_kdtree_build_task* children;
+};
+
+/* Splits the nodes of a single task of the current level and generates the
+ * tasks for the two subtrees. Invoked by am_parallel_for. */
+static int am_kdtree_build_split_task(void* data, size_t idx, unsigned int worker)
+{
+	struct am_kdtree_build_level* l = data;
+	struct am_kdtree_build_task* task = &l->tasks[idx];
+	struct am_kdtree_build_task* children = &l->children[2*idx];
+	struct am_kdtree_node* root;
+	size_t median_idx;
+
+	/* Same conditions as for recursive construction: leaves are not split
+	 * and any other subtree must have its children within max_depth */
+	if(task->num_nodes == 1) {
+		median_idx = 0;
+	} else {
+		if(task->depth + 1 > l->ctx->max_depth)
+			return 1;
+
+		if(am_kdtree_split_nodes(l->ctx, task->nodes, task->num_nodes,
+					 task->depth, &median_idx))
 		{
 			return 1;
 		}
 	}
 
+	root = task->nodes[median_idx];
+	*task->out = root;
+	task->split_idx = AM_ARRAY_INDEX(l->ctx->nodes,
+					 &task->nodes[median_idx]);
+
+	children[0].out = &root->smaller;
+	children[0].nodes = task->nodes;
+	children[0].num_nodes = median_idx;
+	children[0].depth = task->depth + 1;
+
+	children[1].out = &root->greater;
+	children[1].nodes = &task->nodes[median_idx+1];
+	children[1].num_nodes = (task->num_nodes - median_idx) - 1;
+	children[1].depth = task->depth + 1;
+
 	return 0;
 }
 
+/* Builds the entire subtree of a task of the last level. Invoked by
+ * am_parallel_for. */
+static int am_kdtree_build_subtree_task(void* data, size_t idx,
+					unsigned int worker)
+{
+	struct am_kdtree_build_level* l = data;
+	struct am_kdtree_build_task* task = &l->tasks[idx];
+
+	return am_kdtree_build_subtree(l->ctx, task->out, task->nodes,
+				       task->num_nodes, task->depth);
+}
+
+/* Builds the upper levels of the tree breadth-first, splitting the nodes of all
+ * subtrees of a level in parallel, until there are enough independent subtrees
+ * for num_workers workers. These are then built in parallel. The split nodes of
+ * the upper levels are reported to the node_built callback function last,
+ * starting with the deepest level.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_kdtree_build_parallel_levels(const struct am_kdtree_build_ctx* ctx,
+					   struct am_kdtree* t,
+					   size_t num_nodes,
+					   unsigned int num_workers)
+{
+	struct am_kdtree_build_level l = { .ctx = ctx };
+	struct am_kdtree_build_task* top = NULL;
+	struct am_kdtree_build_task* tmp;
+	size_t num_top = 0;
+	size_t num_tasks = 1;
+	size_t num_children;
+	size_t min_tasks = (size_t)num_workers *
+		AM_KDTREE_PARALLEL_TASKS_PER_WORKER;
+	int ret = 1;
+
+	if(!(l.tasks = malloc(sizeof(*l.tasks))))
+		return 1;
+
+	l.tasks[0].out = &t->root;
+	l.tasks[0].nodes = ctx->nodes;
+	l.tasks[0].num_nodes = num_nodes;
+	l.tasks[0].depth = 0;
+
+	while(num_tasks > 0 && num_tasks < min_tasks) {
+		if(!(l.children = am_alloc_array_safe(2 * num_tasks,
+						      sizeof(*l.children))))
+		{
+			goto out;
+		}
+
+		if(am_parallel_for(num_tasks, num_workers,
+				   am_kdtree_build_split_task, &l))
+		{
+			goto out_children;
+		}
+
+		/* Keep split nodes for node_built */
+		if(!(tmp = am_realloc_array_safe(top, num_top + num_tasks,
+						 sizeof(*top))))
+		{
+			goto out_children;
+		}
+
+		top = tmp;
+		memcpy(&top[num_top], l.tasks, num_tasks * sizeof(*top));
+		num_top += num_tasks;
+
+		/* Empty subtrees are not built */
+		num_children = 0;
+
+		for(size_t i = 0; i < 2 * num_tasks; i++) {
+			if(l.children[i].num_nodes == 0)
+				*l.children[i].out = NULL;
+			else
+				l.children[num_children++] = l.children[i];
+		}
+
+		free(l.tasks);
+		l.tasks = l.children;
+		l.children = NULL;
+		num_tasks = num_children;
+	}
+
+	if(am_parallel_for(num_tasks, num_workers,
+			   am_kdtree_build_subtree_task, &l))
+	{
+		goto out;
+	}
+
+	/* Split nodes of deeper levels come last, such that iterating
+	 * backwards reports children before their parents */
+	if(ctx->node_built) {
+		for(size_t i = num_top; i > 0; i--) {
+			ctx->node_built(*top[i-1].out, top[i-1].depth,
+					top[i-1].split_idx, ctx->data);
+		}
+	}
+
+	ret = 0;
+
+out_children:
+	free(l.children);
+out:
+	free(top);
+	free(l.tasks);
+
+	return ret;
+}
+
+/* Builds a k-d-tree from an array of pointers to k-d-tree nodes whose
+ * coordinates have been set, using at most num_workers threads (one per online
+ * processor if num_workers is 0). Independent subtrees are built in parallel.
+ *
+ * The strategy defines how the nodes splitting the subtrees are selected. If
+ * node_built is non-NULL, it is invoked for each node once both of its
+ * subtrees have been built, with data passed verbatim as the last argument.
+ * Invocations for different nodes may take place concurrently.
+ *
+ * max_depth is the maximum allowed depth of recursive calls; If recursion
+ * exceeds this limit, the function aborts.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_kdtree_build_parallel(struct am_kdtree* t,
+			     struct am_kdtree_node** nodes,
+			     size_t num_nodes,
+			     size_t max_depth,
+			     unsigned int num_workers,
+			     enum am_kdtree_split_strategy strategy,
+			     am_kdtree_node_built_fun_t node_built,
+			     void* data)
+{
+	struct am_kdtree_build_ctx ctx = {
+		.num_dimensions = t->num_dimensions,
+		.max_depth = max_depth,
+		.strategy = strategy,
+		.node_built = node_built,
+		.data = data,
+		.nodes = nodes
+	};
+
+	if(num_workers == 0)
+		num_workers = am_parallel_num_cpus();
+
+	if(num_workers == 1 || num_nodes < AM_KDTREE_PARALLEL_MIN_NODES)
+		return am_kdtree_build_subtree(&ctx, &t->root, nodes, num_nodes, 0);
+
+	return am_kdtree_build_parallel_levels(&ctx, t, num_nodes, num_workers);
+}
+
 /* Builds a k-d-tree from an array of pointers to k-d-tree nodes whose
  * coordinates have been set.
  *
@@ -116,8 +456,8 @@ int am_kdtree_build(struct am_kdtree* t,
 		    size_t num_nodes,
 		    size_t max_depth)
 {
-	return am_kdtree_split(&t->root, 0, t->num_dimensions, nodes, num_nodes,
-			       max_depth, 0);
+	return am_kdtree_build_parallel(t, nodes, num_nodes, max_depth, 1,
+					AM_KDTREE_SPLIT_MEDIAN, NULL, NULL);
 }
 
 /* Invokes the callback function cb for each node of the k-d-sub-tree rooted at
@@ -48,11 +48,37 @@ struct am_kdtree {
 	struct am_kdtree_node* root;
 };
 
+/* Strategies for the selection of the node splitting a subtree */
+enum am_kdtree_split_strategy {
+	/* Exact median of the coordinates for the split dimension */
+	AM_KDTREE_SPLIT_MEDIAN,
+
+	/* Median of a sample of the coordinates; the nodes are reordered in a
+	 * single pass, but the tree might be slightly less balanced */
+	AM_KDTREE_SPLIT_APPROX_MEDIAN
+};
+
+/* Function invoked during construction for a node n at the given depth once
+ * both of its subtrees have been built. Idx is the index of the node in the
+ * array of node pointers after construction. */
+typedef void (*am_kdtree_node_built_fun_t)(struct am_kdtree_node* n,
+					   size_t depth,
+					   size_t idx,
+					   void* data);
+
 void am_kdtree_init(struct am_kdtree* t, size_t num_dimensions);
 int am_kdtree_build(struct am_kdtree* t,
 		    struct am_kdtree_node** nodes,
 		    size_t num_nodes,
 		    size_t max_depth);
+int am_kdtree_build_parallel(struct am_kdtree* t,
+			     struct am_kdtree_node** nodes,
+			     size_t num_nodes,
+			     size_t max_depth,
+			     unsigned int num_workers,
+			     enum am_kdtree_split_strategy strategy,
+			     am_kdtree_node_built_fun_t node_built,
+			     void* data);
 
 int am_kdtree_query_callback(const struct am_kdtree* t,
 			     double* query_start,
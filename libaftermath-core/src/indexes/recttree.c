@@ -23,142 +23,135 @@
 void am_recttree_init(struct am_recttree* t, size_t num_dimensions)
 {
 	am_kdtree_init(&t->kdtree, num_dimensions);
+	t->subtree_bounds = NULL;
 }
 
-/* Temporary data structure needed when updating the bounding box maximum values
- * for a tree node */
-struct am_recttree_bbox_tmp {
-	/* Bounding boxes ("lower right corners") at the current depth for all
-	 * nodes up to the root */
-	double* maxes;
-
-	/* Number of dimensions for the hyper rectangles */
-	size_t num_dimensions;
-};
-
-/* Initializes a temporary data structure used to determine the bounding box of
- * a tree node.
- *
- * Returns 0 on success, otherwise 1.
- */
-static int am_recttree_bbox_tmp_init(struct am_recttree_bbox_tmp* bbtmp,
-				     size_t num_dimensions,
-				     size_t max_depth)
+void am_recttree_destroy(struct am_recttree* t)
 {
-	size_t num_bytes;
-
-	if(am_size_mul_safe(&num_bytes, num_dimensions, sizeof(double)))
-		return 1;
-
-	if(am_size_mul_safe(&num_bytes, num_bytes, max_depth))
-		return 1;
-
-	if(!(bbtmp->maxes = malloc(num_bytes)))
-		return 1;
-
-	bbtmp->num_dimensions = num_dimensions;
-
-	return 0;
+	free(t->subtree_bounds);
+	t->subtree_bounds = NULL;
 }
 
-/* Destroys a temporary data structure used to determine the bounding box of a
- * tree node. */
-void am_recttree_bbox_tmp_destroy(struct am_recttree_bbox_tmp* bbtmp)
+/* Extends the bounding box defined by start and end, such that it includes the
+ * bounding box defined by other_start and other_end. */
+static void am_recttree_bbox_extend(size_t num_dimensions,
+				    double* start,
+				    double* end,
+				    const double* other_start,
+				    const double* other_end)
 {
-	free(bbtmp->maxes);
-}
+	for(size_t dim = 0; dim < num_dimensions; dim++) {
+		if(other_start[dim] < start[dim])
+			start[dim] = other_start[dim];
 
-/* Extends the maximum coordinates of a bounding box in out with the values from
- * m which are higher. */
-void am_recttree_bbox_max_extend(size_t num_dimensions, double* out, double* m)
-{
-	for(size_t dim = 0; dim < num_dimensions; dim++)
-		if(m[dim] > out[dim])
-			out[dim] = m[dim];
+		if(other_end[dim] > end[dim])
+			end[dim] = other_end[dim];
+	}
 }
 
-/* Updates the bounding box for a tree node */
-void am_recttree_update_bbox(struct am_recttree_node* n,
-			     struct am_recttree_bbox_tmp* bbtmp,
-			     size_t depth)
+/* Sets the bounding box of the subtree rooted at n, which is at the given depth,
+ * once the bounding boxes of both subtrees of n have been set. The bounding box
+ * is stored at the index idx of the storage for bounding boxes of the rect tree
+ * passed in data. Invoked during construction of the k-d-tree. */
+static void am_recttree_update_bbox(struct am_kdtree_node* kdnode,
+				    size_t depth,
+				    size_t idx,
+				    void* data)
 {
-	struct am_recttree_node* smaller;
-	struct am_recttree_node* greater;
-	size_t this_dimension = depth % bbtmp->num_dimensions;
-	double* this_bbox_max = &bbtmp->maxes[depth * bbtmp->num_dimensions];
-	double* smaller_bbox_max;
-	double* greater_bbox_max;
+	struct am_recttree* t = data;
+	struct am_recttree_node* n = (struct am_recttree_node*)kdnode;
+	struct am_recttree_node* child;
+	size_t num_dimensions = t->kdtree.num_dimensions;
+	size_t this_dimension = depth % num_dimensions;
+
+	n->subtree_start = &t->subtree_bounds[2 * num_dimensions * idx];
+	n->subtree_end = n->subtree_start + num_dimensions;
 
 	/* Initialize with own hyper rectangle */
-	memcpy(this_bbox_max,
+	memcpy(n->subtree_start,
+	       n->kdnode.coordinates,
+	       num_dimensions * sizeof(double));
+
+	memcpy(n->subtree_end,
 	       n->hyperrect_end,
-	       bbtmp->num_dimensions * sizeof(double));
+	       num_dimensions * sizeof(double));
 
 	/* Extend for rectangles with smaller values for this dimension */
 	if(n->kdnode.smaller) {
-		smaller_bbox_max = this_bbox_max + bbtmp->num_dimensions;
-		smaller = (struct am_recttree_node*)n->kdnode.smaller;
-		am_recttree_update_bbox(smaller, bbtmp, depth + 1);
-		am_recttree_bbox_max_extend(bbtmp->num_dimensions,
-					    this_bbox_max,
-					    smaller_bbox_max);
+		child = (struct am_recttree_node*)n->kdnode.smaller;
+		am_recttree_bbox_extend(num_dimensions,
+					n->subtree_start, n->subtree_end,
+					child->subtree_start, child->subtree_end);
 	}
 
 	/* Extend for rectangles with greater values for this dimension */
 	if(n->kdnode.greater) {
-		greater_bbox_max = this_bbox_max + bbtmp->num_dimensions;
-		greater = (struct am_recttree_node*)n->kdnode.greater;
-		am_recttree_update_bbox(greater, bbtmp, depth + 1);
-		am_recttree_bbox_max_extend(bbtmp->num_dimensions,
-					    this_bbox_max,
-					    greater_bbox_max);
+		child = (struct am_recttree_node*)n->kdnode.greater;
+		am_recttree_bbox_extend(num_dimensions,
+					n->subtree_start, n->subtree_end,
+					child->subtree_start, child->subtree_end);
 	}
 
 	/* Set maximum value for this node */
-	n->bbox_max = this_bbox_max[this_dimension];
+	n->bbox_max = n->subtree_end[this_dimension];
 }
 
 /* Builds a rect tree from a an array of pointers to tree nodes whose
- * coordinates have been set prior to the call.
+ * coordinates have been set prior to the call using at most num_workers
+ * threads (one per online processor if num_workers is 0). The strategy defines
+ * how the underlying k-d-tree is split (see am_kdtree_build_parallel).
  *
  * Returns 0 on success, otherwise 1.
  */
-int am_recttree_build(struct am_recttree* t,
-		      struct am_recttree_node** nodes,
-		      size_t num_nodes,
-		      size_t max_depth)
+int am_recttree_build_parallel(struct am_recttree* t,
+			       struct am_recttree_node** nodes,
+			       size_t num_nodes,
+			       size_t max_depth,
+			       unsigned int num_workers,
+			       enum am_kdtree_split_strategy strategy)
 {
 	size_t num_dimensions = t->kdtree.num_dimensions;
-	struct am_recttree_bbox_tmp bbtmp;
-	size_t actual_depth;
+	size_t bounds_per_node;
+
+	am_recttree_destroy(t);
+
+	if(am_size_mul_safe(&bounds_per_node, num_dimensions, 2 * sizeof(double)))
+		return 1;
+
+	if(num_nodes > 0 &&
+	   !(t->subtree_bounds = am_alloc_array_safe(num_nodes, bounds_per_node)))
+	{
+		return 1;
+	}
 
 	/* Passing the recttree pointers directly as k-d-tree node pointers
 	 * works, since each recttree node has a k-d-tree node as its first
 	 * member */
-	if(am_kdtree_build(&t->kdtree, (struct am_kdtree_node**)nodes, num_nodes,
-			   max_depth))
+	if(am_kdtree_build_parallel(&t->kdtree, (struct am_kdtree_node**)nodes,
+				    num_nodes, max_depth, num_workers, strategy,
+				    am_recttree_update_bbox, t))
 	{
+		am_recttree_destroy(t);
 		return 1;
 	}
 
-	actual_depth = am_kdtree_depth(&t->kdtree);
-
-	/* No need to calculate bounding boxes for empty tree */
-	if(actual_depth == 0)
-		return 0;
-
-	if(am_recttree_bbox_tmp_init(&bbtmp, num_dimensions, actual_depth))
-		return 1;
-
-	am_recttree_update_bbox((struct am_recttree_node*)t->kdtree.root,
-				&bbtmp,
-				0);
-
-	am_recttree_bbox_tmp_destroy(&bbtmp);
-
 	return 0;
 }
 
+/* Builds a rect tree from a an array of pointers to tree nodes whose
+ * coordinates have been set prior to the call.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_recttree_build(struct am_recttree* t,
+		      struct am_recttree_node** nodes,
+		      size_t num_nodes,
+		      size_t max_depth)
+{
+	return am_recttree_build_parallel(t, nodes, num_nodes, max_depth, 1,
+					  AM_KDTREE_SPLIT_MEDIAN);
+}
+
 /* Invokes the callback function cb for each node of the subtree rooted at n
  * whose hyper rectangle overlaps with the query hyper rectangle defined by
  * query_start and query_end. If the callback function returns a value different
@@ -274,6 +267,101 @@ int am_recttree_query_callback(const struct am_recttree* t,
 		query_start, query_end, cb, data);
 }
 
+/* Returns true if the extent of the bounding box of the subtree rooted at n is
+ * smaller than min_extent in all dimensions. */
+static inline int am_recttree_node_below_extent(const struct am_recttree_node* n,
+						size_t num_dimensions,
+						const double* min_extent)
+{
+	for(size_t dim = 0; dim < num_dimensions; dim++)
+		if(n->subtree_end[dim] - n->subtree_start[dim] >= min_extent[dim])
+			return 0;
+
+	return 1;
+}
+
+/* Same as am_recttree_query_callback_node, but aggregates subtrees whose
+ * bounding box is smaller than min_extent in all dimensions (see
+ * am_recttree_query_lod_callback). */
+static int am_recttree_query_lod_callback_node(
+	struct am_recttree_node* n,
+	size_t num_dimensions,
+	const double* query_start,
+	const double* query_end,
+	const double* min_extent,
+	int (*cb)(struct am_recttree_node* n, int aggregate, void* data),
+	void* data)
+{
+	if(!n)
+		return 0;
+
+	/* Nothing to do if no rectangle of the subtree overlaps */
+	if(!am_hyperrectangle_intersect_p(
+		   num_dimensions,
+		   query_start, query_end,
+		   n->subtree_start, n->subtree_end))
+	{
+		return 0;
+	}
+
+	/* Do not descend into small subtrees */
+	if(!am_kdtree_node_is_leaf(&n->kdnode) &&
+	   am_recttree_node_below_extent(n, num_dimensions, min_extent))
+	{
+		return cb(n, 1, data);
+	}
+
+	if(am_hyperrectangle_intersect_p(
+		   num_dimensions,
+		   query_start, query_end,
+		   n->kdnode.coordinates, n->hyperrect_end))
+	{
+		if(cb(n, 0, data))
+			return 1;
+	}
+
+	if(am_recttree_query_lod_callback_node(
+		   (struct am_recttree_node*)n->kdnode.smaller,
+		   num_dimensions, query_start, query_end, min_extent,
+		   cb, data))
+	{
+		return 1;
+	}
+
+	return am_recttree_query_lod_callback_node(
+		(struct am_recttree_node*)n->kdnode.greater,
+		num_dimensions, query_start, query_end, min_extent,
+		cb, data);
+}
+
+/* Level-of-detail variant of am_recttree_query_callback. Subtrees overlapping
+ * with the query hyper rectangle whose bounding box is smaller than min_extent
+ * in all dimensions are not traversed. Instead, the callback function is
+ * invoked once for the root of the subtree with aggregate set to 1 and the
+ * bounding box of the subtree can be obtained from the subtree_start and
+ * subtree_end fields of the node. For all other nodes overlapping with the
+ * query hyper rectangle, the callback function is invoked with aggregate set
+ * to 0. If the callback function returns a value different from 0, no further
+ * invocations of the callback function take place.
+ *
+ * Returns 0 if the callback function was invoked for all overlapping hyper
+ * rectangles or subtrees or 1 if enumeration has been interrupted by the
+ * callback function.
+ */
+int am_recttree_query_lod_callback(
+	const struct am_recttree* t,
+	const double* query_start,
+	const double* query_end,
+	const double* min_extent,
+	int (*cb)(struct am_recttree_node* n, int aggregate, void* data),
+	void* data)
+{
+	return am_recttree_query_lod_callback_node(
+		(struct am_recttree_node*)t->kdtree.root,
+		t->kdtree.num_dimensions,
+		query_start, query_end, min_extent, cb, data);
+}
+
 static int am_recttree_node_at_callback(struct am_recttree_node* n,
 					void* data)
 {
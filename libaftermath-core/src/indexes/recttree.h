@@ -28,22 +28,45 @@ struct am_recttree_node {
 	struct am_kdtree_node kdnode;
 	double* hyperrect_end;
 	double bbox_max;
+
+	/* Bounding box of the hyper rectangles of all nodes of the subtree
+	 * rooted at this node, including the node itself. Set when the tree is
+	 * built. */
+	double* subtree_start;
+	double* subtree_end;
 };
 
 struct am_recttree {
 	struct am_kdtree kdtree;
+
+	/* Storage for the subtree bounding boxes of all nodes */
+	double* subtree_bounds;
 };
 
 void am_recttree_init(struct am_recttree* t, size_t num_dimensions);
+void am_recttree_destroy(struct am_recttree* t);
 int am_recttree_build(struct am_recttree* t,
 		      struct am_recttree_node** nodes,
 		      size_t num_nodes,
 		      size_t max_depth);
+int am_recttree_build_parallel(struct am_recttree* t,
+			       struct am_recttree_node** nodes,
+			       size_t num_nodes,
+			       size_t max_depth,
+			       unsigned int num_workers,
+			       enum am_kdtree_split_strategy strategy);
 int am_recttree_query_callback(const struct am_recttree* t,
 			       const double* query_start,
 			       const double* query_end,
 			       int (*cb)(struct am_recttree_node* n, void* data),
 			       void* data);
+int am_recttree_query_lod_callback(
+	const struct am_recttree* t,
+	const double* query_start,
+	const double* query_end,
+	const double* min_extent,
+	int (*cb)(struct am_recttree_node* n, int aggregate, void* data),
+	void* data);
 
 /* Returns 1 if two hyperrectangles A and B (defined by a_start and a_end, and
  * b_start and b_end, respectively) overlap. Otherwise, 0 is returned.
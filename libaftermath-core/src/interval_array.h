@@ -208,6 +208,140 @@ am_interval_array_iterator_start_intn(struct am_typed_array_generic* arr,
 		AM_SIZEOF_BITS(*puint),				\
 		pquery)
 
+/* A read-only view on the start and end timestamps of a sequence of intervals
+ * sorted by their start timestamps. The timestamps are either embedded into the
+ * elements of an array of structures, in which case the stride is the size of
+ * an element, or stored in two separate, contiguous columns, in which case the
+ * stride is the size of a timestamp. All accessors below work on both
+ * layouts. */
+struct am_interval_columns {
+	/* Start and end timestamp of the first interval */
+	const am_timestamp_t* start;
+	const am_timestamp_t* end;
+
+	/* Distance in bytes between the timestamps of two consecutive
+	 * intervals */
+	size_t stride;
+
+	/* Number of intervals */
+	size_t num_elements;
+};
+
+/* Initializes an interval column view ic for the intervals embedded at the
+ * offset interval_field_offset into the elements of size element_size of an
+ * array of structures arr. */
+static inline void
+am_interval_columns_init_strided(struct am_interval_columns* ic,
+				 const struct am_typed_array_generic* arr,
+				 size_t element_size,
+				 off_t interval_field_offset)
+{
+	const struct am_interval* first;
+
+	first = AM_PTR_ADD(arr->elements, interval_field_offset);
+
+	ic->start = &first->start;
+	ic->end = &first->end;
+	ic->stride = element_size;
+	ic->num_elements = arr->num_elements;
+}
+
+/* Initializes an interval column view ic for num_elements intervals whose start
+ * and end timestamps are stored in two separate columns start and end. */
+static inline void
+am_interval_columns_init_columnar(struct am_interval_columns* ic,
+				  const am_timestamp_t* start,
+				  const am_timestamp_t* end,
+				  size_t num_elements)
+{
+	ic->start = start;
+	ic->end = end;
+	ic->stride = sizeof(am_timestamp_t);
+	ic->num_elements = num_elements;
+}
+
+/* Returns true if the intervals of the view ic are stored in separate,
+ * contiguous columns */
+static inline int
+am_interval_columns_is_columnar(const struct am_interval_columns* ic)
+{
+	return ic->stride == sizeof(am_timestamp_t);
+}
+
+/* Returns the start timestamp of the interval with the index idx */
+static inline am_timestamp_t
+am_interval_columns_start(const struct am_interval_columns* ic, size_t idx)
+{
+	return *((const am_timestamp_t*)AM_PTR_ADD(ic->start, idx * ic->stride));
+}
+
+/* Returns the end timestamp of the interval with the index idx */
+static inline am_timestamp_t
+am_interval_columns_end(const struct am_interval_columns* ic, size_t idx)
+{
+	return *((const am_timestamp_t*)AM_PTR_ADD(ic->end, idx * ic->stride));
+}
+
+/* Copies the interval with the index idx to *i */
+static inline void
+am_interval_columns_get(const struct am_interval_columns* ic,
+			size_t idx,
+			struct am_interval* i)
+{
+	i->start = am_interval_columns_start(ic, idx);
+	i->end = am_interval_columns_end(ic, idx);
+}
+
+/* Determines the range of indexes of the intervals of the view ic that overlap
+ * with the interval query. The index of the first overlapping interval is
+ * returned in *first and the function returns the index following the last
+ * overlapping interval. If no interval overlaps, the returned index is equal
+ * to *first. */
+static inline size_t
+am_interval_columns_overlapping_range(const struct am_interval_columns* ic,
+				      const struct am_interval* query,
+				      size_t* first)
+{
+	size_t lo = 0;
+	size_t hi = ic->num_elements;
+	size_t mid;
+
+	/* First interval that does not end before the query */
+	while(lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if(am_interval_columns_end(ic, mid) < query->start)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	*first = lo;
+
+	/* First interval starting after the query */
+	hi = ic->num_elements;
+
+	while(lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if(am_interval_columns_start(ic, mid) <= query->end)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* Iterates over the indexes of all intervals of a view pic that overlap with
+ * the interval pquery. The argument idx must be the name of a size_t variable
+ * used as the iterator. */
+#define am_interval_columns_for_each_overlapping(pic, idx, pquery)		\
+	for(size_t am_ic_end_##idx =						\
+		    am_interval_columns_overlapping_range(pic, pquery, &(idx)); \
+	    (idx) < am_ic_end_##idx;						\
+	    (idx)++)
+
 /* This macro provides a generic way to implement a binary search function for
  * arrays of an event type T with an interval. The declared function returns the
  * first instance of type T whose interval overlaps with the query interval. If
@@ -0,0 +1,108 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_IO_ARRAY_CACHE_H
+#define AM_IO_ARRAY_CACHE_H
+
+/* An I/O array cache is used temporarily when a trace is loaded. It associates
+ * pairs of an event collection ID and an array identifier with the address of
+ * the per-event-collection array, such that the generated append functions do
+ * not need to look up the event collection and to search the event
+ * collection's arrays by name for every single event.
+ *
+ * The cache is direct-mapped and array identifiers are compared by address
+ * only. This is sufficient, since the identifiers passed by the generated code
+ * are string literals. Identical strings at different addresses simply result
+ * in separate entries for the same array.
+ *
+ * Cached arrays must not be destroyed while the cache is in use. The cache must
+ * therefore be reset whenever arrays might be destroyed (e.g., when the trace
+ * associated with an I/O context is destroyed).
+ */
+
+#include <aftermath/core/base_types.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define AM_IO_ARRAY_CACHE_SIZE 128
+
+struct am_io_array_cache_entry {
+	const char* ident;
+	am_event_collection_id_t ecoll_id;
+	void* array;
+};
+
+struct am_io_array_cache {
+	struct am_io_array_cache_entry entries[AM_IO_ARRAY_CACHE_SIZE];
+};
+
+/* Removes all entries from the cache */
+static inline void am_io_array_cache_reset(struct am_io_array_cache* c)
+{
+	for(size_t i = 0; i < AM_IO_ARRAY_CACHE_SIZE; i++) {
+		c->entries[i].ident = NULL;
+		c->entries[i].array = NULL;
+	}
+}
+
+/* Returns the cache entry for a pair of an event collection ID and an array
+ * identifier */
+static inline struct am_io_array_cache_entry*
+am_io_array_cache_slot(struct am_io_array_cache* c,
+		       am_event_collection_id_t ecoll_id,
+		       const char* ident)
+{
+	uintptr_t h = ((uintptr_t)ident >> 3) ^ (ecoll_id * 0x9E3779B1u);
+
+	return &c->entries[h % AM_IO_ARRAY_CACHE_SIZE];
+}
+
+/* Returns the address of the array cached for the array identifier ident and
+ * the event collection with the ID ecoll_id or NULL if there is no such entry
+ * in the cache. */
+static inline void* am_io_array_cache_lookup(struct am_io_array_cache* c,
+					     am_event_collection_id_t ecoll_id,
+					     const char* ident)
+{
+	struct am_io_array_cache_entry* e;
+
+	e = am_io_array_cache_slot(c, ecoll_id, ident);
+
+	if(e->ident == ident && e->ecoll_id == ecoll_id)
+		return e->array;
+
+	return NULL;
+}
+
+/* Associates the array identifier ident and the event collection ID ecoll_id
+ * with the array arr. Any previous entry mapped to the same slot is
+ * evicted. */
+static inline void am_io_array_cache_insert(struct am_io_array_cache* c,
+					    am_event_collection_id_t ecoll_id,
+					    const char* ident,
+					    void* arr)
+{
+	struct am_io_array_cache_entry* e;
+
+	e = am_io_array_cache_slot(c, ecoll_id, ident);
+	e->ident = ident;
+	e->ecoll_id = ecoll_id;
+	e->array = arr;
+}
+
+#endif
@@ -21,6 +21,9 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 int am_io_context_init(struct am_io_context* ctx,
 		       struct am_frame_type_registry* frame_types)
@@ -28,10 +31,19 @@ int am_io_context_init(struct am_io_context* ctx,
 	ctx->trace = NULL;
 	ctx->filename = NULL;
 	ctx->fp = NULL;
+	ctx->map_base = NULL;
+	ctx->map_size = 0;
+	ctx->map_pos = 0;
 	ctx->bounds_valid = 0;
+	ctx->bounds.start = AM_TIMESTAMP_T_MAX;
+	ctx->bounds.end = 0;
+	ctx->num_threads = 0;
+	ctx->load_filter = NULL;
+	ctx->load_frame_types = NULL;
 	ctx->frame_types = frame_types;
 
 	am_io_hierarchy_context_init(&ctx->hierarchy_context);
+	am_io_array_cache_reset(&ctx->array_cache);
 
 	if(am_io_error_stack_definit(&ctx->error_stack))
 		return 1;
@@ -66,9 +78,55 @@ int am_io_context_set_filename(struct am_io_context* ctx, const char* filename)
 	return 0;
 }
 
+/* Tries to map the entire file opened by the I/O context into memory. If the
+ * file is not a regular file, is empty or if the mapping fails, the context is
+ * left unchanged and reads are performed through the file pointer. */
+static void am_io_context_try_map(struct am_io_context* ctx)
+{
+	struct stat st;
+	void* addr;
+
+	if(fstat(fileno(ctx->fp), &st))
+		return;
+
+	if(!S_ISREG(st.st_mode) || st.st_size <= 0)
+		return;
+
+	if((uintmax_t)st.st_size > SIZE_MAX)
+		return;
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+		    fileno(ctx->fp), 0);
+
+	if(addr == MAP_FAILED)
+		return;
+
+	/* Frames are decoded in order; this is only a hint */
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+	ctx->map_base = addr;
+	ctx->map_size = st.st_size;
+	ctx->map_pos = 0;
+}
+
+/* Releases the memory mapping of an I/O context if the file has been
+ * mapped. */
+static void am_io_context_unmap(struct am_io_context* ctx)
+{
+	if(ctx->map_base) {
+		munmap(ctx->map_base, ctx->map_size);
+		ctx->map_base = NULL;
+		ctx->map_size = 0;
+		ctx->map_pos = 0;
+	}
+}
+
 /* Opens a file in the specified mode m. If the operation fails, an error is
  * pushed onto the I/O error stack of the I/O context. Returns 0 on success,
- * otherwise 1.  */
+ * otherwise 1.
+ *
+ * Files opened for reading are mapped into memory if possible. Files that
+ * cannot be mapped (e.g., pipes) are read through a regular file pointer. */
 int am_io_context_open(struct am_io_context* ctx,
 		       const char* filename,
 		       enum am_io_mode m)
@@ -118,6 +176,9 @@ int am_io_context_open(struct am_io_context* ctx,
 		return 1;
 	}
 
+	if(m == AM_IO_READ)
+		am_io_context_try_map(ctx);
+
 	return 0;
 }
 
@@ -125,6 +186,8 @@ int am_io_context_open(struct am_io_context* ctx,
  * filename. */
 void am_io_context_close(struct am_io_context* ctx)
 {
+	am_io_context_unmap(ctx);
+
 	if(ctx->fp) {
 		fclose(ctx->fp);
 		ctx->fp = NULL;
@@ -133,6 +196,15 @@ void am_io_context_close(struct am_io_context* ctx)
 	am_io_context_set_filename(ctx, NULL);
 }
 
+/* Returns the current offset within the file opened with the I/O context. */
+off_t am_io_context_tell(struct am_io_context* ctx)
+{
+	if(am_io_context_is_mapped(ctx))
+		return ctx->map_pos;
+	else
+		return ftello(ctx->fp);
+}
+
 /* Resets an I/O context. If a trace has been associated with the context, the
  * trace is destroyed, but not freed. */
 void am_io_context_reset(struct am_io_context* ctx)
@@ -144,8 +216,11 @@ void am_io_context_reset(struct am_io_context* ctx)
 
 	am_io_hierarchy_context_destroy(&ctx->hierarchy_context);
 	am_io_hierarchy_context_init(&ctx->hierarchy_context);
+	am_io_array_cache_reset(&ctx->array_cache);
 
 	ctx->bounds_valid = 0;
+	ctx->bounds.start = AM_TIMESTAMP_T_MAX;
+	ctx->bounds.end = 0;
 }
 
 void am_io_fail(void)
@@ -21,12 +21,34 @@
 
 #define _FILE_OFFSET_BITS 64
 #include <stdio.h>
+#include <string.h>
+#include <aftermath/core/io_array_cache.h>
 #include <aftermath/core/io_error.h>
 #include <aftermath/core/io_hierarchy_context.h>
 #include <aftermath/core/trace.h>
 #include <aftermath/core/frame_type_registry.h>
 #include <aftermath/core/array_collection.h>
 
+/* Restricts the events that are materialized when a trace is loaded.
+ * Descriptions, hierarchies, event collections and event mappings are always
+ * loaded. */
+struct am_io_load_filter {
+	/* Only events whose timestamps overlap with this interval are
+	 * loaded */
+	struct am_interval interval;
+
+	/* If num_collection_ids is non-zero, only events of the event
+	 * collections whose IDs are listed are loaded. The IDs must be sorted
+	 * in ascending order. */
+	const am_event_collection_id_t* collection_ids;
+	size_t num_collection_ids;
+
+	/* If num_frame_types is non-zero, only events from frames whose type
+	 * names are listed (e.g., "am_dsk_state_event") are loaded */
+	const char* const* frame_types;
+	size_t num_frame_types;
+};
+
 /* An IO context serves as a compound structure for temporary data needed when
  * loading / writing a trace from / to disk. When an IO operation fails, the
  * error stack captures the errors at the different levels from the outermost
@@ -40,8 +62,34 @@ struct am_io_context {
 	char* filename;
 	FILE* fp;
 
+	/* If a trace file opened for reading is a regular file, its contents
+	 * are mapped into memory and all reads are served directly from the
+	 * mapping at the offset map_pos. If the file cannot be mapped (e.g.,
+	 * because it is a pipe), map_base is NULL and data is read through
+	 * fp. */
+	char* map_base;
+	size_t map_size;
+	size_t map_pos;
+
 	struct am_io_hierarchy_context hierarchy_context;
+	struct am_io_array_cache array_cache;
 	struct am_frame_type_registry* frame_types;
+
+	/* Minimum and maximum timestamps of all events processed through this
+	 * context. Copied to the trace once all frames have been read. */
+	struct am_interval bounds;
+
+	/* Maximum number of threads used for loading a trace. A value of zero
+	 * indicates one thread per online processor. */
+	unsigned int num_threads;
+
+	/* Filter for the events to load or NULL if all events are loaded */
+	const struct am_io_load_filter* load_filter;
+
+	/* If the load filter restricts the frame types, load_frame_types is
+	 * indexed by the sequential ID of a frame type and is non-zero for
+	 * all types whose frames are loaded. Otherwise NULL. */
+	unsigned char* load_frame_types;
 };
 
 enum am_io_mode {
@@ -58,8 +106,118 @@ int am_io_context_open(struct am_io_context* ctx,
 		       const char* filename,
 		       enum am_io_mode m);
 void am_io_context_close(struct am_io_context* ctx);
+off_t am_io_context_tell(struct am_io_context* ctx);
 void am_io_fail(void);
 
+/* Returns true if the file of the I/O context is accessed through a memory
+ * mapping, otherwise false. */
+static inline int am_io_context_is_mapped(const struct am_io_context* ctx)
+{
+	return ctx->map_base != NULL;
+}
+
+/* Returns true if the end of the file of the I/O context has been reached,
+ * otherwise false. */
+static inline int am_io_context_eof(struct am_io_context* ctx)
+{
+	if(am_io_context_is_mapped(ctx))
+		return ctx->map_pos >= ctx->map_size;
+	else
+		return feof(ctx->fp);
+}
+
+/* Returns true if an event of the event collection with the ID collection_id
+ * whose timestamps span [start, end] must be loaded according to the load
+ * filter of the I/O context. */
+static inline int
+am_io_context_load_event(const struct am_io_context* ctx,
+			 am_event_collection_id_t collection_id,
+			 am_timestamp_t start,
+			 am_timestamp_t end)
+{
+	const struct am_io_load_filter* f = ctx->load_filter;
+	size_t lo;
+	size_t hi;
+	size_t mid;
+
+	if(!f)
+		return 1;
+
+	if(end < f->interval.start || start > f->interval.end)
+		return 0;
+
+	if(f->num_collection_ids == 0)
+		return 1;
+
+	lo = 0;
+	hi = f->num_collection_ids;
+
+	while(lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if(f->collection_ids[mid] < collection_id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo < f->num_collection_ids &&
+		f->collection_ids[lo] == collection_id;
+}
+
+/* Returns true if the frames of the type ft must be loaded according to the
+ * load filter of the I/O context. */
+static inline int am_io_context_load_frame_type(const struct am_io_context* ctx,
+						const struct am_frame_type* ft)
+{
+	return !ctx->load_frame_types || ctx->load_frame_types[ft->seq_id];
+}
+
+/* Adds the interval [start, end] to the bounds of the I/O context */
+static inline void am_io_context_extend_bounds(struct am_io_context* ctx,
+					       am_timestamp_t start,
+					       am_timestamp_t end)
+{
+	if(start < ctx->bounds.start)
+		ctx->bounds.start = start;
+
+	if(end > ctx->bounds.end)
+		ctx->bounds.end = end;
+}
+
+/* Returns a pointer to the next size bytes of the memory mapping of an I/O
+ * context and advances the current position by size bytes. If less than size
+ * bytes remain, the position remains unchanged and NULL is returned. */
+static inline const void* am_io_context_map_advance(struct am_io_context* ctx,
+						    size_t size)
+{
+	const void* ret;
+
+	if(ctx->map_size - ctx->map_pos < size)
+		return NULL;
+
+	ret = ctx->map_base + ctx->map_pos;
+	ctx->map_pos += size;
+
+	return ret;
+}
+
+/* Copies the next size bytes from the memory mapping of an I/O context to buf
+ * and advances the current position. Returns 0 on success, otherwise 1. */
+static inline int am_io_context_map_read(struct am_io_context* ctx,
+					 void* buf,
+					 size_t size)
+{
+	const void* src;
+
+	if(!(src = am_io_context_map_advance(ctx, size)))
+		return 1;
+
+	memcpy(buf, src, size);
+
+	return 0;
+}
+
 /* Convenience macro that pushes a new error onto the I/O error stack of an I/O
  * context using a printf-style format string and a variable argument list,
  * invokes am_io_fail (for debugging) and returns 1. */
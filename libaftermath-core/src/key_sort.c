@@ -0,0 +1,399 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "key_sort.h"
+#include <aftermath/core/parallel.h>
+#include <aftermath/core/ptr.h>
+#include <aftermath/core/qsort.h>
+#include <aftermath/core/safe_alloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Arrays with less elements are sorted with quicksort */
+#define AM_KEY_SORT_RADIX_MIN_ELEMENTS 16384
+
+/* Minimum number of elements processed by a worker of a parallel step */
+#define AM_KEY_SORT_MIN_BLOCK_ELEMENTS 65536
+
+#define AM_KEY_SORT_DIGIT_BITS 8
+#define AM_KEY_SORT_RADIX (1 << AM_KEY_SORT_DIGIT_BITS)
+
+/* Key of an element and the index of the element before sorting */
+struct am_key_sort_pair {
+	uint64_t key;
+	size_t idx;
+};
+
+/* Orders pairs by key and then by index, which makes quicksort stable */
+static inline int am_key_sort_pair_cmp(struct am_key_sort_pair* a,
+				       struct am_key_sort_pair* b)
+{
+	if(a->key != b->key)
+		return (a->key > b->key) ? 1 : -1;
+
+	return (a->idx > b->idx) ? 1 : ((a->idx < b->idx) ? -1 : 0);
+}
+
+AM_DECL_QSORT_SUFFIX(am_key_sort_, _pairs,
+		     struct am_key_sort_pair,
+		     am_key_sort_pair_cmp)
+
+/* Returns the key of the element with the index idx */
+static inline uint64_t am_key_sort_get_key(const void* elements,
+					   size_t idx,
+					   size_t element_size,
+					   size_t key_offset)
+{
+	uint64_t key;
+
+	memcpy(&key,
+	       AM_PTR_ADD(elements, idx * element_size + key_offset),
+	       sizeof(key));
+
+	return key;
+}
+
+/* Returns 1 if the keys of the num_elements elements of size element_size
+ * starting at elements are in ascending order, otherwise 0. */
+int am_key_sorted(const void* elements,
+		  size_t num_elements,
+		  size_t element_size,
+		  size_t key_offset)
+{
+	uint64_t prev;
+	uint64_t curr;
+
+	if(num_elements < 2)
+		return 1;
+
+	prev = am_key_sort_get_key(elements, 0, element_size, key_offset);
+
+	for(size_t i = 1; i < num_elements; i++) {
+		curr = am_key_sort_get_key(elements, i, element_size,
+					   key_offset);
+
+		if(curr < prev)
+			return 0;
+
+		prev = curr;
+	}
+
+	return 1;
+}
+
+/* State shared by the workers of a parallel sort. The elements are divided
+ * into num_blocks contiguous blocks of block_size elements (the last one
+ * possibly being shorter), each of which is processed by a single
+ * invocation. */
+struct am_key_sort_ctx {
+	void* elements;
+	void* tmp;
+	size_t num_elements;
+	size_t element_size;
+	size_t key_offset;
+
+	struct am_key_sort_pair* src;
+	struct am_key_sort_pair* dst;
+
+	size_t num_blocks;
+	size_t block_size;
+
+	/* Per-block digit histograms, which are turned into per-block output
+	 * offsets before scattering */
+	size_t (*hist)[AM_KEY_SORT_RADIX];
+
+	/* Per-block bitwise AND and OR of all keys of the block */
+	uint64_t* key_and;
+	uint64_t* key_or;
+
+	/* Position of the digit of the current pass */
+	unsigned int shift;
+};
+
+/* Sets *begin and *end to the range of element indexes of a block */
+static inline void am_key_sort_block_range(const struct am_key_sort_ctx* ctx,
+					   size_t block,
+					   size_t* begin,
+					   size_t* end)
+{
+	*begin = block * ctx->block_size;
+	*end = *begin + ctx->block_size;
+
+	if(*end > ctx->num_elements)
+		*end = ctx->num_elements;
+}
+
+/* Extracts the keys of the elements of a block into pairs */
+static int am_key_sort_extract(void* data, size_t block, unsigned int worker)
+{
+	struct am_key_sort_ctx* ctx = data;
+	uint64_t key_and = UINT64_MAX;
+	uint64_t key_or = 0;
+	size_t begin;
+	size_t end;
+
+	am_key_sort_block_range(ctx, block, &begin, &end);
+
+	for(size_t i = begin; i < end; i++) {
+		ctx->src[i].key = am_key_sort_get_key(ctx->elements, i,
+						      ctx->element_size,
+						      ctx->key_offset);
+		ctx->src[i].idx = i;
+
+		key_and &= ctx->src[i].key;
+		key_or |= ctx->src[i].key;
+	}
+
+	ctx->key_and[block] = key_and;
+	ctx->key_or[block] = key_or;
+
+	return 0;
+}
+
+/* Builds the histogram of the current digit for the pairs of a block */
+static int am_key_sort_histogram(void* data, size_t block, unsigned int worker)
+{
+	struct am_key_sort_ctx* ctx = data;
+	size_t* hist = ctx->hist[block];
+	size_t begin;
+	size_t end;
+
+	am_key_sort_block_range(ctx, block, &begin, &end);
+	memset(hist, 0, sizeof(ctx->hist[block]));
+
+	for(size_t i = begin; i < end; i++)
+		hist[(ctx->src[i].key >> ctx->shift) & (AM_KEY_SORT_RADIX-1)]++;
+
+	return 0;
+}
+
+/* Moves the pairs of a block to their positions for the current digit */
+static int am_key_sort_scatter(void* data, size_t block, unsigned int worker)
+{
+	struct am_key_sort_ctx* ctx = data;
+	size_t* offs = ctx->hist[block];
+	size_t begin;
+	size_t end;
+	size_t digit;
+
+	am_key_sort_block_range(ctx, block, &begin, &end);
+
+	for(size_t i = begin; i < end; i++) {
+		digit = (ctx->src[i].key >> ctx->shift) & (AM_KEY_SORT_RADIX-1);
+		ctx->dst[offs[digit]++] = ctx->src[i];
+	}
+
+	return 0;
+}
+
+/* Copies the elements of the sorted pairs of a block to the temporary
+ * buffer */
+static int am_key_sort_gather(void* data, size_t block, unsigned int worker)
+{
+	struct am_key_sort_ctx* ctx = data;
+	size_t esz = ctx->element_size;
+	size_t begin;
+	size_t end;
+
+	am_key_sort_block_range(ctx, block, &begin, &end);
+
+	for(size_t i = begin; i < end; i++) {
+		memcpy(AM_PTR_ADD(ctx->tmp, i * esz),
+		       AM_PTR_ADD(ctx->elements, ctx->src[i].idx * esz),
+		       esz);
+	}
+
+	return 0;
+}
+
+/* Copies a block of sorted elements from the temporary buffer back to the
+ * array */
+static int am_key_sort_copy_back(void* data, size_t block, unsigned int worker)
+{
+	struct am_key_sort_ctx* ctx = data;
+	size_t esz = ctx->element_size;
+	size_t begin;
+	size_t end;
+
+	am_key_sort_block_range(ctx, block, &begin, &end);
+
+	memcpy(AM_PTR_ADD(ctx->elements, begin * esz),
+	       AM_PTR_ADD(ctx->tmp, begin * esz),
+	       (end - begin) * esz);
+
+	return 0;
+}
+
+/* Sorts the pairs of ctx->src using one pass per digit of the keys. Digits that
+ * are identical for all keys (e.g., the upper bits of timestamps of a short
+ * trace) are skipped. On return, ctx->src points to the sorted pairs. Returns 0
+ * on success, otherwise 1. */
+static int am_key_sort_radix(struct am_key_sort_ctx* ctx,
+			     unsigned int num_workers)
+{
+	struct am_key_sort_pair* swp;
+	uint64_t key_and = UINT64_MAX;
+	uint64_t key_or = 0;
+	uint64_t varying;
+	size_t off = 0;
+
+	for(size_t b = 0; b < ctx->num_blocks; b++) {
+		key_and &= ctx->key_and[b];
+		key_or |= ctx->key_or[b];
+	}
+
+	varying = key_and ^ key_or;
+
+	for(ctx->shift = 0; ctx->shift < 64;
+	    ctx->shift += AM_KEY_SORT_DIGIT_BITS)
+	{
+		if(!((varying >> ctx->shift) & (AM_KEY_SORT_RADIX-1)))
+			continue;
+
+		if(am_parallel_for(ctx->num_blocks, num_workers,
+				   am_key_sort_histogram, ctx))
+		{
+			return 1;
+		}
+
+		/* Turn histograms into output offsets, such that the pairs of
+		 * a block are placed after those of the preceding blocks with
+		 * the same digit */
+		off = 0;
+
+		for(size_t d = 0; d < AM_KEY_SORT_RADIX; d++) {
+			for(size_t b = 0; b < ctx->num_blocks; b++) {
+				size_t cnt = ctx->hist[b][d];
+
+				ctx->hist[b][d] = off;
+				off += cnt;
+			}
+		}
+
+		if(am_parallel_for(ctx->num_blocks, num_workers,
+				   am_key_sort_scatter, ctx))
+		{
+			return 1;
+		}
+
+		swp = ctx->src;
+		ctx->src = ctx->dst;
+		ctx->dst = swp;
+	}
+
+	return 0;
+}
+
+/* Sorts the num_elements elements of size element_size starting at elements in
+ * ascending order of the unsigned 64-bit key located key_offset bytes after the
+ * start of each element. Elements with identical keys keep their relative
+ * order. Large arrays are sorted using up to num_workers threads; if
+ * num_workers is 0, one thread per online processor is used. Returns 0 on
+ * success, otherwise 1. On failure, the array is left unchanged. */
+int am_key_sort(void* elements,
+		size_t num_elements,
+		size_t element_size,
+		size_t key_offset,
+		unsigned int num_workers)
+{
+	struct am_key_sort_ctx ctx;
+	struct am_key_sort_pair* pairs;
+	size_t tmp_size;
+	size_t pairs_size;
+	int ret = 1;
+
+	if(num_elements < 2)
+		return 0;
+
+	if(am_size_mul_safe(&tmp_size, num_elements, element_size) ||
+	   am_size_mul_safe(&pairs_size, num_elements, 2 * sizeof(*pairs)))
+	{
+		return 1;
+	}
+
+	if(!(pairs = malloc(pairs_size)))
+		goto out;
+
+	if(!(ctx.tmp = malloc(tmp_size)))
+		goto out_pairs;
+
+	if(num_workers == 0)
+		num_workers = am_parallel_num_cpus();
+
+	ctx.elements = elements;
+	ctx.num_elements = num_elements;
+	ctx.element_size = element_size;
+	ctx.key_offset = key_offset;
+	ctx.src = &pairs[0];
+	ctx.dst = &pairs[num_elements];
+
+	ctx.num_blocks = (num_elements + AM_KEY_SORT_MIN_BLOCK_ELEMENTS - 1) /
+		AM_KEY_SORT_MIN_BLOCK_ELEMENTS;
+
+	if(ctx.num_blocks > num_workers)
+		ctx.num_blocks = num_workers;
+
+	if(num_elements < AM_KEY_SORT_RADIX_MIN_ELEMENTS)
+		ctx.num_blocks = 1;
+
+	ctx.block_size = (num_elements + ctx.num_blocks - 1) / ctx.num_blocks;
+
+	if(!(ctx.hist = calloc(ctx.num_blocks, sizeof(*ctx.hist))))
+		goto out_tmp;
+
+	if(!(ctx.key_and = calloc(ctx.num_blocks, sizeof(*ctx.key_and))))
+		goto out_hist;
+
+	if(!(ctx.key_or = calloc(ctx.num_blocks, sizeof(*ctx.key_or))))
+		goto out_key_and;
+
+	if(am_parallel_for(ctx.num_blocks, num_workers,
+			   am_key_sort_extract, &ctx))
+	{
+		goto out_key_or;
+	}
+
+	if(num_elements < AM_KEY_SORT_RADIX_MIN_ELEMENTS)
+		am_key_sort_qsort_pairs(ctx.src, num_elements);
+	else if(am_key_sort_radix(&ctx, num_workers))
+		goto out_key_or;
+
+	if(am_parallel_for(ctx.num_blocks, num_workers,
+			   am_key_sort_gather, &ctx) ||
+	   am_parallel_for(ctx.num_blocks, num_workers,
+			   am_key_sort_copy_back, &ctx))
+	{
+		goto out_key_or;
+	}
+
+	ret = 0;
+
+out_key_or:
+	free(ctx.key_or);
+out_key_and:
+	free(ctx.key_and);
+out_hist:
+	free(ctx.hist);
+out_tmp:
+	free(ctx.tmp);
+out_pairs:
+	free(pairs);
+out:
+	return ret;
+}
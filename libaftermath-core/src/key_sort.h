@@ -0,0 +1,43 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_KEY_SORT_H
+#define AM_KEY_SORT_H
+
+#include <stddef.h>
+
+/* Functions sorting arrays of arbitrary elements in ascending order of an
+ * unsigned 64-bit key embedded in each element (e.g., the start timestamp of
+ * an interval). The sort is stable. Small arrays are sorted with quicksort,
+ * large arrays with a parallel LSD radix sort on the keys. In both cases, the
+ * keys are sorted together with the indexes of their elements and the elements
+ * are moved to their final positions in a single pass afterwards, such that
+ * large elements are copied only twice. */
+
+int am_key_sorted(const void* elements,
+		  size_t num_elements,
+		  size_t element_size,
+		  size_t key_offset);
+
+int am_key_sort(void* elements,
+		size_t num_elements,
+		size_t element_size,
+		size_t key_offset,
+		unsigned int num_workers);
+
+#endif
@@ -21,9 +21,22 @@
 
 #include <aftermath/core/typed_array.h>
 #include <aftermath/core/in_memory.h>
+#include <aftermath/core/interval_array.h>
 
 AM_DECL_TYPED_ARRAY(
 	am_openmp_iteration_period_array,
 	struct am_openmp_iteration_period)
 
+/* Initializes an interval column view ic for the intervals of the columnar
+ * representation c of an array of OpenMP iteration execution periods */
+static inline void am_openmp_iteration_period_columns_interval_view(
+	const struct am_openmp_iteration_period_columns* c,
+	struct am_interval_columns* ic)
+{
+	am_interval_columns_init_columnar(ic,
+					  c->interval_start,
+					  c->interval_end,
+					  c->num_elements);
+}
+
 #endif
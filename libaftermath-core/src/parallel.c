@@ -0,0 +1,139 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include <aftermath/core/parallel.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct am_parallel_for_state {
+	/* Next index to be dispatched */
+	size_t next;
+
+	/* Total number of indexes */
+	size_t n;
+
+	/* Set to 1 as soon as an invocation has failed */
+	int failed;
+
+	am_parallel_for_fun_t fun;
+	void* data;
+};
+
+struct am_parallel_for_worker {
+	struct am_parallel_for_state* state;
+	unsigned int id;
+	pthread_t thread;
+};
+
+/* Returns the number of online processors or 1 if the number cannot be
+ * determined. */
+unsigned int am_parallel_num_cpus(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if(n < 1)
+		return 1;
+
+	return n;
+}
+
+/* Repeatedly fetches the next index to process from the shared state until all
+ * indexes have been dispatched or until an invocation has failed. */
+static void* am_parallel_for_worker_run(void* arg)
+{
+	struct am_parallel_for_worker* w = arg;
+	struct am_parallel_for_state* s = w->state;
+	size_t idx;
+
+	while(!__atomic_load_n(&s->failed, __ATOMIC_RELAXED)) {
+		idx = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED);
+
+		if(idx >= s->n)
+			break;
+
+		if(s->fun(s->data, idx, w->id))
+			__atomic_store_n(&s->failed, 1, __ATOMIC_RELAXED);
+	}
+
+	return NULL;
+}
+
+/* Invokes fun(data, idx, worker) for each idx in [0; n) using at most
+ * num_workers threads, including the calling thread. Indexes are dispatched
+ * dynamically in increasing order, but may complete in any order. If num_workers
+ * is 0, one worker per online processor is used. If threads cannot be created,
+ * the work is distributed among the remaining threads.
+ *
+ * After the first failed invocation no further indexes are dispatched. Returns
+ * 0 if all invocations succeeded, otherwise 1. */
+int am_parallel_for(size_t n,
+		    unsigned int num_workers,
+		    am_parallel_for_fun_t fun,
+		    void* data)
+{
+	struct am_parallel_for_state s = {
+		.next = 0,
+		.n = n,
+		.failed = 0,
+		.fun = fun,
+		.data = data
+	};
+
+	struct am_parallel_for_worker* workers;
+	struct am_parallel_for_worker self;
+	unsigned int num_started = 0;
+
+	if(num_workers == 0)
+		num_workers = am_parallel_num_cpus();
+
+	if(num_workers > n)
+		num_workers = n;
+
+	self.state = &s;
+	self.id = 0;
+
+	if(num_workers > 1 &&
+	   (workers = calloc(num_workers - 1, sizeof(*workers))))
+	{
+		for(unsigned int i = 0; i < num_workers - 1; i++) {
+			workers[num_started].state = &s;
+			workers[num_started].id = num_started + 1;
+
+			if(pthread_create(&workers[num_started].thread, NULL,
+					  am_parallel_for_worker_run,
+					  &workers[num_started]))
+			{
+				break;
+			}
+
+			num_started++;
+		}
+
+		am_parallel_for_worker_run(&self);
+
+		for(unsigned int i = 0; i < num_started; i++)
+			pthread_join(workers[i].thread, NULL);
+
+		free(workers);
+	} else {
+		am_parallel_for_worker_run(&self);
+	}
+
+	return s.failed;
+}
@@ -0,0 +1,37 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_PARALLEL_H
+#define AM_PARALLEL_H
+
+#include <stddef.h>
+
+/* Function invoked by am_parallel_for for each index. Worker is the
+ * zero-indexed number of the thread executing the invocation, which can be used
+ * to access per-thread data without synchronization. Must return 0 on success,
+ * otherwise 1. */
+typedef int (*am_parallel_for_fun_t)(void* data, size_t idx, unsigned int worker);
+
+unsigned int am_parallel_num_cpus(void);
+
+int am_parallel_for(size_t n,
+		    unsigned int num_workers,
+		    am_parallel_for_fun_t fun,
+		    void* data);
+
+#endif
@@ -23,6 +23,7 @@
 #include <aftermath/core/in_memory.h>
 #include <aftermath/core/bsearch.h>
 #include <aftermath/core/interval_array.h>
+#include <aftermath/core/statistics/interval.h>
 
 AM_DECL_TYPED_ARRAY(am_state_event_array, struct am_state_event)
 
@@ -34,4 +35,33 @@ AM_DECL_INTERVAL_EVENT_ARRAY_BSEARCH_LAST_OVERLAPPING(am_state_event_array,
 						      struct am_state_event,
 						      interval)
 
+/* Initializes an interval column view ic for the intervals of the columnar
+ * representation c of an array of state events */
+static inline void
+am_state_event_columns_interval_view(const struct am_state_event_columns* c,
+				     struct am_interval_columns* ic)
+{
+	am_interval_columns_init_columnar(ic,
+					  c->interval_start,
+					  c->interval_end,
+					  c->num_elements);
+}
+
+/* Accumulates the durations of the state events of the columnar representation
+ * c that overlap with *query per state index. The result is identical to
+ * am_interval_stats_by_index_collect() on the array of state events c has been
+ * built from, but only the columns of the overlapping events are read. */
+static inline void
+am_state_event_columns_collect_stats(const struct am_state_event_columns* c,
+				     struct am_interval_stats_by_index* is,
+				     const struct am_interval* query)
+{
+	struct am_interval_columns ic;
+
+	am_state_event_columns_interval_view(c, &ic);
+	am_interval_stats_by_index_collect_columns(
+		is, query, &ic, c->state_idx,
+		sizeof(c->state_idx[0]), AM_SIZEOF_BITS(c->state_idx[0]));
+}
+
 #endif
@@ -45,6 +45,9 @@ enum am_histogram_bin_mode {
 	AM_HISTOGRAM_BIN_MODE_SAT
 };
 
+/* Number of independent accumulators used when scanning arrays of samples */
+#define AM_HISTOGRAM_BLOCK_SIZE 8
+
 #define AM_DECL_HISTOGRAM_1D_CLONE_FUN(SUFFIX)					\
 	static inline struct am_histogram1d_##SUFFIX*				\
 	am_histogram1d_##SUFFIX##_clone(struct am_histogram1d_##SUFFIX* h)	\
@@ -151,6 +154,43 @@ enum am_histogram_bin_mode {
 										\
 	AM_DECL_HISTOGRAM_1D_CLONE_FUN(SUFFIX)					\
 										\
+	/* Returns the bin for a sample whose distance to the left boundary of	\
+	 * the histogram is s_shifted_u. The sample must be within the range	\
+	 * of the histogram. */						\
+	static inline size_t							\
+	am_histogram1d_##SUFFIX##_shifted_bin(					\
+		const struct am_histogram1d_##SUFFIX* h, UT s_shifted_u)	\
+	{									\
+		/* Final bin number as a UT */					\
+		UT utbin;							\
+										\
+		/* Final bin number */						\
+		size_t bin;							\
+										\
+		if(sizeof(size_t) <= sizeof(UT)) {				\
+			/* The result is guaranteed to be in			\
+			 * [0; h->data.num_bins). Since h->num_bins is a size_t,\
+			 * this is guaranteed to be representable by a size_t.	\
+			 * Since sizeof(size_t) <= sizeof(UT), the muldiv	\
+			 * operation cannot produce a result that cannot be	\
+			 * represented by a UT. */				\
+			am_muldiv_u##BITS(s_shifted_u, (UT)h->data.num_bins,	\
+					  h->range, &utbin);			\
+										\
+			bin = (size_t)utbin;					\
+		} else {							\
+			/* Only using size_t with sizeof(size_t) > sizeof(UT),	\
+			 * so there is nothing that cannot be represented by a	\
+			 * size_t. */						\
+			AM_MACRO_ARG_EXPAND_JOIN(am_muldiv_u, AM_SIZE_BITS)(	\
+				(size_t)s_shifted_u,				\
+				h->data.num_bins,				\
+				(size_t)h->range, &bin);			\
+		}								\
+										\
+		return bin;							\
+	}									\
+										\
 	/* Adds a sample s to the histogram, i.e., increments the count for the \
 	 * corresponding bin by 1. Returns 0 on success, otherwise 1. */	\
 	static inline int							\
@@ -160,9 +200,6 @@ enum am_histogram_bin_mode {
 		/* Value of s - h->left */					\
 		UT s_shifted_u = 0;						\
 										\
-		/* Final bin number as a UT */					\
-		UT utbin;							\
-										\
 		/* Final bin number */						\
 		size_t bin;							\
 										\
@@ -189,26 +226,7 @@ enum am_histogram_bin_mode {
 								s);		\
 		}								\
 										\
-		if(sizeof(size_t) <= sizeof(UT)) {				\
-			/* The result is guaranteed to be in			\
-			 * [0; h->data.num_bins). Since h->num_bins is a size_t,\
-			 * this is guaranteed to be representable by a size_t.	\
-			 * Since sizeof(size_t) <= sizeof(UT), the muldiv	\
-			 * operation cannot produce a result that cannot be	\
-			 * represented by a UT. */				\
-			am_muldiv_u##BITS(s_shifted_u, (UT)h->data.num_bins,	\
-					  h->range, &utbin);			\
-										\
-			bin = (size_t)utbin;					\
-		} else {							\
-			/* Only using size_t with sizeof(size_t) > sizeof(UT),	\
-			 * so there is nothing that cannot be represented by a	\
-			 * size_t. */						\
-			AM_MACRO_ARG_EXPAND_JOIN(am_muldiv_u, AM_SIZE_BITS)(	\
-				(size_t)s_shifted_u,				\
-				h->data.num_bins,				\
-				(size_t)h->range, &bin);			\
-		}								\
+		bin = am_histogram1d_##SUFFIX##_shifted_bin(h, s_shifted_u);	\
 										\
 	assign:								\
 		if(am_add_sat_u64(h->data.bins[bin], 1, &h->data.bins[bin]) !=	\
@@ -218,6 +236,165 @@ enum am_histogram_bin_mode {
 		}								\
 										\
 		return 0;							\
+	}									\
+										\
+	/* Determines the minimum and maximum value of the n samples starting	\
+	 * at s and returns them in *min and *max. If n is 0, both values are	\
+	 * set to 0. The samples are scanned in blocks of			\
+	 * AM_HISTOGRAM_BLOCK_SIZE independent minima and maxima, such that	\
+	 * the loop can be vectorized by the compiler. */			\
+	static inline void							\
+	am_histogram1d_##SUFFIX##_find_min_max(const T* s, size_t n,		\
+					       T* min, T* max)		\
+	{									\
+		T bmin[AM_HISTOGRAM_BLOCK_SIZE];				\
+		T bmax[AM_HISTOGRAM_BLOCK_SIZE];				\
+		size_t i = 0;							\
+										\
+		if(n == 0) {							\
+			*min = 0;						\
+			*max = 0;						\
+			return;						\
+		}								\
+										\
+		for(size_t j = 0; j < AM_HISTOGRAM_BLOCK_SIZE; j++) {		\
+			bmin[j] = s[0];					\
+			bmax[j] = s[0];					\
+		}								\
+										\
+		for(; i + AM_HISTOGRAM_BLOCK_SIZE <= n;			\
+		    i += AM_HISTOGRAM_BLOCK_SIZE)				\
+		{								\
+			for(size_t j = 0; j < AM_HISTOGRAM_BLOCK_SIZE; j++) {	\
+				bmin[j] = (s[i+j] < bmin[j]) ? s[i+j] : bmin[j]; \
+				bmax[j] = (s[i+j] > bmax[j]) ? s[i+j] : bmax[j]; \
+			}							\
+		}								\
+										\
+		for(; i < n; i++) {						\
+			bmin[0] = (s[i] < bmin[0]) ? s[i] : bmin[0];		\
+			bmax[0] = (s[i] > bmax[0]) ? s[i] : bmax[0];		\
+		}								\
+										\
+		*min = bmin[0];						\
+		*max = bmax[0];						\
+										\
+		for(size_t j = 1; j < AM_HISTOGRAM_BLOCK_SIZE; j++) {		\
+			*min = (bmin[j] < *min) ? bmin[j] : *min;		\
+			*max = (bmax[j] > *max) ? bmax[j] : *max;		\
+		}								\
+	}									\
+										\
+	/* Adds the n samples starting at s to the histogram. The result is	\
+	 * identical to calling am_histogram1d_##SUFFIX##_add_sample() for	\
+	 * each sample, but instead of an overflow-safe multiplication and	\
+	 * division per sample, the bin is estimated using a precomputed	\
+	 * reciprocal of the bin width and then corrected using a table with	\
+	 * the first value of each bin. The counts are accumulated in a private \
+	 * array that is merged into the histogram at the end. Returns 0 on	\
+	 * success, otherwise 1. */						\
+	static inline int							\
+	am_histogram1d_##SUFFIX##_add_samples(					\
+		struct am_histogram1d_##SUFFIX* h, const T* s, size_t n)	\
+	{									\
+		size_t num_bins = h->data.num_bins;				\
+		uint64_t* counts;						\
+		UT* first;							\
+		UT s_shifted_u;						\
+		double scale;							\
+		double dfirst;							\
+		size_t bin;							\
+		int ret = 1;							\
+										\
+		/* Setting up the tables does not pay off for only a few	\
+		 * samples */							\
+		if(n < num_bins || n < AM_HISTOGRAM_BLOCK_SIZE) {		\
+			for(size_t i = 0; i < n; i++)				\
+				if(am_histogram1d_##SUFFIX##_add_sample(h, s[i])) \
+					return 1;				\
+										\
+			return 0;						\
+		}								\
+										\
+		if(!(counts = calloc(num_bins, sizeof(*counts))))		\
+			goto out;						\
+										\
+		if(!(first = malloc((num_bins + 1) * sizeof(*first))))		\
+			goto out_counts;					\
+										\
+		/* Determine the first shifted value of each bin: start from	\
+		 * an estimate and correct it using the exact bin function.	\
+		 * The additional entry at the end acts as a sentinel, as the	\
+		 * shifted values are always strictly lower than the range. */	\
+		for(size_t b = 0; b < num_bins; b++) {				\
+			dfirst = ((double)b * (double)h->range) /		\
+				(double)num_bins;				\
+										\
+			if(dfirst >= (double)h->range)				\
+				first[b] = h->range - 1;			\
+			else							\
+				first[b] = (UT)dfirst;				\
+										\
+			while(first[b] > 0 &&					\
+			      am_histogram1d_##SUFFIX##_shifted_bin(		\
+				      h, first[b] - 1) >= b)			\
+			{							\
+				first[b]--;					\
+			}							\
+										\
+			while(first[b] < h->range &&				\
+			      am_histogram1d_##SUFFIX##_shifted_bin(		\
+				      h, first[b]) < b)			\
+			{							\
+				first[b]++;					\
+			}							\
+		}								\
+										\
+		first[num_bins] = h->range;					\
+		scale = (double)num_bins / (double)h->range;			\
+										\
+		for(size_t i = 0; i < n; i++) {				\
+			if(s[i] < h->left || s[i] > h->right) {		\
+				if(h->mode == AM_HISTOGRAM_BIN_MODE_SAT) {	\
+					bin = (s[i] < h->left) ?		\
+						0 : num_bins - 1;		\
+					counts[bin]++;				\
+				}						\
+										\
+				continue;					\
+			}							\
+										\
+			s_shifted_u = (UT)((UT)s[i] - (UT)h->left);		\
+			bin = (size_t)((double)s_shifted_u * scale);		\
+										\
+			if(bin >= num_bins)					\
+				bin = num_bins - 1;				\
+										\
+			while(s_shifted_u < first[bin])			\
+				bin--;						\
+										\
+			while(s_shifted_u >= first[bin+1])			\
+				bin++;						\
+										\
+			counts[bin]++;						\
+		}								\
+										\
+		ret = 0;							\
+										\
+		for(size_t b = 0; b < num_bins; b++) {				\
+			if(am_add_sat_u64(h->data.bins[b], counts[b],		\
+					  &h->data.bins[b]) !=			\
+			   AM_ARITHMETIC_STATUS_EXACT)				\
+			{							\
+				ret = 1;					\
+			}							\
+		}								\
+										\
+		free(first);							\
+	out_counts:								\
+		free(counts);							\
+	out:									\
+		return ret;							\
 	}
 
 AM_DECL_INT_HISTOGRAM_1D( int8_t,  8,  int8, 1,  uint8_t)
@@ -325,5 +502,104 @@ assign:
 	return 0;
 }
 
+/* Determines the minimum and maximum value of the n samples starting at s and
+ * returns them in *min and *max. If n is 0, both values are set to 0. */
+static inline void am_histogram1d_double_find_min_max(const double* s, size_t n,
+						      double* min, double* max)
+{
+	double bmin[AM_HISTOGRAM_BLOCK_SIZE];
+	double bmax[AM_HISTOGRAM_BLOCK_SIZE];
+	size_t i = 0;
+
+	if(n == 0) {
+		*min = 0;
+		*max = 0;
+		return;
+	}
+
+	for(size_t j = 0; j < AM_HISTOGRAM_BLOCK_SIZE; j++) {
+		bmin[j] = s[0];
+		bmax[j] = s[0];
+	}
+
+	for(; i + AM_HISTOGRAM_BLOCK_SIZE <= n; i += AM_HISTOGRAM_BLOCK_SIZE) {
+		for(size_t j = 0; j < AM_HISTOGRAM_BLOCK_SIZE; j++) {
+			bmin[j] = (s[i+j] < bmin[j]) ? s[i+j] : bmin[j];
+			bmax[j] = (s[i+j] > bmax[j]) ? s[i+j] : bmax[j];
+		}
+	}
+
+	for(; i < n; i++) {
+		bmin[0] = (s[i] < bmin[0]) ? s[i] : bmin[0];
+		bmax[0] = (s[i] > bmax[0]) ? s[i] : bmax[0];
+	}
+
+	*min = bmin[0];
+	*max = bmax[0];
+
+	for(size_t j = 1; j < AM_HISTOGRAM_BLOCK_SIZE; j++) {
+		*min = (bmin[j] < *min) ? bmin[j] : *min;
+		*max = (bmax[j] > *max) ? bmax[j] : *max;
+	}
+}
+
+/* Adds the n samples starting at s to a 1D double histogram. The result is
+ * identical to calling am_histogram1d_double_add_sample() for each sample, but
+ * the counts are accumulated in a private array that is merged into the
+ * histogram at the end. Returns 0 on success, otherwise 1.
+ */
+static inline int
+am_histogram1d_double_add_samples(struct am_histogram1d_double* h,
+				  const double* s,
+				  size_t n)
+{
+	size_t num_bins = h->data.num_bins;
+	uint64_t* counts;
+	size_t bin;
+	int ret = 0;
+
+	if(n < num_bins) {
+		for(size_t i = 0; i < n; i++)
+			if(am_histogram1d_double_add_sample(h, s[i]))
+				return 1;
+
+		return 0;
+	}
+
+	if(!(counts = calloc(num_bins, sizeof(*counts))))
+		return 1;
+
+	for(size_t i = 0; i < n; i++) {
+		if(s[i] < h->left || s[i] > h->right) {
+			if(h->mode == AM_HISTOGRAM_BIN_MODE_SAT) {
+				bin = (s[i] < h->left) ? 0 : num_bins - 1;
+				counts[bin]++;
+			}
+
+			continue;
+		}
+
+		bin = (size_t)(((s[i] - h->left) / h->range) *
+			       ((double)num_bins));
+
+		/* Catch rounding errors */
+		if(bin >= num_bins)
+			bin = num_bins - 1;
+
+		counts[bin]++;
+	}
+
+	for(size_t b = 0; b < num_bins; b++) {
+		if(am_add_sat_u64(h->data.bins[b], counts[b], &h->data.bins[b]) !=
+		   AM_ARITHMETIC_STATUS_EXACT)
+		{
+			ret = 1;
+		}
+	}
+
+	free(counts);
+
+	return ret;
+}
 
 #endif
@@ -82,25 +82,59 @@ void am_interval_stats_by_index_collect(struct am_interval_stats_by_index* is,
 					off_t idx_field_offset,
 					unsigned int idx_bits)
 {
-	struct am_time_offset offs;
-	struct am_interval* i;
-	uint64_t idx;
+	struct am_interval_columns ic;
 
-	/* Prevent compiler from complaining about uninitialized variable */
-	idx = 0;
+	am_interval_columns_init_strided(&ic, arr, element_size,
+					 interval_field_offset);
 
-	am_interval_array_for_each_overlapping_uint_offs(arr,
-							 i,
-							 &idx,
-							 sizeof(idx)*8,
-							 element_size,
-							 interval_field_offset,
-							 idx_field_offset,
-							 idx_bits,
-							 query)
-	{
-		am_interval_intersection_duration(i, query, &offs);
-		am_timestamp_add_sat_offset(&is->times[idx], &offs);
+	am_interval_stats_by_index_collect_columns(
+		is, query, &ic,
+		AM_PTR_ADD(arr->elements, idx_field_offset),
+		element_size, idx_bits);
+}
+
+/* Accumulate the duration of all intervals of the interval column view ic that
+ * overlap with *query for the respective indexes. The index of the n-th
+ * interval is the unsigned integer of idx_bits bits at the address idx_column +
+ * n * idx_stride, such that both embedded index fields and separate index
+ * columns can be used. For intervals and indexes stored in separate columns,
+ * the loop only streams through the columns of the overlapping intervals.
+ */
+void am_interval_stats_by_index_collect_columns(
+	struct am_interval_stats_by_index* is,
+	const struct am_interval* query,
+	const struct am_interval_columns* ic,
+	const void* idx_column,
+	size_t idx_stride,
+	unsigned int idx_bits)
+{
+	am_timestamp_t start;
+	am_timestamp_t end;
+	uint64_t idx = 0;
+	size_t first;
+	size_t last;
+
+	last = am_interval_columns_overlapping_range(ic, query, &first);
+
+	for(size_t n = first; n < last; n++) {
+		/* Intersection with the query interval; the overlap check of
+		 * the binary search guarantees start <= end */
+		start = am_interval_columns_start(ic, n);
+		end = am_interval_columns_end(ic, n);
+
+		if(start < query->start)
+			start = query->start;
+
+		if(end > query->end)
+			end = query->end;
+
+		am_assign_uint(&idx, sizeof(idx)*8,
+			       AM_PTR_ADD(idx_column, n * idx_stride), idx_bits);
+
+		/* Same as am_interval_duration(): end and start are
+		 * included */
+		am_timestamp_add_sat(&is->times[idx], end - start);
+		am_timestamp_add_sat(&is->times[idx], 1);
 	}
 }
 
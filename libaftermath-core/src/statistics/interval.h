@@ -44,6 +44,14 @@ void am_interval_stats_by_index_collect(struct am_interval_stats_by_index* is,
 					off_t idx_field_offset,
 					unsigned int idx_bits);
 
+void am_interval_stats_by_index_collect_columns(
+	struct am_interval_stats_by_index* is,
+	const struct am_interval* query,
+	const struct am_interval_columns* ic,
+	const void* idx_column,
+	size_t idx_stride,
+	unsigned int idx_bits);
+
 void am_interval_stats_by_index_fun_collect(
 	struct am_interval_stats_by_index* is,
 	const struct am_interval* query,
@@ -0,0 +1,276 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include <aftermath/core/statistics/interval_summary.h>
+#include <aftermath/core/interval_array.h>
+#include <aftermath/core/ansi_extras.h>
+#include <aftermath/core/ptr.h>
+#include <aftermath/core/safe_alloc.h>
+
+/* Minimal number of elements between two checkpoints */
+#define AM_INTERVAL_SUMMARY_MIN_STRIDE 64
+
+/* Returns the address of the element with the index idx of an array of
+ * structures starting at elements */
+static inline void* am_interval_summary_element(void* elements,
+						size_t element_size,
+						size_t idx)
+{
+	return AM_PTR_ADD(elements, idx * element_size);
+}
+
+/* Reads the index field of the element e */
+static inline uint64_t am_interval_summary_index(void* e,
+						 off_t idx_field_offset,
+						 unsigned int idx_bits)
+{
+	uint64_t idx = 0;
+
+	am_assign_uint(&idx, sizeof(idx)*8,
+		       AM_PTR_ADD(e, idx_field_offset), idx_bits);
+
+	return idx;
+}
+
+/* Initializes an interval summary s for an array of structures arr, sorted by
+ * time. Element_size is the size in bytes of each array element,
+ * interval_field_offset the offset in bytes of the embedded interval of a
+ * structure, idx_field_offset is the offset of the index that the interval
+ * should account for and idx_bits is the width in bits of the index
+ * field. Max_index is the maximum index that can be accounted for.
+ *
+ * If an element's index exceeds max_index or if the cumulative duration of an
+ * index cannot be represented without saturation, the summary cannot provide
+ * exact results and the function fails.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_interval_summary_init(struct am_interval_summary* s,
+			     struct am_typed_array_generic* arr,
+			     size_t element_size,
+			     off_t interval_field_offset,
+			     off_t idx_field_offset,
+			     unsigned int idx_bits,
+			     size_t max_index)
+{
+	struct am_time_offset offs;
+	am_timestamp_t* curr;
+	size_t num_sums;
+	uint64_t idx;
+	void* e;
+
+	if(max_index == SIZE_MAX)
+		return 1;
+
+	s->arr = arr;
+	s->num_elements = arr->num_elements;
+	s->num_indexes = max_index + 1;
+
+	/* Keep the memory overhead of the checkpoints below two bytes per
+	 * element */
+	if(am_size_mul_safe(&s->stride, s->num_indexes, 4))
+		return 1;
+
+	if(s->stride < AM_INTERVAL_SUMMARY_MIN_STRIDE)
+		s->stride = AM_INTERVAL_SUMMARY_MIN_STRIDE;
+
+	s->num_checkpoints = s->num_elements / s->stride + 1;
+
+	/* One additional row for the elements after the last checkpoint */
+	if(am_size_mul_safe(&num_sums, s->num_checkpoints + 1, s->num_indexes))
+		return 1;
+
+	if(!(s->sums = am_alloc_array_safe(num_sums, sizeof(s->sums[0]))))
+		return 1;
+
+	/* Checkpoint 0 has no preceding elements; the sums for the elements
+	 * before checkpoint k are accumulated in row k */
+	memset(s->sums, 0, 2 * s->num_indexes * sizeof(s->sums[0]));
+	curr = &s->sums[s->num_indexes];
+
+	for(size_t i = 0; i < s->num_elements; i++) {
+		e = am_interval_summary_element(arr->elements, element_size, i);
+		idx = am_interval_summary_index(e, idx_field_offset, idx_bits);
+
+		if(idx > max_index)
+			goto out_err_free;
+
+		/* Next checkpoint starts with the sums of the previous one */
+		if(i > 0 && i % s->stride == 0) {
+			memcpy(curr + s->num_indexes, curr,
+			       s->num_indexes * sizeof(curr[0]));
+			curr += s->num_indexes;
+		}
+
+		if(am_interval_duration(AM_PTR_ADD(e, interval_field_offset),
+					&offs) != AM_ARITHMETIC_STATUS_EXACT ||
+		   am_timestamp_add_sat_offset(&curr[idx], &offs) !=
+		   AM_ARITHMETIC_STATUS_EXACT)
+		{
+			goto out_err_free;
+		}
+	}
+
+	return 0;
+
+out_err_free:
+	free(s->sums);
+	return 1;
+}
+
+void am_interval_summary_destroy(struct am_interval_summary* s)
+{
+	free(s->sums);
+}
+
+/* Accumulates the full durations of the elements [start; end[ of the array
+ * summarized by s by iterating over the elements. */
+static inline void
+am_interval_summary_collect_elements(const struct am_interval_summary* s,
+				     struct am_interval_stats_by_index* is,
+				     size_t start,
+				     size_t end,
+				     size_t element_size,
+				     off_t interval_field_offset,
+				     off_t idx_field_offset,
+				     unsigned int idx_bits)
+{
+	struct am_time_offset offs;
+	uint64_t idx;
+	void* e;
+
+	for(size_t i = start; i < end; i++) {
+		e = am_interval_summary_element(s->arr->elements,
+						element_size, i);
+		idx = am_interval_summary_index(e, idx_field_offset, idx_bits);
+
+		am_interval_duration(AM_PTR_ADD(e, interval_field_offset),
+				     &offs);
+		am_timestamp_add_sat_offset(&is->times[idx], &offs);
+	}
+}
+
+/* Accumulates the full durations of the elements [start; end[ of the array
+ * summarized by s using the checkpoints of the summary. */
+static void
+am_interval_summary_collect_range(const struct am_interval_summary* s,
+				  struct am_interval_stats_by_index* is,
+				  size_t start,
+				  size_t end,
+				  size_t element_size,
+				  off_t interval_field_offset,
+				  off_t idx_field_offset,
+				  unsigned int idx_bits)
+{
+	size_t ck_start = (start + s->stride - 1) / s->stride;
+	size_t ck_end = end / s->stride;
+	const am_timestamp_t* sums_start;
+	const am_timestamp_t* sums_end;
+
+	/* No checkpoint pair in range: iterate over the elements */
+	if(ck_start >= ck_end) {
+		am_interval_summary_collect_elements(s, is, start, end,
+						     element_size,
+						     interval_field_offset,
+						     idx_field_offset,
+						     idx_bits);
+		return;
+	}
+
+	am_interval_summary_collect_elements(s, is, start, ck_start * s->stride,
+					     element_size,
+					     interval_field_offset,
+					     idx_field_offset,
+					     idx_bits);
+
+	sums_start = &s->sums[ck_start * s->num_indexes];
+	sums_end = &s->sums[ck_end * s->num_indexes];
+
+	for(size_t idx = 0; idx < s->num_indexes; idx++) {
+		am_timestamp_add_sat(&is->times[idx],
+				     sums_end[idx] - sums_start[idx]);
+	}
+
+	am_interval_summary_collect_elements(s, is, ck_end * s->stride, end,
+					     element_size,
+					     interval_field_offset,
+					     idx_field_offset,
+					     idx_bits);
+}
+
+/* Accumulates the duration of all intervals overlapping with *query for the
+ * respective indexes of the array summarized by s. The remaining parameters
+ * must be identical to the ones used for the initialization of the summary and
+ * the maximum index of is must be at least the maximum index of the summary.
+ *
+ * The result is identical to the one of
+ * am_interval_stats_by_index_collect().
+ */
+void am_interval_summary_collect(const struct am_interval_summary* s,
+				 struct am_interval_stats_by_index* is,
+				 const struct am_interval* query,
+				 size_t element_size,
+				 off_t interval_field_offset,
+				 off_t idx_field_offset,
+				 unsigned int idx_bits)
+{
+	struct am_interval* first_field;
+	struct am_interval* first;
+	struct am_interval* last;
+	struct am_time_offset offs;
+	size_t first_idx;
+	size_t last_idx;
+	uint64_t idx;
+
+	first_field = AM_PTR_ADD(s->arr->elements, interval_field_offset);
+
+	first = am_interval_array_bsearch_first_strided_overlapping(
+		first_field, s->num_elements, element_size, query);
+
+	if(!first)
+		return;
+
+	last = am_interval_array_bsearch_last_strided_overlapping(
+		first_field, s->num_elements, element_size, query);
+
+	first_idx = ((char*)first - (char*)first_field) / element_size;
+	last_idx = ((char*)last - (char*)first_field) / element_size;
+
+	/* The first and last overlapping elements might only partially overlap
+	 * with the query interval */
+	idx = am_interval_summary_index(AM_PTR_SUB(first, interval_field_offset),
+					idx_field_offset, idx_bits);
+	am_interval_intersection_duration(first, query, &offs);
+	am_timestamp_add_sat_offset(&is->times[idx], &offs);
+
+	if(last_idx == first_idx)
+		return;
+
+	idx = am_interval_summary_index(AM_PTR_SUB(last, interval_field_offset),
+					idx_field_offset, idx_bits);
+	am_interval_intersection_duration(last, query, &offs);
+	am_timestamp_add_sat_offset(&is->times[idx], &offs);
+
+	/* All elements in between are entirely included in the query
+	 * interval */
+	am_interval_summary_collect_range(s, is, first_idx + 1, last_idx,
+					  element_size,
+					  interval_field_offset,
+					  idx_field_offset,
+					  idx_bits);
+}
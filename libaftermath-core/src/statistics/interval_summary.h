@@ -0,0 +1,112 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_STATISTICS_INTERVAL_SUMMARY_H
+#define AM_STATISTICS_INTERVAL_SUMMARY_H
+
+#include <aftermath/core/base_types.h>
+#include <aftermath/core/bsearch.h>
+#include <aftermath/core/typed_array.h>
+#include <aftermath/core/statistics/interval.h>
+
+/* An interval summary is a precomputed, exact representation of the per-index
+ * durations of the intervals of an array of structures sorted by time, whose
+ * intervals do not overlap. Every stride elements, the summary stores a
+ * checkpoint with the cumulative per-index durations of all preceding
+ * elements. The accumulated per-index durations for a query interval can thus
+ * be obtained by clipping the first and last overlapping elements and by
+ * subtracting two checkpoints for the elements in between, plus at most
+ * 2*stride elements at the borders. The result is identical to
+ * am_interval_stats_by_index_collect(), but its cost does not depend on the
+ * number of elements overlapping with the query interval.
+ */
+struct am_interval_summary {
+	/* Array the summary has been built for */
+	struct am_typed_array_generic* arr;
+
+	/* Number of elements of the array when the summary was built */
+	size_t num_elements;
+
+	/* Number of elements between two checkpoints */
+	size_t stride;
+
+	/* Number of indexes per checkpoint (max_index + 1) */
+	size_t num_indexes;
+
+	/* Number of checkpoints */
+	size_t num_checkpoints;
+
+	/* (num_checkpoints + 1) * num_indexes cumulative durations;
+	 * Checkpoint k holds the per-index durations of the elements
+	 * [0; k*stride[. The last row is only used during initialization. */
+	am_timestamp_t* sums;
+};
+
+int am_interval_summary_init(struct am_interval_summary* s,
+			     struct am_typed_array_generic* arr,
+			     size_t element_size,
+			     off_t interval_field_offset,
+			     off_t idx_field_offset,
+			     unsigned int idx_bits,
+			     size_t max_index);
+
+void am_interval_summary_destroy(struct am_interval_summary* s);
+
+void am_interval_summary_collect(const struct am_interval_summary* s,
+				 struct am_interval_stats_by_index* is,
+				 const struct am_interval* query,
+				 size_t element_size,
+				 off_t interval_field_offset,
+				 off_t idx_field_offset,
+				 unsigned int idx_bits);
+
+/* Returns true if the summary s is still valid for the array arr and if it
+ * provides durations for the indexes up to max_index, otherwise false. */
+static inline int
+am_interval_summary_valid_p(const struct am_interval_summary* s,
+			    const struct am_typed_array_generic* arr,
+			    size_t max_index)
+{
+	return s->arr == arr &&
+		s->num_elements == arr->num_elements &&
+		s->num_indexes == max_index + 1;
+}
+
+AM_DECL_TYPED_ARRAY_WITH_ELEMENT_DESTRUCTOR(am_interval_summary_array,
+					   struct am_interval_summary,
+					   am_interval_summary_destroy)
+
+#define AM_INTERVAL_SUMMARY_ACC_ARR(x) ((x).arr)
+
+AM_DECL_TYPED_ARRAY_BSEARCH(am_interval_summary_array,
+			    struct am_interval_summary,
+			    struct am_typed_array_generic*,
+			    AM_INTERVAL_SUMMARY_ACC_ARR,
+			    AM_VALCMP_EXPR)
+
+AM_DECL_TYPED_ARRAY_INSERTPOS(am_interval_summary_array,
+			      struct am_interval_summary,
+			      struct am_typed_array_generic*,
+			      AM_INTERVAL_SUMMARY_ACC_ARR,
+			      AM_VALCMP_EXPR)
+
+AM_DECL_TYPED_ARRAY_RESERVE_SORTED(am_interval_summary_array,
+				   struct am_interval_summary,
+				   struct am_typed_array_generic*)
+
+#endif
@@ -18,6 +18,8 @@
 
 #include <aftermath/core/trace.h>
 #include <aftermath/core/default_trace_array_registry.h>
+#include <aftermath/core/key_sort.h>
+#include <aftermath/core/parallel.h>
 
 int am_trace_init(struct am_trace* t, const char* filename)
 {
@@ -31,6 +33,7 @@ int am_trace_init(struct am_trace* t, const char* filename)
 	am_array_registry_init(&t->array_registry);
 	am_array_collection_init(&t->trace_arrays);
 	am_hierarchyp_array_init(&t->hierarchies);
+	t->column_store = NULL;
 
 	if(am_build_default_trace_array_registry(&t->array_registry)) {
 		am_trace_destroy(t);
@@ -42,6 +45,12 @@ int am_trace_init(struct am_trace* t, const char* filename)
 
 void am_trace_destroy(struct am_trace* t)
 {
+	/* Mapped arrays must be reset before the arrays are destroyed */
+	if(t->column_store) {
+		am_column_store_destroy(t->column_store);
+		free(t->column_store);
+	}
+
 	am_array_collection_destroy(&t->trace_arrays, &t->array_registry);
 
 	am_hierarchyp_array_destroy_elements(&t->hierarchies);
@@ -85,3 +94,217 @@ void* am_trace_find_or_add_trace_array(struct am_trace* t, const char* type)
 
 	return a;
 }
+
+/* Adds a single relocatable array to the column store passed in data */
+static int am_trace_spill_array(struct am_typed_array_generic* a,
+				size_t element_size,
+				void* data)
+{
+	return am_column_store_add(data, a, element_size);
+}
+
+/* Moves the elements of all relocatable per-event-collection arrays of a
+ * completely loaded trace to an mmapped cache file, such that the event data no
+ * longer resides on the heap. The cache file is created in the directory of
+ * path_prefix and their names start with its last component. If path_prefix
+ * is NULL, the filename of the trace is used as the prefix.
+ *
+ * Arrays that have already been moved are skipped, such that the function may
+ * be called again after further arrays have been added. Once moved, the arrays
+ * must not be modified in size anymore.
+ *
+ * Returns 0 on success, otherwise 1. On failure, all arrays remain valid, but
+ * some of them may have been moved.
+ */
+int am_trace_spill_event_arrays(struct am_trace* t, const char* path_prefix)
+{
+	struct am_event_collection* ecoll;
+	struct am_array_collection_entry* ace;
+
+	if(!t->column_store) {
+		if(!(t->column_store = malloc(sizeof(*t->column_store))))
+			return 1;
+
+		am_column_store_init(t->column_store);
+	}
+
+	if(t->column_store->fd == -1 &&
+	   am_column_store_open(t->column_store,
+				path_prefix ? path_prefix : t->filename))
+	{
+		return 1;
+	}
+
+	am_trace_for_each_event_collection(t, ecoll) {
+		for(size_t i = 0; i < ecoll->event_arrays.num_elements; i++) {
+			ace = &ecoll->event_arrays.elements[i];
+
+			if(am_array_registry_for_each_relocatable(
+				   &t->array_registry, ace->type, ace->array,
+				   am_trace_spill_array, t->column_store))
+			{
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Number of elements whose order is verified by a single invocation of
+ * am_trace_check_chunk() */
+#define AM_TRACE_SORT_CHECK_CHUNK_ELEMENTS 65536
+
+/* Sortable array of an event collection */
+struct am_trace_sort_array {
+	struct am_typed_array_generic* a;
+	size_t element_size;
+	size_t key_offset;
+	int unsorted;
+};
+
+AM_DECL_TYPED_ARRAY(am_trace_sort_array_array, struct am_trace_sort_array)
+
+/* Range of elements of a sortable array whose order is verified at once */
+struct am_trace_sort_chunk {
+	struct am_trace_sort_array* array;
+	size_t begin;
+	size_t end;
+};
+
+AM_DECL_TYPED_ARRAY(am_trace_sort_chunk_array, struct am_trace_sort_chunk)
+
+/* Adds a single sortable array to the array of sortable arrays passed in
+ * data */
+static int am_trace_add_sort_array(struct am_typed_array_generic* a,
+				   size_t element_size,
+				   size_t key_offset,
+				   void* data)
+{
+	struct am_trace_sort_array_array* arrays = data;
+	struct am_trace_sort_array sa = {
+		.a = a,
+		.element_size = element_size,
+		.key_offset = key_offset,
+		.unsorted = 0
+	};
+
+	if(a->num_elements < 2)
+		return 0;
+
+	return am_trace_sort_array_array_append(arrays, sa);
+}
+
+/* Verifies the order of the elements of a chunk, including the order of the
+ * first element of the chunk with respect to the last element of the preceding
+ * chunk */
+static int am_trace_check_chunk(void* data, size_t idx, unsigned int worker)
+{
+	struct am_trace_sort_chunk* c =
+		&((struct am_trace_sort_chunk_array*)data)->elements[idx];
+	struct am_trace_sort_array* sa = c->array;
+	size_t begin = (c->begin > 0) ? c->begin - 1 : 0;
+
+	if(!am_key_sorted(AM_PTR_ADD(sa->a->elements,
+				     begin * sa->element_size),
+			  c->end - begin,
+			  sa->element_size,
+			  sa->key_offset))
+	{
+		__atomic_store_n(&sa->unsorted, 1, __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+/* Verifies that the elements of all sortable per-event-collection arrays (e.g.,
+ * state events sorted by their start timestamp) are in ascending order, as
+ * assumed by the binary searches on these arrays, and sorts the arrays whose
+ * elements are not. Traces whose events have been merged from multiple
+ * threads into a single event collection may, for example, violate the order.
+ *
+ * Verification is carried out in parallel on chunks of all arrays; unsorted
+ * arrays are sorted with am_key_sort(). At most num_workers threads are used;
+ * if num_workers is 0, one thread per online processor is used. The arrays
+ * must not have been moved out of core. If num_sorted is non-NULL, the number
+ * of arrays that had to be sorted is stored in *num_sorted.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_trace_sort_event_arrays(struct am_trace* t,
+			       unsigned int num_workers,
+			       size_t* num_sorted)
+{
+	struct am_trace_sort_array_array arrays;
+	struct am_trace_sort_chunk_array chunks;
+	struct am_trace_sort_chunk c;
+	struct am_trace_sort_array* sa;
+	struct am_event_collection* ecoll;
+	struct am_array_collection_entry* ace;
+	size_t nsorted = 0;
+	size_t n;
+	int ret = 1;
+
+	am_trace_sort_array_array_init(&arrays);
+	am_trace_sort_chunk_array_init(&chunks);
+
+	am_trace_for_each_event_collection(t, ecoll) {
+		for(size_t i = 0; i < ecoll->event_arrays.num_elements; i++) {
+			ace = &ecoll->event_arrays.elements[i];
+
+			if(am_array_registry_for_each_sortable(
+				   &t->array_registry, ace->type, ace->array,
+				   am_trace_add_sort_array, &arrays))
+			{
+				goto out;
+			}
+		}
+	}
+
+	for(size_t i = 0; i < arrays.num_elements; i++) {
+		sa = &arrays.elements[i];
+		n = sa->a->num_elements;
+
+		for(size_t b = 0; b < n; b += AM_TRACE_SORT_CHECK_CHUNK_ELEMENTS) {
+			c.array = sa;
+			c.begin = b;
+			c.end = (n - b > AM_TRACE_SORT_CHECK_CHUNK_ELEMENTS) ?
+				b + AM_TRACE_SORT_CHECK_CHUNK_ELEMENTS : n;
+
+			if(am_trace_sort_chunk_array_append(&chunks, c))
+				goto out;
+		}
+	}
+
+	if(am_parallel_for(chunks.num_elements, num_workers,
+			   am_trace_check_chunk, &chunks))
+	{
+		goto out;
+	}
+
+	for(size_t i = 0; i < arrays.num_elements; i++) {
+		sa = &arrays.elements[i];
+
+		if(!sa->unsorted)
+			continue;
+
+		if(am_key_sort(sa->a->elements, sa->a->num_elements,
+			       sa->element_size, sa->key_offset, num_workers))
+		{
+			goto out;
+		}
+
+		nsorted++;
+	}
+
+	if(num_sorted)
+		*num_sorted = nsorted;
+
+	ret = 0;
+
+out:
+	am_trace_sort_chunk_array_destroy(&chunks);
+	am_trace_sort_array_array_destroy(&arrays);
+
+	return ret;
+}
@@ -23,6 +23,7 @@
 #include <aftermath/core/event_collection.h>
 #include <aftermath/core/event_collection_array.h>
 #include <aftermath/core/array_registry.h>
+#include <aftermath/core/column_store.h>
 
 struct am_trace {
 	char* filename;
@@ -35,6 +36,10 @@ struct am_trace {
 
 	struct am_array_registry array_registry;
 	struct am_array_collection trace_arrays;
+
+	/* Out-of-core storage for event arrays; NULL if all arrays reside on
+	 * the heap */
+	struct am_column_store* column_store;
 };
 
 #define am_trace_for_each_event_collection(t, coll) \
@@ -44,6 +49,10 @@ struct am_trace {
 
 int am_trace_init(struct am_trace* t, const char* filename);
 void am_trace_destroy(struct am_trace* t);
+int am_trace_spill_event_arrays(struct am_trace* t, const char* path_prefix);
+int am_trace_sort_event_arrays(struct am_trace* t,
+			       unsigned int num_workers,
+			       size_t* num_sorted);
 
 /* Finds a per-trace array by type. Returns a pointer to the array or NULL if no
  * such array is associated with the trace. */
@@ -0,0 +1,1578 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "trace_cache.h"
+#include <aftermath/core/counter_event_array_collection.h>
+#include <aftermath/core/hierarchy_array.h>
+#include <aftermath/core/qsort.h>
+#include <aftermath/core/safe_alloc.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define AM_TRACE_CACHE_MAGIC "AMTCACHE"
+#define AM_TRACE_CACHE_VERSION 1
+#define AM_TRACE_CACHE_SUFFIX ".amcache"
+
+/* Marks the absence of an array or a parent node in the structure */
+#define AM_TRACE_CACHE_NONE UINT64_MAX
+
+/* Per-event-collection arrays of counter events are stored as a collection of
+ * arrays of counter events, one for each counter */
+#define AM_TRACE_CACHE_COUNTER_EVENT_IDENT "am::core::counter_event"
+
+/* Number of elements converted at once when writing elements with fields that
+ * need to be relocated */
+#define AM_TRACE_CACHE_CHUNK_ELEMENTS 4096
+
+enum am_trace_cache_array_kind {
+	/* Single array identified by a descriptor */
+	AM_TRACE_CACHE_ARRAY_PLAIN = 0,
+
+	/* Counter event array collection with one descriptor per counter */
+	AM_TRACE_CACHE_ARRAY_COUNTERS = 1
+};
+
+struct am_trace_cache_header {
+	char magic[8];
+	uint64_t version;
+
+	/* Hash over the layouts of all in-memory types */
+	uint64_t layout_hash;
+
+	/* Size and modification time of the trace file */
+	uint64_t trace_size;
+	uint64_t trace_mtime_sec;
+	uint64_t trace_mtime_nsec;
+
+	uint64_t bounds_start;
+	uint64_t bounds_end;
+
+	uint64_t num_arrays;
+	uint64_t arrays_offset;
+
+	/* Size of the string table in bytes */
+	uint64_t strings_offset;
+	uint64_t strings_size;
+
+	/* Size of the structure in 64-bit words */
+	uint64_t structure_offset;
+	uint64_t structure_size;
+};
+
+/* Describes the elements of a single array */
+struct am_trace_cache_array_desc {
+	/* Index of the layout in am_trace_cache_layouts */
+	uint64_t layout;
+
+	uint64_t num_elements;
+	uint64_t offset;
+
+	/* Ordinal of the first element; ordinals are assigned contiguously in
+	 * the order of the descriptors starting with 1, such that 0 represents
+	 * a NULL pointer */
+	uint64_t first_ordinal;
+};
+
+/* An array of the trace to be written to the cache */
+struct am_trace_cache_array_ref {
+	struct am_typed_array_generic* array;
+	const struct am_trace_cache_layout* layout;
+	uint64_t first_ordinal;
+};
+
+AM_DECL_TYPED_ARRAY(am_trace_cache_array_ref_array,
+		    struct am_trace_cache_array_ref)
+
+/* Address range of the elements of an array to be written */
+struct am_trace_cache_range {
+	uintptr_t start;
+	uintptr_t end;
+	size_t element_size;
+	uint64_t first_ordinal;
+};
+
+#define AM_TRACE_CACHE_CMP_RANGE_START(pa, pb)		\
+	((pa)->start > (pb)->start) ? 1 :		\
+	  (((pa)->start < (pb)->start) ? -1 : 0)
+
+AM_DECL_QSORT_SUFFIX(am_trace_cache_, _ranges, struct am_trace_cache_range,
+		     AM_TRACE_CACHE_CMP_RANGE_START)
+AM_DECL_TYPED_ARRAY(am_trace_cache_word_array, uint64_t)
+AM_DECL_TYPED_ARRAY(am_trace_cache_char_array, char)
+
+struct am_trace_cache_writer {
+	struct am_trace* trace;
+	struct am_trace_cache_array_ref_array arrays;
+
+	/* Address ranges of the arrays, sorted by start address */
+	struct am_trace_cache_range* ranges;
+
+	struct am_trace_cache_char_array strings;
+	struct am_trace_cache_word_array structure;
+	uint64_t next_ordinal;
+};
+
+/* Returns the layout for the type identified by ident or NULL if no such
+ * layout exists. */
+static const struct am_trace_cache_layout*
+am_trace_cache_find_layout(const char* ident)
+{
+	size_t start = 0;
+	size_t end = am_trace_cache_num_layouts;
+	size_t mid;
+	int cmp;
+
+	while(start < end) {
+		mid = start + (end - start) / 2;
+		cmp = strcmp(ident, am_trace_cache_layouts[mid].ident);
+
+		if(cmp == 0)
+			return &am_trace_cache_layouts[mid];
+		else if(cmp < 0)
+			end = mid;
+		else
+			start = mid + 1;
+	}
+
+	return NULL;
+}
+
+/* Updates a 64-bit FNV-1a hash with size bytes at data */
+static uint64_t am_trace_cache_hash(uint64_t h, const void* data, size_t size)
+{
+	const unsigned char* p = data;
+
+	for(size_t i = 0; i < size; i++)
+		h = (h ^ p[i]) * UINT64_C(1099511628211);
+
+	return h;
+}
+
+/* Returns a hash over the version of the cache format and the layouts of all
+ * in-memory types */
+static uint64_t am_trace_cache_layout_hash(void)
+{
+	const struct am_trace_cache_layout* l;
+	uint64_t h = UINT64_C(14695981039346656037);
+	uint64_t vals[4];
+
+	vals[0] = AM_TRACE_CACHE_VERSION;
+	vals[1] = sizeof(void*);
+	vals[2] = sizeof(struct am_counter_event_array);
+	vals[3] = am_trace_cache_num_layouts;
+	h = am_trace_cache_hash(h, vals, sizeof(vals));
+
+	for(size_t i = 0; i < am_trace_cache_num_layouts; i++) {
+		l = &am_trace_cache_layouts[i];
+
+		vals[0] = l->element_size;
+		vals[1] = l->num_fields;
+		vals[2] = l->supported;
+		h = am_trace_cache_hash(h, l->ident, strlen(l->ident) + 1);
+		h = am_trace_cache_hash(h, vals, 3 * sizeof(vals[0]));
+
+		for(size_t j = 0; j < l->num_fields; j++) {
+			vals[0] = l->fields[j].kind;
+			vals[1] = l->fields[j].offset;
+			h = am_trace_cache_hash(h, vals, 2 * sizeof(vals[0]));
+		}
+	}
+
+	return h;
+}
+
+/* Returns the default name of the cache file for a trace file in a newly
+ * allocated string or NULL on failure. */
+char* am_trace_cache_filename(const char* trace_filename)
+{
+	size_t len = strlen(trace_filename);
+	char* ret;
+
+	if(am_size_add_safe(&len, len, sizeof(AM_TRACE_CACHE_SUFFIX)))
+		return NULL;
+
+	if(!(ret = malloc(len)))
+		return NULL;
+
+	strcpy(ret, trace_filename);
+	strcat(ret, AM_TRACE_CACHE_SUFFIX);
+
+	return ret;
+}
+
+/******************************************************************************/
+/* Writing                                                                    */
+/******************************************************************************/
+
+static int am_trace_cache_push_word(struct am_trace_cache_writer* w,
+				    uint64_t word)
+{
+	return am_trace_cache_word_array_append(&w->structure, word);
+}
+
+/* Adds a string to the string table and stores a reference to the string in
+ * *ref. References are offsets into the table plus one, such that a NULL
+ * pointer is represented by 0. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_add_string(struct am_trace_cache_writer* w,
+				     const char* str,
+				     uint64_t* ref)
+{
+	size_t len;
+
+	if(!str) {
+		*ref = 0;
+		return 0;
+	}
+
+	len = strlen(str) + 1;
+
+	if(am_trace_cache_char_array_prealloc_n(&w->strings, len))
+		return 1;
+
+	memcpy(&w->strings.elements[w->strings.num_elements], str, len);
+	*ref = w->strings.num_elements + 1;
+	w->strings.num_elements += len;
+	w->strings.num_free -= len;
+
+	return 0;
+}
+
+static int am_trace_cache_push_string(struct am_trace_cache_writer* w,
+				      const char* str)
+{
+	uint64_t ref;
+
+	if(am_trace_cache_add_string(w, str, &ref))
+		return 1;
+
+	return am_trace_cache_push_word(w, ref);
+}
+
+/* Registers a single array with the layout l for writing and adds the index of
+ * its descriptor to the structure. Returns 0 on success, 1 on failure and 2 if
+ * the array cannot be cached. */
+static int am_trace_cache_collect_plain(struct am_trace_cache_writer* w,
+					const struct am_trace_cache_layout* l,
+					struct am_typed_array_generic* a)
+{
+	struct am_trace_cache_array_ref ref;
+
+	if(a->num_elements == 0)
+		return am_trace_cache_push_word(w, AM_TRACE_CACHE_NONE);
+
+	if(!l || !l->supported)
+		return 2;
+
+	ref.array = a;
+	ref.layout = l;
+	ref.first_ordinal = w->next_ordinal;
+
+	if(am_size_add_safe(&w->next_ordinal, w->next_ordinal, a->num_elements))
+		return 1;
+
+	if(am_trace_cache_push_word(w, w->arrays.num_elements))
+		return 1;
+
+	return am_trace_cache_array_ref_array_append(&w->arrays, ref);
+}
+
+/* Registers the array a of type ident for writing and adds its description to
+ * the structure. Returns 0 on success, 1 on failure and 2 if the array cannot
+ * be cached. */
+static int am_trace_cache_collect_array(struct am_trace_cache_writer* w,
+					const char* ident,
+					struct am_typed_array_generic* a)
+{
+	const struct am_trace_cache_layout* l = am_trace_cache_find_layout(ident);
+	struct am_counter_event_array_collection* c;
+	int ret;
+
+	if(am_trace_cache_push_string(w, ident))
+		return 1;
+
+	if(strcmp(ident, AM_TRACE_CACHE_COUNTER_EVENT_IDENT) != 0) {
+		if(am_trace_cache_push_word(w, AM_TRACE_CACHE_ARRAY_PLAIN))
+			return 1;
+
+		return am_trace_cache_collect_plain(w, l, a);
+	}
+
+	c = (struct am_counter_event_array_collection*)a;
+
+	if(am_trace_cache_push_word(w, AM_TRACE_CACHE_ARRAY_COUNTERS) ||
+	   am_trace_cache_push_word(w, c->num_elements))
+	{
+		return 1;
+	}
+
+	for(size_t i = 0; i < c->num_elements; i++) {
+		if(am_trace_cache_push_word(w, c->elements[i].counter_id))
+			return 1;
+
+		if((ret = am_trace_cache_collect_plain(
+			    w, l, AM_TYPED_ARRAY_GENERIC(&c->elements[i]))))
+		{
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Adds all arrays of an array collection to the structure. Returns 0 on
+ * success, 1 on failure and 2 if any array cannot be cached. */
+static int am_trace_cache_collect_arrays(struct am_trace_cache_writer* w,
+					 struct am_array_collection* ac)
+{
+	int ret;
+
+	if(am_trace_cache_push_word(w, ac->num_elements))
+		return 1;
+
+	for(size_t i = 0; i < ac->num_elements; i++) {
+		if((ret = am_trace_cache_collect_array(w,
+						       ac->elements[i].type,
+						       ac->elements[i].array)))
+		{
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Adds the node n and its descendants in pre-order to the structure. The index
+ * of the node in pre-order is *idx, the one of its parent parent_idx. Returns
+ * 0 on success, 1 on failure and 2 if an event mapping refers to a collection
+ * that is not part of the trace. */
+static int am_trace_cache_collect_node(struct am_trace_cache_writer* w,
+				       struct am_hierarchy_node* n,
+				       uint64_t parent_idx,
+				       uint64_t* idx)
+{
+	struct am_event_mapping_element* e;
+	struct am_hierarchy_node* child;
+	uint64_t self_idx = (*idx)++;
+	int ret;
+
+	if(am_trace_cache_push_string(w, n->name) ||
+	   am_trace_cache_push_word(w, n->id) ||
+	   am_trace_cache_push_word(w, parent_idx) ||
+	   am_trace_cache_push_word(w, n->event_mapping.mappings.num_elements))
+	{
+		return 1;
+	}
+
+	for(size_t i = 0; i < n->event_mapping.mappings.num_elements; i++) {
+		e = &n->event_mapping.mappings.elements[i];
+
+		/* Collections are referenced by their index */
+		if(!am_event_collection_array_is_element_ptr(
+			   &w->trace->event_collections, e->collection))
+		{
+			return 2;
+		}
+
+		if(am_trace_cache_push_word(w, e->interval.start) ||
+		   am_trace_cache_push_word(w, e->interval.end) ||
+		   am_trace_cache_push_word(
+			   w, am_event_collection_array_index(
+				   &w->trace->event_collections,
+				   e->collection)))
+		{
+			return 1;
+		}
+	}
+
+	am_hierarchy_node_for_each_child(n, child)
+		if((ret = am_trace_cache_collect_node(w, child, self_idx, idx)))
+			return ret;
+
+	return 0;
+}
+
+/* Builds the structure of the trace and registers all arrays for writing.
+ * Returns 0 on success, 1 on failure and 2 if the trace cannot be cached. */
+static int am_trace_cache_collect(struct am_trace_cache_writer* w)
+{
+	struct am_trace* t = w->trace;
+	struct am_event_collection* ecoll;
+	struct am_hierarchy* h;
+	uint64_t idx;
+	int ret;
+
+	if(am_trace_cache_push_word(w, t->event_collections.num_elements))
+		return 1;
+
+	am_trace_for_each_event_collection(t, ecoll) {
+		if(am_trace_cache_push_word(w, ecoll->id) ||
+		   am_trace_cache_push_string(w, ecoll->name))
+		{
+			return 1;
+		}
+
+		if((ret = am_trace_cache_collect_arrays(w, &ecoll->event_arrays)))
+			return ret;
+	}
+
+	if((ret = am_trace_cache_collect_arrays(w, &t->trace_arrays)))
+		return ret;
+
+	if(am_trace_cache_push_word(w, t->hierarchies.num_elements))
+		return 1;
+
+	for(size_t i = 0; i < t->hierarchies.num_elements; i++) {
+		h = t->hierarchies.elements[i];
+		idx = 0;
+
+		if(am_trace_cache_push_string(w, h->name) ||
+		   am_trace_cache_push_word(w, h->id) ||
+		   am_trace_cache_push_word(
+			   w, h->root ? h->root->num_descendants + 1 : 0))
+		{
+			return 1;
+		}
+
+		if(h->root &&
+		   (ret = am_trace_cache_collect_node(w, h->root,
+						      AM_TRACE_CACHE_NONE,
+						      &idx)))
+		{
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Builds the sorted table of address ranges of all arrays to be written.
+ * Returns 0 on success, otherwise 1. */
+static int am_trace_cache_build_ranges(struct am_trace_cache_writer* w)
+{
+	struct am_trace_cache_array_ref* ref;
+	struct am_trace_cache_range* r;
+	size_t size;
+
+	if(w->arrays.num_elements == 0)
+		return 0;
+
+	if(!(w->ranges = am_alloc_array_safe(w->arrays.num_elements,
+					     sizeof(w->ranges[0]))))
+	{
+		return 1;
+	}
+
+	for(size_t i = 0; i < w->arrays.num_elements; i++) {
+		ref = &w->arrays.elements[i];
+		r = &w->ranges[i];
+
+		if(am_size_mul_safe(&size, ref->array->num_elements,
+				    ref->layout->element_size))
+		{
+			return 1;
+		}
+
+		r->start = (uintptr_t)ref->array->elements;
+		r->end = r->start + size;
+		r->element_size = ref->layout->element_size;
+		r->first_ordinal = ref->first_ordinal;
+	}
+
+	am_trace_cache_qsort_ranges(w->ranges, w->arrays.num_elements);
+
+	return 0;
+}
+
+/* Converts a pointer to an element of an array of the trace into its ordinal
+ * and stores the result in *ordinal. Returns 0 on success or 1 if the pointer
+ * does not point to an element of any array written to the cache. */
+static int am_trace_cache_ptr_to_ordinal(const struct am_trace_cache_writer* w,
+					 const void* ptr,
+					 uint64_t* ordinal)
+{
+	uintptr_t p = (uintptr_t)ptr;
+	const struct am_trace_cache_range* r;
+	size_t start = 0;
+	size_t end = w->arrays.num_elements;
+	size_t mid;
+
+	if(!ptr) {
+		*ordinal = 0;
+		return 0;
+	}
+
+	/* Find last range starting at or before p */
+	while(end - start > 1) {
+		mid = start + (end - start) / 2;
+
+		if(w->ranges[mid].start <= p)
+			start = mid;
+		else
+			end = mid;
+	}
+
+	if(start == end)
+		return 1;
+
+	r = &w->ranges[start];
+
+	if(p < r->start || p >= r->end || (p - r->start) % r->element_size)
+		return 1;
+
+	*ordinal = r->first_ordinal + (p - r->start) / r->element_size;
+
+	return 0;
+}
+
+/* Replaces the pointers and strings of the num_elements elements at elements
+ * with the layout l by ordinals and string references. Returns 0 on success,
+ * 1 on failure and 2 if a pointer does not point to an element of an array of
+ * the trace. */
+static int am_trace_cache_relocate_out(struct am_trace_cache_writer* w,
+				       const struct am_trace_cache_layout* l,
+				       void* elements,
+				       size_t num_elements)
+{
+	const struct am_trace_cache_field* f;
+	uint64_t val;
+	void* slot;
+
+	for(size_t i = 0; i < num_elements; i++) {
+		for(size_t j = 0; j < l->num_fields; j++) {
+			f = &l->fields[j];
+			slot = (char*)elements + i * l->element_size + f->offset;
+
+			if(f->kind == AM_TRACE_CACHE_FIELD_POINTER) {
+				if(am_trace_cache_ptr_to_ordinal(
+					   w, *(void**)slot, &val))
+				{
+					return 2;
+				}
+			} else {
+				if(am_trace_cache_add_string(
+					   w, *(char**)slot, &val))
+				{
+					return 1;
+				}
+			}
+
+			*(uintptr_t*)slot = val;
+		}
+	}
+
+	return 0;
+}
+
+/* Writes num_bytes zero bytes to fp. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_write_padding(FILE* fp, size_t num_bytes)
+{
+	static const char zeros[64];
+	size_t n;
+
+	while(num_bytes > 0) {
+		n = (num_bytes < sizeof(zeros)) ? num_bytes : sizeof(zeros);
+
+		if(fwrite(zeros, n, 1, fp) != 1)
+			return 1;
+
+		num_bytes -= n;
+	}
+
+	return 0;
+}
+
+/* Pads the file up to the next multiple of alignment and stores the new
+ * offset in *offset. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_align(FILE* fp, uint64_t* offset, uint64_t alignment)
+{
+	uint64_t aligned = ((*offset + alignment - 1) / alignment) * alignment;
+
+	if(am_trace_cache_write_padding(fp, aligned - *offset))
+		return 1;
+
+	*offset = aligned;
+
+	return 0;
+}
+
+/* Writes the elements of the array described by ref to fp and fills the
+ * descriptor *desc. *offset is the current offset in the file and is updated
+ * accordingly. Returns 0 on success, 1 on failure and 2 if the array cannot be
+ * cached. */
+static int am_trace_cache_write_array(struct am_trace_cache_writer* w,
+				      FILE* fp,
+				      const struct am_trace_cache_array_ref* ref,
+				      struct am_trace_cache_array_desc* desc,
+				      uint64_t* offset,
+				      size_t page_size,
+				      void* chunk)
+{
+	const struct am_trace_cache_layout* l = ref->layout;
+	struct am_typed_array_generic* a = ref->array;
+	size_t chunk_elements;
+	size_t size;
+	int ret;
+
+	if(am_trace_cache_align(fp, offset, page_size))
+		return 1;
+
+	desc->layout = l - am_trace_cache_layouts;
+	desc->num_elements = a->num_elements;
+	desc->offset = *offset;
+	desc->first_ordinal = ref->first_ordinal;
+
+	if(l->num_fields == 0) {
+		if(fwrite(a->elements, l->element_size, a->num_elements, fp) !=
+		   a->num_elements)
+		{
+			return 1;
+		}
+	} else {
+		for(size_t i = 0; i < a->num_elements; i += chunk_elements) {
+			chunk_elements = a->num_elements - i;
+
+			if(chunk_elements > AM_TRACE_CACHE_CHUNK_ELEMENTS)
+				chunk_elements = AM_TRACE_CACHE_CHUNK_ELEMENTS;
+
+			memcpy(chunk,
+			       (char*)a->elements + i * l->element_size,
+			       chunk_elements * l->element_size);
+
+			if((ret = am_trace_cache_relocate_out(
+				    w, l, chunk, chunk_elements)))
+			{
+				return ret;
+			}
+
+			if(fwrite(chunk, l->element_size, chunk_elements, fp) !=
+			   chunk_elements)
+			{
+				return 1;
+			}
+		}
+	}
+
+	size = a->num_elements * l->element_size;
+	*offset += size;
+
+	return 0;
+}
+
+/* Writes the cache file for the writer w to fp. Returns 0 on success, 1 on
+ * failure and 2 if the trace cannot be cached. */
+static int am_trace_cache_write_fp(struct am_trace_cache_writer* w,
+				   FILE* fp,
+				   const struct stat* trace_stat)
+{
+	struct am_trace_cache_header hdr;
+	struct am_trace_cache_array_desc* descs;
+	size_t max_element_size = 0;
+	size_t descs_size;
+	uint64_t offset;
+	long page_size;
+	void* chunk = NULL;
+	int ret = 1;
+
+	if((page_size = sysconf(_SC_PAGESIZE)) <= 0)
+		return 1;
+
+	if(!(descs = am_alloc_array_safe(w->arrays.num_elements + 1,
+					 sizeof(descs[0]))))
+	{
+		return 1;
+	}
+
+	for(size_t i = 0; i < w->arrays.num_elements; i++)
+		if(w->arrays.elements[i].layout->element_size > max_element_size)
+			max_element_size = w->arrays.elements[i].layout->element_size;
+
+	if(!(chunk = am_alloc_array_safe(AM_TRACE_CACHE_CHUNK_ELEMENTS,
+					 max_element_size + 1)))
+	{
+		goto out;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, AM_TRACE_CACHE_MAGIC, sizeof(hdr.magic));
+	hdr.version = AM_TRACE_CACHE_VERSION;
+	hdr.layout_hash = am_trace_cache_layout_hash();
+	hdr.trace_size = trace_stat->st_size;
+	hdr.trace_mtime_sec = trace_stat->st_mtim.tv_sec;
+	hdr.trace_mtime_nsec = trace_stat->st_mtim.tv_nsec;
+	hdr.bounds_start = w->trace->bounds.start;
+	hdr.bounds_end = w->trace->bounds.end;
+	hdr.num_arrays = w->arrays.num_elements;
+	hdr.arrays_offset = sizeof(hdr);
+
+	descs_size = w->arrays.num_elements * sizeof(descs[0]);
+	offset = sizeof(hdr) + descs_size;
+
+	/* Header and descriptors are written once all offsets are known */
+	if(am_trace_cache_write_padding(fp, offset))
+		goto out;
+
+	for(size_t i = 0; i < w->arrays.num_elements; i++) {
+		if((ret = am_trace_cache_write_array(w, fp,
+						     &w->arrays.elements[i],
+						     &descs[i], &offset,
+						     page_size, chunk)))
+		{
+			goto out;
+		}
+	}
+
+	ret = 1;
+
+	if(am_trace_cache_align(fp, &offset, sizeof(uint64_t)))
+		goto out;
+
+	hdr.strings_offset = offset;
+	hdr.strings_size = w->strings.num_elements;
+
+	if(w->strings.num_elements > 0 &&
+	   fwrite(w->strings.elements, w->strings.num_elements, 1, fp) != 1)
+	{
+		goto out;
+	}
+
+	offset += w->strings.num_elements;
+
+	if(am_trace_cache_align(fp, &offset, sizeof(uint64_t)))
+		goto out;
+
+	hdr.structure_offset = offset;
+	hdr.structure_size = w->structure.num_elements;
+
+	if(fwrite(w->structure.elements, sizeof(uint64_t),
+		  w->structure.num_elements, fp) != w->structure.num_elements)
+	{
+		goto out;
+	}
+
+	if(fseeko(fp, 0, SEEK_SET))
+		goto out;
+
+	if(fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto out;
+
+	if(descs_size > 0 && fwrite(descs, descs_size, 1, fp) != 1)
+		goto out;
+
+	ret = 0;
+
+out:
+	free(chunk);
+	free(descs);
+
+	return ret;
+}
+
+/* Writes a cache for the completely loaded trace t to the file filename. The
+ * file is written under a temporary name first and then renamed, such that
+ * concurrent loads never see a partially written cache. The trace must have
+ * been loaded from the file t->filename.
+ *
+ * Returns 0 on success, 1 on failure and 2 if the trace contains data that
+ * cannot be cached.
+ */
+int am_trace_cache_write(struct am_trace* t, const char* filename)
+{
+	struct am_trace_cache_writer w;
+	struct stat trace_stat;
+	char* tmpname;
+	size_t len;
+	FILE* fp;
+	int fd;
+	int ret = 1;
+
+	if(stat(t->filename, &trace_stat))
+		return 1;
+
+	w.trace = t;
+	w.ranges = NULL;
+	w.next_ordinal = 1;
+	am_trace_cache_array_ref_array_init(&w.arrays);
+	am_trace_cache_char_array_init(&w.strings);
+	am_trace_cache_word_array_init(&w.structure);
+
+	/* Avoid reallocation for every few strings and words */
+	w.strings.num_prealloc = 4096;
+	w.structure.num_prealloc = 4096;
+
+	if((ret = am_trace_cache_collect(&w)))
+		goto out;
+
+	ret = 1;
+
+	if(am_trace_cache_build_ranges(&w))
+		goto out;
+
+	len = strlen(filename);
+
+	if(am_size_add_safe(&len, len, sizeof(".XXXXXX")))
+		goto out;
+
+	if(!(tmpname = malloc(len)))
+		goto out;
+
+	strcpy(tmpname, filename);
+	strcat(tmpname, ".XXXXXX");
+
+	if((fd = mkstemp(tmpname)) == -1)
+		goto out_tmpname;
+
+	if(!(fp = fdopen(fd, "wb"))) {
+		close(fd);
+		goto out_unlink;
+	}
+
+	ret = am_trace_cache_write_fp(&w, fp, &trace_stat);
+
+	if(fclose(fp) && ret == 0)
+		ret = 1;
+
+	if(ret == 0 && rename(tmpname, filename))
+		ret = 1;
+
+out_unlink:
+	if(ret != 0)
+		unlink(tmpname);
+out_tmpname:
+	free(tmpname);
+out:
+	free(w.ranges);
+	am_trace_cache_word_array_destroy(&w.structure);
+	am_trace_cache_char_array_destroy(&w.strings);
+	am_trace_cache_array_ref_array_destroy(&w.arrays);
+
+	return ret;
+}
+
+/******************************************************************************/
+/* Loading                                                                    */
+/******************************************************************************/
+
+struct am_trace_cache_reader {
+	struct am_trace* trace;
+
+	void* base;
+	size_t size;
+
+	const struct am_trace_cache_header* hdr;
+	const struct am_trace_cache_array_desc* descs;
+
+	/* Addresses of the elements of each array once placed or NULL */
+	void** placed;
+
+	const char* strings;
+	const uint64_t* structure;
+	size_t pos;
+};
+
+/* Reads the next word of the structure into *word. Returns 0 on success or 1
+ * if the end of the structure has been reached. */
+static int am_trace_cache_read_word(struct am_trace_cache_reader* r,
+				    uint64_t* word)
+{
+	if(r->pos >= r->hdr->structure_size)
+		return 1;
+
+	*word = r->structure[r->pos++];
+
+	return 0;
+}
+
+/* Resolves a string reference. Returns 0 on success or 1 if the reference is
+ * invalid. */
+static int am_trace_cache_resolve_string(struct am_trace_cache_reader* r,
+					 uint64_t ref,
+					 const char** str)
+{
+	if(ref == 0) {
+		*str = NULL;
+		return 0;
+	}
+
+	if(ref > r->hdr->strings_size)
+		return 1;
+
+	*str = &r->strings[ref - 1];
+
+	return 0;
+}
+
+/* Reads a string reference from the structure and resolves it. Returns 0 on
+ * success, otherwise 1. */
+static int am_trace_cache_read_string(struct am_trace_cache_reader* r,
+				      const char** str)
+{
+	uint64_t ref;
+
+	if(am_trace_cache_read_word(r, &ref))
+		return 1;
+
+	return am_trace_cache_resolve_string(r, ref, str);
+}
+
+/* Same as am_trace_cache_read_string, but fails for NULL strings */
+static int am_trace_cache_read_nonnull_string(struct am_trace_cache_reader* r,
+					      const char** str)
+{
+	if(am_trace_cache_read_string(r, str))
+		return 1;
+
+	return (*str == NULL);
+}
+
+/* Checks the header and descriptors of the cache against the size of the file
+ * and the trace file. Returns 0 if the cache is valid, otherwise 2. */
+static int am_trace_cache_check(struct am_trace_cache_reader* r,
+				const struct stat* trace_stat)
+{
+	const struct am_trace_cache_header* hdr = r->base;
+	const struct am_trace_cache_array_desc* d;
+	const struct am_trace_cache_layout* l;
+	size_t next_ordinal = 1;
+	size_t end;
+
+	if(r->size < sizeof(*hdr))
+		return 2;
+
+	if(memcmp(hdr->magic, AM_TRACE_CACHE_MAGIC, sizeof(hdr->magic)) ||
+	   hdr->version != AM_TRACE_CACHE_VERSION ||
+	   hdr->layout_hash != am_trace_cache_layout_hash() ||
+	   hdr->trace_size != (uint64_t)trace_stat->st_size ||
+	   hdr->trace_mtime_sec != (uint64_t)trace_stat->st_mtim.tv_sec ||
+	   hdr->trace_mtime_nsec != (uint64_t)trace_stat->st_mtim.tv_nsec)
+	{
+		return 2;
+	}
+
+	if(am_size_mul_safe(&end, hdr->num_arrays, sizeof(*d)) ||
+	   am_size_add_safe(&end, end, hdr->arrays_offset) ||
+	   end > r->size ||
+	   hdr->arrays_offset % sizeof(uint64_t))
+	{
+		return 2;
+	}
+
+	if(am_size_add_safe(&end, hdr->strings_offset, hdr->strings_size) ||
+	   end > r->size ||
+	   (hdr->strings_size > 0 &&
+	    ((const char*)r->base)[end - 1] != '\0'))
+	{
+		return 2;
+	}
+
+	if(am_size_mul_safe(&end, hdr->structure_size, sizeof(uint64_t)) ||
+	   am_size_add_safe(&end, end, hdr->structure_offset) ||
+	   end > r->size ||
+	   hdr->structure_offset % sizeof(uint64_t))
+	{
+		return 2;
+	}
+
+	r->hdr = hdr;
+	r->descs = (const void*)((const char*)r->base + hdr->arrays_offset);
+	r->strings = (const char*)r->base + hdr->strings_offset;
+	r->structure = (const void*)((const char*)r->base +
+				     hdr->structure_offset);
+
+	for(size_t i = 0; i < hdr->num_arrays; i++) {
+		d = &r->descs[i];
+
+		if(d->layout >= am_trace_cache_num_layouts)
+			return 2;
+
+		l = &am_trace_cache_layouts[d->layout];
+
+		if(!l->supported ||
+		   d->num_elements == 0 ||
+		   d->first_ordinal != next_ordinal ||
+		   am_size_mul_safe(&end, d->num_elements, l->element_size) ||
+		   am_size_add_safe(&end, end, d->offset) ||
+		   end > r->size ||
+		   am_size_add_safe(&next_ordinal, next_ordinal,
+				    d->num_elements))
+		{
+			return 2;
+		}
+	}
+
+	return 0;
+}
+
+/* Copies the elements of the array described by d into a newly allocated
+ * buffer and replaces string references with newly allocated copies of the
+ * strings. Returns the buffer on success or NULL on failure. */
+static void* am_trace_cache_copy_elements(struct am_trace_cache_reader* r,
+					  const struct am_trace_cache_array_desc* d)
+{
+	const struct am_trace_cache_layout* l = &am_trace_cache_layouts[d->layout];
+	const struct am_trace_cache_field* f;
+	const char* str;
+	char* dup;
+	char* elements;
+	char** slot;
+	int failed = 0;
+
+	if(!(elements = am_alloc_array_safe(d->num_elements, l->element_size)))
+		return NULL;
+
+	memcpy(elements, (char*)r->base + d->offset,
+	       d->num_elements * l->element_size);
+
+	/* Once a string cannot be resolved or copied, all remaining strings
+	 * are set to NULL, such that the elements can be destroyed safely */
+	for(size_t i = 0; i < d->num_elements; i++) {
+		for(size_t j = 0; j < l->num_fields; j++) {
+			f = &l->fields[j];
+
+			if(f->kind != AM_TRACE_CACHE_FIELD_STRING)
+				continue;
+
+			slot = (char**)(elements + i * l->element_size + f->offset);
+			dup = NULL;
+
+			if(!failed &&
+			   (am_trace_cache_resolve_string(
+				   r, *(uintptr_t*)slot, &str) ||
+			    (str && !(dup = strdup(str)))))
+			{
+				failed = 1;
+			}
+
+			*slot = dup;
+		}
+	}
+
+	if(failed) {
+		for(size_t i = 0; i < d->num_elements; i++) {
+			for(size_t j = 0; j < l->num_fields; j++) {
+				f = &l->fields[j];
+
+				if(f->kind != AM_TRACE_CACHE_FIELD_STRING)
+					continue;
+
+				free(*(char**)(elements + i * l->element_size +
+					       f->offset));
+			}
+		}
+
+		free(elements);
+		return NULL;
+	}
+
+	return elements;
+}
+
+/* Reads the index of a descriptor from the structure and assigns the elements
+ * of the described array to a. Arrays without strings are used directly from
+ * the mapping, others are copied. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_place_array(struct am_trace_cache_reader* r,
+				      const char* ident,
+				      struct am_typed_array_generic* a)
+{
+	const struct am_trace_cache_array_desc* d;
+	const struct am_trace_cache_layout* l;
+	uint64_t idx;
+	void* elements;
+	int has_strings = 0;
+
+	if(am_trace_cache_read_word(r, &idx))
+		return 1;
+
+	if(idx == AM_TRACE_CACHE_NONE)
+		return 0;
+
+	if(idx >= r->hdr->num_arrays || r->placed[idx])
+		return 1;
+
+	d = &r->descs[idx];
+	l = &am_trace_cache_layouts[d->layout];
+
+	/* The array must have been created for the same type */
+	if(strcmp(l->ident, ident) != 0)
+		return 1;
+
+	for(size_t i = 0; i < l->num_fields; i++)
+		if(l->fields[i].kind == AM_TRACE_CACHE_FIELD_STRING)
+			has_strings = 1;
+
+	if(has_strings) {
+		if(!(elements = am_trace_cache_copy_elements(r, d)))
+			return 1;
+	} else {
+		elements = (char*)r->base + d->offset;
+
+		if(am_column_store_adopt_array(r->trace->column_store, a))
+			return 1;
+	}
+
+	a->elements = elements;
+	a->num_elements = d->num_elements;
+	a->num_free = 0;
+	r->placed[idx] = elements;
+
+	return 0;
+}
+
+/* Reads the description of an array from the structure, creates the array and
+ * adds it to the array collection ac. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_read_array(struct am_trace_cache_reader* r,
+				     struct am_array_collection* ac)
+{
+	struct am_counter_event_array_collection* c;
+	struct am_counter_event_array* cea;
+	struct am_typed_array_generic* a;
+	const char* ident;
+	uint64_t kind;
+	uint64_t num_counters;
+	uint64_t counter_id;
+
+	if(am_trace_cache_read_nonnull_string(r, &ident) ||
+	   am_trace_cache_read_word(r, &kind))
+	{
+		return 1;
+	}
+
+	if(!(a = am_array_registry_allocate_and_init_array(
+		     &r->trace->array_registry, ident, NULL)))
+	{
+		return 1;
+	}
+
+	if(am_array_collection_add(ac, a, ident)) {
+		am_array_registry_destroy_and_free_array(
+			&r->trace->array_registry, ident, NULL, a);
+		return 1;
+	}
+
+	if(kind == AM_TRACE_CACHE_ARRAY_PLAIN)
+		return am_trace_cache_place_array(r, ident, a);
+
+	if(kind != AM_TRACE_CACHE_ARRAY_COUNTERS ||
+	   strcmp(ident, AM_TRACE_CACHE_COUNTER_EVENT_IDENT) != 0 ||
+	   am_trace_cache_read_word(r, &num_counters))
+	{
+		return 1;
+	}
+
+	c = (struct am_counter_event_array_collection*)a;
+
+	for(uint64_t i = 0; i < num_counters; i++) {
+		if(am_trace_cache_read_word(r, &counter_id))
+			return 1;
+
+		if(!(cea = am_counter_event_array_collection_find_or_add(
+			     c, counter_id)))
+		{
+			return 1;
+		}
+
+		if(am_trace_cache_place_array(r, ident,
+					      AM_TYPED_ARRAY_GENERIC(cea)))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Reads the descriptions of num_arrays arrays from the structure and adds them
+ * to the array collection ac. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_read_arrays(struct am_trace_cache_reader* r,
+				      struct am_array_collection* ac)
+{
+	uint64_t num_arrays;
+
+	if(am_trace_cache_read_word(r, &num_arrays))
+		return 1;
+
+	for(uint64_t i = 0; i < num_arrays; i++)
+		if(am_trace_cache_read_array(r, ac))
+			return 1;
+
+	return 0;
+}
+
+/* Reads all event collections with their arrays. Returns 0 on success,
+ * otherwise 1. */
+static int am_trace_cache_read_event_collections(struct am_trace_cache_reader* r)
+{
+	struct am_trace* t = r->trace;
+	struct am_event_collection* ecoll;
+	uint64_t num_collections;
+	uint64_t id;
+	const char* name;
+
+	if(am_trace_cache_read_word(r, &num_collections))
+		return 1;
+
+	for(uint64_t i = 0; i < num_collections; i++) {
+		if(am_trace_cache_read_word(r, &id) ||
+		   am_trace_cache_read_nonnull_string(r, &name))
+		{
+			return 1;
+		}
+
+		if(!(ecoll = am_event_collection_array_add(
+			     &t->event_collections, id, name)))
+		{
+			return 1;
+		}
+
+		/* Collections are stored in order, such that indexes in the
+		 * event mappings remain valid */
+		if(ecoll != &t->event_collections.elements[i])
+			return 1;
+
+		if(am_trace_cache_read_arrays(r, &ecoll->event_arrays))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Reads a single hierarchy node and adds it to the hierarchy h. Nodes holds
+ * the nodes of the hierarchy read so far in pre-order and idx is the index of
+ * the new node. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_read_node(struct am_trace_cache_reader* r,
+				    struct am_hierarchy* h,
+				    struct am_hierarchy_node** nodes,
+				    uint64_t idx)
+{
+	struct am_trace* t = r->trace;
+	struct am_hierarchy_node* n;
+	struct am_interval interval;
+	const char* name;
+	uint64_t id;
+	uint64_t parent_idx;
+	uint64_t num_mappings;
+	uint64_t coll_idx;
+
+	if(am_trace_cache_read_string(r, &name) ||
+	   am_trace_cache_read_word(r, &id) ||
+	   am_trace_cache_read_word(r, &parent_idx) ||
+	   am_trace_cache_read_word(r, &num_mappings))
+	{
+		return 1;
+	}
+
+	/* Only the first node is the root, all others have a parent that
+	 * precedes them in pre-order */
+	if((idx == 0) != (parent_idx == AM_TRACE_CACHE_NONE) ||
+	   (idx > 0 && parent_idx >= idx))
+	{
+		return 1;
+	}
+
+	if(!(n = malloc(sizeof(*n))))
+		return 1;
+
+	if(am_hierarchy_node_init(n, id, name)) {
+		free(n);
+		return 1;
+	}
+
+	if(idx == 0)
+		h->root = n;
+	else
+		am_hierarchy_node_add_child(nodes[parent_idx], n);
+
+	nodes[idx] = n;
+
+	for(uint64_t i = 0; i < num_mappings; i++) {
+		if(am_trace_cache_read_word(r, &interval.start) ||
+		   am_trace_cache_read_word(r, &interval.end) ||
+		   am_trace_cache_read_word(r, &coll_idx) ||
+		   coll_idx >= t->event_collections.num_elements)
+		{
+			return 1;
+		}
+
+		if(am_event_mapping_append(
+			   &n->event_mapping, &interval,
+			   &t->event_collections.elements[coll_idx]))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Reads all hierarchies. Returns 0 on success, otherwise 1. */
+static int am_trace_cache_read_hierarchies(struct am_trace_cache_reader* r)
+{
+	struct am_hierarchy_node** nodes;
+	struct am_hierarchy* h;
+	uint64_t num_hierarchies;
+	uint64_t num_nodes;
+	uint64_t id;
+	const char* name;
+	int ret = 1;
+
+	if(am_trace_cache_read_word(r, &num_hierarchies))
+		return 1;
+
+	for(uint64_t i = 0; i < num_hierarchies; i++) {
+		if(am_trace_cache_read_nonnull_string(r, &name) ||
+		   am_trace_cache_read_word(r, &id) ||
+		   am_trace_cache_read_word(r, &num_nodes))
+		{
+			return 1;
+		}
+
+		/* Each node occupies at least four words */
+		if(num_nodes > (r->hdr->structure_size - r->pos) / 4)
+			return 1;
+
+		if(!(h = malloc(sizeof(*h))))
+			return 1;
+
+		if(am_hierarchy_init(h, name, id))
+			goto out_err_free;
+
+		if(am_hierarchyp_array_add(&r->trace->hierarchies, h))
+			goto out_err_destroy;
+
+		if(num_nodes == 0)
+			continue;
+
+		if(!(nodes = am_alloc_array_safe(num_nodes, sizeof(nodes[0]))))
+			return 1;
+
+		for(uint64_t j = 0; j < num_nodes; j++) {
+			if((ret = am_trace_cache_read_node(r, h, nodes, j)))
+				break;
+		}
+
+		free(nodes);
+
+		if(ret)
+			return 1;
+	}
+
+	return 0;
+
+out_err_destroy:
+	am_hierarchy_destroy(h);
+out_err_free:
+	free(h);
+	return 1;
+}
+
+/* Replaces the ordinals of the pointers of all elements of the array with the
+ * index idx with the addresses of the elements they refer to. Returns 0 on
+ * success, otherwise 1. */
+static int am_trace_cache_relocate_in(struct am_trace_cache_reader* r,
+				      size_t idx)
+{
+	const struct am_trace_cache_array_desc* d = &r->descs[idx];
+	const struct am_trace_cache_layout* l = &am_trace_cache_layouts[d->layout];
+	const struct am_trace_cache_array_desc* td;
+	const struct am_trace_cache_field* f;
+	const struct am_trace_cache_layout* tl;
+	char* elements = r->placed[idx];
+	uintptr_t* slot;
+	uint64_t ordinal;
+	size_t start;
+	size_t end;
+	size_t mid;
+
+	for(size_t i = 0; i < d->num_elements; i++) {
+		for(size_t j = 0; j < l->num_fields; j++) {
+			f = &l->fields[j];
+
+			if(f->kind != AM_TRACE_CACHE_FIELD_POINTER)
+				continue;
+
+			slot = (uintptr_t*)(elements + i * l->element_size +
+					    f->offset);
+			ordinal = *slot;
+
+			if(ordinal == 0)
+				continue;
+
+			/* Find the last array whose first ordinal is less than
+			 * or equal to the ordinal */
+			start = 0;
+			end = r->hdr->num_arrays;
+
+			while(end - start > 1) {
+				mid = start + (end - start) / 2;
+
+				if(r->descs[mid].first_ordinal <= ordinal)
+					start = mid;
+				else
+					end = mid;
+			}
+
+			td = &r->descs[start];
+			tl = &am_trace_cache_layouts[td->layout];
+
+			if(ordinal < td->first_ordinal ||
+			   ordinal - td->first_ordinal >= td->num_elements ||
+			   !r->placed[start])
+			{
+				return 1;
+			}
+
+			*slot = (uintptr_t)((char*)r->placed[start] +
+					    (ordinal - td->first_ordinal) *
+					    tl->element_size);
+		}
+	}
+
+	return 0;
+}
+
+/* Builds the trace from the validated cache. Returns 0 on success, otherwise
+ * 1. */
+static int am_trace_cache_read(struct am_trace_cache_reader* r)
+{
+	const struct am_trace_cache_layout* l;
+	int has_pointers;
+
+	if(am_trace_cache_read_event_collections(r) ||
+	   am_trace_cache_read_arrays(r, &r->trace->trace_arrays) ||
+	   am_trace_cache_read_hierarchies(r))
+	{
+		return 1;
+	}
+
+	for(size_t i = 0; i < r->hdr->num_arrays; i++) {
+		l = &am_trace_cache_layouts[r->descs[i].layout];
+		has_pointers = 0;
+
+		if(!r->placed[i])
+			return 1;
+
+		for(size_t j = 0; j < l->num_fields; j++)
+			if(l->fields[j].kind == AM_TRACE_CACHE_FIELD_POINTER)
+				has_pointers = 1;
+
+		if(has_pointers && am_trace_cache_relocate_in(r, i))
+			return 1;
+	}
+
+	r->trace->bounds.start = r->hdr->bounds_start;
+	r->trace->bounds.end = r->hdr->bounds_end;
+
+	return 0;
+}
+
+/* Loads the trace for the trace file trace_filename from the cache file
+ * filename and stores a pointer to the newly allocated trace in *pt. The cache
+ * file is mapped privately into memory and remains mapped until the trace is
+ * destroyed.
+ *
+ * Returns 0 on success and 1 on failure. If the cache file does not exist, if
+ * it was generated for a different version of the trace file or by an
+ * incompatible build, or if it is corrupt, 2 is returned.
+ */
+int am_trace_cache_load(const char* filename,
+			const char* trace_filename,
+			struct am_trace** pt)
+{
+	struct am_trace_cache_reader r;
+	struct stat trace_stat;
+	struct stat st;
+	int fd;
+	int ret = 2;
+
+	if(stat(trace_filename, &trace_stat))
+		return 1;
+
+	if((fd = open(filename, O_RDONLY)) == -1)
+		return (errno == ENOENT) ? 2 : 1;
+
+	if(fstat(fd, &st) || st.st_size <= 0 || (uintmax_t)st.st_size > SIZE_MAX)
+		goto out_close;
+
+	r.size = st.st_size;
+	r.base = mmap(NULL, r.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	if(r.base == MAP_FAILED)
+		goto out_close;
+
+	close(fd);
+
+	if(am_trace_cache_check(&r, &trace_stat))
+		goto out_unmap;
+
+	ret = 1;
+
+	if(!(r.placed = calloc(r.hdr->num_arrays + 1, sizeof(r.placed[0]))))
+		goto out_unmap;
+
+	if(!(r.trace = malloc(sizeof(*r.trace))))
+		goto out_placed;
+
+	if(am_trace_init(r.trace, trace_filename))
+		goto out_trace_free;
+
+	if(!(r.trace->column_store = malloc(sizeof(*r.trace->column_store))))
+		goto out_trace_destroy;
+
+	am_column_store_init(r.trace->column_store);
+
+	/* From now on, the mapping is owned by the trace */
+	if(am_column_store_add_mapping(r.trace->column_store, r.base, r.size)) {
+		free(r.trace->column_store);
+		r.trace->column_store = NULL;
+		goto out_trace_destroy;
+	}
+
+	r.pos = 0;
+
+	if(am_trace_cache_read(&r)) {
+		/* Corrupt cache; the mapping is released with the trace */
+		am_trace_destroy(r.trace);
+		free(r.trace);
+		free(r.placed);
+		return 2;
+	}
+
+	free(r.placed);
+	*pt = r.trace;
+
+	return 0;
+
+out_trace_destroy:
+	am_trace_destroy(r.trace);
+out_trace_free:
+	free(r.trace);
+out_placed:
+	free(r.placed);
+out_unmap:
+	munmap(r.base, r.size);
+	return ret;
+out_close:
+	close(fd);
+	return ret;
+}
@@ -0,0 +1,84 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_TRACE_CACHE_H
+#define AM_TRACE_CACHE_H
+
+/* A trace cache is a snapshot of a completely loaded and postprocessed trace
+ * that allows subsequent loads of the same trace to skip parsing, sorting,
+ * joining and postprocessing. The file is mapped privately into memory upon
+ * loading and arrays whose elements do not own any memory are used directly
+ * from the mapping. Pointers from elements to elements of other arrays are
+ * stored as ordinal numbers of their targets and strings as references into a
+ * string table.
+ *
+ * A cache is only valid for the trace file it has been generated from, as
+ * identified by its size and modification time, and for builds with the same
+ * in-memory layouts of all types.
+ *
+ * File layout (all values in native byte order):
+ *
+ *   struct am_trace_cache_header
+ *   num_arrays times struct am_trace_cache_array_desc
+ *   for each array: elements (page-aligned)
+ *   string table (zero-terminated strings)
+ *   structure: sequence of 64-bit words describing the event collections,
+ *              the per-trace arrays and the hierarchies
+ */
+
+#include <aftermath/core/trace.h>
+#include <stddef.h>
+
+enum am_trace_cache_field_kind {
+	/* Non-owning pointer to an element of an array of the trace */
+	AM_TRACE_CACHE_FIELD_POINTER,
+
+	/* Owned, zero-terminated string */
+	AM_TRACE_CACHE_FIELD_STRING
+};
+
+/* A field of an element that needs to be relocated */
+struct am_trace_cache_field {
+	enum am_trace_cache_field_kind kind;
+	size_t offset;
+};
+
+/* Layout of the elements of an in-memory type */
+struct am_trace_cache_layout {
+	const char* ident;
+	size_t element_size;
+
+	const struct am_trace_cache_field* fields;
+	size_t num_fields;
+
+	/* False if the elements contain data that cannot be relocated, e.g.,
+	 * owned pointers to separately allocated arrays */
+	int supported;
+};
+
+/* Generated table of layouts, sorted by identifier */
+extern const struct am_trace_cache_layout am_trace_cache_layouts[];
+extern const size_t am_trace_cache_num_layouts;
+
+char* am_trace_cache_filename(const char* trace_filename);
+int am_trace_cache_write(struct am_trace* t, const char* filename);
+int am_trace_cache_load(const char* filename,
+			const char* trace_filename,
+			struct am_trace** pt);
+
+#endif
@@ -37,6 +37,8 @@ int am_write_buffer_init(struct am_write_buffer* buf, size_t size)
 
 	buf->size = size;
 	buf->used = 0;
+	buf->full = NULL;
+	buf->full_data = NULL;
 
 	return 0;
 }
@@ -100,3 +102,17 @@ int am_write_buffer_write_bytes(struct am_write_buffer* buf,
 
 	return 0;
 }
+
+/**
+ * Sets the function that is invoked when a frame does not fit into the
+ * remaining space of the buffer. The pointer data is passed verbatim to the
+ * function. If full is NULL, writes to a full buffer fail immediately.
+ */
+void am_write_buffer_set_full_fun(struct am_write_buffer* buf,
+				  int (*full)(struct am_write_buffer* buf,
+					      void* data),
+				  void* data)
+{
+	buf->full = full;
+	buf->full_data = data;
+}
@@ -39,6 +39,16 @@ struct am_write_buffer {
 
 	/* Number of bytes already used in the data buffer */
 	size_t used;
+
+	/* Optional function invoked when a frame does not fit into the
+	 * remaining space of the buffer. The function may replace the data
+	 * buffer with a buffer that has more space available (e.g., by
+	 * handing over the full buffer for asynchronous writing). Must return
+	 * 0 if the write should be retried, otherwise 1. */
+	int (*full)(struct am_write_buffer* buf, void* data);
+
+	/* Data passed verbatim to full() */
+	void* full_data;
 };
 
 int am_write_buffer_init(struct am_write_buffer* buf, size_t size);
@@ -48,5 +58,21 @@ int am_write_buffer_dump_fp(struct am_write_buffer* buf, FILE* fp);
 int am_write_buffer_write_bytes(struct am_write_buffer* buf,
 				size_t num_bytes,
 				void* data);
+void am_write_buffer_set_full_fun(struct am_write_buffer* buf,
+				  int (*full)(struct am_write_buffer* buf,
+					      void* data),
+				  void* data);
+
+/* Invoked after a failed attempt to write a frame to buf. Returns 0 if space
+ * has been made available in buf and if the write should be retried,
+ * otherwise 1. A frame that doesn't fit into an empty buffer is never
+ * retried. */
+static inline int am_write_buffer_make_room(struct am_write_buffer* buf)
+{
+	if(!buf->full || buf->used == 0)
+		return 1;
+
+	return buf->full(buf, buf->full_data);
+}
 
 #endif
@@ -0,0 +1 @@
+.//../../../../src//timeline//tile_cache.h
\ No newline at end of file
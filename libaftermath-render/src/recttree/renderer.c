@@ -29,6 +29,7 @@ void am_recttree_renderer_init(
 	void* cb_data)
 {
 	r->params.zoom_factor = 1.5;
+	r->params.lod_threshold = 1.0;
 	r->params.bgcolor = AM_RGBA255(0xFF, 0xFF, 0xFF, 0xFF);
 
 	r->width = 0;
@@ -38,6 +39,7 @@ void am_recttree_renderer_init(
 	r->offset.x = 0;
 	r->offset.y = 0;
 	r->render_rect_cb = render_rect_cb;
+	r->render_aggregate_cb = NULL;
 	r->cb_data = cb_data;
 }
 
@@ -45,6 +47,16 @@ void am_recttree_renderer_destroy(struct am_recttree_renderer* r)
 {
 }
 
+/* Sets the callback function invoked for subtrees of the rect tree that are
+ * too small to be rendered node by node. Passing NULL renders all visible nodes
+ * individually regardless of their size. */
+void am_recttree_renderer_set_render_aggregate_callback(
+	struct am_recttree_renderer* r,
+	am_recttree_renderer_render_node_callback render_aggregate_cb)
+{
+	r->render_aggregate_cb = render_aggregate_cb;
+}
+
 /* Sets the rect tree associated to the renderer */
 void am_recttree_renderer_set_recttree(struct am_recttree_renderer* r,
 				       const struct am_recttree* t)
@@ -101,6 +113,29 @@ struct am_recttree_renderer_cb_params {
 	cairo_t* cr;
 };
 
+/* Invokes the callback function cb with the screen rectangle for the hyper
+ * rectangle in graph coordinates defined by start and end. */
+static void am_recttree_renderer_invoke_cb(
+	struct am_recttree_renderer* r,
+	cairo_t* cr,
+	am_recttree_renderer_render_node_callback cb,
+	const struct am_recttree_node* n,
+	const double* start,
+	const double* end)
+{
+	struct am_rect screen_rect;
+
+	screen_rect.x = am_recttree_renderer_graph_x_to_screen(r, start[0]);
+	screen_rect.y = am_recttree_renderer_graph_y_to_screen(r, start[1]);
+
+	screen_rect.width = am_recttree_renderer_graph_w_to_screen(
+		r, end[0] - start[0]);
+	screen_rect.height = am_recttree_renderer_graph_h_to_screen(
+		r, end[1] - start[1]);
+
+	cb(cr, screen_rect, r->zoom, n, r->cb_data);
+}
+
 /* Callback function invoked by the rect tree query function for each rectangle
  * overlapping with the query rectangle; invokes in turn the rendering callback
  * function associated with the renderer.
@@ -113,20 +148,33 @@ static int am_recttree_renderer_node_callback(struct am_recttree_node* n,
 {
 	struct am_recttree_renderer_cb_params* cb_params = data;
 	struct am_recttree_renderer* r = cb_params->renderer;
-	struct am_rect screen_rect;
-	cairo_t* cr = cb_params->cr;
 
-	screen_rect.x = am_recttree_renderer_graph_x_to_screen(
-		r, n->kdnode.coordinates[0]);
-	screen_rect.y = am_recttree_renderer_graph_y_to_screen(
-		r, n->kdnode.coordinates[1]);
+	am_recttree_renderer_invoke_cb(r, cb_params->cr, r->render_rect_cb, n,
+				       n->kdnode.coordinates, n->hyperrect_end);
 
-	screen_rect.width = am_recttree_renderer_graph_w_to_screen(
-		r, n->hyperrect_end[0] - n->kdnode.coordinates[0]);
-	screen_rect.height = am_recttree_renderer_graph_h_to_screen(
-		r, n->hyperrect_end[1] - n->kdnode.coordinates[1]);
+	return 0;
+}
 
-	r->render_rect_cb(cr, screen_rect, r->zoom, n, r->cb_data);
+/* Same as am_recttree_renderer_node_callback, but for the level-of-detail
+ * query function. Subtrees are passed to the aggregate rendering callback
+ * function. */
+static int am_recttree_renderer_lod_callback(struct am_recttree_node* n,
+					     int aggregate,
+					     void* data)
+{
+	struct am_recttree_renderer_cb_params* cb_params = data;
+	struct am_recttree_renderer* r = cb_params->renderer;
+
+	if(aggregate) {
+		am_recttree_renderer_invoke_cb(r, cb_params->cr,
+					       r->render_aggregate_cb, n,
+					       n->subtree_start, n->subtree_end);
+	} else {
+		am_recttree_renderer_invoke_cb(r, cb_params->cr,
+					       r->render_rect_cb, n,
+					       n->kdnode.coordinates,
+					       n->hyperrect_end);
+	}
 
 	return 0;
 }
@@ -143,6 +191,7 @@ void am_recttree_renderer_render(struct am_recttree_renderer* r, cairo_t* cr)
 
 	double query_start[2];
 	double query_end[2];
+	double min_extent[2];
 
 	if(r->width == 0 || r->height == 0)
 		return;
@@ -161,7 +210,21 @@ void am_recttree_renderer_render(struct am_recttree_renderer* r, cairo_t* cr)
 	query_end[0] = r->offset.x + am_recttree_renderer_screen_w_to_graph(r, r->width);
 	query_end[1] = r->offset.y + am_recttree_renderer_screen_h_to_graph(r, r->height);
 
-	if(r->render_rect_cb) {
+	if(!r->render_rect_cb)
+		return;
+
+	if(r->render_aggregate_cb) {
+		min_extent[0] = am_recttree_renderer_screen_w_to_graph(
+			r, r->params.lod_threshold);
+		min_extent[1] = am_recttree_renderer_screen_h_to_graph(
+			r, r->params.lod_threshold);
+
+		am_recttree_query_lod_callback(r->recttree,
+					       query_start, query_end,
+					       min_extent,
+					       am_recttree_renderer_lod_callback,
+					       &cb_params);
+	} else {
 		am_recttree_query_callback(r->recttree,
 					   query_start, query_end,
 					   am_recttree_renderer_node_callback,
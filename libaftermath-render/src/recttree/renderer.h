@@ -28,6 +28,11 @@ struct am_recttree_renderer_params {
 
 	/* Scaling factor of the current zoom when zooming in / out */
 	double zoom_factor;
+
+	/* Subtrees of the rect tree whose bounding box is smaller than this
+	 * number of pixels in both dimensions are rendered as a whole by the
+	 * aggregate rendering callback function */
+	double lod_threshold;
 };
 
 typedef void (*am_recttree_renderer_render_node_callback)
@@ -53,6 +58,13 @@ struct am_recttree_renderer {
 	/* callback function to render a single node */
 	am_recttree_renderer_render_node_callback render_rect_cb;
 
+	/* Optional callback function to render an entire subtree whose bounding
+	 * box is smaller than the level-of-detail threshold. The node passed
+	 * to the callback function is the root of the subtree and the screen
+	 * rectangle is the bounding box of the subtree. If NULL, all nodes
+	 * are rendered individually. */
+	am_recttree_renderer_render_node_callback render_aggregate_cb;
+
 	/* Current zoom (scaling factor) */
 	double zoom;
 
@@ -68,6 +80,9 @@ void am_recttree_renderer_init(
 	am_recttree_renderer_render_node_callback render_rect_cb,
 	void* cb_data);
 void am_recttree_renderer_destroy(struct am_recttree_renderer* r);
+void am_recttree_renderer_set_render_aggregate_callback(
+	struct am_recttree_renderer* r,
+	am_recttree_renderer_render_node_callback render_aggregate_cb);
 void am_recttree_renderer_set_recttree(struct am_recttree_renderer* r,
 				       const struct am_recttree* t);
 void am_recttree_renderer_zoom_in(struct am_recttree_renderer* r,
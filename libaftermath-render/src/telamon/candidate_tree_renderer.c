@@ -293,6 +293,66 @@ am_telamon_candidate_tree_renderer_render_edge(
 	cairo_stroke(cr);
 }
 
+/* Renders a subtree of the rect tree for nodes whose bounding box is smaller
+ * than a pixel as a single rectangle using the colors of the candidate at the
+ * root of the subtree. */
+static void
+am_telamon_candidate_tree_renderer_render_node_aggregate(
+	cairo_t* cr,
+	struct am_rect screen_rect,
+	double zoom,
+	const struct am_recttree_node* rtn,
+	void* data)
+{
+	struct am_telamon_candidate_tree_renderer* r = data;
+	const struct am_telamon_candidate_tree_node* n = (const void*)rtn;
+	const struct am_rgba* fill_color;
+	const struct am_rgba* stroke_color;
+
+	if(r->intervals &&
+	   !am_telamon_candidate_tree_node_in_intervals(
+		   n->candidate, r->intervals, r->num_intervals))
+	{
+		return;
+	}
+
+	if(screen_rect.width < 1)
+		screen_rect.width = 1;
+
+	if(screen_rect.height < 1)
+		screen_rect.height = 1;
+
+	am_telamon_candidate_tree_node_colors(
+		r, n->candidate, r->max_interval_end, &fill_color, &stroke_color);
+
+	cairo_set_source_rgba(cr, AM_PRGBA_ARGS(fill_color));
+	cairo_rectangle(cr, AM_RECT_ARGS(screen_rect));
+	cairo_fill(cr);
+}
+
+/* Renders a subtree of the rect tree for edges whose bounding box is smaller
+ * than a pixel as a single rectangle. */
+static void
+am_telamon_candidate_tree_renderer_render_edge_aggregate(
+	cairo_t* cr,
+	struct am_rect screen_rect,
+	double zoom,
+	const struct am_recttree_node* rtn,
+	void* data)
+{
+	struct am_telamon_candidate_tree_renderer* r = data;
+
+	if(screen_rect.width < 1)
+		screen_rect.width = 1;
+
+	if(screen_rect.height < 1)
+		screen_rect.height = 1;
+
+	cairo_set_source_rgba(cr, AM_PRGBA_ARGS(&r->params.color.edges.normal));
+	cairo_rectangle(cr, AM_RECT_ARGS(screen_rect));
+	cairo_fill(cr);
+}
+
 static void am_telamon_candidate_tree_renderer_reset_data(struct am_telamon_candidate_tree_renderer* r)
 {
 	free(r->nodes);
@@ -305,6 +365,9 @@ static void am_telamon_candidate_tree_renderer_reset_data(struct am_telamon_cand
 	am_recttree_renderer_set_recttree(&r->node_renderer, NULL);
 	am_recttree_renderer_set_recttree(&r->edge_renderer, NULL);
 
+	am_recttree_destroy(&r->node_rect_tree);
+	am_recttree_destroy(&r->edge_rect_tree);
+
 	r->valid = 0;
 }
 
@@ -495,11 +558,20 @@ int am_telamon_candidate_tree_renderer_set_root(
 		}
 	}
 
-	if(am_recttree_build(&r->node_rect_tree, rtnodes, num_nodes, max_depth))
+	/* Large candidate trees are bulk-loaded in parallel */
+	if(am_recttree_build_parallel(&r->node_rect_tree, rtnodes, num_nodes,
+				      max_depth, 0,
+				      AM_KDTREE_SPLIT_APPROX_MEDIAN))
+	{
 		goto out_err_all;
+	}
 
-	if(am_recttree_build(&r->edge_rect_tree, rtedges, num_edges, max_depth))
+	if(am_recttree_build_parallel(&r->edge_rect_tree, rtedges, num_edges,
+				      max_depth, 0,
+				      AM_KDTREE_SPLIT_APPROX_MEDIAN))
+	{
 		goto out_err_all;
+	}
 
 	am_recttree_renderer_set_recttree(&r->node_renderer, &r->node_rect_tree);
 	am_recttree_renderer_set_recttree(&r->edge_renderer, &r->edge_rect_tree);
@@ -536,11 +608,22 @@ void am_telamon_candidate_tree_renderer_init(struct am_telamon_candidate_tree_re
 
 	r->node_renderer.params.bgcolor = AM_RGBA255(0, 0, 0, 0);
 
+	am_recttree_renderer_set_render_aggregate_callback(
+		&r->node_renderer,
+		am_telamon_candidate_tree_renderer_render_node_aggregate);
+
 	am_recttree_renderer_init(
 		&r->edge_renderer,
 		am_telamon_candidate_tree_renderer_render_edge,
 		r);
 
+	am_recttree_renderer_set_render_aggregate_callback(
+		&r->edge_renderer,
+		am_telamon_candidate_tree_renderer_render_edge_aggregate);
+
+	am_recttree_init(&r->node_rect_tree, 2);
+	am_recttree_init(&r->edge_rect_tree, 2);
+
 	p->color.background = AM_RGBA255(0xFF, 0xFF, 0xFF, 0xFF);
 	p->color.edges.normal = AM_RGBA255(0x00, 0x00, 0x00, 0xFF);
 	p->color.edges.highlighted = AM_RGBA255(127, 0x00, 127, 0xFF);
@@ -142,8 +142,8 @@ static void render(struct am_timeline_discrete_layer* dl,
 		   cairo_t* cr)
 {
 	struct am_timeline_discrete_layer_type* dlt;
+	struct am_discrete_stats_by_index stats;
 	struct am_interval i_px;
-	struct am_timeline_renderer* r;
 	size_t idx;
 	size_t last_idx = 0;
 	int last_valid = 0;
@@ -154,24 +154,19 @@ static void render(struct am_timeline_discrete_layer* dl,
 	if(!dl->statistics_init)
 		return;
 
-	r = AM_TIMELINE_RENDER_LAYER(dl)->renderer;
+	/* Statistics are local to the invocation, such that lanes can be
+	 * rendered concurrently */
+	if(am_discrete_stats_by_index_init(&stats, dl->statistics.max_index))
+		return;
 
 	/* Process horizontal pixels of the lane */
 	for(unsigned int px = 0; px < ceil(lane_width); px++) {
-		am_timeline_renderer_relx_to_timestamp(r, px, &i_px.start);
-		am_timeline_renderer_relx_to_timestamp(r, px+1, &i_px.end);
-
-		/* Intervals are always inclusive; Exclude the last timestamp
-		 * from the current interval, since it will already be included
-		 * in the interval for the next pixel. */
-		if(i_px.end > i_px.start+1)
-			i_px.end--;
+		am_timeline_lane_pixel_interval(i, lane_width, px, &i_px);
+		am_discrete_stats_by_index_reset(&stats);
 
-		am_discrete_stats_by_index_reset(&dl->statistics);
+		dlt->stats_subtree(&dl->super, &stats, hn, &i_px);
 
-		dlt->stats_subtree(&dl->super, &dl->statistics, hn, &i_px);
-
-		valid = am_discrete_stats_by_index_max(&dl->statistics, &idx);
+		valid = am_discrete_stats_by_index_max(&stats, &idx);
 
 		if(valid) {
 			/* Invoke actual rendering function */
@@ -179,9 +174,11 @@ static void render(struct am_timeline_discrete_layer* dl,
 					   lane_width, lane_height,
 					   cr,
 					   px,
-					   &dl->statistics);
+					   &stats);
 		}
 	}
+
+	am_discrete_stats_by_index_destroy(&stats);
 }
 
 static void destroy(struct am_timeline_discrete_layer* l)
@@ -20,6 +20,38 @@
 #include <aftermath/render/timeline/renderer.h>
 #include <aftermath/core/state_event_array.h>
 #include <aftermath/core/event_collection.h>
+#include <aftermath/core/statistics/interval_summary.h>
+#include <pthread.h>
+
+/* Reference-counted summary of an event array. The array of summaries of a
+ * layer holds one reference and each render worker using the summary holds
+ * another one, such that a summary that is discarded while it is used remains
+ * valid until the last user has released it. */
+struct am_timeline_interval_layer_summary {
+	struct am_interval_summary summary;
+	size_t refcount;
+};
+
+AM_DECL_TYPED_ARRAY(am_timeline_interval_layer_summary_array,
+		    struct am_timeline_interval_layer_summary*)
+
+#define AM_TIMELINE_INTERVAL_LAYER_SUMMARY_ACC_ARR(x) ((x)->summary.arr)
+
+AM_DECL_TYPED_ARRAY_BSEARCH(am_timeline_interval_layer_summary_array,
+			    struct am_timeline_interval_layer_summary*,
+			    struct am_typed_array_generic*,
+			    AM_TIMELINE_INTERVAL_LAYER_SUMMARY_ACC_ARR,
+			    AM_VALCMP_EXPR)
+
+AM_DECL_TYPED_ARRAY_INSERTPOS(am_timeline_interval_layer_summary_array,
+			      struct am_timeline_interval_layer_summary*,
+			      struct am_typed_array_generic*,
+			      AM_TIMELINE_INTERVAL_LAYER_SUMMARY_ACC_ARR,
+			      AM_VALCMP_EXPR)
+
+AM_DECL_TYPED_ARRAY_RESERVE_SORTED(am_timeline_interval_layer_summary_array,
+				   struct am_timeline_interval_layer_summary*,
+				   struct am_typed_array_generic*)
 
 struct am_timeline_interval_layer {
 	struct am_timeline_lane_render_layer super;
@@ -27,6 +59,14 @@ struct am_timeline_interval_layer {
 	struct am_interval_stats_by_index statistics;
 	int statistics_init;
 	void* extra_data;
+
+	/* Lazily built summaries of the event arrays rendered by the layer,
+	 * sorted by the address of the summarized array */
+	struct am_timeline_interval_layer_summary_array summaries;
+
+	/* Protects summaries and the reference counts of the summaries, since
+	 * lanes may be rendered concurrently */
+	pthread_mutex_t summaries_lock;
 };
 
 struct am_timeline_interval_layer_type {
@@ -45,6 +85,29 @@ struct am_timeline_interval_layer_type {
 	size_t (*calculate_index)(struct am_timeline_interval_layer*, void*);
 };
 
+/* Drops a reference to the summary s and frees s if this was the last
+ * reference. Must be called with the summaries lock held. */
+static void am_timeline_interval_layer_summary_unref(
+	struct am_timeline_interval_layer_summary* s)
+{
+	if(--s->refcount == 0) {
+		am_interval_summary_destroy(&s->summary);
+		free(s);
+	}
+}
+
+/* Drops the references of the array of summaries of the layer l and empties
+ * the array. Must be called with the summaries lock held. */
+static void am_timeline_interval_layer_release_all_summaries(
+	struct am_timeline_interval_layer* l)
+{
+	for(size_t i = 0; i < l->summaries.num_elements; i++)
+		am_timeline_interval_layer_summary_unref(l->summaries.elements[i]);
+
+	am_timeline_interval_layer_summary_array_destroy(&l->summaries);
+	am_timeline_interval_layer_summary_array_init(&l->summaries);
+}
+
 /* Sets the set of colors to be used for rendering. */
 void
 am_timeline_interval_layer_set_color_map(struct am_timeline_interval_layer* l,
@@ -67,6 +130,12 @@ am_timeline_interval_layer_set_max_index(struct am_timeline_interval_layer* l,
 
 	l->statistics_init = 0;
 
+	/* Summaries are only valid for the previous maximum index. Summaries
+	 * still in use by render workers are freed once released. */
+	pthread_mutex_lock(&l->summaries_lock);
+	am_timeline_interval_layer_release_all_summaries(l);
+	pthread_mutex_unlock(&l->summaries_lock);
+
 	if(am_interval_stats_by_index_init(&l->statistics, max_idx))
 		return 1;
 
@@ -90,6 +159,91 @@ am_timeline_interval_layer_get_extra_data(struct am_timeline_interval_layer* l)
 	return l->extra_data;
 }
 
+/* Retrieves the summary for the event array ea of an interval layer whose
+ * intervals are associated to an index member. The summary is built upon the
+ * first request and rebuilt if the array has changed since. The caller holds a
+ * reference to the returned summary, which must be released with
+ * am_timeline_interval_layer_put_summary(), such that a concurrent rebuild does
+ * not free the summary while it is in use.
+ *
+ * Returns the summary or NULL if no summary can be provided.
+ */
+static struct am_timeline_interval_layer_summary*
+am_timeline_interval_layer_get_summary(struct am_timeline_interval_layer* il,
+				       struct am_typed_array_generic* ea)
+{
+	struct am_timeline_interval_layer_type* ilt;
+	struct am_timeline_interval_layer_summary** ps;
+	struct am_timeline_interval_layer_summary* s;
+	size_t max_index;
+
+	ilt = (struct am_timeline_interval_layer_type*)il->super.super.type;
+
+	pthread_mutex_lock(&il->summaries_lock);
+
+	max_index = il->statistics.max_index;
+
+	if((ps = am_timeline_interval_layer_summary_array_bsearch(
+		    &il->summaries, ea)))
+	{
+		if(am_interval_summary_valid_p(&(*ps)->summary, ea, max_index))
+			goto out_ref;
+
+		/* Outdated; users of the old summary keep their reference */
+		am_timeline_interval_layer_summary_unref(*ps);
+		am_timeline_interval_layer_summary_array_removep(&il->summaries,
+								 ps);
+	}
+
+	if(!(s = malloc(sizeof(*s))))
+		goto out_err;
+
+	if(am_interval_summary_init(&s->summary, ea,
+				    ilt->element_size,
+				    ilt->interval_offset,
+				    ilt->index_offset,
+				    ilt->index_bits,
+				    max_index))
+	{
+		goto out_err_free;
+	}
+
+	if(!(ps = am_timeline_interval_layer_summary_array_reserve_sorted(
+		     &il->summaries, ea)))
+	{
+		goto out_err_destroy;
+	}
+
+	/* Reference held by the array of summaries */
+	s->refcount = 1;
+	*ps = s;
+
+out_ref:
+	s = *ps;
+	s->refcount++;
+	pthread_mutex_unlock(&il->summaries_lock);
+
+	return s;
+
+out_err_destroy:
+	am_interval_summary_destroy(&s->summary);
+out_err_free:
+	free(s);
+out_err:
+	pthread_mutex_unlock(&il->summaries_lock);
+	return NULL;
+}
+
+/* Releases a summary obtained from am_timeline_interval_layer_get_summary(). */
+static void
+am_timeline_interval_layer_put_summary(struct am_timeline_interval_layer* il,
+				       struct am_timeline_interval_layer_summary* s)
+{
+	pthread_mutex_lock(&il->summaries_lock);
+	am_timeline_interval_layer_summary_unref(s);
+	pthread_mutex_unlock(&il->summaries_lock);
+}
+
 /* Calculates the statistics for an interval i, starting with the hierarchy node
  * hn. If the layer's render mode is
  * AM_TIMELINE_LANE_RENDER_MODE_COMBINE_SUBTREE, the function recurses on the
@@ -104,6 +258,7 @@ static void am_timeline_interval_layer_default_stats_subtree(
 	struct am_typed_array_generic* ea;
 	struct am_event_mapping* m = &hn->event_mapping;
 	struct am_event_collection* ec;
+	struct am_timeline_interval_layer_summary* s;
 	struct am_hierarchy_node* child;
 	struct am_timeline_interval_layer* il = (typeof(il))rl;
 	struct am_timeline_render_layer* l = AM_TIMELINE_RENDER_LAYER(il);
@@ -125,6 +280,20 @@ static void am_timeline_interval_layer_default_stats_subtree(
 				ilt->interval_offset,
 				(size_t (*) (void*, void*))ilt->calculate_index,
 				il);
+		} else if(il->statistics_init &&
+			  stats->max_index == il->statistics.max_index &&
+			  (s = am_timeline_interval_layer_get_summary(il, ea)))
+		{
+			am_interval_summary_collect(
+				&s->summary,
+				stats,
+				i,
+				ilt->element_size,
+				ilt->interval_offset,
+				ilt->index_offset,
+				ilt->index_bits);
+
+			am_timeline_interval_layer_put_summary(il, s);
 		} else {
 			am_interval_stats_by_index_collect(
 				stats,
@@ -156,8 +325,8 @@ static void render(struct am_timeline_interval_layer* il,
 		   cairo_t* cr)
 {
 	struct am_timeline_interval_layer_type* ilt;
+	struct am_interval_stats_by_index stats;
 	struct am_interval i_px;
-	struct am_timeline_renderer* r;
 	const struct am_rgba* color;
 	unsigned int last_start_px = 0;
 	size_t idx;
@@ -170,24 +339,19 @@ static void render(struct am_timeline_interval_layer* il,
 	if(!il->color_map || !il->statistics_init)
 		return;
 
-	r = AM_TIMELINE_RENDER_LAYER(il)->renderer;
+	/* Statistics are local to the invocation, such that lanes can be
+	 * rendered concurrently */
+	if(am_interval_stats_by_index_init(&stats, il->statistics.max_index))
+		return;
 
 	/* Process horizontal pixels of the lane */
 	for(unsigned int px = 0; px < ceil(lane_width); px++) {
-		am_timeline_renderer_relx_to_timestamp(r, px, &i_px.start);
-		am_timeline_renderer_relx_to_timestamp(r, px+1, &i_px.end);
+		am_timeline_lane_pixel_interval(i, lane_width, px, &i_px);
+		am_interval_stats_by_index_reset(&stats);
 
-		/* Intervals are always inclusive; Exclude the last timestamp
-		 * from the current interval, since it will already be included
-		 * in the interval for the next pixel. */
-		if(i_px.end > i_px.start+1)
-			i_px.end--;
+		ilt->stats_subtree(&il->super, &stats, hn, &i_px);
 
-		am_interval_stats_by_index_reset(&il->statistics);
-
-		ilt->stats_subtree(&il->super, &il->statistics, hn, &i_px);
-
-		valid = am_interval_stats_by_index_max(&il->statistics, &idx);
+		valid = am_interval_stats_by_index_max(&stats, &idx);
 
 		/* Draw the previous rectangle if the current color is different
 		 * or if the current pixel is transparent. */
@@ -232,12 +396,18 @@ static void render(struct am_timeline_interval_layer* il,
 			cairo_fill(cr);
 		}
 	}
+
+	am_interval_stats_by_index_destroy(&stats);
 }
 
 static void destroy(struct am_timeline_interval_layer* l)
 {
 	if(l->statistics_init)
 		am_interval_stats_by_index_destroy(&l->statistics);
+
+	am_timeline_interval_layer_release_all_summaries(l);
+	am_timeline_interval_layer_summary_array_destroy(&l->summaries);
+	pthread_mutex_destroy(&l->summaries_lock);
 }
 
 static struct am_timeline_interval_layer*
@@ -248,9 +418,15 @@ instantiate(struct am_timeline_interval_layer_type* t)
 	if(!(l = malloc(sizeof(*l))))
 		return NULL;
 
+	if(pthread_mutex_init(&l->summaries_lock, NULL)) {
+		free(l);
+		return NULL;
+	}
+
 	l->color_map = NULL;
 	l->statistics_init = 0;
 	l->extra_data = NULL;
+	am_timeline_interval_layer_summary_array_init(&l->summaries);
 
 	am_timeline_lane_render_layer_init(&l->super, &t->super);
 
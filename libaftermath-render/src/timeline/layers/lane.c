@@ -47,6 +47,26 @@ destroy(struct am_timeline_lane_render_layer* l)
 	tl->destroy(l);
 }
 
+/* Renders the lane for the hierarchy node hn of the lane render layer l with
+ * the interval i spanning lane_width pixels. In contrast to the render function
+ * invoked by the timeline renderer, the interval and dimensions are independent
+ * of the renderer's visible interval, which allows for rendering of parts of a
+ * lane (e.g., tiles). The upper left corner of the lane is at (0, 0) of the
+ * cairo context cr. */
+void am_timeline_lane_render_layer_render_lane(
+	struct am_timeline_lane_render_layer* l,
+	struct am_hierarchy_node* hn,
+	struct am_interval* i,
+	double lane_width,
+	double lane_height,
+	cairo_t* cr)
+{
+	struct am_timeline_lane_render_layer_type* t =
+		AM_TIMELINE_LANE_RENDER_LAYER_TYPE(l->super.type);
+
+	t->render(l, hn, i, lane_width, lane_height, cr);
+}
+
 struct render_lane_data {
 	struct am_timeline_lane_render_layer* layer;
 	cairo_t* cr;
@@ -75,12 +95,18 @@ render_lane(struct am_timeline_renderer* r,
 	cairo_clip(data->cr);
 	cairo_translate(data->cr, lane_rect.x, lane_rect.y);
 
-	t->render(data->layer,
-		  n,
-		  &r->visible_interval,
-		  r->rects.lanes.width,
-		  r->lane_height,
-		  data->cr);
+	/* Delegate to the function set by the owner of the renderer (e.g., for
+	 * composition of lanes from pre-rendered tiles) if available */
+	if(r->draw_lane.fun) {
+		r->draw_lane.fun(r, data->layer, n, data->cr, r->draw_lane.data);
+	} else {
+		t->render(data->layer,
+			  n,
+			  &r->visible_interval,
+			  r->rects.lanes.width,
+			  r->lane_height,
+			  data->cr);
+	}
 
 	cairo_restore(data->cr);
 
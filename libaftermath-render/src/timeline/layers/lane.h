@@ -25,6 +25,9 @@
 
 #include <aftermath/render/timeline/layer.h>
 #include <aftermath/core/hierarchy.h>
+#include <aftermath/core/arithmetic.h>
+#include <aftermath/core/interval.h>
+#include <aftermath/core/timestamp.h>
 
 struct am_timeline_lane_render_layer_type;
 
@@ -89,4 +92,48 @@ int am_timeline_lane_render_layer_type_init(
 	struct am_timeline_lane_render_layer_type* l,
 	const char* name);
 
+void am_timeline_lane_render_layer_render_lane(
+	struct am_timeline_lane_render_layer* l,
+	struct am_hierarchy_node* hn,
+	struct am_interval* i,
+	double lane_width,
+	double lane_height,
+	cairo_t* cr);
+
+/* Calculates the interval covered by the horizontal pixel px of a lane with a
+ * width of lane_width pixels that displays the interval i. Since intervals are
+ * inclusive, the last timestamp is excluded, as it is already covered by the
+ * next pixel.
+ *
+ * The calculation only depends on its arguments, such that lanes can be
+ * rendered for arbitrary intervals and widths, e.g., by multiple threads
+ * rendering tiles of the same lane.
+ */
+static inline void
+am_timeline_lane_pixel_interval(const struct am_interval* i,
+				double lane_width,
+				unsigned int px,
+				struct am_interval* out)
+{
+	struct am_time_offset d;
+	uint64_t offs;
+
+	out->start = i->start;
+	out->end = i->start;
+
+	if(lane_width == 0)
+		return;
+
+	am_interval_duration(i, &d);
+
+	am_muldiv_sat_u64(px, d.abs, lane_width, &offs);
+	am_timestamp_add_sat(&out->start, offs);
+
+	am_muldiv_sat_u64(px+1, d.abs, lane_width, &offs);
+	am_timestamp_add_sat(&out->end, offs);
+
+	if(out->end > out->start+1)
+		out->end--;
+}
+
 #endif
@@ -64,6 +64,9 @@ int am_timeline_renderer_init(struct am_timeline_renderer* r)
 
 	INIT_LIST_HEAD(&r->layer_appearance_change_callbacks);
 
+	r->draw_lane.fun = NULL;
+	r->draw_lane.data = NULL;
+
 	return 0;
 }
 
@@ -910,3 +913,15 @@ void am_timeline_renderer_indicate_layer_appearance_change(
 		cbfe->callback(r, l, cbfe->data);
 	}
 }
+
+/* Sets the function fun that draws the lanes of lane render layers instead of
+ * the layers' render functions. Data is passed verbatim to fun. If fun is NULL,
+ * lanes are rendered directly by the layers. */
+void am_timeline_renderer_set_draw_lane_fun(
+	struct am_timeline_renderer* r,
+	am_timeline_renderer_draw_lane_fun_t fun,
+	void* data)
+{
+	r->draw_lane.fun = fun;
+	r->draw_lane.data = data;
+}
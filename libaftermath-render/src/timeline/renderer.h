@@ -28,6 +28,19 @@
 #include <aftermath/render/timeline/layer.h>
 #include <aftermath/core/trace.h>
 
+struct am_timeline_renderer;
+struct am_timeline_lane_render_layer;
+
+/* Function drawing a single lane of a lane render layer instead of the layer's
+ * render function. The transformation matrix of the cairo context is set up
+ * such that the upper left corner of the lane is at (0, 0). */
+typedef void (*am_timeline_renderer_draw_lane_fun_t)(
+	struct am_timeline_renderer* r,
+	struct am_timeline_lane_render_layer* l,
+	struct am_hierarchy_node* n,
+	cairo_t* cr,
+	void* data);
+
 enum am_timeline_renderer_lane_mode {
 	/* Always use a separate lane for a node */
 	AM_TIMELINE_RENDERER_LANE_MODE_ALWAYS_SEPARATE,
@@ -123,6 +136,14 @@ struct am_timeline_renderer {
 	 * structures whose callback functions get invoked when a layer informs
 	 * the timeline renderer that it's appearance has changed. */
 	struct list_head layer_appearance_change_callbacks;
+
+	/* Optional function drawing the lanes of lane render layers, e.g., from
+	 * cached tiles. If fun is NULL, the lanes are rendered directly by the
+	 * layers. */
+	struct {
+		am_timeline_renderer_draw_lane_fun_t fun;
+		void* data;
+	} draw_lane;
 };
 
 /* Entry for the list of callback functions that get invoked when a layer
@@ -279,6 +300,11 @@ void am_timeline_renderer_indicate_layer_appearance_change(
 	struct am_timeline_renderer* r,
 	struct am_timeline_render_layer* layer);
 
+void am_timeline_renderer_set_draw_lane_fun(
+	struct am_timeline_renderer* r,
+	am_timeline_renderer_draw_lane_fun_t fun,
+	void* data);
+
 /* Calculates the X coordinate in pixels for a timestamp t relative to the left
  * of the rectangle for the lanes. */
 static inline double
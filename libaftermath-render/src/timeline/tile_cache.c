@@ -0,0 +1,261 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include <aftermath/render/timeline/tile_cache.h>
+
+void am_timeline_tile_destroy(struct am_timeline_tile* t)
+{
+	cairo_surface_destroy(t->surface);
+}
+
+/* Initializes a tile cache c holding at most max_tiles tiles. */
+void am_timeline_tile_cache_init(struct am_timeline_tile_cache* c,
+				 size_t max_tiles)
+{
+	am_timeline_tile_array_init(&c->tiles);
+	c->max_tiles = max_tiles;
+	c->clock = 0;
+}
+
+/* Destroys a tile cache c and releases all of its tiles */
+void am_timeline_tile_cache_destroy(struct am_timeline_tile_cache* c)
+{
+	am_timeline_tile_array_destroy(&c->tiles);
+}
+
+/* Returns the surface of the tile with the given key or NULL if the tile is not
+ * in the cache. The surface remains owned by the cache. */
+cairo_surface_t*
+am_timeline_tile_cache_lookup(struct am_timeline_tile_cache* c,
+			      struct am_timeline_tile_key* key)
+{
+	struct am_timeline_tile* t;
+
+	if(!(t = am_timeline_tile_array_bsearch(&c->tiles, key)))
+		return NULL;
+
+	t->last_use = c->clock++;
+
+	return t->surface;
+}
+
+/* Evicts the least recently used tile from the cache c */
+static void am_timeline_tile_cache_evict_lru(struct am_timeline_tile_cache* c)
+{
+	struct am_timeline_tile* lru;
+
+	if(c->tiles.num_elements == 0)
+		return;
+
+	lru = &c->tiles.elements[0];
+
+	for(size_t i = 1; i < c->tiles.num_elements; i++)
+		if(c->tiles.elements[i].last_use < lru->last_use)
+			lru = &c->tiles.elements[i];
+
+	am_timeline_tile_destroy(lru);
+	am_timeline_tile_array_removep(&c->tiles, lru);
+}
+
+/* Adds a tile with the given key and surface to the cache c. If the cache is
+ * full, the least recently used tile is evicted. If a tile with the same key
+ * is already present, its surface is replaced. On success, the cache takes
+ * ownership of the surface.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_timeline_tile_cache_insert(struct am_timeline_tile_cache* c,
+				  struct am_timeline_tile_key* key,
+				  cairo_surface_t* surface)
+{
+	struct am_timeline_tile* t;
+
+	if((t = am_timeline_tile_array_bsearch(&c->tiles, key))) {
+		am_timeline_tile_destroy(t);
+	} else {
+		if(c->max_tiles == 0)
+			return 1;
+
+		if(c->tiles.num_elements >= c->max_tiles)
+			am_timeline_tile_cache_evict_lru(c);
+
+		if(!(t = am_timeline_tile_array_reserve_sorted(&c->tiles, key)))
+			return 1;
+
+		t->key = *key;
+	}
+
+	t->surface = surface;
+	t->last_use = c->clock++;
+
+	return 0;
+}
+
+/* Removes all tiles from the cache c */
+void am_timeline_tile_cache_invalidate_all(struct am_timeline_tile_cache* c)
+{
+	am_timeline_tile_array_destroy(&c->tiles);
+	am_timeline_tile_array_init(&c->tiles);
+}
+
+/* Removes all tiles rendered by the layer l from the cache c */
+void am_timeline_tile_cache_invalidate_layer(
+	struct am_timeline_tile_cache* c,
+	struct am_timeline_lane_render_layer* l)
+{
+	size_t dst = 0;
+
+	for(size_t i = 0; i < c->tiles.num_elements; i++) {
+		if(c->tiles.elements[i].key.layer == l)
+			am_timeline_tile_destroy(&c->tiles.elements[i]);
+		else
+			c->tiles.elements[dst++] = c->tiles.elements[i];
+	}
+
+	c->tiles.num_free += c->tiles.num_elements - dst;
+	c->tiles.num_elements = dst;
+}
+
+/* Calculates the duration of a tile pixel for the currently visible interval
+ * of the renderer r, i.e., the largest power of two that is smaller or equal to
+ * the duration of a pixel of the renderer. Returns 0 if nothing is visible. */
+static am_timestamp_t
+am_timeline_tile_pixel_duration(struct am_timeline_renderer* r)
+{
+	struct am_time_offset d;
+	am_timestamp_t pxdur;
+	am_timestamp_t ret = 1;
+
+	am_interval_duration(&r->visible_interval, &d);
+
+	if(d.abs == 0 || r->rects.lanes.width < 1)
+		return 0;
+
+	pxdur = d.abs / (am_timestamp_t)r->rects.lanes.width;
+
+	while(ret <= pxdur / 2 &&
+	      ret <= UINT64_MAX / (2 * AM_TIMELINE_TILE_WIDTH))
+	{
+		ret *= 2;
+	}
+
+	return ret;
+}
+
+/* Draws the lane for the hierarchy node n of the lane render layer l of the
+ * renderer r from the tiles of the cache c covering the visible interval. The
+ * transformation matrix of cr must be set up such that the upper left corner
+ * of the lane is at (0, 0). For each tile that is not present in the cache, the
+ * function miss is invoked with miss_data and the area of the tile is left
+ * blank. */
+void am_timeline_tile_cache_draw_lane(struct am_timeline_tile_cache* c,
+				      struct am_timeline_renderer* r,
+				      struct am_timeline_lane_render_layer* l,
+				      struct am_hierarchy_node* n,
+				      cairo_t* cr,
+				      am_timeline_tile_cache_miss_fun_t miss,
+				      void* miss_data)
+{
+	struct am_timeline_tile_key key;
+	struct am_interval tile_interval;
+	struct am_time_offset d;
+	cairo_surface_t* surface;
+	am_timestamp_t tile_duration;
+	uint64_t first;
+	uint64_t last;
+	double px_per_ts;
+	double x;
+
+	if(!(key.pixel_duration = am_timeline_tile_pixel_duration(r)))
+		return;
+
+	am_interval_duration(&r->visible_interval, &d);
+
+	key.layer = l;
+	key.node = n;
+	key.height = ceil(r->lane_height);
+
+	tile_duration = AM_TIMELINE_TILE_WIDTH * key.pixel_duration;
+	first = r->visible_interval.start / tile_duration;
+	last = r->visible_interval.end / tile_duration;
+	px_per_ts = r->rects.lanes.width / (double)d.abs;
+
+	for(uint64_t idx = first; idx <= last; idx++) {
+		key.index = idx;
+
+		if(!(surface = am_timeline_tile_cache_lookup(c, &key))) {
+			miss(&key, miss_data);
+			continue;
+		}
+
+		am_timeline_tile_key_interval(&key, &tile_interval);
+
+		x = ((double)tile_interval.start -
+		     (double)r->visible_interval.start) * px_per_ts;
+
+		cairo_save(cr);
+		cairo_translate(cr, x, 0);
+		cairo_scale(cr, tile_duration * px_per_ts / AM_TIMELINE_TILE_WIDTH,
+			    1.0);
+		cairo_set_source_surface(cr, surface, 0, 0);
+		cairo_rectangle(cr, 0, 0, AM_TIMELINE_TILE_WIDTH, key.height);
+		cairo_fill(cr);
+		cairo_restore(cr);
+	}
+}
+
+/* Renders the tile with the key k into a new image surface. The function only
+ * depends on the key and may be invoked concurrently from multiple threads, as
+ * long as the layer and the trace are not modified during rendering.
+ *
+ * Returns the new surface or NULL on failure.
+ */
+cairo_surface_t* am_timeline_tile_render(const struct am_timeline_tile_key* k)
+{
+	struct am_interval i;
+	cairo_surface_t* surface;
+	cairo_t* cr;
+
+	surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+					     AM_TIMELINE_TILE_WIDTH,
+					     k->height);
+
+	if(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+		goto out_err;
+
+	cr = cairo_create(surface);
+
+	if(cairo_status(cr) != CAIRO_STATUS_SUCCESS)
+		goto out_err_cr;
+
+	am_timeline_tile_key_interval(k, &i);
+	am_timeline_lane_render_layer_render_lane(k->layer, k->node, &i,
+						  AM_TIMELINE_TILE_WIDTH,
+						  k->height, cr);
+
+	cairo_destroy(cr);
+	cairo_surface_flush(surface);
+
+	return surface;
+
+out_err_cr:
+	cairo_destroy(cr);
+out_err:
+	cairo_surface_destroy(surface);
+	return NULL;
+}
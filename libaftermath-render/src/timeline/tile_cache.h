@@ -0,0 +1,177 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_RENDER_TIMELINE_TILE_CACHE_H
+#define AM_RENDER_TIMELINE_TILE_CACHE_H
+
+/* Cache for pre-rendered tiles of timeline lanes. A tile is an image of fixed
+ * width showing the events of a lane render layer for a single hierarchy node
+ * during an interval. Tiles are anchored to a global grid in time: the n-th
+ * tile at a given resolution starts at n * AM_TIMELINE_TILE_WIDTH *
+ * pixel_duration, where pixel_duration is a power of two. Tiles thus remain
+ * valid when the visible interval is shifted and can be reused across zoom
+ * levels that map to the same resolution.
+ *
+ * Rendering of a tile only depends on its key, such that tiles can be rendered
+ * concurrently by worker threads. The cache itself is not thread-safe and
+ * should only be accessed from the thread owning the timeline renderer.
+ */
+
+#include <aftermath/core/bsearch.h>
+#include <aftermath/core/typed_array.h>
+#include <aftermath/render/timeline/renderer.h>
+#include <aftermath/render/timeline/layers/lane.h>
+#include <cairo.h>
+
+/* Width in pixels of a tile */
+#define AM_TIMELINE_TILE_WIDTH 256
+
+/* Uniquely identifies a tile */
+struct am_timeline_tile_key {
+	/* Layer rendering the tile */
+	struct am_timeline_lane_render_layer* layer;
+
+	/* Hierarchy node whose lane is displayed */
+	struct am_hierarchy_node* node;
+
+	/* Duration represented by a single pixel of the tile; always a power
+	 * of two */
+	am_timestamp_t pixel_duration;
+
+	/* Position of the tile on the grid */
+	uint64_t index;
+
+	/* Height of the tile in pixels */
+	unsigned int height;
+};
+
+/* Compares two tile keys a and b. Returns a negative value if a is ordered
+ * before b, a positive value if a is ordered after b and 0 if both keys are
+ * identical. */
+static inline int
+am_timeline_tile_key_cmp(const struct am_timeline_tile_key* a,
+			 const struct am_timeline_tile_key* b)
+{
+	int ret;
+
+	if((ret = AM_VALCMP_PTR(a->layer, b->layer)))
+		return ret;
+
+	if((ret = AM_VALCMP_PTR(a->node, b->node)))
+		return ret;
+
+	if((ret = AM_VALCMP_EXPR(a->pixel_duration, b->pixel_duration)))
+		return ret;
+
+	if((ret = AM_VALCMP_EXPR(a->index, b->index)))
+		return ret;
+
+	return AM_VALCMP_EXPR(a->height, b->height);
+}
+
+/* Calculates the interval displayed by the tile with the key k. */
+static inline void
+am_timeline_tile_key_interval(const struct am_timeline_tile_key* k,
+			      struct am_interval* i)
+{
+	uint64_t duration = AM_TIMELINE_TILE_WIDTH * k->pixel_duration;
+
+	am_mul_sat_u64(k->index, duration, &i->start);
+	am_add_sat_u64(i->start, duration, &i->end);
+}
+
+struct am_timeline_tile {
+	struct am_timeline_tile_key key;
+	cairo_surface_t* surface;
+
+	/* Value of the cache's clock upon the last access to the tile */
+	uint64_t last_use;
+};
+
+void am_timeline_tile_destroy(struct am_timeline_tile* t);
+
+AM_DECL_TYPED_ARRAY_WITH_ELEMENT_DESTRUCTOR(am_timeline_tile_array,
+					   struct am_timeline_tile,
+					   am_timeline_tile_destroy)
+
+#define AM_TIMELINE_TILE_ACC_KEY(x) (&(x).key)
+
+AM_DECL_TYPED_ARRAY_BSEARCH(am_timeline_tile_array,
+			    struct am_timeline_tile,
+			    struct am_timeline_tile_key*,
+			    AM_TIMELINE_TILE_ACC_KEY,
+			    am_timeline_tile_key_cmp)
+
+AM_DECL_TYPED_ARRAY_INSERTPOS(am_timeline_tile_array,
+			      struct am_timeline_tile,
+			      struct am_timeline_tile_key*,
+			      AM_TIMELINE_TILE_ACC_KEY,
+			      am_timeline_tile_key_cmp)
+
+AM_DECL_TYPED_ARRAY_RESERVE_SORTED(am_timeline_tile_array,
+				   struct am_timeline_tile,
+				   struct am_timeline_tile_key*)
+
+struct am_timeline_tile_cache {
+	/* Tiles sorted by key */
+	struct am_timeline_tile_array tiles;
+
+	/* Maximum number of tiles before the least recently used tiles get
+	 * evicted */
+	size_t max_tiles;
+
+	/* Incremented upon each access */
+	uint64_t clock;
+};
+
+/* Function invoked for tiles that are needed for drawing, but not present in
+ * the cache */
+typedef void (*am_timeline_tile_cache_miss_fun_t)(
+	const struct am_timeline_tile_key* key,
+	void* data);
+
+void am_timeline_tile_cache_init(struct am_timeline_tile_cache* c,
+				 size_t max_tiles);
+
+void am_timeline_tile_cache_destroy(struct am_timeline_tile_cache* c);
+
+cairo_surface_t*
+am_timeline_tile_cache_lookup(struct am_timeline_tile_cache* c,
+			      struct am_timeline_tile_key* key);
+
+int am_timeline_tile_cache_insert(struct am_timeline_tile_cache* c,
+				  struct am_timeline_tile_key* key,
+				  cairo_surface_t* surface);
+
+void am_timeline_tile_cache_invalidate_all(struct am_timeline_tile_cache* c);
+
+void am_timeline_tile_cache_invalidate_layer(
+	struct am_timeline_tile_cache* c,
+	struct am_timeline_lane_render_layer* l);
+
+void am_timeline_tile_cache_draw_lane(struct am_timeline_tile_cache* c,
+				      struct am_timeline_renderer* r,
+				      struct am_timeline_lane_render_layer* l,
+				      struct am_hierarchy_node* n,
+				      cairo_t* cr,
+				      am_timeline_tile_cache_miss_fun_t miss,
+				      void* miss_data);
+
+cairo_surface_t* am_timeline_tile_render(const struct am_timeline_tile_key* k);
+
+#endif
@@ -0,0 +1 @@
+../../../src/async_writer.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/counter_sampler.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../src/tsc_calibration.h
\ No newline at end of file
@@ -24,6 +24,17 @@
 /**
  * Reads the executing core's timestamp counter and returns the value as a
  * am_timestamp_t.
+ *
+ * am_tsc_ordered() is identical to am_tsc(), but only reads the counter once
+ * all preceding instructions have completed.
+ *
+ * am_tscp() reads the counter after all preceding instructions have completed
+ * and atomically stores the number of the executing CPU in *cpu, such that the
+ * value can be corrected with the offset of that CPU's counter.
+ *
+ * On architectures without a supported timestamp counter, all functions fall
+ * back to CLOCK_MONOTONIC_RAW in nanoseconds and AM_TSC_IS_MONOTONIC_CLOCK is
+ * defined. In this case, *cpu is always set to 0.
  */
 #ifdef __i386
 	static inline uint64_t am_tsc(void)
@@ -33,6 +44,21 @@
 		return x;
 	}
 
+	static inline uint64_t am_tsc_ordered(void)
+	{
+		uint64_t x;
+		__asm__ volatile ("lfence\n\trdtsc" : "=A" (x) : : "memory");
+		return x;
+	}
+
+	static inline uint64_t am_tscp(uint32_t* cpu)
+	{
+		uint32_t a, d, c;
+		__asm__ volatile ("rdtscp" : "=a" (a), "=d" (d), "=c" (c));
+		*cpu = c & 0xfff;
+		return ((uint64_t)d << 32) | a;
+	}
+
 #elif defined __amd64
 	static inline uint64_t am_tsc(void)
 	{
@@ -40,8 +66,59 @@
 		__asm__ volatile ("rdtsc" : "=a" (a), "=d" (d));
 		return (d<<32) | a;
 	}
+
+	static inline uint64_t am_tsc_ordered(void)
+	{
+		uint64_t a, d;
+		__asm__ volatile ("lfence\n\trdtsc" : "=a" (a), "=d" (d) : : "memory");
+		return (d<<32) | a;
+	}
+
+	static inline uint64_t am_tscp(uint32_t* cpu)
+	{
+		uint64_t a, d, c;
+		__asm__ volatile ("rdtscp" : "=a" (a), "=d" (d), "=c" (c));
+		*cpu = c & 0xfff;
+		return (d<<32) | a;
+	}
 #else
-	#error "No timestamp counter function defined for your architecture"
+	#include <time.h>
+
+	#define AM_TSC_IS_MONOTONIC_CLOCK 1
+
+	static inline uint64_t am_tsc(void)
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+	}
+
+	static inline uint64_t am_tsc_ordered(void)
+	{
+		return am_tsc();
+	}
+
+	static inline uint64_t am_tscp(uint32_t* cpu)
+	{
+		*cpu = 0;
+		return am_tsc();
+	}
+#endif
+
+/**
+ * Reads the performance monitoring counter with the given hardware index
+ * directly from user space. Only available if AM_HAVE_RDPMC is defined and only
+ * permitted if the kernel allows user space access to the counter.
+ */
+#if defined __i386 || defined __amd64
+	#define AM_HAVE_RDPMC 1
+
+	static inline uint64_t am_rdpmc(uint32_t counter)
+	{
+		uint32_t a, d;
+		__asm__ volatile ("rdpmc" : "=a" (a), "=d" (d) : "c" (counter));
+		return ((uint64_t)d << 32) | a;
+	}
 #endif
 
 #endif
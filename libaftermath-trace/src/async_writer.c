@@ -0,0 +1,265 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * Libaftermath-trace is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "async_writer.h"
+#include <aftermath/trace/safe_alloc.h>
+#include <errno.h>
+
+/* Hands the current chunk of the channel passed as data over to the writer
+ * thread and replaces the data buffer of wb with the next chunk of the ring.
+ * Called by the thread recording events. Never blocks.
+ *
+ * Returns 0 if a free chunk was available, otherwise 1.
+ */
+static int am_async_writer_channel_full(struct am_write_buffer* wb,
+					void* data)
+{
+	struct am_async_writer_channel* c = data;
+	uint64_t next = c->published + 1;
+	uint64_t flushed;
+
+	flushed = __atomic_load_n(&c->flushed, __ATOMIC_ACQUIRE);
+
+	/* The next chunk has not been written to disk yet */
+	if(next - flushed >= c->num_chunks) {
+		c->num_dropped++;
+		return 1;
+	}
+
+	c->chunk_used[c->published % c->num_chunks] = wb->used;
+	__atomic_store_n(&c->published, next, __ATOMIC_RELEASE);
+	sem_post(&c->writer->sem);
+
+	wb->data = c->chunks[next % c->num_chunks];
+	wb->used = 0;
+
+	return 0;
+}
+
+/* Writes all chunks of a channel that have been handed over to the writer
+ * thread, but that haven't been written yet. */
+static void am_async_writer_channel_flush(struct am_async_writer* w,
+					  struct am_async_writer_channel* c)
+{
+	uint64_t published;
+	size_t slot;
+
+	published = __atomic_load_n(&c->published, __ATOMIC_ACQUIRE);
+
+	while(c->flushed < published) {
+		slot = c->flushed % c->num_chunks;
+
+		if(c->chunk_used[slot] > 0 && !w->error) {
+			if(fwrite(c->chunks[slot], c->chunk_used[slot], 1,
+				  w->fp) != 1)
+			{
+				w->error = 1;
+			}
+		}
+
+		/* Chunks are released even on error, such that the producer
+		 * never stalls */
+		__atomic_store_n(&c->flushed, c->flushed + 1, __ATOMIC_RELEASE);
+	}
+}
+
+/* Writes all chunks of all channels that have been handed over to the writer
+ * thread */
+static void am_async_writer_flush(struct am_async_writer* w)
+{
+	struct am_async_writer_channel* c;
+
+	for(c = __atomic_load_n(&w->channels, __ATOMIC_ACQUIRE);
+	    c;
+	    c = c->next)
+	{
+		am_async_writer_channel_flush(w, c);
+	}
+}
+
+static void* am_async_writer_thread(void* data)
+{
+	struct am_async_writer* w = data;
+
+	for(;;) {
+		if(sem_wait(&w->sem) && errno == EINTR)
+			continue;
+
+		am_async_writer_flush(w);
+
+		if(__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE))
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * Initializes an asynchronous writer and starts the writer thread. All chunks
+ * are written to fp, which must be open in write mode.
+ *
+ * @return 0 on success, otherwise 1
+ */
+int am_async_writer_init(struct am_async_writer* w, FILE* fp)
+{
+	w->fp = fp;
+	w->channels = NULL;
+	w->stop = 0;
+	w->error = 0;
+	w->num_dropped = 0;
+
+	if(sem_init(&w->sem, 0, 0))
+		goto out_err;
+
+	if(pthread_create(&w->thread, NULL, am_async_writer_thread, w))
+		goto out_err_sem;
+
+	return 0;
+
+out_err_sem:
+	sem_destroy(&w->sem);
+out_err:
+	return 1;
+}
+
+/**
+ * Associates the write buffer wb with a new channel of the writer w. The size
+ * of the chunks of the channel is the size of wb and the current data buffer
+ * of wb is used as the first chunk. The channel uses num_chunks chunks in
+ * total, which must be at least 2. May be called concurrently with the
+ * writer thread and from any thread.
+ *
+ * @return 0 on success, otherwise 1
+ */
+int am_async_writer_add_channel(struct am_async_writer* w,
+				struct am_write_buffer* wb,
+				size_t num_chunks)
+{
+	struct am_async_writer_channel* c;
+	size_t i;
+
+	if(num_chunks < 2)
+		goto out_err;
+
+	if(!(c = malloc(sizeof(*c))))
+		goto out_err;
+
+	if(!(c->chunks = am_alloc_array_safe(num_chunks, sizeof(c->chunks[0]))))
+		goto out_err_free;
+
+	if(!(c->chunk_used = am_alloc_array_safe(num_chunks,
+						 sizeof(c->chunk_used[0]))))
+	{
+		goto out_err_free_chunks;
+	}
+
+	c->chunks[0] = wb->data;
+
+	for(i = 1; i < num_chunks; i++)
+		if(!(c->chunks[i] = malloc(wb->size)))
+			goto out_err_free_chunk_data;
+
+	c->wb = wb;
+	c->num_chunks = num_chunks;
+	c->chunk_size = wb->size;
+	c->published = 0;
+	c->flushed = 0;
+	c->num_dropped = 0;
+	c->writer = w;
+
+	am_write_buffer_set_full_fun(wb, am_async_writer_channel_full, c);
+
+	c->next = __atomic_load_n(&w->channels, __ATOMIC_RELAXED);
+
+	while(!__atomic_compare_exchange_n(&w->channels, &c->next, c, 1,
+					   __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	return 0;
+
+out_err_free_chunk_data:
+	while(--i > 0)
+		free(c->chunks[i]);
+
+	free(c->chunk_used);
+out_err_free_chunks:
+	free(c->chunks);
+out_err_free:
+	free(c);
+out_err:
+	return 1;
+}
+
+/* Dissociates the channel c from its write buffer and frees all chunks, except
+ * for the one currently used as the data buffer of the write buffer. */
+static void am_async_writer_channel_destroy(struct am_async_writer_channel* c)
+{
+	for(size_t i = 0; i < c->num_chunks; i++)
+		if(c->chunks[i] != c->wb->data)
+			free(c->chunks[i]);
+
+	am_write_buffer_set_full_fun(c->wb, NULL, NULL);
+
+	free(c->chunk_used);
+	free(c->chunks);
+}
+
+/**
+ * Stops the writer thread, writes all remaining data of all channels
+ * (including the data of chunks that are still in use by a write buffer) and
+ * dissociates all write buffers from the writer. No event must be written to
+ * any of the write buffers associated with the writer during and after the
+ * call.
+ *
+ * @return 0 on success, 1 if any data could not be written
+ */
+int am_async_writer_finish(struct am_async_writer* w)
+{
+	struct am_async_writer_channel* c;
+	struct am_async_writer_channel* next;
+
+	__atomic_store_n(&w->stop, 1, __ATOMIC_RELEASE);
+	sem_post(&w->sem);
+	pthread_join(w->thread, NULL);
+
+	for(c = w->channels; c; c = next) {
+		next = c->next;
+
+		am_async_writer_channel_flush(w, c);
+
+		if(!w->error && am_write_buffer_dump_fp(c->wb, w->fp))
+			w->error = 1;
+
+		w->num_dropped += c->num_dropped;
+
+		am_async_writer_channel_destroy(c);
+		free(c);
+	}
+
+	w->channels = NULL;
+
+	return w->error;
+}
+
+/**
+ * Frees all resources of an asynchronous writer. The writer must have been
+ * stopped with am_async_writer_finish() before.
+ */
+void am_async_writer_destroy(struct am_async_writer* w)
+{
+	sem_destroy(&w->sem);
+}
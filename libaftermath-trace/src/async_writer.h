@@ -0,0 +1,109 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * Libaftermath-trace is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_ASYNC_WRITER_H
+#define AM_ASYNC_WRITER_H
+
+#include <aftermath/trace/write_buffer.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* An asynchronous writer flushes full chunks of trace data to a file from a
+ * dedicated thread while the application keeps on recording events.
+ *
+ * Each write buffer whose data is to be flushed asynchronously is associated
+ * with a channel. A channel is a ring of equally-sized chunks, one of which is
+ * used as the data buffer of the write buffer. When a frame does not fit into
+ * the remaining space of the current chunk, the chunk is handed over to the
+ * writer thread and the next chunk of the ring becomes the write buffer's
+ * data. If no free chunk is available, the frame is dropped. The thread
+ * recording events thus never blocks on I/O and never takes a lock: chunks
+ * are exchanged with the writer thread through two monotonically increasing
+ * counters per channel, one incremented by the producer and one by the
+ * writer thread.
+ *
+ * Chunks of the same channel are written in order, but chunks of different
+ * channels may be written in any order.
+ */
+struct am_async_writer_channel {
+	/* Write buffer whose chunks are flushed by the channel */
+	struct am_write_buffer* wb;
+
+	/* Ring of num_chunks chunks of chunk_size bytes each */
+	void** chunks;
+
+	/* Number of bytes used in each chunk handed over to the writer */
+	size_t* chunk_used;
+
+	size_t num_chunks;
+	size_t chunk_size;
+
+	/* Number of chunks handed over to the writer thread; only modified by
+	 * the producer */
+	uint64_t published;
+
+	/* Number of chunks written to disk; only modified by the writer
+	 * thread */
+	uint64_t flushed;
+
+	/* Number of frames that have been dropped, since no free chunk was
+	 * available */
+	uint64_t num_dropped;
+
+	/* Writer this channel is associated with */
+	struct am_async_writer* writer;
+
+	/* Next channel of the same writer */
+	struct am_async_writer_channel* next;
+};
+
+struct am_async_writer {
+	/* File to which all chunks are written */
+	FILE* fp;
+
+	pthread_t thread;
+
+	/* Posted whenever a chunk has been handed over to the writer thread or
+	 * when the thread should terminate */
+	sem_t sem;
+
+	/* List of all channels of the writer */
+	struct am_async_writer_channel* channels;
+
+	/* Set to request the termination of the writer thread */
+	int stop;
+
+	/* Set by the writer thread if a chunk could not be written */
+	int error;
+
+	/* Total number of frames dropped by all channels; Only valid after
+	 * am_async_writer_finish() */
+	uint64_t num_dropped;
+};
+
+int am_async_writer_init(struct am_async_writer* w, FILE* fp);
+int am_async_writer_finish(struct am_async_writer* w);
+void am_async_writer_destroy(struct am_async_writer* w);
+
+int am_async_writer_add_channel(struct am_async_writer* w,
+				struct am_write_buffer* wb,
+				size_t num_chunks);
+
+#endif
@@ -19,6 +19,24 @@
 #include <aftermath/trace/buffered_trace.h>
 #include <aftermath/trace/on_disk_write_to_buffer.h>
 #include <aftermath/trace/safe_alloc.h>
+#include "compact_block.h"
+
+/* Maximum number of bytes of frames in their regular on-disk format that are
+ * encoded into a single frame block */
+#define AM_BUFFERED_TRACE_COMPACT_BLOCK_SIZE (1 << 20)
+
+/* Event collection created on demand for a thread */
+struct am_buffered_trace_thread_collection {
+	struct am_buffered_event_collection bec;
+	struct am_buffered_trace_thread_collection* next;
+};
+
+/* Iterates over all event collections created for threads */
+#define am_buffered_trace_for_each_thread_collection(bt, tc)		\
+	for(tc = __atomic_load_n(&(bt)->thread_collections,		\
+				 __ATOMIC_ACQUIRE);			\
+	    tc;								\
+	    tc = tc->next)
 
 /**
  * Initialize a buffered trace
@@ -35,20 +53,33 @@ int am_buffered_trace_init(struct am_buffered_trace* bt, size_t buffer_size)
 	if(am_write_buffer_init(&bt->data, buffer_size))
 		goto out_err;
 
+	if(pthread_key_create(&bt->thread_collection_key, NULL))
+		goto out_err_destroy_data;
+
 	bt->num_collections = 0;
 	bt->collections = NULL;
 	bt->highest_collection_id = 0;
+	bt->next_collection_id = 0;
+	bt->thread_collections = NULL;
 
 	bt->num_hierarchies = 0;
 	bt->hierarchies = NULL;
 	bt->highest_hierarchy_id = 0;
 
+	bt->writer = NULL;
+	bt->stream_num_chunks = 0;
+	bt->stream_close_fp = 0;
+	bt->num_dropped_frames = 0;
+	bt->compact = 0;
+
 	if(am_dsk_header_write_to_buffer(&bt->data, &hdr))
-		goto out_err_destroy;
+		goto out_err_delete_key;
 
 	return 0;
 
-out_err_destroy:
+out_err_delete_key:
+	pthread_key_delete(bt->thread_collection_key);
+out_err_destroy_data:
 	am_write_buffer_destroy(&bt->data);
 out_err:
 	return 1;
@@ -59,6 +90,12 @@ out_err:
  */
 void am_buffered_trace_destroy(struct am_buffered_trace* bt)
 {
+	struct am_buffered_trace_thread_collection* tc;
+	struct am_buffered_trace_thread_collection* next;
+
+	if(bt->writer)
+		am_buffered_trace_finish_streaming(bt);
+
 	for(size_t i = 0; i < bt->num_collections; i++) {
 		am_buffered_event_collection_destroy(bt->collections[i]);
 		free(bt->collections[i]);
@@ -66,6 +103,14 @@ void am_buffered_trace_destroy(struct am_buffered_trace* bt)
 
 	free(bt->collections);
 
+	for(tc = bt->thread_collections; tc; tc = next) {
+		next = tc->next;
+		am_buffered_event_collection_destroy(&tc->bec);
+		free(tc);
+	}
+
+	pthread_key_delete(bt->thread_collection_key);
+
 	for(size_t i = 0; i < bt->num_hierarchies; i++) {
 		am_simple_hierarchy_destroy(bt->hierarchies[i]);
 		free(bt->hierarchies[i]);
@@ -77,19 +122,385 @@ void am_buffered_trace_destroy(struct am_buffered_trace* bt)
 	am_write_buffer_destroy(&bt->data);
 }
 
+/**
+ * Selects whether the frames of the event collections are written as compact
+ * blocks when the trace is dumped. Compact blocks are considerably smaller
+ * than the regular on-disk representation, but can only be read with
+ * versions of Aftermath supporting trace format version 20 or later. Frames
+ * written while the trace is streamed are never compacted.
+ */
+void am_buffered_trace_set_compact(struct am_buffered_trace* bt, int compact)
+{
+	bt->compact = compact;
+}
+
+/* Writes size bytes from buf to fp and advances *offset by size. Returns 0 on
+ * success, otherwise 1. */
+static inline int am_buffered_trace_write_fp(FILE* fp,
+					     const void* buf,
+					     size_t size,
+					     uint64_t* offset)
+{
+	if(size > 0 && fwrite(buf, size, 1, fp) != 1)
+		return 1;
+
+	*offset += size;
+
+	return 0;
+}
+
+/* Dumps the contents of the write buffer wb to fp and advances *offset by the
+ * number of bytes written. Returns 0 on success, otherwise 1. */
+static inline int am_buffered_trace_dump_buffer_fp(struct am_write_buffer* wb,
+						   FILE* fp,
+						   uint64_t* offset)
+{
+	uint64_t used = wb->used;
+
+	if(am_write_buffer_dump_fp(wb, fp))
+		return 1;
+
+	*offset += used;
+
+	return 0;
+}
+
+/* Writes a frame block with the header b followed by size bytes of frames
+ * from buf to fp. An index entry for the block is appended to *entries. Wb is
+ * used as a temporary buffer for the header and *offset is the current offset
+ * in the trace file. Returns 0 on success, otherwise 1. */
+static int am_buffered_trace_write_frame_block_fp(
+	FILE* fp,
+	struct am_write_buffer* wb,
+	uint64_t* offset,
+	const struct am_dsk_frame_block* b,
+	const void* buf,
+	size_t size,
+	struct am_dsk_frame_block_index_entry** entries,
+	size_t* num_entries)
+{
+	struct am_dsk_frame_block_index_entry* e;
+	uint64_t block_offset = *offset;
+	void* tmp;
+
+	if(!(tmp = am_grow_array_safe(*entries,
+				      *num_entries,
+				      1,
+				      sizeof((*entries)[0]))))
+	{
+		return 1;
+	}
+
+	*entries = tmp;
+
+	if(am_dsk_frame_block_write_to_buffer_defid(wb, b) ||
+	   am_buffered_trace_dump_buffer_fp(wb, fp, offset) ||
+	   am_buffered_trace_write_fp(fp, buf, size, offset))
+	{
+		return 1;
+	}
+
+	e = &(*entries)[*num_entries];
+	e->collection_id = b->collection_id;
+	e->offset = block_offset;
+	e->size = *offset - block_offset;
+	e->num_frames = b->num_frames;
+	e->interval = b->interval;
+	(*num_entries)++;
+
+	return 0;
+}
+
+/* Determines the longest sequence of frames starting at raw with at most size
+ * bytes that cannot be encoded compactly and that either all belong to the
+ * event collection with the ID collection_id (if in_collection is non-zero) or
+ * that all do not belong to the event collection. The number of bytes of the
+ * sequence is returned in *seq_size and the number of frames in *num_frames.
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_buffered_trace_scan_raw_frames(const char* raw,
+					     size_t size,
+					     uint32_t collection_id,
+					     int in_collection,
+					     size_t* seq_size,
+					     uint64_t* num_frames)
+{
+	size_t pos = 0;
+	size_t frame_size;
+	uint32_t frame_collection_id;
+	uint32_t type_id;
+	uint64_t n = 0;
+	int is_member;
+
+	while(pos < size) {
+		if(am_default_on_disk_type_frame_size(raw + pos, size - pos,
+						      &frame_size))
+		{
+			return 1;
+		}
+
+		is_member = !am_default_on_disk_type_frame_collection_id(
+			raw + pos, frame_size, &frame_collection_id) &&
+			frame_collection_id == collection_id;
+
+		if(is_member != !!in_collection)
+			break;
+
+		/* Frames of the collection with a layout are encoded */
+		if(is_member) {
+			memcpy(&type_id, raw + pos, sizeof(type_id));
+			type_id = am_int32_letoh(type_id);
+
+			if(am_default_on_disk_type_compact_layout(type_id))
+				break;
+		}
+
+		pos += frame_size;
+		n++;
+	}
+
+	*seq_size = pos;
+	*num_frames = n;
+
+	return 0;
+}
+
+/* Writes the frames of the buffered event collection bec as a sequence of
+ * frame blocks to fp. Frames that can be encoded compactly are written to
+ * compact frame blocks. Other frames of the collection are written verbatim to
+ * frame blocks without compaction. Frames that do not belong to the collection
+ * (e.g., trace-global frames) are written verbatim outside of any block, such
+ * that frame blocks only ever contain frames of their event collection. For
+ * each block, an index entry is appended to *entries. Wb is used as a
+ * temporary buffer for block headers and *offset is the current offset in the
+ * trace file.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_buffered_trace_dump_collection_compact_fp(
+	struct am_buffered_event_collection* bec,
+	FILE* fp,
+	struct am_write_buffer* wb,
+	uint64_t* offset,
+	struct am_dsk_frame_block_index_entry** entries,
+	size_t* num_entries)
+{
+	struct am_dsk_frame_block b;
+	const char* raw = bec->data.data;
+	size_t size = bec->data.used;
+	size_t pos = 0;
+	size_t block_size;
+	size_t out_size;
+	size_t consumed;
+	void* out;
+	uint64_t num_frames;
+	uint64_t tmin;
+	uint64_t tmax;
+	int ret;
+
+	b.collection_id = bec->id;
+
+	while(pos < size) {
+		block_size = size - pos;
+
+		if(block_size > AM_BUFFERED_TRACE_COMPACT_BLOCK_SIZE)
+			block_size = AM_BUFFERED_TRACE_COMPACT_BLOCK_SIZE;
+
+		ret = am_compact_block_encode(raw + pos,
+					      block_size,
+					      bec->id,
+					      am_default_on_disk_type_compact_layout,
+					      &out,
+					      &out_size,
+					      &consumed,
+					      &num_frames,
+					      &tmin,
+					      &tmax);
+
+		if(ret == 1)
+			return 1;
+
+		if(ret == 2) {
+			/* Frames that do not belong to the collection */
+			if(am_buffered_trace_scan_raw_frames(raw + pos,
+							     size - pos,
+							     bec->id, 0,
+							     &consumed,
+							     &num_frames))
+			{
+				return 1;
+			}
+
+			if(consumed > 0) {
+				if(am_buffered_trace_write_fp(fp, raw + pos,
+							      consumed, offset))
+				{
+					return 1;
+				}
+
+				pos += consumed;
+				continue;
+			}
+
+			/* Frames of the collection without a layout */
+			if(am_buffered_trace_scan_raw_frames(raw + pos,
+							     size - pos,
+							     bec->id, 1,
+							     &consumed,
+							     &num_frames) ||
+			   consumed == 0)
+			{
+				return 1;
+			}
+
+			/* Time range of the frames is unknown */
+			b.flags = 0;
+			b.num_frames = num_frames;
+			b.raw_size = consumed;
+			b.size = consumed;
+			b.interval.start = 0;
+			b.interval.end = UINT64_MAX;
+
+			if(am_buffered_trace_write_frame_block_fp(
+				   fp, wb, offset, &b, raw + pos, consumed,
+				   entries, num_entries))
+			{
+				return 1;
+			}
+
+			pos += consumed;
+			continue;
+		}
+
+		/* No timestamps in the block */
+		if(tmin > tmax) {
+			tmin = 0;
+			tmax = UINT64_MAX;
+		}
+
+		b.flags = AM_DSK_FRAME_BLOCK_FLAG_COMPACT;
+		b.num_frames = num_frames;
+		b.raw_size = consumed;
+		b.size = out_size;
+		b.interval.start = tmin;
+		b.interval.end = tmax;
+
+		ret = am_buffered_trace_write_frame_block_fp(
+			fp, wb, offset, &b, out, out_size,
+			entries, num_entries);
+
+		free(out);
+
+		if(ret)
+			return 1;
+
+		pos += consumed;
+	}
+
+	return 0;
+}
+
+/* Writes the frames of all event collections as frame blocks to fp, followed
+ * by the index of all blocks. The index ends with an am_dsk_frame_block_index
+ * frame, such that it can be located from the end of the file. The trace
+ * global data must already have been written. Returns 0 on success, otherwise
+ * 1. */
+static int am_buffered_trace_dump_compact_fp(struct am_buffered_trace* bt,
+					     FILE* fp)
+{
+	struct am_dsk_frame_block_index_entry* entries = NULL;
+	struct am_buffered_trace_thread_collection* tc;
+	struct am_dsk_frame_block_index idx;
+	struct am_write_buffer wb;
+	size_t num_entries = 0;
+	uint64_t offset;
+	off_t pos;
+	int ret = 1;
+
+	/* The offset is tracked while writing, such that the index can also
+	 * be generated for non-seekable files */
+	pos = ftello(fp);
+	offset = (pos < 0) ? 0 : pos;
+
+	if(am_write_buffer_init(&wb, 128))
+		goto out;
+
+	if(am_dsk_frame_block_write_default_id_to_buffer(&wb) ||
+	   am_dsk_frame_block_index_entry_write_default_id_to_buffer(&wb) ||
+	   am_dsk_frame_block_index_write_default_id_to_buffer(&wb) ||
+	   am_buffered_trace_dump_buffer_fp(&wb, fp, &offset))
+	{
+		goto out_wb;
+	}
+
+	for(size_t i = 0; i < bt->num_collections; i++) {
+		if(am_buffered_trace_dump_collection_compact_fp(
+			   bt->collections[i], fp, &wb, &offset,
+			   &entries, &num_entries))
+		{
+			goto out_entries;
+		}
+	}
+
+	am_buffered_trace_for_each_thread_collection(bt, tc) {
+		if(am_buffered_trace_dump_collection_compact_fp(
+			   &tc->bec, fp, &wb, &offset,
+			   &entries, &num_entries))
+		{
+			goto out_entries;
+		}
+	}
+
+	idx.first_entry_offset = offset;
+	idx.num_entries = num_entries;
+
+	for(size_t i = 0; i < num_entries; i++) {
+		if(am_dsk_frame_block_index_entry_write_to_buffer_defid(
+			   &wb, &entries[i]) ||
+		   am_buffered_trace_dump_buffer_fp(&wb, fp, &offset))
+		{
+			goto out_entries;
+		}
+	}
+
+	if(am_dsk_frame_block_index_write_to_buffer_defid(&wb, &idx) ||
+	   am_buffered_trace_dump_buffer_fp(&wb, fp, &offset))
+	{
+		goto out_entries;
+	}
+
+	ret = 0;
+
+out_entries:
+	free(entries);
+out_wb:
+	am_write_buffer_destroy(&wb);
+out:
+	return ret;
+}
+
 /**
  * Write the contents of the entire trace to a file already opened
  * @return 0 on sucess, 1 on failure
  */
 int am_buffered_trace_dump_fp(struct am_buffered_trace* bt, FILE* fp)
 {
+	struct am_buffered_trace_thread_collection* tc;
+
 	if(am_write_buffer_dump_fp(&bt->data, fp))
 		return 1;
 
+	if(bt->compact)
+		return am_buffered_trace_dump_compact_fp(bt, fp);
+
 	for(size_t i = 0; i < bt->num_collections; i++)
 		if(am_buffered_event_collection_dump_fp(bt->collections[i], fp))
 			return 1;
 
+	am_buffered_trace_for_each_thread_collection(bt, tc)
+		if(am_buffered_event_collection_dump_fp(&tc->bec, fp))
+			return 1;
+
 	return 0;
 }
 
@@ -115,9 +526,166 @@ out:
 	return ret;
 }
 
+/**
+ * Starts streaming the trace to a file that is already open. The global data
+ * of the trace written so far is written to the file immediately. From then
+ * on, the buffer of each event collection is split into num_chunks chunks of
+ * the size of the collection's buffer, which are written to the file by a
+ * dedicated thread as soon as they are full. If all chunks of a collection
+ * are full, further frames for the collection are dropped.
+ *
+ * Frames on which the events of a collection depend (e.g., the description of
+ * the event collection itself) must be written either to the trace's global
+ * buffer before streaming is started or to the collection's buffer before any
+ * event of the collection. Global data written after the start is written
+ * when streaming ends. Streaming must not be started while threads obtain
+ * their event collection with am_buffered_trace_get_thread_collection() for
+ * the first time.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int am_buffered_trace_start_streaming_fp(struct am_buffered_trace* bt,
+					 FILE* fp,
+					 size_t num_chunks)
+{
+	struct am_buffered_trace_thread_collection* tc;
+
+	if(bt->writer || num_chunks < 2)
+		goto out_err;
+
+	if(am_write_buffer_dump_fp(&bt->data, fp))
+		goto out_err;
+
+	if(!(bt->writer = malloc(sizeof(*bt->writer))))
+		goto out_err;
+
+	if(am_async_writer_init(bt->writer, fp))
+		goto out_err_free;
+
+	bt->stream_num_chunks = num_chunks;
+	bt->stream_close_fp = 0;
+
+	for(size_t i = 0; i < bt->num_collections; i++) {
+		if(am_async_writer_add_channel(bt->writer,
+					       &bt->collections[i]->data,
+					       num_chunks))
+		{
+			goto out_err_finish;
+		}
+	}
+
+	am_buffered_trace_for_each_thread_collection(bt, tc) {
+		if(am_async_writer_add_channel(bt->writer, &tc->bec.data,
+					       num_chunks))
+		{
+			goto out_err_finish;
+		}
+	}
+
+	return 0;
+
+out_err_finish:
+	am_async_writer_finish(bt->writer);
+	am_async_writer_destroy(bt->writer);
+out_err_free:
+	free(bt->writer);
+	bt->writer = NULL;
+out_err:
+	return 1;
+}
+
+/**
+ * Same as am_buffered_trace_start_streaming_fp(), but opens the file with the
+ * specified name. The file is closed when streaming ends.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int am_buffered_trace_start_streaming(struct am_buffered_trace* bt,
+				      const char* filename,
+				      size_t num_chunks)
+{
+	FILE* fp;
+
+	if(!(fp = fopen(filename, "wb+")))
+		return 1;
+
+	if(am_buffered_trace_start_streaming_fp(bt, fp, num_chunks)) {
+		fclose(fp);
+		return 1;
+	}
+
+	bt->stream_close_fp = 1;
+
+	return 0;
+}
+
+/**
+ * Stops streaming the trace and writes all remaining data of the event
+ * collections and the global data written since the start to the file. No
+ * event must be written to the trace during and after the call. The number of
+ * frames that have been dropped is added to bt->num_dropped_frames.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int am_buffered_trace_finish_streaming(struct am_buffered_trace* bt)
+{
+	FILE* fp;
+	int ret = 0;
+
+	if(!bt->writer)
+		return 1;
+
+	fp = bt->writer->fp;
+
+	if(am_async_writer_finish(bt->writer))
+		ret = 1;
+
+	if(am_write_buffer_dump_fp(&bt->data, fp))
+		ret = 1;
+
+	bt->num_dropped_frames += bt->writer->num_dropped;
+
+	am_async_writer_destroy(bt->writer);
+	free(bt->writer);
+	bt->writer = NULL;
+
+	if(bt->stream_close_fp && fclose(fp))
+		ret = 1;
+
+	bt->stream_close_fp = 0;
+
+	return ret;
+}
+
+/* Returns a new, unique ID for an event collection of bt. May be called
+ * concurrently from any thread. */
+static inline am_event_collection_id_t
+am_buffered_trace_alloc_collection_id(struct am_buffered_trace* bt)
+{
+	return __atomic_fetch_add(&bt->next_collection_id, 1, __ATOMIC_RELAXED);
+}
+
+/* Ensures that IDs allocated subsequently with
+ * am_buffered_trace_alloc_collection_id() are higher than id */
+static inline void
+am_buffered_trace_reserve_collection_id(struct am_buffered_trace* bt,
+					am_event_collection_id_t id)
+{
+	am_event_collection_id_t next;
+
+	next = __atomic_load_n(&bt->next_collection_id, __ATOMIC_RELAXED);
+
+	while(next <= id &&
+	      !__atomic_compare_exchange_n(&bt->next_collection_id, &next,
+					   id + 1, 1, __ATOMIC_RELAXED,
+					   __ATOMIC_RELAXED));
+}
+
 /**
  * Adds the buffered event collection bec to the list of event collections of
- * bt. Does not check if a collection with the same ID already exists.
+ * bt. Does not check if a collection with the same ID already exists. If the
+ * trace is streamed, the buffer of the collection is flushed asynchronously
+ * from now on.
  *
  * @return 0 on success, otherwise 1.
  */
@@ -135,12 +703,23 @@ int am_buffered_trace_add_collection(struct am_buffered_trace* bt,
 	}
 
 	bt->collections = tmp;
+
+	if(bt->writer) {
+		if(am_async_writer_add_channel(bt->writer, &bec->data,
+					       bt->stream_num_chunks))
+		{
+			return 1;
+		}
+	}
+
 	bt->collections[bt->num_collections] = bec;
 	bt->num_collections++;
 
 	if(bec->id > bt->highest_collection_id)
 		bt->highest_collection_id = bec->id;
 
+	am_buffered_trace_reserve_collection_id(bt, bec->id);
+
 	return 0;
 }
 
@@ -158,7 +737,7 @@ am_buffered_trace_new_collection(struct am_buffered_trace* bt,
 	struct am_buffered_event_collection* bec;
 	am_event_collection_id_t id;
 
-	id = (bt->num_collections == 0) ? 0 : bt->highest_collection_id + 1;
+	id = am_buffered_trace_alloc_collection_id(bt);
 
 	if(!(bec = malloc(sizeof(*bec))))
 		goto out_err;
@@ -179,6 +758,98 @@ out_err:
 	return NULL;
 }
 
+/* Creates a new event collection for the calling thread, associates it with
+ * the thread and adds it to the list of thread collections of bt. Returns the
+ * new collection or NULL on failure. */
+static struct am_buffered_event_collection*
+am_buffered_trace_new_thread_collection(struct am_buffered_trace* bt,
+					size_t buffer_size)
+{
+	struct am_buffered_trace_thread_collection* tc;
+	am_event_collection_id_t id;
+
+	if(!(tc = malloc(sizeof(*tc))))
+		goto out_err;
+
+	id = am_buffered_trace_alloc_collection_id(bt);
+
+	if(am_buffered_event_collection_init(&tc->bec, id, buffer_size))
+		goto out_err_free;
+
+	if(pthread_setspecific(bt->thread_collection_key, tc))
+		goto out_err_destroy;
+
+	if(bt->writer) {
+		if(am_async_writer_add_channel(bt->writer, &tc->bec.data,
+					       bt->stream_num_chunks))
+		{
+			goto out_err_unset;
+		}
+	}
+
+	tc->next = __atomic_load_n(&bt->thread_collections, __ATOMIC_RELAXED);
+
+	while(!__atomic_compare_exchange_n(&bt->thread_collections, &tc->next,
+					   tc, 1, __ATOMIC_RELEASE,
+					   __ATOMIC_RELAXED));
+
+	return &tc->bec;
+
+out_err_unset:
+	pthread_setspecific(bt->thread_collection_key, NULL);
+out_err_destroy:
+	am_buffered_event_collection_destroy(&tc->bec);
+out_err_free:
+	free(tc);
+out_err:
+	return NULL;
+}
+
+/**
+ * Returns the buffered event collection of the calling thread. Upon the first
+ * call from a thread, a new collection with a buffer of buffer_size bytes and a
+ * unique ID is created for the thread and added to the trace. Subsequent calls
+ * from the same thread return the same collection without modifying any data
+ * shared with other threads, such that the collection can be looked up on the
+ * fast path of a runtime system. May be called concurrently from any thread,
+ * but not concurrently with starting or finishing streaming, dumping or
+ * destroying the trace.
+ *
+ * If is_new is non-NULL, *is_new is set to 1 if the collection has been
+ * created by the call, such that the caller can write the frames describing
+ * the collection (e.g., am_dsk_event_collection), and to 0 if the collection
+ * already existed. On failure, *is_new is left unchanged.
+ *
+ * IDs of collections created for threads are allocated from the same counter
+ * as those created by am_buffered_trace_new_collection() and are higher than
+ * the IDs of all collections added to the trace before.
+ *
+ * @return A pointer to the collection or NULL on failure
+ */
+struct am_buffered_event_collection*
+am_buffered_trace_get_thread_collection(struct am_buffered_trace* bt,
+					size_t buffer_size,
+					int* is_new)
+{
+	struct am_buffered_trace_thread_collection* tc;
+	struct am_buffered_event_collection* bec;
+
+	if((tc = pthread_getspecific(bt->thread_collection_key))) {
+		if(is_new)
+			*is_new = 0;
+
+		return &tc->bec;
+	}
+
+	if(!(bec = am_buffered_trace_new_thread_collection(bt, buffer_size)))
+		return NULL;
+
+	if(is_new)
+		*is_new = 1;
+
+	return bec;
+}
+
 /**
  * Adds the hierarchy h to the list of event hierarchies of bt.
  *
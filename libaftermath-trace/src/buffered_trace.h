@@ -23,11 +23,15 @@
 extern "C" {
 #endif
 
+#include <aftermath/trace/async_writer.h>
 #include <aftermath/trace/buffered_event_collection.h>
 #include <aftermath/trace/simple_hierarchy.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+struct am_buffered_trace_thread_collection;
+
 /* Root data structure for a trace during sampling. */
 struct am_buffered_trace {
 	/* Number of buffered event collections */
@@ -40,6 +44,19 @@ struct am_buffered_trace {
 	 * collections belonging to this trace */
 	am_event_collection_id_t highest_collection_id;
 
+	/* ID of the next event collection created by
+	 * am_buffered_trace_new_collection() or
+	 * am_buffered_trace_get_thread_collection(); accessed atomically */
+	am_event_collection_id_t next_collection_id;
+
+	/* Lock-free list of the event collections created on demand for
+	 * threads by am_buffered_trace_get_thread_collection() */
+	struct am_buffered_trace_thread_collection* thread_collections;
+
+	/* Key of the thread-specific pointer to the event collection of the
+	 * calling thread */
+	pthread_key_t thread_collection_key;
+
 	/* Number of hierarchies */
 	size_t num_hierarchies;
 
@@ -53,14 +70,44 @@ struct am_buffered_trace {
 	/* Trace global data, not associated to any specific worker
 	 * (e.g., event descriptions) */
 	struct am_write_buffer data;
+
+	/* Writer flushing the buffers of the event collections while the
+	 * trace is streamed; NULL if the trace is not streamed */
+	struct am_async_writer* writer;
+
+	/* Number of chunks per event collection while the trace is
+	 * streamed */
+	size_t stream_num_chunks;
+
+	/* If set, the file the trace is streamed to is closed when streaming
+	 * ends */
+	int stream_close_fp;
+
+	/* Number of frames dropped while the trace was streamed, since an
+	 * event collection ran out of free chunks */
+	uint64_t num_dropped_frames;
+
+	/* If set, the frames of the event collections are written as
+	 * compactly encoded frame blocks followed by a block index when the
+	 * trace is dumped */
+	int compact;
 };
 
 int am_buffered_trace_init(struct am_buffered_trace* bt, size_t data_size);
 void am_buffered_trace_destroy(struct am_buffered_trace* bt);
 
+void am_buffered_trace_set_compact(struct am_buffered_trace* bt, int compact);
 int am_buffered_trace_dump(struct am_buffered_trace* bt, const char* filename);
 int am_buffered_trace_dump_fp(struct am_buffered_trace* bt, FILE* fp);
 
+int am_buffered_trace_start_streaming(struct am_buffered_trace* bt,
+				      const char* filename,
+				      size_t num_chunks);
+int am_buffered_trace_start_streaming_fp(struct am_buffered_trace* bt,
+					 FILE* fp,
+					 size_t num_chunks);
+int am_buffered_trace_finish_streaming(struct am_buffered_trace* bt);
+
 struct am_buffered_event_collection*
 am_buffered_trace_new_collection(struct am_buffered_trace* bt,
 				 size_t buffer_size);
@@ -68,6 +115,11 @@ am_buffered_trace_new_collection(struct am_buffered_trace* bt,
 int am_buffered_trace_add_collection(struct am_buffered_trace* bt,
 				     struct am_buffered_event_collection* bec);
 
+struct am_buffered_event_collection*
+am_buffered_trace_get_thread_collection(struct am_buffered_trace* bt,
+					size_t buffer_size,
+					int* is_new);
+
 struct am_simple_hierarchy*
 am_buffered_trace_new_hierarchy(struct am_buffered_trace* bt,
 				const char* name,
@@ -0,0 +1,292 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * Libaftermath-trace is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#include "counter_sampler.h"
+#include <aftermath/trace/arch.h>
+#include <aftermath/trace/on_disk_write_to_buffer.h>
+#include <linux/perf_event.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Perf event type, configuration and name of each counter of enum
+ * am_counter_sampler_counter */
+static const struct {
+	uint32_t type;
+	uint64_t config;
+	const char* name;
+} am_counter_sampler_counters[AM_COUNTER_SAMPLER_NUM_COUNTERS] = {
+	[AM_COUNTER_SAMPLER_TASK_CLOCK] = {
+		PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "task-clock"
+	},
+	[AM_COUNTER_SAMPLER_CONTEXT_SWITCHES] = {
+		PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,
+		"context-switches"
+	},
+	[AM_COUNTER_SAMPLER_PAGE_FAULTS] = {
+		PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page-faults"
+	},
+	[AM_COUNTER_SAMPLER_CYCLES] = {
+		PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"
+	},
+	[AM_COUNTER_SAMPLER_INSTRUCTIONS] = {
+		PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"
+	}
+};
+
+/* Opens the counter described by the entry idx of am_counter_sampler_counters
+ * for the calling thread on any CPU. If the kernel refuses to count events in
+ * kernel mode, only events in user mode are counted.
+ *
+ * Returns the file descriptor of the counter or -1 on failure.
+ */
+static int am_counter_sampler_open(size_t idx)
+{
+	struct perf_event_attr attr;
+	int fd;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = am_counter_sampler_counters[idx].type;
+	attr.config = am_counter_sampler_counters[idx].config;
+	attr.exclude_hv = 1;
+
+	fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+	if(fd == -1 && (errno == EACCES || errno == EPERM)) {
+		attr.exclude_kernel = 1;
+		fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+
+	return fd;
+}
+
+/* Initializes a counter sampler for the calling thread. Counters is a bit mask
+ * composed of AM_COUNTER_SAMPLER_MASK() values indicating which counters should
+ * be sampled. Counters that are not supported by the system or that the
+ * process is not permitted to open are skipped silently.
+ *
+ * @param first_counter_id On-disk ID of the counter
+ * AM_COUNTER_SAMPLER_TASK_CLOCK; the IDs of the other counters follow
+ * consecutively
+ * @param period Minimal number of timestamp counter ticks between two samples
+ * taken by am_counter_sampler_sample_periodic()
+ * @param counter_event_type_id The numerical on-disk ID for the type
+ * am_dsk_counter_event
+ * @return 0 on success, 1 otherwise
+ */
+int am_counter_sampler_init(struct am_counter_sampler* s,
+			    unsigned int counters,
+			    am_counter_t first_counter_id,
+			    am_timestamp_t period,
+			    uint32_t counter_event_type_id)
+{
+	struct am_counter_sampler_entry* e;
+	long page_size = sysconf(_SC_PAGESIZE);
+	void* page;
+	int fd;
+
+	s->num_entries = 0;
+	s->period = period;
+	s->last_sample = 0;
+	s->has_sample = 0;
+	s->counter_event_type_id = counter_event_type_id;
+
+	if(counters & ~AM_COUNTER_SAMPLER_ALL)
+		return 1;
+
+	for(size_t i = 0; i < AM_COUNTER_SAMPLER_NUM_COUNTERS; i++) {
+		if(!(counters & AM_COUNTER_SAMPLER_MASK(i)))
+			continue;
+
+		if((fd = am_counter_sampler_open(i)) == -1)
+			continue;
+
+		e = &s->entries[s->num_entries++];
+		e->fd = fd;
+		e->counter_id = first_counter_id + i;
+		e->page = NULL;
+
+		/* The first page of the mapping contains the information
+		 * needed for reading the counter with rdpmc; no ring buffer
+		 * is needed since the counter is never sampled by the
+		 * kernel */
+		page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, fd, 0);
+
+		if(page != MAP_FAILED)
+			e->page = page;
+	}
+
+	return 0;
+}
+
+/* Closes all counters of a counter sampler */
+void am_counter_sampler_destroy(struct am_counter_sampler* s)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+
+	for(size_t i = 0; i < s->num_entries; i++) {
+		if(s->entries[i].page)
+			munmap(s->entries[i].page, page_size);
+
+		close(s->entries[i].fd);
+	}
+
+	s->num_entries = 0;
+}
+
+#ifdef AM_HAVE_RDPMC
+/* Reads the value of the counter of e with rdpmc if permitted by the kernel and
+ * if the counter is currently scheduled on a hardware counter. The mapped page
+ * is protected by a sequence lock that is incremented by the kernel whenever
+ * the counter is rescheduled.
+ *
+ * Returns 0 on success or 1 if the counter cannot be read from user space.
+ */
+static inline int
+am_counter_sampler_entry_read_rdpmc(const struct am_counter_sampler_entry* e,
+				    uint64_t* value)
+{
+	volatile struct perf_event_mmap_page* pg = e->page;
+	uint32_t seq;
+	uint32_t idx;
+	uint16_t width;
+	int64_t pmc;
+	int64_t offset;
+
+	if(!pg)
+		return 1;
+
+	do {
+		seq = pg->lock;
+		__atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+		idx = pg->index;
+		offset = pg->offset;
+
+		if(!pg->cap_user_rdpmc || idx == 0)
+			return 1;
+
+		width = pg->pmc_width;
+		pmc = am_rdpmc(idx - 1);
+
+		/* Sign-extend the counter value from the hardware width */
+		pmc <<= 64 - width;
+		pmc >>= 64 - width;
+
+		__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	} while(pg->lock != seq);
+
+	*value = offset + pmc;
+
+	return 0;
+}
+#endif
+
+/* Reads the current value of the counter of e.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static inline int
+am_counter_sampler_entry_read(const struct am_counter_sampler_entry* e,
+			      uint64_t* value)
+{
+#ifdef AM_HAVE_RDPMC
+	if(!am_counter_sampler_entry_read_rdpmc(e, value))
+		return 0;
+#endif
+
+	if(read(e->fd, value, sizeof(*value)) != sizeof(*value))
+		return 1;
+
+	return 0;
+}
+
+/* Reads all counters of s and writes one counter event per counter with the
+ * timestamp now to the event collection bec.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_counter_sampler_sample(struct am_counter_sampler* s,
+			      struct am_buffered_event_collection* bec,
+			      am_timestamp_t now)
+{
+	struct am_dsk_counter_event ce;
+	uint64_t value;
+
+	ce.collection_id = bec->id;
+	ce.time = now;
+
+	for(size_t i = 0; i < s->num_entries; i++) {
+		if(am_counter_sampler_entry_read(&s->entries[i], &value))
+			return 1;
+
+		ce.counter_id = s->entries[i].counter_id;
+		ce.value = value;
+
+		if(am_dsk_counter_event_write_to_buffer(&bec->data,
+							&ce,
+							s->counter_event_type_id))
+		{
+			return 1;
+		}
+	}
+
+	s->last_sample = now;
+	s->has_sample = 1;
+
+	return 0;
+}
+
+/* Writes one counter description per counter selected in the bit mask counters
+ * to the write buffer wb. The descriptions only need to be written once per
+ * trace, independently from the number of threads sampling counters.
+ *
+ * @param first_counter_id On-disk ID of the counter
+ * AM_COUNTER_SAMPLER_TASK_CLOCK, as passed to am_counter_sampler_init()
+ * @param counter_description_type_id The numerical on-disk ID for the type
+ * am_dsk_counter_description
+ * @return 0 on success, 1 otherwise
+ */
+int am_counter_sampler_write_descriptions_to_buffer(
+	struct am_write_buffer* wb,
+	unsigned int counters,
+	am_counter_t first_counter_id,
+	uint32_t counter_description_type_id)
+{
+	struct am_dsk_counter_description cd;
+
+	for(size_t i = 0; i < AM_COUNTER_SAMPLER_NUM_COUNTERS; i++) {
+		if(!(counters & AM_COUNTER_SAMPLER_MASK(i)))
+			continue;
+
+		cd.counter_id = first_counter_id + i;
+		cd.name.str = (char*)am_counter_sampler_counters[i].name;
+		cd.name.len = strlen(am_counter_sampler_counters[i].name);
+
+		if(am_dsk_counter_description_write_to_buffer(
+			   wb, &cd, counter_description_type_id))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
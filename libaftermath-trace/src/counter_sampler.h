@@ -0,0 +1,150 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * Libaftermath-trace is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_COUNTER_SAMPLER_H
+#define AM_COUNTER_SAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <aftermath/trace/base_types.h>
+#include <aftermath/trace/buffered_event_collection.h>
+#include <aftermath/trace/on_disk_default_type_ids.h>
+#include <aftermath/trace/write_buffer.h>
+
+struct perf_event_mmap_page;
+
+/* Counters that can be sampled by a counter sampler. The on-disk ID of a
+ * counter is the sampler's first counter ID plus the counter's value in this
+ * enumeration. */
+enum am_counter_sampler_counter {
+	AM_COUNTER_SAMPLER_TASK_CLOCK = 0,
+	AM_COUNTER_SAMPLER_CONTEXT_SWITCHES,
+	AM_COUNTER_SAMPLER_PAGE_FAULTS,
+	AM_COUNTER_SAMPLER_CYCLES,
+	AM_COUNTER_SAMPLER_INSTRUCTIONS,
+	AM_COUNTER_SAMPLER_NUM_COUNTERS
+};
+
+#define AM_COUNTER_SAMPLER_MASK(counter) (1u << (counter))
+#define AM_COUNTER_SAMPLER_ALL \
+	((1u << AM_COUNTER_SAMPLER_NUM_COUNTERS) - 1)
+
+/* A counter opened through perf_event_open for the sampling thread */
+struct am_counter_sampler_entry {
+	/* File descriptor returned by perf_event_open */
+	int fd;
+
+	/* Page mapped from fd for reading the counter with rdpmc; NULL if the
+	 * page could not be mapped */
+	struct perf_event_mmap_page* page;
+
+	/* On-disk ID of the counter */
+	am_counter_t counter_id;
+};
+
+/* Set of per-thread performance counters that are sampled and written as
+ * counter events into an event collection. A sampler must be initialized and
+ * used by the thread whose counters are sampled. */
+struct am_counter_sampler {
+	/* Number of counters that could be opened */
+	size_t num_entries;
+
+	/* Counters that could be opened */
+	struct am_counter_sampler_entry entries[AM_COUNTER_SAMPLER_NUM_COUNTERS];
+
+	/* Minimal distance in timestamp counter ticks between two samples
+	 * taken by am_counter_sampler_sample_periodic() */
+	am_timestamp_t period;
+
+	/* Timestamp of the last sample */
+	am_timestamp_t last_sample;
+
+	/* Non-zero if at least one sample has been taken */
+	int has_sample;
+
+	/* Numerical on-disk ID for the type am_dsk_counter_event */
+	uint32_t counter_event_type_id;
+};
+
+int am_counter_sampler_init(struct am_counter_sampler* s,
+			    unsigned int counters,
+			    am_counter_t first_counter_id,
+			    am_timestamp_t period,
+			    uint32_t counter_event_type_id);
+
+/* Same as am_counter_sampler_init, but uses the default on-disk frame type ID
+ * for counter events */
+static inline int
+am_counter_sampler_init_defid(struct am_counter_sampler* s,
+			      unsigned int counters,
+			      am_counter_t first_counter_id,
+			      am_timestamp_t period)
+{
+	return am_counter_sampler_init(
+		s, counters, first_counter_id, period,
+		am_default_on_disk_type_ids.am_dsk_counter_event);
+}
+
+void am_counter_sampler_destroy(struct am_counter_sampler* s);
+
+int am_counter_sampler_sample(struct am_counter_sampler* s,
+			      struct am_buffered_event_collection* bec,
+			      am_timestamp_t now);
+
+/* Samples all counters of s if at least s->period ticks have passed since the
+ * last sample or if no sample has been taken yet.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static inline int
+am_counter_sampler_sample_periodic(struct am_counter_sampler* s,
+				   struct am_buffered_event_collection* bec,
+				   am_timestamp_t now)
+{
+	if(s->has_sample && now - s->last_sample < s->period)
+		return 0;
+
+	return am_counter_sampler_sample(s, bec, now);
+}
+
+int am_counter_sampler_write_descriptions_to_buffer(
+	struct am_write_buffer* wb,
+	unsigned int counters,
+	am_counter_t first_counter_id,
+	uint32_t counter_description_type_id);
+
+/* Same as am_counter_sampler_write_descriptions_to_buffer, but uses the default
+ * on-disk frame type ID for counter descriptions */
+static inline int
+am_counter_sampler_write_descriptions_to_buffer_defid(
+	struct am_write_buffer* wb,
+	unsigned int counters,
+	am_counter_t first_counter_id)
+{
+	return am_counter_sampler_write_descriptions_to_buffer(
+		wb, counters, first_counter_id,
+		am_default_on_disk_type_ids.am_dsk_counter_description);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -31,6 +31,7 @@ int am_state_stack_init(struct am_state_stack* s, size_t max_entries)
 {
 	s->size = max_entries;
 	s->top = 0;
+	s->sampler = NULL;
 
 	if(!(s->entries = am_alloc_array_safe(s->size, sizeof(*s->entries))))
 		return 1;
@@ -76,6 +77,22 @@ int am_state_stack_push(struct am_state_stack* s,
 	return 0;
 }
 
+/**
+ * Samples the counters of the sampler associated with a state stack, if any,
+ * at a state transition at time ts.
+ * @return 0 on success, 1 otherwise
+ */
+static inline int
+am_state_stack_sample_counters(struct am_state_stack* s,
+			       struct am_buffered_event_collection* bec,
+			       am_timestamp_t ts)
+{
+	if(!s->sampler)
+		return 0;
+
+	return am_counter_sampler_sample_periodic(s->sampler, bec, ts);
+}
+
 /**
  * Push a new state onto the stack and create a new state event in an
  * event collection. The timestamp for the start of the event is the
@@ -116,7 +133,7 @@ int am_state_stack_push_trace(struct am_state_stack* s,
 		}
 	}
 
-	return 0;
+	return am_state_stack_sample_counters(s, bec, start_ts);
 }
 
 /**
@@ -174,7 +191,8 @@ int am_state_stack_pop_trace(struct am_state_stack* s,
 
 	if(am_dsk_state_event_write_to_buffer(&bec->data,
 					      &se,
-					      state_event_type_id))
+					      state_event_type_id) ||
+	   am_state_stack_sample_counters(s, bec, end_ts))
 	{
 		return 1;
 	}
@@ -217,6 +235,7 @@ int am_state_stack_try_pop_trace(struct am_state_stack* s,
 	if(am_dsk_state_event_write_to_buffer(&bec->data,
 					      &se,
 					      state_event_type_id) ||
+	   am_state_stack_sample_counters(s, bec, end_ts) ||
 	   am_state_stack_pop(s, end_ts))
 	{
 		if(err)
@@ -25,6 +25,7 @@ extern "C" {
 
 #include <aftermath/trace/base_types.h>
 #include <aftermath/trace/buffered_event_collection.h>
+#include <aftermath/trace/counter_sampler.h>
 #include <aftermath/trace/on_disk_default_type_ids.h>
 
 /* Single entry on a state stack */
@@ -45,11 +46,27 @@ struct am_state_stack {
 
 	/* Actual stack entries */
 	struct am_state_stack_entry* entries;
+
+	/* Optional counter sampler invoked on every traced state transition;
+	 * NULL if no counters are sampled */
+	struct am_counter_sampler* sampler;
 };
 
 int am_state_stack_init(struct am_state_stack* s, size_t max_entries);
 void am_state_stack_destroy(struct am_state_stack* s);
 int am_state_stack_is_empty(struct am_state_stack* s);
+
+/* Associates the counter sampler cs with the state stack s. Counters are
+ * sampled periodically on state transitions traced by
+ * am_state_stack_push_trace(), am_state_stack_pop_trace() and
+ * am_state_stack_try_pop_trace(). Cs may be NULL to stop sampling. */
+static inline void
+am_state_stack_set_counter_sampler(struct am_state_stack* s,
+				   struct am_counter_sampler* cs)
+{
+	s->sampler = cs;
+}
+
 int am_state_stack_push(struct am_state_stack* s,
 			am_state_t state,
 			am_timestamp_t tsc);
@@ -0,0 +1,251 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * Libaftermath-trace is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#define _GNU_SOURCE
+#include "tsc_calibration.h"
+#include <aftermath/trace/on_disk_write_to_buffer.h>
+#include <aftermath/trace/safe_alloc.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef AM_TSC_IS_MONOTONIC_CLOCK
+
+#define AM_TSC_CALIBRATION_NUM_SAMPLES 32
+
+/* Pair of a timestamp counter value and the value of CLOCK_MONOTONIC_RAW in
+ * nanoseconds taken at the same moment */
+struct am_tsc_calibration_sample {
+	uint64_t tsc;
+	uint64_t ns;
+};
+
+/* Takes a sample of the timestamp counter and CLOCK_MONOTONIC_RAW. The clock is
+ * read between two ordered reads of the counter and the midpoint of the two
+ * counter values is used. The sample with the smallest distance between the
+ * two counter values out of AM_TSC_CALIBRATION_NUM_SAMPLES attempts is
+ * returned in *s, which filters out samples disturbed by interrupts.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_tsc_calibration_sample(struct am_tsc_calibration_sample* s)
+{
+	struct timespec ts;
+	uint64_t before;
+	uint64_t after;
+	uint64_t min_delta = UINT64_MAX;
+
+	for(int i = 0; i < AM_TSC_CALIBRATION_NUM_SAMPLES; i++) {
+		before = am_tsc_ordered();
+
+		if(clock_gettime(CLOCK_MONOTONIC_RAW, &ts))
+			return 1;
+
+		after = am_tsc_ordered();
+
+		if(after - before < min_delta) {
+			min_delta = after - before;
+			s->tsc = before + (after - before) / 2;
+			s->ns = (uint64_t)ts.tv_sec * 1000000000 +
+				(uint64_t)ts.tv_nsec;
+		}
+	}
+
+	return 0;
+}
+
+/* Returns the difference between the counter value of the sample s and the
+ * counter value expected for the sample's time with a counter running at
+ * ticks_per_second. */
+static int64_t am_tsc_calibration_sample_skew(
+	const struct am_tsc_calibration_sample* s,
+	uint64_t ticks_per_second)
+{
+	uint64_t expected;
+
+	/* Split the conversion into seconds and nanoseconds to avoid
+	 * overflows */
+	expected = (s->ns / 1000000000) * ticks_per_second +
+		((s->ns % 1000000000) * ticks_per_second) / 1000000000;
+
+	return (int64_t)(s->tsc - expected);
+}
+
+/* Measures the frequency of the timestamp counter by taking two samples
+ * duration_ms milliseconds apart.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_tsc_calibration_measure_frequency(struct am_tsc_calibration* c,
+						unsigned int duration_ms)
+{
+	struct am_tsc_calibration_sample start;
+	struct am_tsc_calibration_sample end;
+	struct timespec ts;
+
+	ts.tv_sec = duration_ms / 1000;
+	ts.tv_nsec = (duration_ms % 1000) * 1000000;
+
+	if(am_tsc_calibration_sample(&start))
+		return 1;
+
+	while(nanosleep(&ts, &ts));
+
+	if(am_tsc_calibration_sample(&end))
+		return 1;
+
+	if(end.ns <= start.ns || end.tsc <= start.tsc)
+		return 1;
+
+	c->ticks_per_second = (uint64_t)
+		((double)(end.tsc - start.tsc) * 1000000000.0 /
+		 (double)(end.ns - start.ns));
+
+	return 0;
+}
+
+/* Determines the offsets of the counters of all CPUs the calling thread may run
+ * on by migrating the thread to each of these CPUs and by comparing the skew of
+ * the counter with respect to CLOCK_MONOTONIC_RAW to the skew of the first CPU.
+ * The affinity of the calling thread is restored before returning. Offsets of
+ * CPUs the thread may not run on are set to 0.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+static int am_tsc_calibration_measure_offsets(struct am_tsc_calibration* c)
+{
+	struct am_tsc_calibration_sample s;
+	cpu_set_t orig_set;
+	cpu_set_t set;
+	int64_t ref_skew = 0;
+	int64_t skew;
+	int have_ref = 0;
+	int ret = 1;
+
+	if(sched_getaffinity(0, sizeof(orig_set), &orig_set))
+		return 1;
+
+	for(size_t cpu = 0; cpu < c->num_cpus && cpu < CPU_SETSIZE; cpu++) {
+		if(!CPU_ISSET(cpu, &orig_set))
+			continue;
+
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+
+		/* CPU might have gone offline in the meantime */
+		if(sched_setaffinity(0, sizeof(set), &set))
+			continue;
+
+		if(am_tsc_calibration_sample(&s))
+			goto out_restore;
+
+		skew = am_tsc_calibration_sample_skew(&s, c->ticks_per_second);
+
+		if(!have_ref) {
+			ref_skew = skew;
+			have_ref = 1;
+		}
+
+		c->offsets[cpu] = skew - ref_skew;
+	}
+
+	ret = 0;
+
+out_restore:
+	if(sched_setaffinity(0, sizeof(orig_set), &orig_set))
+		ret = 1;
+
+	return ret;
+}
+
+#endif
+
+/* Calibrates the timestamp counter by measuring its frequency over
+ * duration_ms milliseconds and the offsets of the counters of all
+ * CPUs. Migrates the calling thread temporarily to every CPU it may run on.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_tsc_calibration_init(struct am_tsc_calibration* c,
+			    unsigned int duration_ms)
+{
+	long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+
+	if(num_cpus < 1)
+		return 1;
+
+	c->num_cpus = num_cpus;
+
+	if(!(c->offsets = am_alloc_array_safe(c->num_cpus, sizeof(c->offsets[0]))))
+		return 1;
+
+	for(size_t i = 0; i < c->num_cpus; i++)
+		c->offsets[i] = 0;
+
+#ifdef AM_TSC_IS_MONOTONIC_CLOCK
+	/* Timestamps are already in nanoseconds and identical on all CPUs */
+	(void)duration_ms;
+	c->ticks_per_second = 1000000000;
+
+	return 0;
+#else
+	if(am_tsc_calibration_measure_frequency(c, duration_ms))
+		goto out_err_free;
+
+	if(am_tsc_calibration_measure_offsets(c))
+		goto out_err_free;
+
+	return 0;
+
+out_err_free:
+	free(c->offsets);
+	return 1;
+#endif
+}
+
+void am_tsc_calibration_destroy(struct am_tsc_calibration* c)
+{
+	free(c->offsets);
+}
+
+/* Writes one frame of type am_dsk_timestamp_calibration per CPU to the write
+ * buffer wb.
+ *
+ * Returns 0 on success, otherwise 1.
+ */
+int am_tsc_calibration_write_to_buffer(struct am_write_buffer* wb,
+				       const struct am_tsc_calibration* c,
+				       uint32_t timestamp_calibration_type)
+{
+	struct am_dsk_timestamp_calibration dsk_tc;
+
+	for(size_t cpu = 0; cpu < c->num_cpus; cpu++) {
+		dsk_tc.cpu = cpu;
+		dsk_tc.ticks_per_second = c->ticks_per_second;
+		dsk_tc.offset = c->offsets[cpu];
+
+		if(am_dsk_timestamp_calibration_write_to_buffer(
+			   wb, &dsk_tc, timestamp_calibration_type))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * Author: Andi Drebes <andi@drebesium.org>
+ *
+ * Libaftermath-trace is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ */
+
+#ifndef AM_TSC_CALIBRATION_H
+#define AM_TSC_CALIBRATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <aftermath/trace/arch.h>
+#include <aftermath/trace/base_types.h>
+#include <aftermath/trace/write_buffer.h>
+#include <aftermath/trace/on_disk_default_type_ids.h>
+#include <stddef.h>
+
+/* Frequency of the timestamp counter and offsets of the counters of all CPUs
+ * with respect to the counter of a reference CPU, measured against
+ * CLOCK_MONOTONIC_RAW */
+struct am_tsc_calibration {
+	/* Number of timestamp counter ticks per second */
+	uint64_t ticks_per_second;
+
+	/* Number of entries in offsets */
+	size_t num_cpus;
+
+	/* Per-CPU value by which the counter of a CPU is ahead of the counter
+	 * of the reference CPU; indexed by CPU number */
+	int64_t* offsets;
+};
+
+int am_tsc_calibration_init(struct am_tsc_calibration* c,
+			    unsigned int duration_ms);
+void am_tsc_calibration_destroy(struct am_tsc_calibration* c);
+
+int am_tsc_calibration_write_to_buffer(struct am_write_buffer* wb,
+				       const struct am_tsc_calibration* c,
+				       uint32_t timestamp_calibration_type);
+
+/* Same as am_tsc_calibration_write_to_buffer, but uses the default on-disk type
+ * ID for am_dsk_timestamp_calibration. */
+static inline int
+am_tsc_calibration_write_to_buffer_defid(struct am_write_buffer* wb,
+					 const struct am_tsc_calibration* c)
+{
+	return am_tsc_calibration_write_to_buffer(
+		wb,
+		c,
+		am_default_on_disk_type_ids.am_dsk_timestamp_calibration);
+}
+
+/* Returns the current value of the executing CPU's timestamp counter, corrected
+ * by the offset of that CPU, such that timestamps taken on different CPUs can
+ * be compared with each other. */
+static inline am_timestamp_t
+am_tsc_calibration_now(const struct am_tsc_calibration* c)
+{
+	uint32_t cpu;
+	uint64_t tsc = am_tscp(&cpu);
+
+	if(cpu < c->num_cpus)
+		tsc -= (uint64_t)c->offsets[cpu];
+
+	return tsc;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif